@@ -0,0 +1,36 @@
+/**************************************************************************************************
+* Arquivo:      monotonic_clock.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Relógio monotônico em microssegundos, comum ao driver e à aplicação
+* (esp_timer no ESP32, CLOCK_MONOTONIC no target linux).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF) / gcc
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef MONOTONIC_CLOCK_H
+#define MONOTONIC_CLOCK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Instante atual em microssegundos. Só diferenças entre leituras têm significado.
+ */
+int64_t monotonic_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MONOTONIC_CLOCK_H
@@ -1,8 +1,8 @@
 /**************************************************************************************************
 * Arquivo:      sercalo_i2c.h
 * Autor:        Felipe Oliveira Barino
-* Data:         2024-07-18
-* Versão:       0.1.2
+* Data:         2026-10-18
+* Versão:       0.4.0
 *
 * Descrição:    Arquivo de cabeçalho (header) para o driver do Filtro Óptico
 * Sintonizável Sercalo TF1. Define a interface pública do driver,
@@ -16,15 +16,30 @@
 * [2024-05-21] - [Barino] - [0.1.0] - Versão inicial para Switch
 * [2024-07-14] - [Barino] - [0.1.1] - Modificado para controle do Filtro Óptico Sintonizável TF1
 * [2024-07-18] - [Barino] - [0.1.2] - Documentação e comentários extensivos.
+* [2026-10-18] - [Barino] - [0.2.0] - Backend simulado (CONFIG_SERCALO_I2C_SIMULATOR) e target linux.
+* [2026-10-18] - [Barino] - [0.3.0] - Quadros pré-codificados (sercalo_encode_cmd/sercalo_send_frame).
+* [2026-10-18] - [Barino] - [0.4.0] - Contadores das transações (sercalo_get_bus_stats).
 *
 **************************************************************************************************/
 
 #ifndef SERCALO_I2C_H
 #define SERCALO_I2C_H
 
-#include "driver/i2c.h"
+#include "sdkconfig.h"
 #include "esp_err.h"
 
+#if CONFIG_IDF_TARGET_LINUX
+// O target de host não possui o driver I2C; apenas os tipos usados pela interface são definidos.
+#include <stdint.h>
+#include <stddef.h>
+typedef int i2c_port_t;
+#define I2C_NUM_0           0
+#define I2C_MASTER_WRITE    0
+#define I2C_MASTER_READ     1
+#else
+#include "driver/i2c.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -55,6 +70,10 @@ extern "C" {
 #define SERCALO_CMD_WVMIN       0x56 // Retorna o comprimento de onda mínimo selecionável
 #define SERCALO_CMD_WVMAX       0x57 // Retorna o comprimento de onda máximo selecionável
 
+// --- Quadros de Comando ---
+#define SERCALO_FRAME_LEN(params_len)   ((params_len) + 3)      // Cmd + Len + Parâmetros + CRC
+#define SERCALO_SET_FRAME_LEN           SERCALO_FRAME_LEN(8)    // Quadro do comando SET (4 eixos)
+
 
 // --- Estruturas e Tipos de Dados Públicos ---
 
@@ -96,6 +115,18 @@ typedef enum {
     SERCALO_POWER_NORMAL = 1  /*!< Modo de operação normal. */
 } sercalo_power_mode_t;
 
+/**
+ * @brief Contadores acumulados das transações de todos os dispositivos (desde a partida).
+ */
+typedef struct {
+    uint32_t transactions;      /*!< Transações iniciadas (envio + leitura da resposta). */
+    uint32_t bus_errors;        /*!< Falhas de escrita ou de leitura no barramento (NACK, timeout). */
+    uint32_t invalid_responses; /*!< Respostas curtas, com eco inesperado ou tamanho além do lido. */
+    uint32_t crc_errors;        /*!< Respostas com CRC incorreto. */
+    uint32_t device_errors;     /*!< Respostas de erro do dispositivo (eco com o bit 0x80). */
+    uint64_t busy_us;           /*!< Tempo total das transações, incluindo a espera da resposta. */
+} sercalo_bus_stats_t;
+
 
 // --- Protótipos de Funções Públicas ---
 
@@ -131,6 +162,43 @@ esp_err_t sercalo_i2c_init_device(sercalo_dev_t *dev, i2c_port_t i2c_port, uint8
 esp_err_t sercalo_send_cmd_receive_reply(sercalo_dev_t *dev, uint8_t cmd_code,
                                          const uint8_t *params_write, uint8_t params_write_len,
                                          uint8_t *reply_data_buffer, uint8_t *actual_reply_data_len, size_t max_reply_data_len);
+
+/**
+ * @brief Codifica o quadro de um comando (cabeçalho, parâmetros e CRC).
+ *
+ * O quadro depende apenas do comando, dos parâmetros e do endereço do dispositivo,
+ * e pode ser montado antecipadamente e reenviado com `sercalo_send_frame`
+ * (ex.: os pontos de uma varredura do espelho).
+ *
+ * @param dev Dispositivo de destino (o endereço entra no CRC).
+ * @param cmd_code O código do comando.
+ * @param params_write Parâmetros do comando. NULL se não houver.
+ * @param params_write_len Número de bytes de parâmetros.
+ * @param[out] frame Buffer do quadro (ao menos SERCALO_FRAME_LEN(params_write_len) bytes).
+ * @param frame_size Tamanho do buffer.
+ * @return Tamanho do quadro, ou 0 se o buffer for pequeno demais.
+ */
+size_t sercalo_encode_cmd(const sercalo_dev_t *dev, uint8_t cmd_code,
+                          const uint8_t *params_write, uint8_t params_write_len,
+                          uint8_t *frame, size_t frame_size);
+
+/**
+ * @brief Envia um quadro já codificado e recebe a resposta.
+ *
+ * Executa a transação de `sercalo_send_cmd_receive_reply` (envio, espera de
+ * CONFIG_SERCALO_REPLY_WAIT_MS, leitura e validação da resposta) sem montar o quadro.
+ *
+ * @param dev Ponteiro para o dispositivo inicializado.
+ * @param frame Quadro de `sercalo_encode_cmd` (o comando é o primeiro byte).
+ * @param frame_len Tamanho do quadro.
+ * @param[out] reply_data_buffer Buffer para os dados da resposta. Pode ser NULL.
+ * @param[out] actual_reply_data_len Tamanho real dos dados da resposta. Pode ser NULL.
+ * @param max_reply_data_len O tamanho máximo do `reply_data_buffer`.
+ * @return ESP_OK em sucesso, ou um código de erro do ESP-IDF em caso de falha.
+ */
+esp_err_t sercalo_send_frame(sercalo_dev_t *dev, const uint8_t *frame, size_t frame_len,
+                             uint8_t *reply_data_buffer, uint8_t *actual_reply_data_len, size_t max_reply_data_len);
+
 /**
  * @brief Calcula o checksum CRC-8 para uma mensagem.
  *
@@ -140,6 +208,14 @@ esp_err_t sercalo_send_cmd_receive_reply(sercalo_dev_t *dev, uint8_t cmd_code,
  */
 uint8_t sercalo_calculate_crc8(const uint8_t *msg, size_t len);
 
+/**
+ * @brief Copia os contadores das transações (ver `sercalo_bus_stats_t`).
+ *
+ * Os contadores são atualizados por `sercalo_send_frame`, nunca zerados; a
+ * ocupação do barramento é a derivada de `busy_us`.
+ */
+void sercalo_get_bus_stats(sercalo_bus_stats_t *stats);
+
 // --- Funções da API de Alto Nível ---
 
 /**
@@ -182,6 +258,16 @@ esp_err_t sercalo_get_temperature(sercalo_dev_t *dev, int8_t *temperature);
  */
 esp_err_t sercalo_set_mirror_position(sercalo_dev_t *dev, const sercalo_mirror_pos_t *pos);
 
+/**
+ * @brief Codifica o quadro SET de uma posição do espelho, para envio com `sercalo_send_frame`.
+ * @param dev Dispositivo de destino.
+ * @param pos Posições dos 4 eixos.
+ * @param[out] frame Buffer do quadro.
+ * @return SERCALO_SET_FRAME_LEN, ou 0 se `pos` for nulo.
+ */
+size_t sercalo_encode_mirror_position(const sercalo_dev_t *dev, const sercalo_mirror_pos_t *pos,
+                                      uint8_t frame[SERCALO_SET_FRAME_LEN]);
+
 /**
  * @brief Obtém a posição atual do espelho MEMS.
  * @param dev Ponteiro para o dispositivo.
@@ -0,0 +1,60 @@
+/**************************************************************************************************
+* Arquivo:      sercalo_sim.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Interface do modelo simulado do Filtro Óptico Sintonizável Sercalo TF1.
+* Quando CONFIG_SERCALO_I2C_SIMULATOR está habilitado, o driver encaminha
+* as transações I2C para estas funções em vez do periférico do ESP32.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF) / gcc
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_SIM_H
+#define SERCALO_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Simula a escrita de um quadro de comando para o dispositivo no endereço indicado.
+ *
+ * O quadro é validado (tamanho e CRC-8) e processado imediatamente; a resposta
+ * fica armazenada até a próxima chamada a `sercalo_sim_read`.
+ *
+ * @param device_address_7bit Endereço de 7 bits do dispositivo simulado.
+ * @param data Quadro completo (comando, tamanho, parâmetros e CRC).
+ * @param len Tamanho do quadro em bytes.
+ * @return ESP_OK se o dispositivo existe e aceitou o quadro.
+ * @return ESP_FAIL se nenhum dispositivo simulado responde no endereço (equivalente a um NACK I2C).
+ */
+esp_err_t sercalo_sim_write(uint8_t device_address_7bit, const uint8_t *data, size_t len);
+
+/**
+ * @brief Simula a leitura da resposta pendente do dispositivo no endereço indicado.
+ *
+ * Bytes além do tamanho da resposta são preenchidos com 0xFF, como no barramento real.
+ *
+ * @param device_address_7bit Endereço de 7 bits do dispositivo simulado.
+ * @param[out] data Buffer de destino.
+ * @param len Número de bytes a ler.
+ * @return ESP_OK em sucesso, ESP_FAIL se nenhum dispositivo responde no endereço.
+ */
+esp_err_t sercalo_sim_read(uint8_t device_address_7bit, uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERCALO_SIM_H
@@ -0,0 +1,37 @@
+/**************************************************************************************************
+* Arquivo:      monotonic_clock.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Implementação do relógio monotônico (ver monotonic_clock.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF) / gcc
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "monotonic_clock.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_timer.h"
+#endif
+
+/**
+ * {@inheritdoc}
+ */
+int64_t monotonic_us(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    return esp_timer_get_time();
+#endif
+}
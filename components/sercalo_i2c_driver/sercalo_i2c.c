@@ -1,8 +1,8 @@
 /**************************************************************************************************
 * Arquivo:      sercalo_i2c.c
 * Autor:        Felipe Oliveira Barino
-* Data:         2024-07-18
-* Versão:       0.1.2
+* Data:         2026-10-18
+* Versão:       0.4.2
 *
 * Descrição:    Implementação do driver de baixo nível para comunicação I2C com o
 * Filtro Óptico Sintonizável Sercalo TF1. Este arquivo contém a lógica
@@ -16,15 +16,27 @@
 * [2025-05-21] - [Barino] - [0.1.0] - Versão inicial para Switch
 * [2024-07-14] - [Barino] - [0.1.1] - Adaptado para o Filtro Óptico Sintonizável TF1.
 * [2024-07-18] - [Barino] - [0.1.2] - Documentação e comentários extensivos.
+* [2026-10-18] - [Barino] - [0.2.0] - Acesso ao barramento isolado em bus_write/bus_read (suporte ao simulador).
+* [2026-10-18] - [Barino] - [0.3.0] - Quadros pré-codificados (sercalo_encode_cmd/sercalo_send_frame) e espera configurável.
+* [2026-10-18] - [Barino] - [0.4.0] - Contadores de transações, erros e ocupação do barramento.
+* [2026-10-18] - [Barino] - [0.4.1] - Rejeita respostas cujo tamanho declarado excede os bytes lidos.
+* [2026-10-18] - [Barino] - [0.4.2] - Relógio monotônico comum (monotonic_us).
 *
 **************************************************************************************************/
 
 #include "sercalo_i2c.h"
+#include "sercalo_sim.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <string.h> // Para memcpy, strtok_r
+#include "monotonic_clock.h"
 
 static const char *TAG = "sercalo_i2c";
 
+static sercalo_bus_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
 // --- Funções Auxiliares Internas ---
 
 /**
@@ -90,6 +102,41 @@ static void float_to_bytes_be(float f, uint8_t *b) {
     b[3] = converter.bytes[0]; // LSB
 }
 
+/**
+ * @brief Escreve um quadro no barramento (I2C real ou dispositivo simulado).
+ */
+static esp_err_t bus_write(sercalo_dev_t *dev, const uint8_t *data, size_t len) {
+#if CONFIG_SERCALO_I2C_SIMULATOR
+    return sercalo_sim_write(dev->device_address_7bit, data, len);
+#else
+    return i2c_master_write_to_device(dev->i2c_port, dev->device_address_7bit, data, len, pdMS_TO_TICKS(200));
+#endif
+}
+
+/**
+ * @brief Lê uma resposta do barramento (I2C real ou dispositivo simulado).
+ */
+static esp_err_t bus_read(sercalo_dev_t *dev, uint8_t *data, size_t len) {
+#if CONFIG_SERCALO_I2C_SIMULATOR
+    return sercalo_sim_read(dev->device_address_7bit, data, len);
+#else
+    return i2c_master_read_from_device(dev->i2c_port, dev->device_address_7bit, data, len, pdMS_TO_TICKS(200));
+#endif
+}
+
+/**
+ * @brief Soma uma transação encerrada aos contadores.
+ * @param counter Contador de erro a incrementar, ou NULL se a transação teve sucesso.
+ */
+static void count_transaction(int64_t start_us, uint32_t *counter) {
+    int64_t elapsed = monotonic_us() - start_us;
+    taskENTER_CRITICAL(&s_stats_lock);
+    s_stats.transactions++;
+    s_stats.busy_us += (elapsed > 0) ? (uint64_t)elapsed : 0;
+    if (counter != NULL) (*counter)++;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
 // --- Funções Principais do Driver ---
 
 /**
@@ -119,63 +166,90 @@ uint8_t sercalo_calculate_crc8(const uint8_t *msg, size_t len) {
 /**
  * {@inheritdoc}
  */
-esp_err_t sercalo_send_cmd_receive_reply(sercalo_dev_t *dev, uint8_t cmd_code,
-                                         const uint8_t *params_write, uint8_t params_write_len,
-                                         uint8_t *reply_data_buffer, uint8_t *actual_reply_data_len, size_t max_reply_data_len) {
-    if (dev == NULL) return ESP_ERR_INVALID_STATE;
+size_t sercalo_encode_cmd(const sercalo_dev_t *dev, uint8_t cmd_code,
+                          const uint8_t *params_write, uint8_t params_write_len,
+                          uint8_t *frame, size_t frame_size) {
+    if (dev == NULL || frame == NULL || SERCALO_FRAME_LEN(params_write_len) > frame_size) return 0;
 
-    esp_err_t ret;
-    uint8_t tx_buffer[32];
-    uint8_t rx_buffer[32];
     size_t tx_len = 0;
 
     // 1. Monta o pacote de transmissão (payload)
-    tx_buffer[tx_len++] = cmd_code;
-    tx_buffer[tx_len++] = params_write_len;
+    frame[tx_len++] = cmd_code;
+    frame[tx_len++] = params_write_len;
     if (params_write_len > 0 && params_write != NULL) {
-        if (tx_len + params_write_len + 1 > sizeof(tx_buffer)) {
-            ESP_LOGE(TAG, "Buffer TX (cmd 0x%02X) pequeno demais", cmd_code);
-            return ESP_ERR_NO_MEM;
-        }
-        memcpy(&tx_buffer[tx_len], params_write, params_write_len);
+        memcpy(&frame[tx_len], params_write, params_write_len);
         tx_len += params_write_len;
     }
 
     // 2. Calcula o CRC8 do pacote de transmissão
     // O CRC inclui o endereço de escrita do dispositivo.
-    uint8_t crc_calc_buffer_write[1 + sizeof(tx_buffer)];
-    size_t crc_calc_len_write = 0;
-    crc_calc_buffer_write[crc_calc_len_write++] = (dev->device_address_7bit << 1) | I2C_MASTER_WRITE;
-    memcpy(&crc_calc_buffer_write[crc_calc_len_write], tx_buffer, tx_len);
-    crc_calc_len_write += tx_len;
-    tx_buffer[tx_len++] = sercalo_calculate_crc8(crc_calc_buffer_write, crc_calc_len_write);
+    uint8_t crc = crc8_table[(dev->device_address_7bit << 1) | I2C_MASTER_WRITE];
+    for (size_t i = 0; i < tx_len; i++) {
+        crc = crc8_table[crc ^ frame[i]];
+    }
+    frame[tx_len++] = crc;
+    return tx_len;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sercalo_send_cmd_receive_reply(sercalo_dev_t *dev, uint8_t cmd_code,
+                                         const uint8_t *params_write, uint8_t params_write_len,
+                                         uint8_t *reply_data_buffer, uint8_t *actual_reply_data_len, size_t max_reply_data_len) {
+    if (dev == NULL) return ESP_ERR_INVALID_STATE;
+
+    uint8_t tx_buffer[32];
+    size_t tx_len = sercalo_encode_cmd(dev, cmd_code, params_write, params_write_len, tx_buffer, sizeof(tx_buffer));
+    if (tx_len == 0) {
+        ESP_LOGE(TAG, "Buffer TX (cmd 0x%02X) pequeno demais", cmd_code);
+        return ESP_ERR_NO_MEM;
+    }
+    return sercalo_send_frame(dev, tx_buffer, tx_len, reply_data_buffer, actual_reply_data_len, max_reply_data_len);
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sercalo_send_frame(sercalo_dev_t *dev, const uint8_t *tx_buffer, size_t tx_len,
+                             uint8_t *reply_data_buffer, uint8_t *actual_reply_data_len, size_t max_reply_data_len) {
+    if (dev == NULL) return ESP_ERR_INVALID_STATE;
+    if (tx_buffer == NULL || tx_len < SERCALO_FRAME_LEN(0)) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t ret;
+    uint8_t rx_buffer[32];
+    uint8_t cmd_code = tx_buffer[0];
 
     ESP_LOGD(TAG, "TX (cmd 0x%02X, addr 0x%02X, len %zu): ...", cmd_code, dev->device_address_7bit, tx_len);
+    int64_t start_us = monotonic_us();
 
     // 3. Envia o comando via I2C
-    ret = i2c_master_write_to_device(dev->i2c_port, dev->device_address_7bit, tx_buffer, tx_len, pdMS_TO_TICKS(200));
+    ret = bus_write(dev, tx_buffer, tx_len);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Erro ao enviar comando 0x%02X: %s", cmd_code, esp_err_to_name(ret));
+        count_transaction(start_us, &s_stats.bus_errors);
         return ret;
     }
 
     // 4. Aguarda o dispositivo processar o comando
-    vTaskDelay(pdMS_TO_TICKS(150));
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_SERCALO_REPLY_WAIT_MS));
 
     // 5. Lê a resposta do dispositivo
     size_t rx_read_attempt_len = 1 + 1 + max_reply_data_len + 1; // Cmd_echo + Len/Err + Max_Payload + CRC
     if (rx_read_attempt_len > sizeof(rx_buffer)) {
         rx_read_attempt_len = sizeof(rx_buffer);
     }
-    ret = i2c_master_read_from_device(dev->i2c_port, dev->device_address_7bit, rx_buffer, rx_read_attempt_len, pdMS_TO_TICKS(200));
+    ret = bus_read(dev, rx_buffer, rx_read_attempt_len);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Erro ao ler resposta do comando 0x%02X: %s", cmd_code, esp_err_to_name(ret));
+        count_transaction(start_us, &s_stats.bus_errors);
         return ret;
     }
 
     // 6. Valida a resposta recebida
     if (rx_read_attempt_len < 3) { // Mínimo: Cmd_echo + Len/Err + CRC
         ESP_LOGE(TAG, "Resposta RX muito curta (%zu bytes)", rx_read_attempt_len);
+        count_transaction(start_us, &s_stats.invalid_responses);
         return ESP_ERR_INVALID_RESPONSE;
     }
     
@@ -191,6 +265,14 @@ esp_err_t sercalo_send_cmd_receive_reply(sercalo_dev_t *dev, uint8_t cmd_code,
         total_msg_len_from_device = 2 + response_payload_len_or_err_num + 1; // Cmd_echo + Len + Payload + CRC
     } else {
         ESP_LOGE(TAG, "Eco de comando inesperado! Recebido: 0x%02X", response_cmd_echo);
+        count_transaction(start_us, &s_stats.invalid_responses);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (total_msg_len_from_device > rx_read_attempt_len) {
+        // O tamanho vem do dispositivo: uma resposta corrompida não pode ler além do que foi recebido.
+        ESP_LOGE(TAG, "Resposta (cmd 0x%02X) de %zu bytes excede os %zu lidos", cmd_code,
+                 total_msg_len_from_device, rx_read_attempt_len);
+        count_transaction(start_us, &s_stats.invalid_responses);
         return ESP_ERR_INVALID_RESPONSE;
     }
 
@@ -205,28 +287,42 @@ esp_err_t sercalo_send_cmd_receive_reply(sercalo_dev_t *dev, uint8_t cmd_code,
 
     if (received_crc != calculated_crc) {
         ESP_LOGE(TAG, "Erro de CRC na resposta! Recebido: 0x%02X, Calculado: 0x%02X", received_crc, calculated_crc);
+        count_transaction(start_us, &s_stats.crc_errors);
         return ESP_ERR_INVALID_CRC;
     }
 
     // 9. Processa a resposta (erro ou dados)
     if (is_error_response) {
+        count_transaction(start_us, &s_stats.device_errors);
         ESP_LOGE(TAG, "Dispositivo retornou erro para cmd 0x%02X: Código %d", cmd_code, response_payload_len_or_err_num);
         return ESP_FAIL; // Retorna um erro genérico
     }
+    if (reply_data_buffer != NULL && response_payload_len_or_err_num > max_reply_data_len) {
+        ESP_LOGE(TAG, "Buffer de resposta (cmd 0x%02X) pequeno demais!", cmd_code);
+        count_transaction(start_us, &s_stats.invalid_responses);
+        return ESP_ERR_NO_MEM;
+    }
+    count_transaction(start_us, NULL);
 
     if (actual_reply_data_len != NULL) {
         *actual_reply_data_len = response_payload_len_or_err_num;
     }
     if (reply_data_buffer != NULL && response_payload_len_or_err_num > 0) {
-        if (response_payload_len_or_err_num > max_reply_data_len) {
-            ESP_LOGE(TAG, "Buffer de resposta (cmd 0x%02X) pequeno demais!", cmd_code);
-            return ESP_ERR_NO_MEM;
-        }
         memcpy(reply_data_buffer, &rx_buffer[2], response_payload_len_or_err_num);
     }
     return ESP_OK;
 }
 
+/**
+ * {@inheritdoc}
+ */
+void sercalo_get_bus_stats(sercalo_bus_stats_t *stats) {
+    if (stats == NULL) return;
+    taskENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_lock);
+}
+
 // --- Implementação das Funções de Comando para o Filtro Sintonizável ---
 
 /**
@@ -311,17 +407,28 @@ esp_err_t sercalo_get_temperature(sercalo_dev_t *dev, int8_t *temperature) {
 /**
  * {@inheritdoc}
  */
-esp_err_t sercalo_set_mirror_position(sercalo_dev_t *dev, const sercalo_mirror_pos_t *pos) {
-    if (dev == NULL || pos == NULL) return ESP_ERR_INVALID_ARG;
+size_t sercalo_encode_mirror_position(const sercalo_dev_t *dev, const sercalo_mirror_pos_t *pos,
+                                      uint8_t frame[SERCALO_SET_FRAME_LEN]) {
+    if (pos == NULL) return 0;
 
     uint8_t params_tx[8]; // 4 eixos * 2 bytes/eixo
     params_tx[0] = (pos->x_neg >> 8) & 0xFF; params_tx[1] = pos->x_neg & 0xFF;
     params_tx[2] = (pos->x_pos >> 8) & 0xFF; params_tx[3] = pos->x_pos & 0xFF;
     params_tx[4] = (pos->y_neg >> 8) & 0xFF; params_tx[5] = pos->y_neg & 0xFF;
     params_tx[6] = (pos->y_pos >> 8) & 0xFF; params_tx[7] = pos->y_pos & 0xFF;
+    return sercalo_encode_cmd(dev, SERCALO_CMD_SET, params_tx, sizeof(params_tx), frame, SERCALO_SET_FRAME_LEN);
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sercalo_set_mirror_position(sercalo_dev_t *dev, const sercalo_mirror_pos_t *pos) {
+    if (dev == NULL || pos == NULL) return ESP_ERR_INVALID_ARG;
 
+    uint8_t frame[SERCALO_SET_FRAME_LEN];
+    size_t len = sercalo_encode_mirror_position(dev, pos, frame);
     ESP_LOGD(TAG, "Definindo posição do espelho (addr 0x%02X)...", dev->device_address_7bit);
-    return sercalo_send_cmd_receive_reply(dev, SERCALO_CMD_SET, params_tx, sizeof(params_tx), NULL, NULL, 0);
+    return sercalo_send_frame(dev, frame, len, NULL, NULL, 0);
 }
 
 /**
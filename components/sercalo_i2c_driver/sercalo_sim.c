@@ -0,0 +1,357 @@
+/**************************************************************************************************
+* Arquivo:      sercalo_sim.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.2.1
+*
+* Descrição:    Modelo em software do Filtro Óptico Sintonizável Sercalo TF1. Interpreta
+* os quadros de comando do protocolo I2C (com CRC-8) e gera as respostas
+* que o dispositivo real enviaria, para uso sem hardware ou no target linux.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF) / gcc
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.2.0] - Dinâmica do espelho (oscilador amortecido) na leitura POS.
+* [2026-10-18] - [Barino] - [0.2.1] - Relógio monotônico comum (monotonic_us).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+
+#if CONFIG_SERCALO_I2C_SIMULATOR
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include "esp_log.h"
+#include "sercalo_i2c.h"
+#include "sercalo_sim.h"
+
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+#include "monotonic_clock.h"
+#endif
+
+static const char *TAG = "sercalo_sim";
+
+// Códigos de erro devolvidos pelo dispositivo (segundo byte de uma resposta de erro).
+#define SIM_ERR_UNKNOWN_CMD     0x01
+#define SIM_ERR_BAD_PARAM       0x02
+#define SIM_ERR_OUT_OF_RANGE    0x03
+#define SIM_ERR_LOW_POWER       0x04
+#define SIM_ERR_CRC             0x05
+
+#define SIM_FRAME_MAX           32
+
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+#define SIM_MIRROR_OMEGA        (2.0 * M_PI * CONFIG_SERCALO_SIM_MIRROR_RESONANCE_CHZ / 100.0)  // rad/s
+#define SIM_MIRROR_ZETA         (CONFIG_SERCALO_SIM_MIRROR_DAMPING_PERMILLE / 1000.0)
+#endif
+
+/**
+ * @struct sim_device_t
+ * @brief  Estado de um filtro TF1 simulado.
+ */
+typedef struct {
+    uint8_t address_7bit;               /*!< Endereço I2C do dispositivo. */
+    const char *id_string;              /*!< Resposta do comando ID ("modelo|S/N|FW"). */
+    float min_wl;                       /*!< Comprimento de onda mínimo selecionável (nm). */
+    float max_wl;                       /*!< Comprimento de onda máximo selecionável (nm). */
+    float wavelength;                   /*!< Comprimento de onda atual (nm). */
+    sercalo_mirror_pos_t pos;           /*!< Posição comandada do espelho MEMS. */
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+    double x;                           /*!< Posição real do eixo X positivo (contagens), em movimento. */
+    double v;                           /*!< Velocidade do eixo X positivo (contagens/s). */
+    int64_t t_us;                       /*!< Instante em que `x` e `v` foram calculados. */
+#endif
+    sercalo_power_mode_t power;         /*!< Modo de energia atual. */
+    uint8_t reply[SIM_FRAME_MAX];       /*!< Resposta pendente para a próxima leitura. */
+    size_t reply_len;                   /*!< Tamanho da resposta pendente. */
+} sim_device_t;
+
+static sim_device_t s_devices[] = {
+    { .address_7bit = 0x3F, .id_string = "TF1-C|SIM-0001|7.0", .min_wl = 1527.608f, .max_wl = 1565.503f },
+    { .address_7bit = 0x7F, .id_string = "TF1-L|SIM-0002|6.0", .min_wl = 1567.133f, .max_wl = 1606.594f },
+};
+static const int s_num_devices = sizeof(s_devices) / sizeof(sim_device_t);
+static bool s_initialized = false;
+
+// --- Funções Auxiliares Internas ---
+
+static void put_float_be(float f, uint8_t *b) {
+    union { float val; uint8_t bytes[4]; } converter = { .val = f };
+    b[0] = converter.bytes[3];
+    b[1] = converter.bytes[2];
+    b[2] = converter.bytes[1];
+    b[3] = converter.bytes[0];
+}
+
+static float get_float_be(const uint8_t *b) {
+    union { float val; uint8_t bytes[4]; } converter;
+    converter.bytes[3] = b[0];
+    converter.bytes[2] = b[1];
+    converter.bytes[1] = b[2];
+    converter.bytes[0] = b[3];
+    return converter.val;
+}
+
+/**
+ * @brief Converte um comprimento de onda na posição equivalente do espelho.
+ *
+ * O modelo usa uma relação linear entre o eixo X positivo e o comprimento de onda;
+ * os demais atuadores ficam em repouso.
+ */
+static void wavelength_to_pos(const sim_device_t *sim, float wl, sercalo_mirror_pos_t *pos) {
+    float frac = (wl - sim->min_wl) / (sim->max_wl - sim->min_wl);
+    pos->x_neg = 0;
+    pos->x_pos = (uint16_t)(frac * 65535.0f + 0.5f);
+    pos->y_neg = 0;
+    pos->y_pos = 0;
+}
+
+static float pos_to_wavelength(const sim_device_t *sim, const sercalo_mirror_pos_t *pos) {
+    return sim->min_wl + ((float)pos->x_pos / 65535.0f) * (sim->max_wl - sim->min_wl);
+}
+
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+/**
+ * @brief Avança a dinâmica do espelho até o instante atual.
+ *
+ * O eixo X segue um oscilador de segunda ordem subamortecido em torno da posição
+ * comandada (`pos.x_pos`), integrado pela solução analítica: o resultado não
+ * depende de quando (ou quantas vezes) o estado é consultado. Um salto grande
+ * excita uma oscilação proporcional ao salto, que leva mais tempo para entrar
+ * na tolerância do que a de um passo pequeno.
+ */
+static void mirror_advance(sim_device_t *sim) {
+    const double sigma = SIM_MIRROR_ZETA * SIM_MIRROR_OMEGA;
+    const double omega_d = SIM_MIRROR_OMEGA * sqrt(1.0 - SIM_MIRROR_ZETA * SIM_MIRROR_ZETA);
+    int64_t now = monotonic_us();
+    double t = (double)(now - sim->t_us) / 1e6;
+    sim->t_us = now;
+    if (t <= 0.0) return;
+
+    double e0 = sim->x - (double)sim->pos.x_pos;
+    double v0 = sim->v;
+    double decay = exp(-sigma * t);
+    double c = cos(omega_d * t);
+    double s = sin(omega_d * t);
+    sim->x = (double)sim->pos.x_pos + decay * (e0 * c + (v0 + sigma * e0) / omega_d * s);
+    sim->v = decay * (v0 * c - (SIM_MIRROR_OMEGA * SIM_MIRROR_OMEGA * e0 + sigma * v0) / omega_d * s);
+}
+#endif
+
+/**
+ * @brief Aplica uma nova posição comandada (o espelho parte do estado atual).
+ */
+static void command_pos(sim_device_t *sim, const sercalo_mirror_pos_t *pos) {
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+    mirror_advance(sim);
+#endif
+    sim->pos = *pos;
+}
+
+/**
+ * @brief Posição que o dispositivo reporta no comando POS.
+ */
+static void measured_pos(sim_device_t *sim, sercalo_mirror_pos_t *pos) {
+    *pos = sim->pos;
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+    mirror_advance(sim);
+    double x = sim->x + 0.5;
+    pos->x_pos = (x <= 0.0) ? 0 : (x >= 65535.0) ? 65535 : (uint16_t)x;
+#endif
+}
+
+static void reset_device(sim_device_t *sim) {
+    sim->power = SERCALO_POWER_LOW;
+    sim->wavelength = sim->min_wl;
+    wavelength_to_pos(sim, sim->wavelength, &sim->pos);
+#if CONFIG_SERCALO_SIM_MIRROR_DYNAMICS
+    sim->x = sim->pos.x_pos;
+    sim->v = 0.0;
+    sim->t_us = monotonic_us();
+#endif
+    sim->reply_len = 0;
+}
+
+static sim_device_t *find_device(uint8_t address_7bit) {
+    if (!s_initialized) {
+        for (int i = 0; i < s_num_devices; i++) {
+            reset_device(&s_devices[i]);
+        }
+        s_initialized = true;
+    }
+    for (int i = 0; i < s_num_devices; i++) {
+        if (s_devices[i].address_7bit == address_7bit) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Monta a resposta pendente (eco, tamanho, payload e CRC de leitura).
+ */
+static void set_reply(sim_device_t *sim, uint8_t cmd, const uint8_t *payload, uint8_t len) {
+    uint8_t crc_buf[1 + SIM_FRAME_MAX];
+    sim->reply[0] = cmd;
+    sim->reply[1] = len;
+    if (len > 0) {
+        memcpy(&sim->reply[2], payload, len);
+    }
+    crc_buf[0] = (sim->address_7bit << 1) | I2C_MASTER_READ;
+    memcpy(&crc_buf[1], sim->reply, 2 + len);
+    sim->reply[2 + len] = sercalo_calculate_crc8(crc_buf, 3 + len);
+    sim->reply_len = 3 + len;
+}
+
+static void set_error_reply(sim_device_t *sim, uint8_t cmd, uint8_t err_code) {
+    uint8_t crc_buf[3];
+    sim->reply[0] = cmd | 0x80;
+    sim->reply[1] = err_code;
+    crc_buf[0] = (sim->address_7bit << 1) | I2C_MASTER_READ;
+    crc_buf[1] = sim->reply[0];
+    crc_buf[2] = sim->reply[1];
+    sim->reply[2] = sercalo_calculate_crc8(crc_buf, 3);
+    sim->reply_len = 3;
+}
+
+/**
+ * @brief Executa um comando já validado e prepara a resposta.
+ */
+static void process_command(sim_device_t *sim, uint8_t cmd, const uint8_t *params, uint8_t params_len) {
+    uint8_t payload[SIM_FRAME_MAX];
+
+    switch (cmd) {
+    case SERCALO_CMD_ID: {
+        size_t len = strlen(sim->id_string);
+        set_reply(sim, cmd, (const uint8_t *)sim->id_string, (uint8_t)len);
+        break;
+    }
+    case SERCALO_CMD_RST:
+        reset_device(sim);
+        set_reply(sim, cmd, NULL, 0);
+        break;
+    case SERCALO_CMD_POW:
+        if (params_len == 1) {
+            if (params[0] > SERCALO_POWER_NORMAL) {
+                set_error_reply(sim, cmd, SIM_ERR_BAD_PARAM);
+                break;
+            }
+            sim->power = (sercalo_power_mode_t)params[0];
+        }
+        payload[0] = (uint8_t)sim->power;
+        set_reply(sim, cmd, payload, 1);
+        break;
+    case SERCALO_CMD_TMP:
+        payload[0] = 31;
+        set_reply(sim, cmd, payload, 1);
+        break;
+    case SERCALO_CMD_SET:
+        if (params_len != 8) {
+            set_error_reply(sim, cmd, SIM_ERR_BAD_PARAM);
+        } else if (sim->power != SERCALO_POWER_NORMAL) {
+            set_error_reply(sim, cmd, SIM_ERR_LOW_POWER);
+        } else {
+            sercalo_mirror_pos_t pos = {
+                .x_neg = (params[0] << 8) | params[1],
+                .x_pos = (params[2] << 8) | params[3],
+                .y_neg = (params[4] << 8) | params[5],
+                .y_pos = (params[6] << 8) | params[7],
+            };
+            command_pos(sim, &pos);
+            sim->wavelength = pos_to_wavelength(sim, &sim->pos);
+            set_reply(sim, cmd, NULL, 0);
+        }
+        break;
+    case SERCALO_CMD_POS: {
+        sercalo_mirror_pos_t pos;
+        measured_pos(sim, &pos);
+        payload[0] = pos.x_neg >> 8; payload[1] = pos.x_neg & 0xFF;
+        payload[2] = pos.x_pos >> 8; payload[3] = pos.x_pos & 0xFF;
+        payload[4] = pos.y_neg >> 8; payload[5] = pos.y_neg & 0xFF;
+        payload[6] = pos.y_pos >> 8; payload[7] = pos.y_pos & 0xFF;
+        set_reply(sim, cmd, payload, 8);
+        break;
+    }
+    case SERCALO_CMD_WVL:
+        if (params_len == 4) {
+            float target = get_float_be(params);
+            if (sim->power != SERCALO_POWER_NORMAL) {
+                set_error_reply(sim, cmd, SIM_ERR_LOW_POWER);
+                break;
+            }
+            if (target < sim->min_wl || target > sim->max_wl) {
+                set_error_reply(sim, cmd, SIM_ERR_OUT_OF_RANGE);
+                break;
+            }
+            sercalo_mirror_pos_t pos;
+            sim->wavelength = target;
+            wavelength_to_pos(sim, target, &pos);
+            command_pos(sim, &pos);
+        } else if (params_len != 0) {
+            set_error_reply(sim, cmd, SIM_ERR_BAD_PARAM);
+            break;
+        }
+        put_float_be(sim->wavelength, payload);
+        set_reply(sim, cmd, payload, 4);
+        break;
+    case SERCALO_CMD_WVMIN:
+        put_float_be(sim->min_wl, payload);
+        set_reply(sim, cmd, payload, 4);
+        break;
+    case SERCALO_CMD_WVMAX:
+        put_float_be(sim->max_wl, payload);
+        set_reply(sim, cmd, payload, 4);
+        break;
+    default:
+        set_error_reply(sim, cmd, SIM_ERR_UNKNOWN_CMD);
+        break;
+    }
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sercalo_sim_write(uint8_t device_address_7bit, const uint8_t *data, size_t len) {
+    sim_device_t *sim = find_device(device_address_7bit);
+    if (sim == NULL) {
+        return ESP_FAIL; // Ninguém no endereço: o mestre recebe NACK.
+    }
+    if (data == NULL || len < 3 || len > SIM_FRAME_MAX || (size_t)data[1] + 3 != len) {
+        set_error_reply(sim, len > 0 ? data[0] : 0, SIM_ERR_BAD_PARAM);
+        return ESP_OK;
+    }
+
+    // Valida o CRC do quadro recebido (inclui o byte de endereço de escrita).
+    uint8_t crc_buf[1 + SIM_FRAME_MAX];
+    crc_buf[0] = (device_address_7bit << 1) | I2C_MASTER_WRITE;
+    memcpy(&crc_buf[1], data, len - 1);
+    if (sercalo_calculate_crc8(crc_buf, len) != data[len - 1]) {
+        ESP_LOGW(TAG, "CRC inválido no quadro para 0x%02X", device_address_7bit);
+        set_error_reply(sim, data[0], SIM_ERR_CRC);
+        return ESP_OK;
+    }
+
+    process_command(sim, data[0], &data[2], data[1]);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sercalo_sim_read(uint8_t device_address_7bit, uint8_t *data, size_t len) {
+    sim_device_t *sim = find_device(device_address_7bit);
+    if (sim == NULL || data == NULL) {
+        return ESP_FAIL;
+    }
+    memset(data, 0xFF, len);
+    memcpy(data, sim->reply, len < sim->reply_len ? len : sim->reply_len);
+    return ESP_OK;
+}
+
+#endif // CONFIG_SERCALO_I2C_SIMULATOR
@@ -0,0 +1,600 @@
+# archive.py
+
+"""
+Arquivo colunar do histórico de varreduras e espectros, lido por mapeamento em memória.
+
+Cada linha é um ponto: instante (us desde 1970, UTC), canal, ciclo, comprimento de
+onda (nm) e potência (amostra do espectro; NaN nos passos de varredura, que não
+medem potência). As linhas são guardadas em trechos de tamanho fixo
+(`chunk_rows` linhas), cada coluna contígua dentro do trecho, e o arquivo só
+cresce: os dados gravados nunca são reescritos.
+
+Formato (little-endian):
+    cabeçalho (64 bytes): "SWA1" | versão (u16) | tamanho do cabeçalho (u16) | chunk_rows (u32)
+                          | colunas (u32) | criação (i64, us)
+    trecho k (em 64 + k * passo): "CHK1" | k (u32) | entrada do índice | preenchimento até 64 bytes
+                          | timestamp_us (i64) x chunk_rows | wavelength (f32) x chunk_rows
+                          | power (f32) x chunk_rows | cycle (u32) x chunk_rows | channel (u8) x chunk_rows
+    rodapé: "SWAI" | trechos (u32) | reservado (u64) | índice (INDEX_DTYPE x trechos)
+            | "SWAE" | trechos (u32) | posição do rodapé (u64)
+
+Cada entrada do índice guarda as linhas do trecho, os canais presentes (máscara de
+bits) e os intervalos de instante e de comprimento de onda. Uma consulta percorre
+só o índice para escolher os trechos e devolve as colunas como views do arquivo
+mapeado (`np.memmap`), sem conversão de texto: um trecho inteiro dentro do
+intervalo não é copiado, e os das bordas são filtrados por máscara. O índice
+também fica no cabeçalho de cada trecho; se o rodapé faltar (gravação
+interrompida), ele é reconstruído percorrendo os trechos.
+
+`ArchiveWriter.add_frames` recebe os quadros do plano de dados já decodificados
+(destino de `UpdateModel.add_frame_sink`, ou `SercaloClient.on_frame` com
+`add_frame`). Os passos de varredura (`TYPE_SWEEP_STEP`) usam o instante do
+firmware, ancorado ao relógio do host; os trechos de espectro (`TYPE_SPECTRUM`)
+recebem o instante da chegada e o comprimento de onda de cada amostra.
+
+Uso:
+    python archive.py historico.swa --tcp 192.168.0.50              # grava (`stream:on`) até Ctrl+C
+    python archive.py historico.swa --unix /tmp/sercalo_mux --duration 3600
+    python archive.py historico.swa                                 # resumo
+    python archive.py historico.swa --start 2026-10-18T08:00 --end 2026-10-18T09:00 --band C --csv hora.csv
+    python archive.py historico.swa --wl-min 1550.0 --wl-max 1550.5
+    python archive.py --bench --rows 20000000                       # ingestão e consultas
+"""
+
+import argparse
+import asyncio
+import csv
+import os
+import struct
+import tempfile
+import threading
+import time
+from collections import namedtuple
+from datetime import datetime, timezone
+
+import numpy as np
+
+from data_plane import (SPECTRUM_HEADER_LEN, TYPE_SPECTRUM, TYPE_SWEEP_STEP, CHANNEL_NAMES, Frame, FrameDecoder,
+                        decode_spectrum_chunk, encode_frame)
+from plot_data import SAMPLE_DTYPE, SWEEP_STEP_DTYPE
+
+VERSION = 1
+DEFAULT_CHUNK_ROWS = 1 << 16    # ~1,3 MB por trecho.
+DEFAULT_FLUSH_INTERVAL = 1.0    # Segundos entre gravações do trecho em andamento.
+ANCHOR_TOLERANCE_US = 1000000   # Desvio do relógio do firmware que refaz a âncora (reinício, volta do contador).
+
+HEADER_LEN = 64
+CHUNK_HEADER_LEN = 64
+FILE_MAGIC = b'SWA1'
+CHUNK_MAGIC = b'CHK1'
+FOOTER_MAGIC = b'SWAI'
+TRAILER_MAGIC = b'SWAE'
+
+Columns = namedtuple('Columns', ['timestamp_us', 'wavelength', 'power', 'cycle', 'channel'])
+COLUMN_DTYPES = Columns(np.dtype('<i8'), np.dtype('<f4'), np.dtype('<f4'), np.dtype('<u4'), np.dtype('u1'))
+ROW_SIZE = sum(dtype.itemsize for dtype in COLUMN_DTYPES)
+
+INDEX_DTYPE = np.dtype([('rows', '<u4'), ('channels', '<u4'), ('t_min', '<i8'), ('t_max', '<i8'),
+                        ('wl_min', '<f4'), ('wl_max', '<f4')])
+
+_HEADER = struct.Struct('<4sHHIIq')
+_CHUNK_HEADER = struct.Struct('<4sI')
+_FOOTER = struct.Struct('<4sIQ')
+_TRAILER = struct.Struct('<4sIQ')
+
+
+def chunk_stride(chunk_rows):
+    """Bytes ocupados por um trecho no arquivo (cabeçalho e colunas)."""
+    return CHUNK_HEADER_LEN + ROW_SIZE * chunk_rows
+
+
+def _column_offsets(chunk_rows):
+    offsets, offset = [], CHUNK_HEADER_LEN
+    for dtype in COLUMN_DTYPES:
+        offsets.append(offset)
+        offset += dtype.itemsize * chunk_rows
+    return offsets
+
+
+def _channel_mask(channels):
+    present = np.unique(channels)
+    return int(np.bitwise_or.reduce(np.left_shift(1, present[present < 32].astype(np.uint32)), initial=0))
+
+
+def _index_entry(columns):
+    """Entrada do índice das colunas de um trecho."""
+    entry = np.zeros((), INDEX_DTYPE)
+    rows = len(columns.timestamp_us)
+    entry['rows'] = rows
+    if rows:
+        entry['channels'] = _channel_mask(columns.channel)
+        entry['t_min'] = columns.timestamp_us.min()
+        entry['t_max'] = columns.timestamp_us.max()
+        finite = columns.wavelength[np.isfinite(columns.wavelength)]
+        entry['wl_min'] = finite.min() if len(finite) else np.nan
+        entry['wl_max'] = finite.max() if len(finite) else np.nan
+    return entry
+
+
+def _read_header(data):
+    if len(data) < HEADER_LEN:
+        raise ValueError("Arquivo curto demais para um arquivo de histórico")
+    magic, version, header_len, chunk_rows, columns, created_us = _HEADER.unpack_from(data)
+    if magic != FILE_MAGIC or version != VERSION or header_len != HEADER_LEN or columns != len(COLUMN_DTYPES):
+        raise ValueError(f"Arquivo de histórico incompatível ({magic!r}, versão {version})")
+    return chunk_rows, created_us
+
+
+def _read_index(data, chunk_rows):
+    """Índice do rodapé; sem rodapé válido, reconstruído dos cabeçalhos dos trechos. Retorna (índice, reparado)."""
+    if len(data) >= HEADER_LEN + _TRAILER.size:
+        magic, count, footer = _TRAILER.unpack_from(data, len(data) - _TRAILER.size)
+        end = footer + _FOOTER.size + count * INDEX_DTYPE.itemsize
+        if magic == TRAILER_MAGIC and end == len(data) - _TRAILER.size and \
+                _FOOTER.unpack_from(data, footer)[:2] == (FOOTER_MAGIC, count):
+            return np.frombuffer(data, INDEX_DTYPE, count, footer + _FOOTER.size).copy(), False
+    stride = chunk_stride(chunk_rows)
+    entries = []
+    offset = HEADER_LEN
+    while offset + CHUNK_HEADER_LEN <= len(data):
+        magic, k = _CHUNK_HEADER.unpack_from(data, offset)
+        if magic != CHUNK_MAGIC or k != len(entries):
+            break
+        entry = np.frombuffer(data, INDEX_DTYPE, 1, offset + _CHUNK_HEADER.size)[0]
+        if entry['rows'] > chunk_rows:
+            break
+        entries.append(entry)
+        offset += stride
+    return np.array(entries, INDEX_DTYPE), True
+
+
+class ArchiveWriter:
+    """
+    Acrescenta linhas a um arquivo de histórico (criado se não existir).
+
+    As linhas se acumulam em colunas pré-alocadas do trecho em andamento; um
+    trecho completo é gravado uma vez, e o em andamento é gravado (só as linhas
+    novas, no lugar definitivo) a cada `flush_interval` segundos, seguido do
+    rodapé. Ao reabrir um arquivo, o último trecho incompleto é completado.
+    `add_frames` pode ser chamado de outra thread (ex.: a de comunicação).
+    """
+
+    def __init__(self, path, chunk_rows=DEFAULT_CHUNK_ROWS, flush_interval=DEFAULT_FLUSH_INTERVAL):
+        if chunk_rows <= 0 or chunk_rows % 64:
+            raise ValueError("chunk_rows deve ser múltiplo de 64")
+        self.path = path
+        self.flush_interval = flush_interval
+        self.lock = threading.Lock()
+        self.rows_written = 0           # Linhas acrescentadas por este escritor.
+        self._anchor = {}               # canal -> instante do host (us) do timestamp_ms zero do firmware
+        exists = os.path.exists(path) and os.path.getsize(path) > 0
+        self._file = open(path, 'r+b' if exists else 'w+b')
+        if exists:
+            data = np.fromfile(path, np.uint8)
+            self.chunk_rows, _ = _read_header(data)
+            index, _ = _read_index(data, self.chunk_rows)
+        else:
+            self.chunk_rows = chunk_rows
+            index = np.zeros(0, INDEX_DTYPE)
+            self._file.write(_HEADER.pack(FILE_MAGIC, VERSION, HEADER_LEN, chunk_rows, len(COLUMN_DTYPES),
+                                          time.time_ns() // 1000).ljust(HEADER_LEN, b'\0'))
+        self._stride = chunk_stride(self.chunk_rows)
+        self._offsets = _column_offsets(self.chunk_rows)
+        self._buffers = Columns(*(np.zeros(self.chunk_rows, dtype) for dtype in COLUMN_DTYPES))
+        self._index = list(index)
+        self._rows = 0                  # Linhas do trecho em andamento.
+        self._flushed = 0               # Linhas do trecho em andamento já gravadas.
+        if self._index and self._index[-1]['rows'] < self.chunk_rows:
+            self._rows = self._flushed = int(self._index.pop()['rows'])
+            base = self._chunk_offset(len(self._index))
+            for buffer, offset in zip(self._buffers, self._offsets):
+                buffer[:self._rows] = np.frombuffer(data, buffer.dtype, self._rows, base + offset)
+        self._last_flush = time.monotonic()
+
+    # --- Entrada ---
+
+    def append(self, timestamp_us, wavelength, power, cycle, channel):
+        """Acrescenta linhas; escalares são repetidos no tamanho dos vetores."""
+        with self.lock:
+            self._append(timestamp_us, wavelength, power, cycle, channel)
+
+    def add_frame(self, frame, now_us=None):
+        self.add_frames((frame,), now_us)
+
+    def add_frames(self, frames, now_us=None):
+        """Acrescenta os passos de varredura e os trechos de espectro de um lote de quadros."""
+        now_us = time.time_ns() // 1000 if now_us is None else now_us
+        steps = {}
+        with self.lock:
+            for frame in frames:
+                if frame.type == TYPE_SWEEP_STEP:
+                    steps.setdefault(frame.channel, []).append(frame.payload)
+                elif frame.type == TYPE_SPECTRUM:
+                    chunk, n = decode_spectrum_chunk(frame.payload)
+                    samples = np.frombuffer(frame.payload, SAMPLE_DTYPE, count=n, offset=SPECTRUM_HEADER_LEN)
+                    wavelength = chunk.start_wl + chunk.step_wl * np.arange(chunk.first, chunk.first + n,
+                                                                            dtype=np.float64)
+                    self._append(now_us, wavelength, samples, chunk.cycle, frame.channel)
+            for channel, payloads in steps.items():
+                decoded = np.frombuffer(b''.join(payloads), SWEEP_STEP_DTYPE)
+                timestamp_us = self._device_time(channel, decoded['timestamp_ms'], now_us)
+                self._append(timestamp_us, decoded['target_wl'], np.nan, decoded['cycle'], channel)
+
+    def _device_time(self, channel, timestamp_ms, now_us):
+        """Instantes do host para os timestamp_ms do firmware (relógio desde o boot)."""
+        device_us = timestamp_ms.astype(np.int64) * 1000
+        anchor = self._anchor.get(channel)
+        if anchor is None or abs(anchor + int(device_us[-1]) - now_us) > ANCHOR_TOLERANCE_US:
+            anchor = self._anchor[channel] = now_us - int(device_us[-1])
+        return anchor + device_us
+
+    def _append(self, *values):
+        n = max(np.size(v) for v in values)
+        values = [np.broadcast_to(v, n) for v in values]
+        done = 0
+        while done < n:
+            take = min(n - done, self.chunk_rows - self._rows)
+            for buffer, v in zip(self._buffers, values):
+                buffer[self._rows:self._rows + take] = v[done:done + take]
+            self._rows += take
+            done += take
+            if self._rows == self.chunk_rows:
+                self._index.append(self._write_chunk())
+                self._rows = self._flushed = 0
+        self.rows_written += n
+        if time.monotonic() - self._last_flush >= self.flush_interval:
+            self._flush()
+
+    # --- Gravação ---
+
+    def _chunk_offset(self, k):
+        return HEADER_LEN + k * self._stride
+
+    def _write_chunk(self):
+        """Grava as linhas novas do trecho em andamento e o seu cabeçalho."""
+        base = self._chunk_offset(len(self._index))
+        for buffer, offset in zip(self._buffers, self._offsets):
+            self._file.seek(base + offset + self._flushed * buffer.itemsize)
+            self._file.write(buffer[self._flushed:self._rows].data)
+        self._flushed = self._rows
+        entry = _index_entry(Columns(*(buffer[:self._rows] for buffer in self._buffers)))
+        self._file.seek(base)
+        self._file.write(_CHUNK_HEADER.pack(CHUNK_MAGIC, len(self._index)) + entry.tobytes())
+        return entry
+
+    def _flush(self):
+        index = list(self._index)
+        if self._rows:
+            index.append(self._write_chunk())
+        footer = self._chunk_offset(len(index))
+        self._file.seek(footer)
+        self._file.write(_FOOTER.pack(FOOTER_MAGIC, len(index), 0) + np.array(index, INDEX_DTYPE).tobytes()
+                         + _TRAILER.pack(TRAILER_MAGIC, len(index), footer))
+        self._file.truncate()
+        self._file.flush()
+        self._last_flush = time.monotonic()
+
+    def flush(self):
+        """Grava o trecho em andamento e o rodapé."""
+        with self.lock:
+            self._flush()
+
+    def close(self):
+        with self.lock:
+            if self._file.closed:
+                return
+            self._flush()
+            self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+class Archive:
+    """
+    Leitura de um arquivo de histórico mapeado em memória.
+
+    As colunas retornadas são views do arquivo (somente leitura) enquanto não
+    forem filtradas; o conteúdo é o do momento da abertura.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self._map = np.memmap(path, np.uint8, 'r')
+        self.chunk_rows, self.created_us = _read_header(self._map)
+        self.index, self.repaired = _read_index(self._map, self.chunk_rows)
+        self._stride = chunk_stride(self.chunk_rows)
+        self._offsets = _column_offsets(self.chunk_rows)
+
+    def __len__(self):
+        return int(self.index['rows'].sum())
+
+    @property
+    def time_range(self):
+        """(primeiro, último) instante em us, ou None se vazio."""
+        used = self.index[self.index['rows'] > 0]
+        return (int(used['t_min'].min()), int(used['t_max'].max())) if len(used) else None
+
+    def chunk(self, k):
+        """Colunas do trecho `k` (views do arquivo)."""
+        rows = int(self.index[k]['rows'])
+        base = HEADER_LEN + k * self._stride
+        return Columns(*(self._map[base + offset:base + offset + rows * dtype.itemsize].view(dtype)
+                         for dtype, offset in zip(COLUMN_DTYPES, self._offsets)))
+
+    def select_chunks(self, start_us=None, end_us=None, wl_min=None, wl_max=None, channel=None):
+        """Trechos que podem conter linhas da consulta (só pelo índice)."""
+        index = self.index
+        keep = index['rows'] > 0
+        if start_us is not None:
+            keep &= index['t_max'] >= start_us
+        if end_us is not None:
+            keep &= index['t_min'] < end_us
+        if wl_min is not None:
+            keep &= index['wl_max'] >= wl_min
+        if wl_max is not None:
+            keep &= index['wl_min'] <= wl_max
+        if channel is not None and channel < 32:
+            keep &= (index['channels'] >> np.uint32(channel)) & 1 != 0
+        return np.flatnonzero(keep)
+
+    def query(self, start_us=None, end_us=None, wl_min=None, wl_max=None, channel=None):
+        """
+        Linhas com instante em [start_us, end_us), comprimento de onda em
+        [wl_min, wl_max] e do canal `channel` (None: sem restrição). Retorna `Columns`.
+        """
+        parts = []
+        for k in self.select_chunks(start_us, end_us, wl_min, wl_max, channel):
+            columns, entry = self.chunk(k), self.index[k]
+            mask = None
+
+            def restrict(condition):
+                nonlocal mask
+                mask = condition if mask is None else mask & condition
+
+            if start_us is not None and entry['t_min'] < start_us:
+                restrict(columns.timestamp_us >= start_us)
+            if end_us is not None and entry['t_max'] >= end_us:
+                restrict(columns.timestamp_us < end_us)
+            if wl_min is not None and not entry['wl_min'] >= wl_min:
+                restrict(columns.wavelength >= wl_min)
+            if wl_max is not None and not entry['wl_max'] <= wl_max:
+                restrict(columns.wavelength <= wl_max)
+            if channel is not None and entry['channels'] != (1 << channel if channel < 32 else 0):
+                restrict(columns.channel == channel)
+            parts.append(columns if mask is None else Columns(*(column[mask] for column in columns)))
+        if len(parts) == 1:
+            return parts[0]
+        if not parts:
+            return Columns(*(np.zeros(0, dtype) for dtype in COLUMN_DTYPES))
+        return Columns(*(np.concatenate(column) for column in zip(*parts)))
+
+    def close(self):
+        self._map._mmap.close()
+        self._map = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def _format_time(us):
+    return datetime.fromtimestamp(us / 1e6, timezone.utc).astimezone().isoformat(timespec='milliseconds')
+
+
+def _parse_time(text):
+    """Instante em us de segundos desde 1970 ou de data ISO (hora local, se sem fuso)."""
+    try:
+        return int(float(text) * 1e6)
+    except ValueError:
+        return int(datetime.fromisoformat(text).timestamp() * 1e6)
+
+
+def write_csv(path, columns):
+    with open(path, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['instante', 'banda', 'ciclo', 'comprimento_nm', 'potencia'])
+        for t, wl, p, cycle, ch in zip(*(column.tolist() for column in columns)):
+            writer.writerow([f"{t / 1e6:.6f}", CHANNEL_NAMES.get(ch, '-'), cycle, f"{wl:.4f}",
+                             '' if p != p else f"{p:g}"])
+
+
+def print_summary(archive):
+    span = archive.time_range
+    size = os.path.getsize(archive.path)
+    print(f"{archive.path}: {len(archive)} linhas em {len(archive.index)} trechos de {archive.chunk_rows} "
+          f"({size / 1e6:.1f} MB){', índice reconstruído' if archive.repaired else ''}")
+    if span:
+        print(f"  de {_format_time(span[0])} a {_format_time(span[1])}")
+        used = archive.index[archive.index['rows'] > 0]
+        print(f"  comprimentos de onda de {np.nanmin(used['wl_min']):.3f} a {np.nanmax(used['wl_max']):.3f} nm")
+
+
+# --- Gravação a partir do controlador ---
+
+async def record(args):
+    from sercalo_client import SercaloClient
+    if args.tcp:
+        client = await SercaloClient.open_tcp(args.tcp, args.tcp_port)
+    elif args.unix:
+        client = await SercaloClient.open_unix(args.unix)
+    else:
+        client = await SercaloClient.open_serial(args.port, args.baudrate)
+    with ArchiveWriter(args.file, args.chunk_rows) as writer:
+        client.on_frame = writer.add_frame
+        async with client:
+            await client.command('stream:on')
+            print(f"Gravando em {args.file} (Ctrl+C para encerrar)")
+            try:
+                await asyncio.wait_for(client.wait_disconnected(), args.duration or None)
+            except asyncio.TimeoutError:
+                pass
+        print(f"{writer.rows_written} linhas gravadas")
+
+
+# --- Benchmark ---
+
+def _spectrum_frames(points, channel, start_wl, step_wl, rng):
+    """Quadros de um espectro de `points` amostras, como os do firmware."""
+    per_frame = (512 - SPECTRUM_HEADER_LEN) // 2
+    frames = []
+    for first in range(0, points, per_frame):
+        n = min(per_frame, points - first)
+        payload = struct.pack('<IffHH', 0, start_wl, step_wl, first, points) + \
+            rng.integers(0, 65535, n, dtype='<u2').tobytes()
+        frames.append(encode_frame(TYPE_SPECTRUM, channel, len(frames), payload))
+    return frames
+
+
+def _timed(function, rounds):
+    start = time.perf_counter()
+    for _ in range(rounds):
+        result = function()
+    return (time.perf_counter() - start) / rounds, result
+
+
+def bench(args):
+    directory = tempfile.mkdtemp(prefix='archive_bench_')
+    path = args.file or os.path.join(directory, 'bench.swa')
+    if os.path.exists(path):
+        os.remove(path)
+    rng = np.random.default_rng(1)
+    points = 4096
+    raw = b''.join(_spectrum_frames(points, 0, 1530.0, 0.01, rng) + _spectrum_frames(points, 1, 1570.0, 0.01, rng))
+
+    # Decodificador do fluxo e escritor: um espectro por canal a cada 100 ms.
+    spectra = 200
+    start = time.perf_counter()
+    decoder = FrameDecoder()
+    with ArchiveWriter(path, args.chunk_rows) as writer:
+        for i in range(spectra):
+            writer.add_frames(decoder.feed(raw), now_us=1_700_000_000_000_000 + i * 100_000)
+        decoded_rows = writer.rows_written
+    decode_s = time.perf_counter() - start
+
+    # Escritor sozinho, com os quadros já decodificados (o restante das linhas).
+    frames = FrameDecoder().feed(raw)
+    rows_per_round = 2 * points
+    rounds = max(1, (args.rows - decoded_rows) // rows_per_round)
+    start = time.perf_counter()
+    with ArchiveWriter(path) as writer:
+        for i in range(rounds):
+            writer.add_frames(frames, now_us=1_700_000_000_000_000 + (spectra + i) * 100_000)
+        writer_rows = writer.rows_written
+    write_s = time.perf_counter() - start
+
+    # Passos de varredura (payloads de 14 bytes) em lotes de 256 quadros.
+    steps = np.zeros(256, SWEEP_STEP_DTYPE)
+    steps['timestamp_ms'] = np.arange(256)
+    steps['target_wl'] = 1550.0 + np.arange(256) * 0.035
+    step_frames = [Frame(TYPE_SWEEP_STEP, 0, 0, payload) for payload in
+                   np.frombuffer(steps.tobytes(), dtype=f'V{SWEEP_STEP_DTYPE.itemsize}').tolist()]
+    step_path = os.path.join(directory, 'steps.swa')
+    step_rounds = 2000
+    start = time.perf_counter()
+    with ArchiveWriter(step_path) as writer:
+        for i in range(step_rounds):
+            writer.add_frames(step_frames, now_us=1_700_000_000_000_000 + i * 256_000)
+    step_s = time.perf_counter() - start
+
+    size = os.path.getsize(path)
+    print(f"Ingestão (decodificador + escritor): {decoded_rows / decode_s / 1e6:.2f} M linhas/s")
+    print(f"Ingestão (escritor, quadros de espectro): {writer_rows} linhas em {write_s:.2f} s "
+          f"({writer_rows / write_s / 1e6:.1f} M linhas/s, {writer_rows * ROW_SIZE / write_s / 1e6:.0f} MB/s)")
+    print(f"Ingestão (escritor, passos de varredura): {step_rounds * 256 / step_s / 1e6:.2f} M linhas/s")
+
+    start = time.perf_counter()
+    archive = Archive(path)
+    open_ms = (time.perf_counter() - start) * 1000.0
+    t0, t1 = archive.time_range
+    total = len(archive)
+    print(f"Arquivo: {total} linhas, {len(archive.index)} trechos, {size / 1e6:.0f} MB; abertura {open_ms:.2f} ms")
+
+    rounds = 50
+    queries = [
+        ("1 minuto", lambda s: archive.query(s, s + 60_000_000)),
+        ("1 hora, banda C", lambda s: archive.query(s, s + 3_600_000_000, channel=0)),
+        ("0,5 nm, todo o período", lambda s: archive.query(wl_min=1550.0, wl_max=1550.5)),
+        ("1 minuto, 0,5 nm", lambda s: archive.query(s, s + 60_000_000, 1550.0, 1550.5)),
+    ]
+    for name, function in queries:
+        starts = rng.integers(t0, max(t0 + 1, t1 - 3_600_000_000), rounds)
+        it = iter(starts.tolist())
+        seconds, result = _timed(lambda: function(next(it)), rounds)
+        print(f"Consulta {name}: {seconds * 1000:.2f} ms ({len(result.timestamp_us)} linhas)")
+    seconds, _ = _timed(lambda: float(archive.query().power.mean()), 3)
+    print(f"Média da potência em todas as linhas: {seconds * 1000:.0f} ms "
+          f"({total / seconds / 1e6:.0f} M linhas/s)")
+
+    # Referência: as mesmas linhas em CSV, lidas com o módulo csv.
+    csv_rows = min(total, 1_000_000)
+    csv_path = os.path.join(directory, 'bench.csv')
+    write_csv(csv_path, Columns(*(column[:csv_rows] for column in archive.query(t0, t1 + 1))))
+    start = time.perf_counter()
+    with open(csv_path, newline='') as f:
+        reader = csv.reader(f)
+        next(reader)
+        parsed = [(float(r[0]), r[1], int(r[2]), float(r[3]), float(r[4] or 'nan')) for r in reader]
+    csv_s = time.perf_counter() - start
+    print(f"Referência CSV: {len(parsed)} linhas em {csv_s:.2f} s ({len(parsed) / csv_s / 1e6:.2f} M linhas/s, "
+          f"{os.path.getsize(csv_path) / len(parsed):.0f} bytes/linha contra {ROW_SIZE})")
+    archive.close()
+    if not args.file:
+        for name in os.listdir(directory):
+            os.remove(os.path.join(directory, name))
+        os.rmdir(directory)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Arquivo colunar do histórico de varreduras e espectros")
+    parser.add_argument('file', nargs='?', help="Arquivo de histórico (.swa)")
+    source = parser.add_mutually_exclusive_group()
+    source.add_argument('--tcp', metavar='HOST', help="Grava do servidor TCP do firmware")
+    source.add_argument('--port', help="Grava da porta serial do console")
+    source.add_argument('--unix', metavar='PATH', help="Grava através do mux_daemon.py")
+    source.add_argument('--bench', action='store_true', help="Mede a ingestão e as consultas (dados sintéticos)")
+    parser.add_argument('--tcp-port', type=int, default=5025)
+    parser.add_argument('--baudrate', type=int, default=115200)
+    parser.add_argument('--duration', type=float, default=0, help="Segundos de gravação (0 = até Ctrl+C)")
+    parser.add_argument('--chunk-rows', type=int, default=DEFAULT_CHUNK_ROWS, help="Linhas por trecho (arquivo novo)")
+    parser.add_argument('--rows', type=int, default=20_000_000, help="Linhas do benchmark")
+    parser.add_argument('--start', type=_parse_time, help="Início da consulta (segundos desde 1970 ou data ISO)")
+    parser.add_argument('--end', type=_parse_time, help="Fim da consulta (exclusivo)")
+    parser.add_argument('--wl-min', type=float, help="Menor comprimento de onda da consulta (nm)")
+    parser.add_argument('--wl-max', type=float, help="Maior comprimento de onda da consulta (nm)")
+    parser.add_argument('--band', choices=sorted(CHANNEL_NAMES.values()), help="Banda da consulta")
+    parser.add_argument('--csv', help="Exporta as linhas da consulta em CSV")
+    args = parser.parse_args()
+
+    if args.bench:
+        bench(args)
+        return
+    if not args.file:
+        parser.error("informe o arquivo de histórico")
+    if args.tcp or args.port or args.unix:
+        try:
+            asyncio.run(record(args))
+        except KeyboardInterrupt:
+            pass
+        return
+
+    with Archive(args.file) as archive:
+        print_summary(archive)
+        channel = {name: ch for ch, name in CHANNEL_NAMES.items()}.get(args.band)
+        if any(v is not None for v in (args.start, args.end, args.wl_min, args.wl_max, channel)):
+            start = time.perf_counter()
+            columns = archive.query(args.start, args.end, args.wl_min, args.wl_max, channel)
+            elapsed = time.perf_counter() - start
+            print(f"Consulta: {len(columns.timestamp_us)} linhas em {elapsed * 1000:.2f} ms")
+            if args.csv:
+                write_csv(args.csv, columns)
+                print(f"Exportado para {args.csv}")
+
+
+if __name__ == '__main__':
+    main()
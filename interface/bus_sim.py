@@ -0,0 +1,477 @@
+# bus_sim.py
+
+"""
+Simulador de eventos discretos da ocupação do barramento I2C, para planejar uma
+implantação (mais filtros, varreduras, consultas) antes de montá-la.
+
+A partir de uma descrição da carga (JSON), prevê a ocupação de cada barramento,
+os percentis de latência por classe de tráfego e os prazos perdidos pelos passos
+de varredura. Roda milhares de segundos simulados por segundo real.
+
+O escalonamento é o do firmware:
+  * cada barramento é um mutex (`g_command_mutex`); quem espera é atendido por
+    prioridade da task e, na mesma prioridade, por ordem de chegada;
+  * o mutex fica tomado durante a transação inteira, incluindo a espera pela
+    resposta (`CONFIG_SERCALO_REPLY_WAIT_MS`, lida do sdkconfig);
+  * cada varredura é uma task: envia o passo (WVL) e só então aguarda
+    `passo_tempo_ms`, de modo que o atraso de um passo desloca os seguintes.
+    Com `passo_tempo_ms` 0, o próximo passo sai quando o modelo de
+    estabilização (a + tau·ln(|salto|/0,01 nm), comandos `settle` e
+    `characterize`) prevê o espelho estável;
+  * com o escalonamento EDF (`CONFIG_SERCALO_SWEEP_EDF_ENABLE`, main/bus_sched.h),
+    os passos de varredura aguardam a vez por prazo (liberação + folga de
+    `CONFIG_SERCALO_SWEEP_SLACK_PCT` da permanência no passo) antes do mutex;
+    sem ele, disputam o mutex por ordem de chegada;
+  * comandos passam pela fila única (`CMD_QUEUE_LENGTH`) e pela task de
+    comandos, um por vez; com a fila cheia, são descartados. Cada transação de
+    um comando toma o mutex separadamente (como `ensure_power_on` e a leitura
+    do `get-wl`);
+  * um raster reenvia pontos SET (e, com `pos`, lê POS) sem intervalo.
+
+Modelo de tempo do TF1: os bytes do quadro e da resposta no clock do barramento
+(9 bits por byte, mais endereço, início e parada; o driver lê sempre a resposta
+de tamanho máximo do comando) somados à espera pela resposta. Com mux, trocar de
+segmento custa uma escrita de um byte no mux, com o barramento tomado.
+
+Um passo perde o prazo quando toma o barramento mais de `prazo_ms` depois da
+liberação (fim da espera do passo anterior), ou seja, quando a disputa pelo
+barramento alonga a permanência no passo anterior além do tolerado. Sem
+`prazo_ms`, o prazo é a folga do escalonador, como no `sweep?` do firmware.
+
+Uso:
+    python bus_sim.py --exemplo > carga.json
+    python bus_sim.py carga.json --duracao 3600
+    python bus_sim.py carga.json --espera-ms 50 --json
+    python bus_sim.py carga.json --escalonador fifo
+"""
+
+import argparse
+import heapq
+import json
+import math
+import os
+import random
+import re
+import sys
+import time
+from collections import deque
+
+DEFAULT_REPLY_WAIT_MS = 150     # Padrão de CONFIG_SERCALO_REPLY_WAIT_MS.
+DEFAULT_SLACK_PCT = 10          # Padrão de CONFIG_SERCALO_SWEEP_SLACK_PCT.
+CMD_QUEUE_LENGTH = 16           # main/command.h
+SETTLE_D0_NM = 0.01             # main/settle_model.h
+
+PRIO_COMMAND = 5                # CmdProcessorTask
+PRIO_SWEEP = 5                  # wavelength_sweep_task
+PRIO_RASTER = 5                 # raster_task
+
+# Opcode -> (bytes de parâmetros enviados, bytes de resposta lidos pelo driver).
+OPCODES = {
+    'id': (0, 29),
+    'pow': (0, 1),
+    'pow_set': (1, 1),
+    'tmp': (0, 1),
+    'set': (8, 0),
+    'pos': (0, 8),
+    'wvl': (0, 4),
+    'wvl_set': (4, 4),
+    'wvmin': (0, 4),
+    'wvmax': (0, 4),
+}
+
+# Transações de cada comando do firmware (cada uma com o mutex tomado à parte).
+# A consulta de POW de `ensure_power_on` sai com o gerenciador de energia ligado.
+COMMANDS = {
+    'iden': ['id'],
+    'get-wl': ['pow', 'wvl'],
+    'set-wl': ['pow', 'wvl_set'],
+    'get-power': ['pow'],
+    'tmp': ['tmp'],
+    'pos': ['pos'],
+}
+
+EXAMPLE = {
+    "barramentos": [{"nome": "i2c0", "khz": 100, "mux": False}],
+    "canais": [
+        {"nome": "C", "barramento": "i2c0", "segmento": 0},
+        {"nome": "L", "barramento": "i2c0", "segmento": 0},
+    ],
+    "varreduras": [
+        {"canal": "C", "min": 1530, "max": 1560, "passo_nm": 0.5, "passo_tempo_ms": 1000},
+        {"canal": "L", "min": 1570, "max": 1605, "passo_nm": 0.5, "passo_tempo_ms": 0,
+         "modelo": {"a_ms": 1150, "tau_ms": 528}},
+    ],
+    "consultas": [
+        {"classe": "painel", "comando": "get-wl", "canal": "C", "periodo_ms": 1000},
+        {"classe": "operador", "comando": "iden", "canal": "C", "periodo_ms": 20000, "poisson": True},
+    ],
+    "rasters": [],
+}
+
+
+# --- Modelo de tempo ---
+
+def read_sdkconfig(path):
+    """Lê as opções do firmware que afetam o tempo das transações."""
+    options = {}
+    try:
+        with open(path) as f:
+            for line in f:
+                m = re.match(r'^(CONFIG_\w+)=(.*)$', line.strip())
+                if m:
+                    options[m.group(1)] = m.group(2).strip('"')
+    except OSError:
+        pass
+    return options
+
+
+class TimingModel:
+    """Duração das transações do TF1 em um barramento."""
+
+    def __init__(self, reply_wait_ms, power_manager=False):
+        self.reply_wait_ms = reply_wait_ms
+        self.power_manager = power_manager
+
+    def transaction_ms(self, opcode, bus_khz):
+        params, reply = OPCODES[opcode]
+        # Escrita: endereço + Cmd + Len + parâmetros + CRC; leitura: endereço + eco + Len + resposta + CRC.
+        bits = 9 * ((1 + params + 3) + (1 + reply + 3)) + 4
+        return bits / bus_khz + self.reply_wait_ms
+
+    def mux_switch_ms(self, bus_khz):
+        return (9 * 2 + 2) / bus_khz
+
+    def command_opcodes(self, command):
+        ops = list(COMMANDS[command])
+        if self.power_manager and ops[0] == 'pow' and len(ops) > 1:
+            ops = ops[1:]   # Estado de energia acompanhado pelo firmware: sem consulta.
+        return ops
+
+
+# --- Núcleo de eventos discretos ---
+
+class Bus:
+    def __init__(self, name, khz, mux):
+        self.name = name
+        self.khz = khz
+        self.mux = mux
+        self.segment = None
+        self.owner = None
+        self.waiters = []           # heap: (-prioridade, chegada, processo)
+        self.turn_taken = False     # Vez do escalonador EDF (um passo de varredura por vez).
+        self.turn_pending = []      # heap: (prazo, chegada, processo)
+        self.busy_ms = 0.0
+        self.mux_switches = 0
+
+
+class Simulator:
+    """Processos são geradores que produzem pedidos: ('delay', ms),
+       ('bus', canal, opcode, prioridade), ('queue',), ('turn', canal, prazo)
+       e ('turn_release', canal)."""
+
+    def __init__(self, timing, edf=True, slack_pct=DEFAULT_SLACK_PCT):
+        self.timing = timing
+        self.edf = edf
+        self.slack_pct = slack_pct
+        self.now = 0.0
+        self._events = []
+        self._seq = 0
+        self.command_queue = deque()
+        self.command_waiter = None
+        self.dropped = {}
+
+    def schedule(self, at, proc, value=None):
+        self._seq += 1
+        heapq.heappush(self._events, (at, self._seq, proc, value))
+
+    def start(self, proc):
+        self.schedule(self.now, proc)
+
+    def _step(self, proc, value):
+        try:
+            request = proc.send(value)
+        except StopIteration:
+            return
+        kind = request[0]
+        if kind == 'delay':
+            self.schedule(self.now + max(0.0, request[1]), proc, self.now + max(0.0, request[1]))
+        elif kind == 'bus':
+            _, channel, opcode, prio = request
+            bus = channel.bus
+            self._seq += 1
+            entry = (-prio, self._seq, proc, channel, opcode)
+            if bus.owner is None:
+                self._grant(bus, entry)
+            else:
+                heapq.heappush(bus.waiters, entry)
+        elif kind == 'queue':
+            if self.command_queue:
+                self.schedule(self.now, proc, self.command_queue.popleft())
+            else:
+                self.command_waiter = proc
+        elif kind == 'turn':
+            bus = request[1].bus
+            if not bus.turn_taken:
+                bus.turn_taken = True
+                self.schedule(self.now, proc, self.now)
+            else:
+                self._seq += 1
+                heapq.heappush(bus.turn_pending, (request[2], self._seq, proc))
+        elif kind == 'turn_release':
+            bus = request[1].bus
+            if bus.turn_pending:
+                _, _, waiter = heapq.heappop(bus.turn_pending)
+                self.schedule(self.now, waiter, self.now)
+            else:
+                bus.turn_taken = False
+            self.schedule(self.now, proc, self.now)
+
+    def _grant(self, bus, entry):
+        _, _, proc, channel, opcode = entry
+        granted = self.now
+        hold = self.timing.transaction_ms(opcode, bus.khz)
+        if bus.mux and bus.segment != channel.segment:
+            hold += self.timing.mux_switch_ms(bus.khz)
+            bus.segment = channel.segment
+            bus.mux_switches += 1
+        bus.owner = proc
+        bus.busy_ms += hold
+        self.schedule(self.now + hold, ('release', bus, proc), granted)
+
+    def submit_command(self, cls, item):
+        if self.command_waiter is not None:
+            waiter, self.command_waiter = self.command_waiter, None
+            self.schedule(self.now, waiter, item)
+        elif len(self.command_queue) < CMD_QUEUE_LENGTH:
+            self.command_queue.append(item)
+        else:
+            self.dropped[cls] = self.dropped.get(cls, 0) + 1
+
+    def run(self, until_ms):
+        while self._events:
+            at, _, target, value = heapq.heappop(self._events)
+            if at > until_ms:
+                break
+            self.now = at
+            if isinstance(target, tuple):
+                # Fim de uma transação: libera o mutex, passa ao próximo e retoma o dono.
+                _, bus, proc = target
+                bus.owner = None
+                if bus.waiters:
+                    self._grant(bus, heapq.heappop(bus.waiters))
+                self._step(proc, value)
+            else:
+                self._step(target, value)
+        self.now = until_ms
+
+
+class Channel:
+    def __init__(self, name, bus, segment):
+        self.name = name
+        self.bus = bus
+        self.segment = segment
+
+
+class Stats:
+    """Latências (ms) por classe e prazos perdidos."""
+
+    def __init__(self):
+        self.latency = {}
+        self.deadlines = {}
+
+    def add(self, cls, ms):
+        self.latency.setdefault(cls, []).append(ms)
+
+    def deadline(self, cls, missed):
+        total, misses = self.deadlines.get(cls, (0, 0))
+        self.deadlines[cls] = (total + 1, misses + (1 if missed else 0))
+
+
+# --- Processos (espelham as tasks do firmware) ---
+
+def sweep_process(sim, stats, channel, profile):
+    cls = f"varredura {channel.name}"
+    step_nm = float(profile['passo_nm'])
+    steps = int(math.floor((float(profile['max']) - float(profile['min'])) / step_nm + 1e-6)) + 1
+    interval = float(profile.get('passo_tempo_ms', 1000))
+    fixed_deadline_ms = profile.get('prazo_ms')
+    with_pos = bool(profile.get('pos', False))
+    model = profile.get('modelo', {"a_ms": 2250, "tau_ms": 0})
+    tx_ms = sim.timing.transaction_ms('wvl_set', channel.bus.khz)
+
+    def dwell_ms(jump_nm):
+        if interval > 0:
+            return interval
+        # Passo automático: do envio até a estabilização prevista.
+        predicted = model['a_ms'] + model['tau_ms'] * math.log(max(abs(jump_nm), SETTLE_D0_NM) / SETTLE_D0_NM)
+        return max(0.0, predicted - tx_ms)
+
+    wait = None
+    while True:
+        for step in range(steps):
+            jump = step_nm if step > 0 else (float(profile['max']) - float(profile['min']))
+            released = sim.now
+            # Folga: fração da permanência no passo (como em sweep_bus_take).
+            slack = (interval if interval > 0 else dwell_ms(step_nm) + tx_ms) * sim.slack_pct / 100.0
+            if sim.edf:
+                yield ('turn', channel, released + slack)
+            granted = yield ('bus', channel, 'wvl_set', PRIO_SWEEP)
+            if sim.edf:
+                yield ('turn_release', channel)
+            if wait is not None:
+                limit = float(fixed_deadline_ms) if fixed_deadline_ms is not None else slack
+                stats.deadline(cls, granted - released > limit)
+            stats.add(cls, sim.now - released)
+            if with_pos:
+                yield ('bus', channel, 'pos', PRIO_SWEEP)
+            wait = dwell_ms(jump)
+            yield ('delay', wait)
+
+
+def command_task(sim, stats):
+    while True:
+        cls, channel, command, arrived = yield ('queue',)
+        for opcode in sim.timing.command_opcodes(command):
+            yield ('bus', channel, opcode, PRIO_COMMAND)
+        stats.add(cls, sim.now - arrived)
+
+
+def poll_source(sim, channel, profile, rng):
+    cls = profile.get('classe', profile['comando'])
+    period = float(profile['periodo_ms'])
+    poisson = bool(profile.get('poisson', False))
+    yield ('delay', rng.uniform(0, period))    # Fase aleatória entre as fontes.
+    while True:
+        sim.submit_command(cls, (cls, channel, profile['comando'], sim.now))
+        yield ('delay', rng.expovariate(1.0 / period) if poisson else period)
+
+
+def raster_process(sim, stats, channel, profile):
+    cls = f"raster {channel.name}"
+    with_pos = bool(profile.get('pos', False))
+    while True:
+        released = sim.now
+        yield ('bus', channel, 'set', PRIO_RASTER)
+        if with_pos:
+            yield ('bus', channel, 'pos', PRIO_RASTER)
+        stats.add(cls, sim.now - released)
+
+
+# --- Execução e relatório ---
+
+def percentile(ordered, p):
+    index = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def simulate(workload, timing, duration_s, seed=1, edf=True, slack_pct=DEFAULT_SLACK_PCT):
+    """Executa a carga por `duration_s` segundos simulados. Retorna o relatório (dict)."""
+    rng = random.Random(seed)
+    sim = Simulator(timing, edf, slack_pct)
+    stats = Stats()
+
+    buses = {b['nome']: Bus(b['nome'], float(b.get('khz', 100)), bool(b.get('mux', False)))
+             for b in workload['barramentos']}
+    channels = {c['nome']: Channel(c['nome'], buses[c['barramento']], int(c.get('segmento', 0)))
+                for c in workload['canais']}
+
+    sim.start(command_task(sim, stats))
+    for profile in workload.get('varreduras', []):
+        sim.start(sweep_process(sim, stats, channels[profile['canal']], profile))
+    for profile in workload.get('consultas', []):
+        sim.start(poll_source(sim, channels[profile['canal']], profile, rng))
+    for profile in workload.get('rasters', []):
+        sim.start(raster_process(sim, stats, channels[profile['canal']], profile))
+
+    wall = time.perf_counter()
+    sim.run(duration_s * 1000.0)
+    wall = time.perf_counter() - wall
+
+    report = {
+        "duracao_s": duration_s,
+        "espera_resposta_ms": timing.reply_wait_ms,
+        "escalonador": "edf" if edf else "fifo",
+        "velocidade": duration_s / wall if wall > 0 else float('inf'),
+        "barramentos": {},
+        "classes": {},
+    }
+    for bus in buses.values():
+        report["barramentos"][bus.name] = {
+            "ocupacao": bus.busy_ms / (duration_s * 1000.0),
+            "trocas_mux": bus.mux_switches,
+        }
+    for cls, values in sorted(stats.latency.items()):
+        ordered = sorted(values)
+        entry = {
+            "n": len(ordered),
+            "p50_ms": percentile(ordered, 50),
+            "p95_ms": percentile(ordered, 95),
+            "p99_ms": percentile(ordered, 99),
+            "max_ms": ordered[-1],
+            "descartados": sim.dropped.get(cls, 0),
+        }
+        if cls in stats.deadlines:
+            total, misses = stats.deadlines[cls]
+            entry["prazos"] = total
+            entry["perdidos"] = misses
+        report["classes"][cls] = entry
+    for cls, count in sim.dropped.items():
+        report["classes"].setdefault(cls, {"n": 0, "descartados": count})
+    return report
+
+
+def print_report(report):
+    print(f"Simulados {report['duracao_s']:.0f} s ({report['velocidade']:.0f} s simulados/s), "
+          f"espera da resposta {report['espera_resposta_ms']:.0f} ms, escalonador {report['escalonador']}")
+    for name, bus in report["barramentos"].items():
+        print(f"  barramento {name}: ocupação {bus['ocupacao'] * 100:.1f}%, trocas de mux {bus['trocas_mux']}")
+    print(f"{'classe':>16} {'n':>8} {'p50 (ms)':>10} {'p95 (ms)':>10} {'p99 (ms)':>10} {'máx (ms)':>10} "
+          f"{'prazos perd.':>13} {'descart.':>9}")
+    for cls, e in report["classes"].items():
+        if e["n"] == 0:
+            print(f"{cls:>16} {0:>8} {'-':>10} {'-':>10} {'-':>10} {'-':>10} {'-':>13} {e['descartados']:>9}")
+            continue
+        missed = f"{e['perdidos']}/{e['prazos']}" if "prazos" in e else "-"
+        print(f"{cls:>16} {e['n']:>8} {e['p50_ms']:>10.1f} {e['p95_ms']:>10.1f} {e['p99_ms']:>10.1f} "
+              f"{e['max_ms']:>10.1f} {missed:>13} {e['descartados']:>9}")
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Simulador de ocupação do barramento I2C dos filtros Sercalo")
+    parser.add_argument('carga', nargs='?', help="Descrição da carga (JSON)")
+    parser.add_argument('--duracao', type=float, default=3600.0, help="Segundos simulados")
+    parser.add_argument('--sdkconfig', default=os.path.join(here, '..', 'sdkconfig'))
+    parser.add_argument('--espera-ms', type=float, help="Espera da resposta (substitui o sdkconfig)")
+    parser.add_argument('--escalonador', choices=['edf', 'fifo'], help="Passos de varredura (substitui o sdkconfig)")
+    parser.add_argument('--semente', type=int, default=1)
+    parser.add_argument('--json', action='store_true', help="Relatório em JSON")
+    parser.add_argument('--exemplo', action='store_true', help="Imprime uma carga de exemplo")
+    args = parser.parse_args()
+
+    if args.exemplo:
+        json.dump(EXAMPLE, sys.stdout, indent=2, ensure_ascii=False)
+        print()
+        return
+    if args.carga is None:
+        parser.error("informe a carga (ou --exemplo)")
+
+    with open(args.carga) as f:
+        workload = json.load(f)
+    options = read_sdkconfig(args.sdkconfig)
+    reply_wait = args.espera_ms if args.espera_ms is not None else \
+        float(options.get('CONFIG_SERCALO_REPLY_WAIT_MS', DEFAULT_REPLY_WAIT_MS))
+    timing = TimingModel(reply_wait, power_manager=options.get('CONFIG_SERCALO_IDLE_POWER_ENABLE') == 'y')
+
+    edf = (args.escalonador == 'edf') if args.escalonador else options.get('CONFIG_SERCALO_SWEEP_EDF_ENABLE', 'y') == 'y'
+    slack_pct = float(options.get('CONFIG_SERCALO_SWEEP_SLACK_PCT', DEFAULT_SLACK_PCT))
+    report = simulate(workload, timing, args.duracao, args.semente, edf, slack_pct)
+    if args.json:
+        json.dump(report, sys.stdout, indent=2, ensure_ascii=False)
+        print()
+    else:
+        print_report(report)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,80 @@
+# client_bench.py
+
+"""
+Medição de comandos/s do cliente asyncio (sercalo_client.py) em função do número
+de comandos pendentes (janela).
+
+Com janela 1, cada comando espera a resposta do anterior, como nos scripts que
+enviam um comando por vez; com janelas maiores, os comandos seguintes já estão na
+fila do firmware quando a resposta chega, e o tempo de ida e volta da conexão
+deixa de separar os comandos. O ganho é maior em comandos que não acessam o
+barramento I2C (o padrão, `stream`); com `get-wl?C`, o limite passa a ser o
+tempo da transação com o filtro.
+
+Uso (firmware de host, ver "Execução no Host" no README principal):
+    python client_bench.py --tcp 127.0.0.1 --window 1 4 8 16
+    python client_bench.py --port /tmp/sercalo_ctl --command "get-wl?C" --commands 100
+    python client_bench.py --unix /tmp/sercalo_mux --window 1      # através do mux_daemon.py
+"""
+
+import argparse
+import asyncio
+import statistics
+import time
+
+from sercalo_client import DEFAULT_TCP_PORT, SercaloClient
+from tcp_bench import percentile
+
+
+async def worker(client, command, count, latencies):
+    """Envia `count` comandos, um por vez; `window` workers mantêm a janela cheia."""
+    nacks = 0
+    for _ in range(count):
+        start = time.perf_counter()
+        reply = await client.request(command)
+        latencies.append(time.perf_counter() - start)
+        nacks += not reply.ok
+    return nacks
+
+
+async def run_window(args, window):
+    if args.tcp:
+        client = await SercaloClient.open_tcp(args.tcp, args.tcp_port, window=window, tagged=not args.fifo)
+    elif args.unix:
+        client = await SercaloClient.open_unix(args.unix, window=window, tagged=not args.fifo)
+    else:
+        client = await SercaloClient.open_serial(args.port, args.baudrate, window=window, tagged=not args.fifo)
+    async with client:
+        latencies = []
+        start = time.perf_counter()
+        counts = [args.commands // window + (i < args.commands % window) for i in range(window)]
+        nacks = await asyncio.gather(*(worker(client, args.command, n, latencies) for n in counts))
+        elapsed = time.perf_counter() - start
+    return latencies, elapsed, sum(nacks)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark do cliente asyncio com vários comandos pendentes")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--tcp', metavar='HOST', help="Servidor TCP do firmware")
+    source.add_argument('--port', help="Porta serial do console (ou pseudo-terminal do firmware de host)")
+    source.add_argument('--unix', metavar='SOCKET', help="Socket do mux_daemon.py")
+    parser.add_argument('--tcp-port', type=int, default=DEFAULT_TCP_PORT)
+    parser.add_argument('--baudrate', type=int, default=115200)
+    parser.add_argument('--window', type=int, nargs='+', default=[1, 2, 4, 8, 16], help="Comandos pendentes")
+    parser.add_argument('--commands', type=int, default=500, help="Comandos por rodada")
+    parser.add_argument('--command', default='stream', help="Comando enviado (sem ':' e '\\n')")
+    parser.add_argument('--fifo', action='store_true', help="Associa as respostas pela ordem, sem etiquetas")
+    args = parser.parse_args()
+
+    print(f"Comando: :{args.command}  ({args.commands} por rodada, {'FIFO' if args.fifo else 'etiquetas'})")
+    print(f"{'janela':>8} {'cmd/s':>10} {'p50 (ms)':>10} {'p99 (ms)':>10} {'máx (ms)':>10} {'NACK':>6}")
+    for window in args.window:
+        latencies, elapsed, nacks = asyncio.run(run_window(args, window))
+        ms = [x * 1000.0 for x in latencies]
+        print(f"{window:>8} {len(latencies) / elapsed:>10.1f} {statistics.median(ms):>10.2f} "
+              f"{percentile(ms, 99):>10.2f} {max(ms):>10.2f} {nacks:>6}")
+
+
+if __name__ == '__main__':
+    main()
@@ -1,99 +1,160 @@
 # communication.py
 
-import sys
-import glob
+import asyncio
+import time
 import serial
-from PyQt5.QtCore import QObject, QThread, pyqtSignal, pyqtSlot
+from serial.tools import list_ports
+from PyQt5.QtCore import QObject, pyqtSignal, pyqtSlot
+from data_plane import FrameDecoder
+from discovery import cached_controller_ports
+from sercalo_client import DEFAULT_TCP_PORT, SercaloClient
 
 def serial_ports():
     """ Lists serial port names
 
-        :raises EnvironmentError:
-            On unsupported or unknown platforms
+        As portas vêm dos metadados do sistema, sem abrir nenhuma. As portas em
+        que a última descoberta (discovery.py) encontrou controladores vêm primeiro.
+
         :returns:
             A list of the serial ports available on the system
     """
-    if sys.platform.startswith('win'):
-        ports = ['COM%s' % (i + 1) for i in range(256)]
-    elif sys.platform.startswith('linux') or sys.platform.startswith('cygwin'):
-        # this excludes your current terminal "/dev/tty"
-        ports = glob.glob('/dev/tty[A-Za-z]*')
-    elif sys.platform.startswith('darwin'):
-        ports = glob.glob('/dev/tty.*')
-    else:
-        raise EnvironmentError('Unsupported platform')
-
-    result = []
-    for port in ports:
+    known = cached_controller_ports()
+    others = sorted(info.device for info in list_ports.comports() if info.device not in known)
+    return known + others
+
+
+class ClientCommunicator(QObject):
+    """
+    Executa o cliente asyncio (sercalo_client.py) em uma thread separada.
+
+    A interface entrega comandos por `submit`, que retorna imediatamente: vários
+    comandos ficam pendentes ao mesmo tempo, e cada resposta volta ao widget que
+    enviou o comando. Respostas, quadros `:DAT:` e erros não são emitidos como
+    sinais, e sim depositados no `UpdateModel`, que a janela drena a cada quadro
+    de tela.
+    """
+    port_closed = pyqtSignal()          # Emite quando a conexão termina
+
+    def __init__(self, port, model, baudrate=115200, parent=None):
+        super().__init__(parent)
+        self._port_name = port
+        self._baudrate = baudrate
+        self.model = model
+        self._loop = None
+        self._client = None
+        self._stop = None
+
+    @pyqtSlot()
+    def connect(self):
+        """Abre a conexão e atende os comandos até `disconnect` (bloqueia a thread de comunicação)."""
+        self._loop = asyncio.new_event_loop()
         try:
-            s = serial.Serial(port)
-            s.close()
-            result.append(port)
-        except (OSError, serial.SerialException):
-            pass
-    return result
+            self._loop.run_until_complete(self._run())
+        finally:
+            self._loop.close()
+            self._loop = None
+            self.model.reset_link()
+            self.port_closed.emit()
 
+    async def _run(self):
+        self._stop = asyncio.Event()
+        try:
+            if self._port_name.startswith('tcp://'):
+                host, _, port = self._port_name[6:].partition(':')
+                self._client = await SercaloClient.open_tcp(host, int(port or DEFAULT_TCP_PORT))
+            elif self._port_name.startswith('unix://'):
+                self._client = await SercaloClient.open_unix(self._port_name[7:])
+            else:
+                self._client = await SercaloClient.open_serial(self._port_name, self._baudrate)
+        except (OSError, serial.SerialException) as e:
+            self.model.post_error(f"Falha ao abrir porta {self._port_name}: {e}")
+            return
+        # Plano de dados espelhado no console (comando :stream:on)
+        self._client.on_frame = self.model.post_frame
+        stop = asyncio.ensure_future(self._stop.wait())
+        lost = asyncio.ensure_future(self._client.wait_disconnected())
+        await asyncio.wait([stop, lost], return_when=asyncio.FIRST_COMPLETED)
+        if lost.done() and not stop.done():
+            self.model.post_error(f"Conexão com {self._port_name} encerrada")
+        stop.cancel()
+        await self._client.close()
+
+    def submit(self, key, command):
+        """Enfileira um comando (sem ':' e '\\n'); a resposta vai para `key` no modelo. Thread-safe."""
+        loop = self._loop
+        if loop is None or self._client is None:
+            return False
+        self.model.command_queued()
+        loop.call_soon_threadsafe(lambda: asyncio.ensure_future(self._request(key, command)))
+        return True
+
+    async def _request(self, key, command):
+        start = time.perf_counter()
+        try:
+            reply = await self._client.request(command)
+        except asyncio.TimeoutError:
+            self.model.post_reply(key, False, "Sem resposta")
+            return
+        except ConnectionError as e:
+            self.model.post_reply(key, False, str(e))
+            return
+        latency = time.perf_counter() - start
+        if reply.ok:
+            self.model.post_reply(key, True, reply.data or '', latency)
+        else:
+            self.model.post_reply(key, False, reply.error, latency)
+
+    def disconnect(self):
+        """Encerra a conexão. Thread-safe."""
+        loop = self._loop
+        if loop is not None and self._stop is not None:
+            loop.call_soon_threadsafe(self._stop.set)
 
-class SerialCommunicator(QObject):
+
+class DataPortReader(QObject):
     """
-    Gerencia a comunicação com o dispositivo serial em uma thread separada.
+    Lê a UART dedicada ao plano de dados (telemetria) em uma thread separada.
+
+    A porta de dados só transmite quadros binários; os comandos e suas respostas
+    continuam no `ClientCommunicator`, que assim não espera atrás de rajadas de dados.
+    Os quadros vão para o `UpdateModel`, como os do console.
     """
-    # Sinais emitidos para a thread principal da GUI
-    response_received = pyqtSignal(str) # Emite uma resposta bem-sucedida (:ACK)
-    error_received = pyqtSignal(str)    # Emite uma resposta de erro (:NACK)
-    port_closed = pyqtSignal()          # Emite quando a porta é fechada
+    port_closed = pyqtSignal()
 
-    def __init__(self, port, baudrate=115200, parent=None):
+    def __init__(self, port, model, baudrate=921600, parent=None):
         super().__init__(parent)
+        self.model = model
         self.serial_port = None
         self._port_name = port
         self._baudrate = baudrate
         self._is_running = False
+        self.decoder = FrameDecoder()
 
     @pyqtSlot()
     def connect(self):
-        """Tenta abrir a porta serial e iniciar a leitura."""
+        """Abre a porta de dados e inicia a leitura."""
         try:
-            self.serial_port = serial.Serial(self._port_name, self._baudrate, timeout=1)
+            self.serial_port = serial.Serial(self._port_name, self._baudrate, timeout=0.1)
             self._is_running = True
-            self.run() # Inicia o loop de leitura no contexto da thread
+            self.run()
         except serial.SerialException as e:
-            self.error_received.emit(f"Falha ao abrir porta {self._port_name}: {e}")
-
-    @pyqtSlot(str)
-    def send_command(self, command):
-        """Envia um comando para o dispositivo serial."""
-        if self.serial_port and self.serial_port.is_open:
-            try:
-                # O firmware espera o comando formatado com ':' e '\n'
-                full_command = f":{command}\n"
-                self.serial_port.write(full_command.encode('utf-8'))
-                print(f"Enviado: {full_command.strip()}")
-            except serial.SerialException as e:
-                self.error_received.emit(f"Erro ao enviar comando: {e}")
+            self.model.post_error(f"Falha ao abrir porta de dados {self._port_name}: {e}")
+            self.port_closed.emit()
 
     def run(self):
-        """Loop principal que lê continuamente da porta serial."""
+        """Lê blocos de bytes e repassa os quadros completos."""
         while self._is_running and self.serial_port and self.serial_port.is_open:
             try:
-                line = self.serial_port.readline().decode('utf-8').strip()
-                if line:
-                    print(f"Recebido: {line}")
-                    if line.startswith(':ACK'):
-                        self.response_received.emit(line)
-                    elif line.startswith(':NACK'):
-                        self.error_received.emit(line)
-            except TypeError:
-                # Ocorre quando a porta é fechada enquanto readline() está bloqueado
-                break
-            except Exception as e:
-                self.error_received.emit(f"Erro de leitura: {e}")
+                data = self.serial_port.read(max(1, self.serial_port.in_waiting))
+                self.model.post_frames(self.decoder.feed(data))
+            except (TypeError, serial.SerialException, OSError):
+                # Porta fechada durante a leitura
                 break
         self.port_closed.emit()
 
     @pyqtSlot()
     def disconnect(self):
-        """Para o loop de leitura e fecha a porta serial."""
+        """Para o loop de leitura e fecha a porta de dados."""
         self._is_running = False
         if self.serial_port and self.serial_port.is_open:
-            self.serial_port.close()
\ No newline at end of file
+            self.serial_port.close()
@@ -0,0 +1,176 @@
+# data_plane.py
+
+"""
+Decodificação dos quadros do plano de dados do firmware (ver main/data_plane.h).
+
+Formato (little-endian):
+    | 0xA5 | 0x5A | tipo | canal | seq (u16) | len (u16) | payload | CRC-8 |
+
+Os quadros chegam pela UART de dados (bytes crus), pelo console ou TCP, como linhas
+`:DAT:<hex>` quando o comando `:stream:on` está ativo, ou em datagramas UDP
+(ver udp_receiver.py).
+"""
+
+import struct
+from collections import namedtuple
+
+SYNC = b'\xA5\x5A'
+HEADER_LEN = 8
+MAX_PAYLOAD = 512
+NO_CHANNEL = 0xFF
+
+TYPE_SWEEP_STEP = 0x01
+TYPE_SPECTRUM = 0x02
+TYPE_TRACE = 0x03
+TYPE_RASTER_POINT = 0x04
+
+RASTER_FLAG_READBACK = 0x01
+RASTER_FLAG_ADC = 0x02
+RASTER_FLAG_ERROR = 0x04
+
+CHANNEL_NAMES = {0: 'C', 1: 'L'}
+
+Frame = namedtuple('Frame', ['type', 'channel', 'seq', 'payload'])
+SweepStep = namedtuple('SweepStep', ['timestamp_ms', 'cycle', 'step', 'target_wl'])
+# Cabeçalho de um trecho de espectro; as amostras (u16) seguem a partir de SPECTRUM_HEADER_LEN.
+SpectrumChunk = namedtuple('SpectrumChunk', ['cycle', 'start_wl', 'step_wl', 'first', 'total'])
+# `target` e `readback`: (x_neg, x_pos, y_neg, y_pos); `readback` é None sem leitura de POS.
+RasterPoint = namedtuple('RasterPoint', ['timestamp_ms', 'pass_', 'row', 'col', 'target', 'readback', 'adc', 'flags'])
+
+_SWEEP_STEP = struct.Struct('<IIHf')
+_RASTER_POINT = struct.Struct('<IIHH4H4HHB')
+_SPECTRUM_CHUNK = struct.Struct('<IffHH')
+SPECTRUM_HEADER_LEN = _SPECTRUM_CHUNK.size
+
+
+def _make_crc8_table():
+    table = []
+    for byte in range(256):
+        crc = byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+        table.append(crc)
+    return bytes(table)
+
+
+_CRC8_TABLE = _make_crc8_table()
+
+
+def crc8(data):
+    """CRC-8 (polinômio 0x07, valor inicial 0), o mesmo do protocolo I2C do TF1."""
+    crc = 0
+    for b in data:
+        crc = _CRC8_TABLE[crc ^ b]
+    return crc
+
+
+class FrameDecoder:
+    """
+    Extrai quadros de um fluxo de bytes, ressincronizando após lixo ou CRC inválido.
+
+    Também acompanha a numeração para contar quadros perdidos.
+    """
+
+    def __init__(self):
+        self._buffer = bytearray()
+        self._last_seq = None
+        self.crc_errors = 0
+        self.lost_frames = 0
+
+    def feed(self, data):
+        """Adiciona bytes recebidos e retorna a lista de quadros completos."""
+        self._buffer.extend(data)
+        frames = []
+        while True:
+            start = self._buffer.find(SYNC)
+            if start < 0:
+                # Mantém um possível primeiro byte de sincronismo no fim do buffer.
+                del self._buffer[:max(0, len(self._buffer) - 1)]
+                break
+            if start > 0:
+                del self._buffer[:start]
+            if len(self._buffer) < HEADER_LEN:
+                break
+            length = self._buffer[6] | (self._buffer[7] << 8)
+            if length > MAX_PAYLOAD:
+                del self._buffer[:2]
+                continue
+            total = HEADER_LEN + length + 1
+            if len(self._buffer) < total:
+                break
+            if crc8(self._buffer[2:total - 1]) != self._buffer[total - 1]:
+                self.crc_errors += 1
+                del self._buffer[:2]
+                continue
+            frames.append(self._make_frame(bytes(self._buffer[:total])))
+            del self._buffer[:total]
+        return frames
+
+    def _make_frame(self, raw):
+        seq = raw[4] | (raw[5] << 8)
+        if self._last_seq is not None:
+            self.lost_frames += (seq - self._last_seq - 1) & 0xFFFF
+        self._last_seq = seq
+        return Frame(raw[2], raw[3], seq, raw[HEADER_LEN:-1])
+
+
+def encode_frame(frame_type, channel, seq, payload):
+    """Monta um quadro completo (usado por ferramentas de teste e simulação)."""
+    body = struct.pack('<BBHH', frame_type, channel, seq & 0xFFFF, len(payload)) + bytes(payload)
+    return SYNC + body + bytes([crc8(body)])
+
+
+def decode_frame(raw):
+    """Decodifica um quadro completo isolado (ex.: de um datagrama). Retorna None se inválido."""
+    if len(raw) < HEADER_LEN + 1 or raw[:2] != SYNC:
+        return None
+    length = raw[6] | (raw[7] << 8)
+    if len(raw) != HEADER_LEN + length + 1 or crc8(raw[2:-1]) != raw[-1]:
+        return None
+    return Frame(raw[2], raw[3], raw[4] | (raw[5] << 8), bytes(raw[HEADER_LEN:-1]))
+
+
+def decode_console_line(line, decoder):
+    """Decodifica uma linha `:DAT:<hex>` do console. Retorna a lista de quadros."""
+    try:
+        return decoder.feed(bytes.fromhex(line[5:]))
+    except ValueError:
+        decoder.crc_errors += 1
+        return []
+
+
+def decode_sweep_step(payload):
+    """Converte o payload de um quadro TYPE_SWEEP_STEP em `SweepStep`."""
+    return SweepStep(*_SWEEP_STEP.unpack_from(payload))
+
+
+def decode_spectrum_chunk(payload):
+    """Cabeçalho (`SpectrumChunk`) e número de amostras de um quadro TYPE_SPECTRUM."""
+    return SpectrumChunk(*_SPECTRUM_CHUNK.unpack_from(payload)), (len(payload) - SPECTRUM_HEADER_LEN) // 2
+
+
+def decode_raster_point(payload):
+    """Converte o payload de um quadro TYPE_RASTER_POINT em `RasterPoint`."""
+    v = _RASTER_POINT.unpack_from(payload)
+    flags = v[13]
+    readback = tuple(v[8:12]) if flags & RASTER_FLAG_READBACK else None
+    adc = v[12] if flags & RASTER_FLAG_ADC else None
+    return RasterPoint(v[0], v[1], v[2], v[3], tuple(v[4:8]), readback, adc, flags)
+
+
+def describe(frame):
+    """Texto curto para exibição de um quadro na interface."""
+    band = CHANNEL_NAMES.get(frame.channel, '-')
+    if frame.type == TYPE_SWEEP_STEP:
+        s = decode_sweep_step(frame.payload)
+        return f"Banda {band}: ciclo {s.cycle}, passo {s.step}, {s.target_wl:.3f} nm"
+    if frame.type == TYPE_RASTER_POINT:
+        p = decode_raster_point(frame.payload)
+        pos = f", pos {p.readback}" if p.readback else ""
+        return f"Banda {band}: raster {p.pass_}, ponto ({p.row}, {p.col}), alvo {p.target}{pos}"
+    if frame.type == TYPE_SPECTRUM:
+        c, n = decode_spectrum_chunk(frame.payload)
+        return f"Banda {band}: espectro {c.cycle}, pontos {c.first}-{c.first + n - 1} de {c.total}"
+    if frame.type == TYPE_TRACE:
+        return f"Banda {band}: {frame.payload.decode('utf-8', errors='replace')}"
+    return f"Banda {band}: quadro tipo 0x{frame.type:02X} ({len(frame.payload)} bytes)"
@@ -0,0 +1,275 @@
+# discovery.py
+
+"""
+Descoberta das portas seriais dos controladores Sercalo.
+
+Em vez de abrir cada `/dev/tty*` para ver se existe, as portas são listadas pelos
+metadados do sistema (`serial.tools.list_ports`, sem abrir nenhuma) e filtradas
+pelo VID/PID USB das pontes USB-serial usadas com o ESP32. Só as candidatas
+recebem a sonda: `:iden?` enviado a todas ao mesmo tempo (uma thread por porta),
+com um tempo limite curto. Quem responde com `:ACK`/`:NACK` é um controlador; a
+resposta traz o modelo, o S/N e o firmware de cada filtro.
+
+O resultado é guardado em cache (`~/.cache/sercalo/ports.json`) por adaptador USB
+(número de série da ponte ou, sem ele, a posição no barramento USB), com o S/N dos
+filtros: adaptadores que não são controladores deixam de ser sondados, e um
+controlador é encontrado pelo S/N de um filtro mesmo que mude de porta.
+
+Uso:
+    python discovery.py                   # lista os controladores e o tempo gasto
+    python discovery.py --sn 1234         # porta do controlador com o filtro 1234
+    python discovery.py --all --legacy    # sonda todas as portas; compara com serial_ports()
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import sys
+import time
+from collections import namedtuple
+from concurrent.futures import ThreadPoolExecutor
+
+import serial
+from serial.tools import list_ports
+
+from response import parse_response, split_tag
+
+# Pontes USB-serial das placas ESP32 (VID, PID).
+KNOWN_USB_IDS = {
+    (0x10C4, 0xEA60): "CP210x",
+    (0x1A86, 0x7523): "CH340",
+    (0x1A86, 0x55D4): "CH9102",
+    (0x0403, 0x6001): "FT232R",
+    (0x0403, 0x6015): "FT231X",
+    (0x303A, 0x1001): "ESP32 USB Serial/JTAG",
+}
+
+PROBE_TIMEOUT = 1.0             # O iden lê os dois filtros: duas transações de ~150 ms.
+CACHE_PATH = os.path.join(os.path.expanduser('~'), '.cache', 'sercalo', 'ports.json')
+
+Controller = namedtuple('Controller', ['port', 'usb_key', 'description', 'channels'])
+Discovery = namedtuple('Discovery', ['controllers', 'candidates', 'skipped', 'failed',
+                                     'enumerate_s', 'probe_s', 'total_s'])
+
+_TEXT_GROUP = re.compile(r'Canal (\w+): (.*)')
+
+
+def usb_key(info):
+    """Identidade do adaptador entre reconexões: S/N da ponte USB, posição no barramento ou a porta."""
+    if info.serial_number:
+        return f"{info.vid:04X}:{info.pid:04X}:{info.serial_number}"
+    return info.location or info.device
+
+
+def candidate_ports(include_unknown=False):
+    """Portas listadas pelo sistema (sem abri-las); só as pontes conhecidas, salvo `include_unknown`."""
+    ports = []
+    for info in list_ports.comports():
+        if (info.vid, info.pid) in KNOWN_USB_IDS or include_unknown:
+            ports.append(info)
+    return sorted(ports, key=lambda info: info.device)
+
+
+def parse_iden(line):
+    """
+    Dados de identificação por canal ({'C': {'modelo', 'sn', 'fw'}, ...}) de uma
+    resposta ao `iden?`, no formato em uso no console (text, kv ou json).
+    """
+    _, line = split_tag(line.strip())
+    payload = line[5:].strip() if line.startswith(':ACK') else ''
+    if payload.startswith('{'):
+        return parse_response(line, 'json').data or {}
+    if re.match(r'\w+\.\w+=', payload):
+        return parse_response(line, 'kv').data or {}
+    channels = {}
+    for group in payload.split(' | '):
+        match = _TEXT_GROUP.match(group)
+        if match:
+            fields = (item.partition('=') for item in match.group(2).split(', '))
+            channels[match.group(1)] = {key: value for key, _, value in fields}
+    return channels
+
+
+def probe(port, timeout=PROBE_TIMEOUT, baudrate=115200):
+    """
+    Envia `:iden?` à porta e retorna a identificação por canal, ou None se não
+    houver resposta de comando no tempo limite. Gera serial.SerialException se a
+    porta não puder ser aberta (ex.: em uso).
+    """
+    link = serial.Serial()
+    link.port = port
+    link.baudrate = baudrate
+    link.timeout = 0.05
+    link.dtr = False            # DTR/RTS em nível ativo reiniciariam o ESP32 (auto-reset).
+    link.rts = False
+    link.exclusive = True       # Não disputa uma porta já aberta pela interface.
+    link.open()
+    try:
+        link.reset_input_buffer()
+        link.write(b":iden?\n")
+        deadline = time.monotonic() + timeout
+        pending = b''
+        while time.monotonic() < deadline:
+            pending += link.read(link.in_waiting or 1)
+            while b'\n' in pending:
+                raw, _, pending = pending.partition(b'\n')
+                line = raw.decode('utf-8', errors='replace').strip()
+                # Logs do console e linhas :DAT: são ignorados.
+                if line.startswith(':ACK') or line.startswith(':NACK'):
+                    return parse_iden(line)
+        return None
+    finally:
+        link.close()
+
+
+def load_cache(path=CACHE_PATH):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return {}
+
+
+def save_cache(cache, path=CACHE_PATH):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'w') as f:
+        json.dump(cache, f, indent=1, sort_keys=True)
+
+
+def discover(include_unknown=False, refresh=False, timeout=PROBE_TIMEOUT, cache_path=CACHE_PATH):
+    """
+    Lista as candidatas, sonda-as em paralelo e atualiza o cache.
+
+    Adaptadores que já responderam como "não controlador" não são sondados de novo,
+    salvo `refresh`. Retorna `Discovery` com os controladores encontrados e os tempos.
+    """
+    start = time.perf_counter()
+    infos = candidate_ports(include_unknown)
+    enumerated = time.perf_counter()
+
+    cache = load_cache(cache_path) if cache_path else {}
+    to_probe, skipped = [], []
+    for info in infos:
+        entry = cache.get(usb_key(info))
+        if entry is not None and not entry.get('controlador') and not refresh:
+            skipped.append(info.device)
+        else:
+            to_probe.append(info)
+
+    def run(info):
+        try:
+            return info, probe(info.device, timeout), None
+        except (serial.SerialException, OSError) as e:
+            return info, None, e
+
+    controllers, failed = [], []
+    if to_probe:
+        with ThreadPoolExecutor(max_workers=len(to_probe)) as pool:
+            results = list(pool.map(run, to_probe))
+        for info, channels, error in results:
+            key = usb_key(info)
+            if error is not None:
+                failed.append((info.device, str(error)))
+                continue  # Em uso ou sem permissão: nada se conclui sobre o adaptador.
+            if channels is None and cache.get(key, {}).get('controlador'):
+                continue  # Controlador ocupado ou reiniciando: não é descartado por uma sonda sem resposta.
+            cache[key] = {'porta': info.device, 'controlador': channels is not None,
+                          'canais': channels or {}, 'visto': time.strftime('%Y-%m-%dT%H:%M:%S')}
+            if channels is not None:
+                controllers.append(Controller(info.device, key, info.description, channels))
+    probed = time.perf_counter()
+
+    if cache_path:
+        save_cache(cache, cache_path)
+    return Discovery(controllers, len(infos), skipped, failed,
+                     enumerated - start, probed - enumerated, probed - start)
+
+
+def find_by_sn(sn, timeout=PROBE_TIMEOUT, cache_path=CACHE_PATH):
+    """
+    Porta do controlador que tem um filtro com o S/N `sn`.
+
+    Tenta primeiro o adaptador registrado no cache (uma sonda, na porta em que ele
+    estiver agora); se não confirmar, refaz a descoberta completa.
+    """
+    cache = load_cache(cache_path)
+    known = {key for key, entry in cache.items()
+             if any(ch.get('sn') == sn for ch in entry.get('canais', {}).values())}
+    for info in list_ports.comports():
+        if usb_key(info) in known:
+            try:
+                channels = probe(info.device, timeout)
+            except (serial.SerialException, OSError):
+                continue
+            if channels and any(ch.get('sn') == sn for ch in channels.values()):
+                return info.device
+    for controller in discover(timeout=timeout, cache_path=cache_path).controllers:
+        if any(ch.get('sn') == sn for ch in controller.channels.values()):
+            return controller.port
+    return None
+
+
+def cached_controller_ports(cache_path=CACHE_PATH):
+    """Portas em que controladores foram vistos pela última vez, sem abrir nenhuma porta."""
+    present = {usb_key(info): info.device for info in list_ports.comports()}
+    return [present[key] for key, entry in load_cache(cache_path).items()
+            if entry.get('controlador') and key in present]
+
+
+def legacy_serial_ports():
+    """Enumeração anterior de communication.serial_ports(): abre cada /dev/tty* (para comparação)."""
+    if sys.platform.startswith('win'):
+        ports = ['COM%s' % (i + 1) for i in range(256)]
+    elif sys.platform.startswith('darwin'):
+        ports = glob.glob('/dev/tty.*')
+    else:
+        ports = glob.glob('/dev/tty[A-Za-z]*')
+    result = []
+    for port in ports:
+        try:
+            s = serial.Serial(port)
+            s.close()
+            result.append(port)
+        except (OSError, serial.SerialException):
+            pass
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Descoberta dos controladores Sercalo nas portas seriais")
+    parser.add_argument('--sn', help="Mostra só a porta do controlador com este S/N de filtro")
+    parser.add_argument('--all', action='store_true', help="Sonda também portas sem VID/PID conhecido")
+    parser.add_argument('--refresh', action='store_true', help="Sonda de novo os adaptadores já descartados")
+    parser.add_argument('--timeout', type=float, default=PROBE_TIMEOUT, help="Tempo limite da sonda (s)")
+    parser.add_argument('--legacy', action='store_true', help="Mede também serial_ports() (abre cada porta)")
+    args = parser.parse_args()
+
+    if args.sn:
+        port = find_by_sn(args.sn, args.timeout)
+        print(port if port else f"Nenhum controlador com o filtro {args.sn}")
+        return
+
+    result = discover(args.all, args.refresh, args.timeout)
+    for c in result.controllers:
+        filters = ', '.join(f"{band}: {ch.get('modelo', '?')} sn={ch.get('sn', '?')} fw={ch.get('fw', '?')}"
+                            if 'erro' not in ch else f"{band}: {ch['erro']}"
+                            for band, ch in sorted(c.channels.items()))
+        print(f"{c.port:<16} {c.description}  [{filters}]")
+    for port, error in result.failed:
+        print(f"{port:<16} não sondada: {error}")
+    print(f"{len(result.controllers)} controlador(es); {result.candidates} candidata(s), "
+          f"{len(result.skipped)} descartada(s) pelo cache, {len(result.failed)} sem acesso")
+    print(f"Tempo: listagem {result.enumerate_s * 1000:.1f} ms, sonda {result.probe_s * 1000:.1f} ms, "
+          f"total {result.total_s * 1000:.1f} ms")
+
+    if args.legacy:
+        start = time.perf_counter()
+        ports = legacy_serial_ports()
+        print(f"serial_ports() anterior: {len(ports)} porta(s) abertas uma a uma em "
+              f"{(time.perf_counter() - start) * 1000:.1f} ms, sem identificar os controladores")
+
+
+if __name__ == '__main__':
+    main()
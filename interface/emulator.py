@@ -0,0 +1,682 @@
+# emulator.py
+
+"""
+Emulador do controlador em um pseudo-terminal, para testar a interface e os
+clientes sem hardware e sem o ESP-IDF.
+
+O processo cria um pseudo-terminal (ligado a `--link`, `/tmp/sercalo_emu` por
+padrão) e, com `--tcp`, também aceita conexões como o servidor TCP do firmware.
+O protocolo é o de main/main.c: comandos `:cmd[?|:]args` terminados em `\\n` ou
+`\\r`, etiquetas `:@tag cmd`, a fila única de 16 comandos (recusa imediata com
+`:NACK: Fila de comandos cheia`), uma task de comandos que executa um por vez,
+respostas nos formatos text, kv e json e o plano de dados em linhas `:DAT:<hex>`
+(comando `stream`). Comandos: iden, get-interval, get-wl, set-wl, sweep,
+powerup, get-power, stream, format e metrics (bloco binário de main/metrics.h,
+com as latências, erros e passos atrasados medidos no próprio emulador); os
+demais respondem `Comando desconhecido`, como no firmware compilado sem os
+módulos opcionais.
+
+O tempo vem do modelo do TF1 de bus_sim.py: cada transação ocupa o barramento
+(um mutex, também disputado pelas varreduras) pelos bytes no clock do barramento
+mais a espera pela resposta (`CONFIG_SERCALO_REPLY_WAIT_MS`, lida do sdkconfig).
+Sobre ele, podem ser acrescentados uma latência fixa e um jitter por transação,
+travamentos ocasionais (`--stall-rate`/`--stall-ms`, para reproduzir picos de
+latência vistos em campo) e erros: transações que falham (`--fail-rate`, NACK ou
+CRC no barramento), respostas perdidas (`--drop-rate`) e respostas corrompidas
+(`--corrupt-rate`). `--time-scale` multiplica todos os tempos (0: sem espera).
+
+Cada `--band` acrescenta um filtro (`nome:min:max`); as bandas C e L usam as
+faixas dos filtros simulados do firmware (components/sercalo_i2c_driver).
+
+Uso:
+    python emulator.py                                    # /tmp/sercalo_emu
+    python emulator.py --tcp 5025 --fail-rate 0.01 --stall-rate 0.005 --stall-ms 2000
+    python emulator.py --time-scale 0 --band C --band L --band S:1480:1520
+    python client_bench.py --port /tmp/sercalo_emu --command "get-wl?C" --window 1 8
+"""
+
+import argparse
+import asyncio
+import os
+import random
+import re
+import signal
+import struct
+import sys
+import time
+import tty
+
+from bus_sim import CMD_QUEUE_LENGTH, DEFAULT_REPLY_WAIT_MS, TimingModel, read_sdkconfig
+from data_plane import TYPE_SWEEP_STEP, TYPE_TRACE, encode_frame
+import metrics
+from response import ResponseWriter
+from sercalo_client import DEFAULT_TCP_PORT
+
+CMD_BUFFER_SIZE = 128           # main/command.h
+COMMAND_TAG_MAX = 8
+I2C_KHZ = 100                   # I2C_MASTER_FREQ_HZ
+WAKE_DELAY_MS = 100             # Espera de ensure_power_on após religar o filtro.
+OUTPUT_LIMIT = 1 << 16          # Bytes guardados para um terminal sem leitor (depois, descartados).
+SWEEP_SLACK_PCT = 10            # Folga dos passos de varredura (CONFIG_SERCALO_SWEEP_SLACK_PCT).
+
+DEFAULT_LINK = '/tmp/sercalo_emu'
+
+# Filtros simulados do firmware (sercalo_sim.c): nome -> (modelo, S/N, FW, min, max).
+KNOWN_BANDS = {
+    'C': ('TF1-C', 'SIM-0001', '7.0', 1527.608, 1565.503),
+    'L': ('TF1-L', 'SIM-0002', '6.0', 1567.133, 1606.594),
+}
+
+_TAG = re.compile(r'@([0-9A-Za-z]+) ')
+
+
+class CommandFailed(Exception):
+    """Handler encerrado com um `esp_err_t` diferente de ESP_OK."""
+
+    def __init__(self, err):
+        super().__init__(err)
+        self.err = err
+
+
+# --- Filtros e barramento ---
+
+class Filter:
+    """Estado de um TF1 emulado."""
+
+    def __init__(self, index, name, model, sn, fw, min_wl, max_wl):
+        self.index = index
+        self.name = name
+        self.label = f'Canal {name}'
+        self.model, self.sn, self.fw = model, sn, fw
+        self.min_wl, self.max_wl = min_wl, max_wl
+        self.wl = min_wl
+        self.power = 1              # 1 = normal, 0 = repouso.
+        self.sweep_task = None
+        self.sweep_update = None    # (parâmetros, limite, instante do pedido)
+        self.swaps = 0
+        self.swap_ms = 0
+        self.sweep_steps = 0
+        self.sweep_overruns = 0
+        self.sweep_lateness = metrics.HistogramAccumulator()
+
+
+class Bus:
+    """Barramento I2C: um mutex tomado durante cada transação, com o tempo do modelo do TF1."""
+
+    def __init__(self, args, rng, stats):
+        options = read_sdkconfig(args.sdkconfig)
+        reply_wait_ms = args.reply_wait_ms
+        if reply_wait_ms is None:
+            reply_wait_ms = float(options.get('CONFIG_SERCALO_REPLY_WAIT_MS', DEFAULT_REPLY_WAIT_MS))
+        self.timing = TimingModel(reply_wait_ms)
+        self.args = args
+        self.rng = rng
+        self.stats = stats
+        self.lock = asyncio.Lock()
+
+    def delay_ms(self, opcode):
+        ms = self.timing.transaction_ms(opcode, I2C_KHZ) + self.args.latency_ms
+        if self.args.jitter_ms:
+            ms += self.rng.uniform(0, self.args.jitter_ms)
+        if self.args.stall_rate and self.rng.random() < self.args.stall_rate:
+            self.stats['stalls'] += 1
+            ms += self.args.stall_ms
+        return ms
+
+    async def transaction(self, opcode, on_acquire=None):
+        """
+        Executa uma transação com o barramento tomado; gera CommandFailed em erro injetado.
+        `on_acquire` recebe a espera pelo barramento, em segundos.
+        """
+        start = time.monotonic()
+        async with self.lock:
+            acquired = time.monotonic()
+            if on_acquire is not None:
+                on_acquire(acquired - start)
+            await sleep_ms(self.delay_ms(opcode), self.args.time_scale)
+            self.stats['busy_us'] += int((time.monotonic() - acquired) * 1e6)
+        self.stats['transactions'] += 1
+        if self.args.fail_rate and self.rng.random() < self.args.fail_rate:
+            self.stats['failures'] += 1
+            err = self.rng.choice(('ESP_FAIL', 'ESP_ERR_INVALID_CRC'))
+            self.stats['crc_errors' if err == 'ESP_ERR_INVALID_CRC' else 'bus_errors'] += 1
+            raise CommandFailed(err)
+
+
+async def sleep_ms(ms, scale):
+    if ms > 0 and scale > 0:
+        await asyncio.sleep(ms * scale / 1000.0)
+
+
+# --- Origens dos comandos ---
+
+class Source:
+    """Origem de comandos (console ou conexão TCP), com formato e assinatura do plano de dados próprios."""
+
+    def __init__(self, name):
+        self.name = name
+        self.format = 'text'
+        self.stream = False
+        self._buffer = bytearray()
+        self._started = False
+
+    def feed(self, data, emulator):
+        """Máquina de estados de uart_command_monitor_task: ':' inicia, '\\n' ou '\\r' termina."""
+        for byte in data:
+            c = chr(byte)
+            if not self._started:
+                if c == ':':
+                    self._started = True
+                    self._buffer.clear()
+            elif c in '\r\n':
+                if self._buffer:
+                    emulator.submit(self._buffer.decode('utf-8', errors='replace'), self)
+                self._started = False
+            elif len(self._buffer) < CMD_BUFFER_SIZE - 1:
+                self._buffer.append(byte)
+            else:
+                self._started = False   # Comando longo demais: descartado.
+
+    def write(self, data):
+        raise NotImplementedError
+
+
+class PtySource(Source):
+    """Console em um pseudo-terminal; sem leitor, a saída excedente é descartada, como na UART."""
+
+    def __init__(self, link):
+        super().__init__('uart')
+        self.master, self._slave = os.openpty()
+        tty.setraw(self._slave)     # Mantido aberto: o terminal continua válido entre clientes.
+        os.set_blocking(self.master, False)
+        self.path = os.ttyname(self._slave)
+        self.link = link
+        if link:
+            if os.path.islink(link):
+                os.unlink(link)
+            os.symlink(self.path, link)
+        self._out = bytearray()
+        self._loop = None
+
+    def start(self, emulator):
+        self._loop = asyncio.get_running_loop()
+        self._loop.add_reader(self.master, self._on_readable, emulator)
+
+    def _on_readable(self, emulator):
+        try:
+            data = os.read(self.master, 4096)
+        except OSError:
+            return
+        self.feed(data, emulator)
+
+    def write(self, data):
+        if len(self._out) + len(data) > OUTPUT_LIMIT:
+            return
+        if not self._out:
+            self._loop.add_writer(self.master, self._flush)
+        self._out += data
+
+    def _flush(self):
+        try:
+            sent = os.write(self.master, self._out)
+        except BlockingIOError:
+            return
+        except OSError:
+            sent = len(self._out)
+        del self._out[:sent]
+        if not self._out:
+            self._loop.remove_writer(self.master)
+
+    def close(self):
+        if self.link and os.path.islink(self.link):
+            os.unlink(self.link)
+
+
+class TcpSource(Source):
+    def __init__(self, writer):
+        super().__init__('tcp')
+        self.writer = writer
+
+    def write(self, data):
+        if not self.writer.is_closing():
+            self.writer.write(data)
+
+
+# --- Firmware emulado ---
+
+class Emulator:
+    def __init__(self, args):
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.stats = dict.fromkeys(('commands', 'rejected', 'nacks', 'transactions', 'failures', 'bus_errors',
+                                    'crc_errors', 'busy_us', 'stalls', 'dropped', 'corrupted', 'published',
+                                    'scrapes', 'scrape_last_us', 'scrape_max_us'), 0)
+        self.queue_wait = metrics.HistogramAccumulator()
+        self.execution = metrics.HistogramAccumulator()
+        self.bus = Bus(args, self.rng, self.stats)
+        self.filters = []
+        for spec in args.band or ['C', 'L']:
+            name, *limits = spec.split(':')
+            if name.upper() in KNOWN_BANDS and not limits:
+                model, sn, fw, lo, hi = KNOWN_BANDS[name.upper()]
+            else:
+                lo, hi = (float(v) for v in limits)
+                model, sn, fw = f'TF1-{name.upper()}', f'SIM-{len(self.filters) + 1:04d}', '7.0'
+            self.filters.append(Filter(len(self.filters), name.upper(), model, sn, fw, lo, hi))
+        self.queue = asyncio.Queue(CMD_QUEUE_LENGTH)
+        self.sources = []
+        self.seq = 0
+        self.start = time.monotonic()
+        self.handlers = {
+            'iden': self.handle_iden,
+            'get-interval': self.handle_get_interval,
+            'get-wl': self.handle_get_wl,
+            'set-wl': self.handle_set_wl,
+            'sweep': self.handle_sweep,
+            'powerup': self.handle_powerup,
+            'get-power': self.handle_get_power,
+            'stream': self.handle_stream,
+            'format': self.handle_format,
+            'metrics': self.handle_metrics,
+        }
+
+    def now_ms(self):
+        return int((time.monotonic() - self.start) * 1000)
+
+    def log(self, source, text):
+        """Linha de log do ESP-IDF no console (com `--logs`), como as que os clientes ignoram."""
+        if self.args.logs and isinstance(source, PtySource):
+            source.write(f"I ({self.now_ms()}) SERCALO_FILTER_APP: {text}\n".encode())
+
+    # --- Fila de comandos (command_submit / command_processor_task) ---
+
+    def submit(self, line, source):
+        tag = ''
+        if line.startswith('@'):
+            match = _TAG.match(line)
+            if match is None or len(match.group(1)) > COMMAND_TAG_MAX:
+                source.write(":NACK: Etiqueta inválida\n".encode())
+                return
+            tag = '@' + match.group(1)
+            line = line[match.end():]
+        try:
+            self.queue.put_nowait((line, tag, source, time.monotonic()))
+        except asyncio.QueueFull:
+            self.stats['rejected'] += 1
+            source.write(f":NACK{tag}: Fila de comandos cheia\n".encode())
+
+    async def process_commands(self):
+        while True:
+            line, tag, source, queued = await self.queue.get()
+            self.stats['commands'] += 1
+            self.log(source, f'Processando comando ({source.name}): "{line}"')
+            start = time.monotonic()
+            reply = await self.execute(line, tag, source)
+            self.queue_wait.observe((start - queued) * 1e6)
+            self.execution.observe((time.monotonic() - start) * 1e6)
+            if reply.startswith(b':NACK' if isinstance(reply, bytes) else ':NACK'):
+                self.stats['nacks'] += 1
+            self.reply(source, reply)
+
+    async def execute(self, line, tag, source):
+        match = re.match(r'[?:]*([^?:]+)[?:]?(.*)$', line)
+        if match is None:
+            return f":NACK{tag}: Comando vazio\n"
+        name, args = match.group(1), match.group(2)
+        handler = self.handlers.get(name)
+        if handler is None:
+            return f":NACK{tag}: Comando desconhecido\n"
+        resp = ResponseWriter(source.format)
+        try:
+            block = await handler(args, resp, source)
+        except CommandFailed as e:
+            return f":NACK{tag}: {e.err}\n"
+        if block is not None:
+            # Bloco binário (command_reply_block_*): `:ACK: #<dígitos><tamanho><dados>\n`.
+            size = str(len(block))
+            return f":ACK{tag}: #{len(size)}{size}".encode() + block + b"\n"
+        data = resp.finish()
+        if data is None:
+            return f":NACK{tag}: ESP_ERR_INVALID_SIZE\n"
+        return f":ACK{tag}: {data}\n" if data else f":ACK{tag}\n"
+
+    def reply(self, source, text):
+        data = text if isinstance(text, bytes) else text.encode()
+        if self.args.drop_rate and self.rng.random() < self.args.drop_rate:
+            self.stats['dropped'] += 1
+            return
+        if self.args.corrupt_rate and self.rng.random() < self.args.corrupt_rate:
+            self.stats['corrupted'] += 1
+            data = bytearray(data)
+            data[self.rng.randrange(len(data) - 1)] = self.rng.choice(b'#~\x00\xff')
+            data = bytes(data)
+        source.write(data)
+
+    # --- Plano de dados ---
+
+    def publish(self, frame_type, channel, payload):
+        self.stats['published'] += 1
+        frame = encode_frame(frame_type, channel, self.seq, payload)
+        self.seq = (self.seq + 1) & 0xFFFF
+        line = b':DAT:' + frame.hex().upper().encode() + b'\n'
+        for source in self.sources:
+            if source.stream:
+                source.write(line)
+
+    def trace(self, channel, text):
+        self.publish(TYPE_TRACE, channel, text.encode()[:512])
+
+    # --- Handlers (main.c) ---
+
+    def select(self, band):
+        for f in self.filters:
+            if band and f.name == band[0].upper():
+                return f
+        raise CommandFailed('ESP_ERR_INVALID_ARG')
+
+    async def ensure_power_on(self, f):
+        await self.bus.transaction('pow')
+        if f.power == 0:
+            await self.bus.transaction('pow_set')
+            f.power = 1
+            await sleep_ms(WAKE_DELAY_MS, self.args.time_scale)
+
+    async def handle_iden(self, args, resp, source):
+        for f in self.filters:
+            err = None
+            try:
+                await self.bus.transaction('id')
+            except CommandFailed as e:
+                err = e.err
+            resp.begin_group(f.name, f.label)
+            if err is None:
+                resp.add_str('modelo', f.model)
+                resp.add_str('sn', f.sn)
+                resp.add_str('fw', f.fw)
+            else:
+                resp.add_err('erro', err)
+            resp.end_group()
+
+    async def handle_get_interval(self, args, resp, source):
+        f = self.select(args.split('?')[0])
+        try:
+            await self.bus.transaction('wvmin')
+            await self.bus.transaction('wvmax')
+        except CommandFailed:
+            raise CommandFailed('ESP_FAIL')
+        resp.add_float('min', f.min_wl, 3)
+        resp.add_float('max', f.max_wl, 3)
+
+    async def handle_get_wl(self, args, resp, source):
+        f = self.select(args.split('?')[0])
+        try:
+            await self.ensure_power_on(f)
+        except CommandFailed:
+            pass    # O firmware ignora a falha e tenta a leitura.
+        try:
+            await self.bus.transaction('wvl')
+        except CommandFailed:
+            raise CommandFailed('ESP_FAIL')
+        resp.add_float(None, f.wl, 3)
+
+    async def handle_set_wl(self, args, resp, source):
+        parts = [p for p in args.split(':') if p]
+        if len(parts) < 2:
+            raise CommandFailed('ESP_ERR_INVALID_ARG')
+        f = self.select(parts[0])
+        try:
+            await self.ensure_power_on(f)
+        except CommandFailed:
+            pass
+        target = _atof(parts[1])
+        if target <= 0:
+            raise CommandFailed('ESP_ERR_INVALID_ARG')
+        await self.stop_sweep(f)
+        await self.bus.transaction('wvl_set')
+        if not f.min_wl <= target <= f.max_wl:
+            raise CommandFailed('ESP_FAIL')     # Erro do filtro: fora da faixa.
+        f.wl = target
+
+    async def handle_sweep(self, args, resp, source):
+        parts = [p for p in args.split(':') if p]
+        if not parts:
+            for f in self.filters:
+                resp.begin_group(f.name, f.label)
+                resp.add_bool('ativo', f.sweep_task is not None)
+                resp.add_uint('trocas', f.swaps)
+                resp.add_uint('troca_ms', f.swap_ms)
+                resp.add_bool('troca_pendente', f.sweep_update is not None)
+                resp.end_group()
+            return
+        if len(parts) < 5 or (len(parts) > 5 and parts[5] not in ('passo', 'ciclo')):
+            raise CommandFailed('ESP_ERR_INVALID_ARG')
+        f = self.select(parts[0])
+        params = (_atof(parts[1]), _atof(parts[2]), _atof(parts[3]), _atoi(parts[4]))
+        lo, hi, step, interval = params
+        if lo <= 0 or hi <= lo or step <= 0 or interval < 1:
+            raise CommandFailed('ESP_ERR_INVALID_ARG')
+        if len(parts) > 5 and f.sweep_task is not None:
+            f.sweep_update = (params, parts[5], time.monotonic())
+            resp.add_str('troca', parts[5])
+            return
+        await self.stop_sweep(f)
+        f.swaps = f.swap_ms = 0
+        f.sweep_update = None
+        f.sweep_task = asyncio.ensure_future(self.sweep_task(f, params))
+
+    async def stop_sweep(self, f):
+        task, f.sweep_task = f.sweep_task, None
+        if task is not None:
+            task.cancel()
+            await asyncio.gather(task, return_exceptions=True)
+
+    def swap(self, f, boundary):
+        update = f.sweep_update
+        if update is None or update[1] != boundary:
+            return None
+        f.sweep_update = None
+        f.swaps += 1
+        f.swap_ms = int((time.monotonic() - update[2]) * 1000)
+        return update[0]
+
+    async def sweep_task(self, f, params):
+        def on_acquire(wait_s):
+            # Espera pelo barramento; além da folga (fração do intervalo atual), o passo está atrasado.
+            f.sweep_steps += 1
+            f.sweep_overruns += wait_s * 1000 > interval * SWEEP_SLACK_PCT / 100 * self.args.time_scale
+            f.sweep_lateness.observe(wait_s * 1e6)
+
+        cycle = 0
+        while True:
+            lo, hi, step_nm, interval = params
+            step, wl = 0, lo
+            while wl <= hi:
+                try:
+                    await self.bus.transaction('wvl_set', on_acquire)
+                    ok = f.min_wl <= wl <= f.max_wl
+                except CommandFailed:
+                    ok = False
+                if ok:
+                    f.wl = wl
+                    self.publish(TYPE_SWEEP_STEP, f.index,
+                                 struct.pack('<IIHf', self.now_ms() & 0xFFFFFFFF, cycle, step & 0xFFFF, wl))
+                step += 1
+                await sleep_ms(interval, self.args.time_scale)
+                if self.args.time_scale == 0:
+                    await asyncio.sleep(0)  # Sem espera, a varredura ainda cede a vez aos comandos.
+                new = self.swap(f, 'passo')
+                if new is not None:
+                    params = new
+                    lo, hi, step_nm, interval = params
+                    if wl + step_nm < lo:
+                        wl = lo - step_nm
+                    self.trace(f.index, f"sweep {f.name}: parâmetros trocados no passo {step}, {f.swap_ms} ms após o pedido")
+                wl += step_nm
+            new = self.swap(f, 'ciclo')
+            if new is not None:
+                params = new
+                self.trace(f.index, f"sweep {f.name}: parâmetros trocados no fim do ciclo {cycle}, {f.swap_ms} ms após o pedido")
+            self.trace(f.index, f"sweep {f.name}: ciclo {cycle} concluído ({step} passos)")
+            cycle += 1
+
+    async def handle_powerup(self, args, resp, source):
+        for f in self.filters:
+            err = None
+            try:
+                await self.bus.transaction('pow_set')
+                f.power = 1
+            except CommandFailed as e:
+                err = e.err
+            resp.begin_group(f.name, f.label)
+            if err is None:
+                resp.add_bool('ligado', True)
+            else:
+                resp.add_err('erro', err)
+            resp.end_group()
+
+    async def handle_get_power(self, args, resp, source):
+        for f in self.filters:
+            err = None
+            try:
+                await self.bus.transaction('pow')
+            except CommandFailed as e:
+                err = e.err
+            resp.begin_group(f.name, f.label)
+            if err is None:
+                resp.add_int('modo', f.power)
+            else:
+                resp.add_err('erro', err)
+            resp.end_group()
+
+    async def handle_stream(self, args, resp, source):
+        mode = re.split(r'[:?]', args)[0] if args else ''
+        if mode == 'on':
+            source.stream = True
+        elif mode == 'off':
+            source.stream = False
+        elif mode:
+            raise CommandFailed('ESP_ERR_INVALID_ARG')
+        resp.add_str('origem', source.name)
+        resp.add_bool('stream', source.stream)
+        resp.add_bool('uart', False)
+        resp.add_uint('publicados', self.stats['published'])
+        resp.add_uint('descartados', 0)
+
+    async def handle_format(self, args, resp, source):
+        fmt = re.split(r'[:?]', args)[0] if args else ''
+        if fmt:
+            if fmt not in ('text', 'kv', 'json'):
+                raise CommandFailed('ESP_ERR_INVALID_ARG')
+            source.format = fmt
+            resp.set_format(fmt)
+        resp.add_str('formato', resp.fmt)
+
+    async def handle_metrics(self, args, resp, source):
+        start = time.monotonic()
+        s = self.stats
+        channels = []
+        for i in range(metrics.CHANNELS):
+            f = self.filters[i] if i < len(self.filters) else Filter(i, '-', '', '', '', 0, 0)
+            channels.append(metrics.ChannelMetrics(f.sweep_steps, f.sweep_overruns, 0, 0, 0, f.sweep_lateness.freeze()))
+        snap = metrics.Snapshot(
+            metrics.VERSION, 0, metrics.BIN_LIMITS_US, int((start - self.start) * 1e6),
+            s['nacks'], s['rejected'], self.queue.qsize(), self.queue_wait.freeze(), self.execution.freeze(),
+            s['transactions'], s['bus_errors'], 0, s['crc_errors'], 0, s['busy_us'],
+            s['published'], 0, s['published'], 0, 0,
+            tuple(channels), s['scrapes'], 0, s['scrape_last_us'], s['scrape_max_us'])
+        block = metrics.encode(snap._replace(scrape_build_us=int((time.monotonic() - start) * 1e6)))
+        elapsed_us = int((time.monotonic() - start) * 1e6)
+        s['scrapes'] += 1
+        s['scrape_last_us'] = elapsed_us
+        s['scrape_max_us'] = max(s['scrape_max_us'], elapsed_us)
+        return block
+
+    # --- Execução ---
+
+    async def serve_tcp(self, port):
+        async def handle(reader, writer):
+            source = TcpSource(writer)
+            self.sources.append(source)
+            try:
+                while True:
+                    data = await reader.read(4096)
+                    if not data:
+                        break
+                    source.feed(data, self)
+            except (ConnectionError, OSError):
+                pass
+            finally:
+                self.sources.remove(source)
+                writer.close()
+
+        return await asyncio.start_server(handle, '0.0.0.0', port)
+
+    async def run(self, pty):
+        pty.start(self)
+        self.sources.append(pty)
+        server = await self.serve_tcp(self.args.tcp) if self.args.tcp else None
+        processor = asyncio.ensure_future(self.process_commands())
+        stop = asyncio.Event()
+        loop = asyncio.get_running_loop()
+        for sig in (signal.SIGINT, signal.SIGTERM):
+            loop.add_signal_handler(sig, stop.set)
+        await stop.wait()
+        processor.cancel()
+        for f in self.filters:
+            await self.stop_sweep(f)
+        if server is not None:
+            server.close()
+
+
+def _atof(text):
+    """Como `atof`: o prefixo numérico, ou 0."""
+    match = re.match(r'\s*[-+]?(\d+\.?\d*|\.\d+)([eE][-+]?\d+)?', text)
+    return float(match.group(0)) if match else 0.0
+
+
+def _atoi(text):
+    match = re.match(r'\s*[-+]?\d+', text)
+    return int(match.group(0)) if match else 0
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Emulador do controlador em um pseudo-terminal")
+    parser.add_argument('--link', default=DEFAULT_LINK, help="Link simbólico para o pseudo-terminal")
+    parser.add_argument('--tcp', type=int, nargs='?', const=DEFAULT_TCP_PORT, help="Aceita também conexões TCP")
+    parser.add_argument('--band', action='append', metavar='NOME[:MIN:MAX]',
+                        help="Filtro emulado (padrão: C e L); repetir para mais filtros")
+    parser.add_argument('--sdkconfig', default=os.path.join(here, '..', 'sdkconfig'))
+    parser.add_argument('--reply-wait-ms', type=float, help="Espera da resposta do TF1 (substitui o sdkconfig)")
+    parser.add_argument('--latency-ms', type=float, default=0.0, help="Latência acrescentada a cada transação")
+    parser.add_argument('--jitter-ms', type=float, default=0.0, help="Jitter uniforme por transação (0 a N ms)")
+    parser.add_argument('--stall-rate', type=float, default=0.0, help="Probabilidade de travamento por transação")
+    parser.add_argument('--stall-ms', type=float, default=1000.0, help="Duração de um travamento")
+    parser.add_argument('--fail-rate', type=float, default=0.0, help="Probabilidade de falha por transação")
+    parser.add_argument('--drop-rate', type=float, default=0.0, help="Probabilidade de perder uma resposta")
+    parser.add_argument('--corrupt-rate', type=float, default=0.0, help="Probabilidade de corromper uma resposta")
+    parser.add_argument('--time-scale', type=float, default=1.0, help="Multiplica todos os tempos (0: sem espera)")
+    parser.add_argument('--seed', type=int, help="Semente dos erros injetados (reprodutível)")
+    parser.add_argument('--logs', action='store_true', help="Escreve linhas de log no console, como o ESP-IDF")
+    args = parser.parse_args()
+
+    if not hasattr(os, 'openpty'):
+        sys.exit("Pseudo-terminais requerem um sistema POSIX")
+    emulator = Emulator(args)
+    pty = PtySource(args.link)
+    print(f"Console em {pty.path}" + (f" ({args.link})" if args.link else "") +
+          (f", TCP na porta {args.tcp}" if args.tcp else "") +
+          f"; filtros: {', '.join(f.name for f in emulator.filters)}; "
+          f"transação WVL: {emulator.bus.timing.transaction_ms('wvl', I2C_KHZ):.1f} ms", flush=True)
+    try:
+        asyncio.run(emulator.run(pty))
+    finally:
+        pty.close()
+        s = emulator.stats
+        print(f"{s['commands']} comandos, {s['rejected']} recusados (fila cheia), {s['transactions']} transações; "
+              f"injetados: {s['failures']} falhas, {s['stalls']} travamentos, {s['dropped']} respostas perdidas, "
+              f"{s['corrupted']} corrompidas")
+
+
+if __name__ == '__main__':
+    main()
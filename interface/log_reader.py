@@ -0,0 +1,217 @@
+# log_reader.py
+
+"""
+Download e decodificação dos arquivos de registro das varreduras gravados em flash
+(ver main/sweep_log.h e o comando `log`).
+
+Cada arquivo é uma sequência de blocos (little-endian):
+    cabeçalho: magic "SLG1" (u32) | block_seq (u32) | record_count (u16) | record_size (u16) | dropped (u32)
+    registros: timestamp_ms (u32) | cycle (u32) | step (u16) | channel (u8) | flags (u8)
+               | target_wl (f32) | readback_wl (f32) | adc (u16) | reservado (u16)
+
+O comando `:log:read:<índice>` devolve o arquivo como bloco binário de tamanho
+definido (`:ACK: #<d><tamanho><dados>\\n`), pela serial ou pelo servidor TCP.
+
+Uso:
+    python log_reader.py --port /dev/ttyUSB0 --list
+    python log_reader.py --port /dev/ttyUSB0 --index 3 --csv varredura.csv
+    python log_reader.py --tcp 192.168.0.50 --index 3 --save sweep_00003.bin
+    python log_reader.py --file sweep_00003.bin --csv varredura.csv
+"""
+
+import argparse
+import csv
+import socket
+import struct
+import sys
+from collections import namedtuple
+
+BLOCK_MAGIC = 0x31474C53
+
+FLAG_READBACK = 0x01
+FLAG_ADC = 0x02
+FLAG_ERROR = 0x04
+FLAG_SYNTHETIC = 0x80
+
+CHANNEL_NAMES = {0: 'C', 1: 'L'}
+
+Record = namedtuple('Record', ['timestamp_ms', 'cycle', 'step', 'channel', 'flags',
+                               'target_wl', 'readback_wl', 'adc'])
+
+_HEADER = struct.Struct('<IIHHI')
+_RECORD = struct.Struct('<IIHBBffHH')
+
+
+class LogSummary:
+    """Contadores da decodificação de um arquivo."""
+
+    def __init__(self):
+        self.blocks = 0
+        self.records = 0
+        self.dropped = 0
+        self.errors = 0
+        self.block_gaps = 0
+        self.corrupt = False
+
+
+def parse_log(data, summary=None):
+    """Decodifica o conteúdo de um arquivo de registro. Retorna a lista de `Record`."""
+    summary = summary if summary is not None else LogSummary()
+    records = []
+    offset = 0
+    last_seq = None
+    while offset + _HEADER.size <= len(data):
+        magic, block_seq, count, record_size, dropped = _HEADER.unpack_from(data, offset)
+        end = offset + _HEADER.size + count * record_size
+        if magic != BLOCK_MAGIC or record_size < _RECORD.size or end > len(data):
+            summary.corrupt = True
+            break
+        if last_seq is not None and block_seq != last_seq + 1:
+            summary.block_gaps += 1
+        last_seq = block_seq
+        summary.blocks += 1
+        summary.dropped += dropped
+        for i in range(count):
+            fields = _RECORD.unpack_from(data, offset + _HEADER.size + i * record_size)
+            record = Record(*fields[:8])
+            if record.flags & FLAG_ERROR:
+                summary.errors += 1
+            records.append(record)
+        offset = end
+    if offset != len(data):
+        summary.corrupt = True
+    summary.records += len(records)
+    return records
+
+
+def write_csv(path, records):
+    with open(path, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['timestamp_ms', 'ciclo', 'passo', 'banda', 'alvo_nm', 'readback_nm', 'adc', 'erro'])
+        for r in records:
+            writer.writerow([
+                r.timestamp_ms, r.cycle, r.step, CHANNEL_NAMES.get(r.channel, '-'),
+                f"{r.target_wl:.3f}",
+                f"{r.readback_wl:.3f}" if r.flags & FLAG_READBACK else '',
+                r.adc if r.flags & FLAG_ADC else '',
+                1 if r.flags & FLAG_ERROR else 0,
+            ])
+
+
+class _Link:
+    """Serial ou TCP, com a mesma interface (`read`, `readline`, `write`)."""
+
+    def __init__(self, port=None, host=None, tcp_port=5025, timeout=10.0):
+        if host is not None:
+            self._sock = socket.create_connection((host, tcp_port), timeout=timeout)
+            self._file = self._sock.makefile('rb')
+            self.write = self._sock.sendall
+        else:
+            import serial
+            self._sock = None
+            self._file = serial.Serial(port, 115200, timeout=timeout)
+            self.write = self._file.write
+
+    def read_exact(self, n):
+        data = bytearray()
+        while len(data) < n:
+            chunk = self._file.read(n - len(data))
+            if not chunk:
+                raise TimeoutError(f"Resposta incompleta ({len(data)} de {n} bytes)")
+            data.extend(chunk)
+        return bytes(data)
+
+    def readline(self):
+        line = self._file.readline()
+        if not line:
+            raise TimeoutError("Sem resposta do dispositivo")
+        return line
+
+    def close(self):
+        self._file.close()
+        if self._sock is not None:
+            self._sock.close()
+
+
+def command(link, text):
+    """Envia um comando e retorna (ok, resto da linha de resposta como bytes)."""
+    link.write(f":{text}\n".encode())
+    while True:
+        line = link.readline()
+        if line.startswith(b':ACK'):
+            return True, line[4:].lstrip(b': ')
+        if line.startswith(b':NACK'):
+            return False, line[6:].strip()
+        # Linhas :DAT: e logs do console são ignorados.
+
+
+def read_block_reply(link, text):
+    """Envia um comando cuja resposta é um bloco binário `#<d><tamanho><dados>`."""
+    link.write(f":{text}\n".encode())
+    while True:
+        # Só a linha de resposta é binária: as demais (:DAT:, logs) são lidas por linha e descartadas.
+        if link.read_exact(1) != b':':
+            link.readline()
+            continue
+        tag = link.read_exact(4)
+        if tag == b'NACK':
+            raise RuntimeError(link.readline().decode(errors='replace').strip(': \r\n'))
+        if tag != b'ACK:':
+            link.readline()
+            continue
+        marker = link.read_exact(2)
+        if marker != b' #':
+            raise RuntimeError(f"Resposta inesperada: {marker + link.readline()!r}")
+        digits = int(link.read_exact(1))
+        length = int(link.read_exact(digits))
+        data = link.read_exact(length)
+        link.readline()
+        return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Leitor dos registros de varredura em flash")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help="Porta serial do console")
+    source.add_argument('--tcp', metavar='HOST', help="Servidor TCP do firmware")
+    source.add_argument('--file', help="Arquivo .bin já baixado")
+    parser.add_argument('--tcp-port', type=int, default=5025)
+    parser.add_argument('--list', action='store_true', help="Lista os arquivos no dispositivo")
+    parser.add_argument('--index', type=int, help="Índice do arquivo a baixar")
+    parser.add_argument('--save', help="Salva o arquivo binário baixado")
+    parser.add_argument('--csv', help="Exporta os registros em CSV")
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, 'rb') as f:
+            data = f.read()
+    else:
+        link = _Link(port=args.port, host=args.tcp, tcp_port=args.tcp_port)
+        try:
+            if args.list or args.index is None:
+                ok, reply = command(link, 'log:list')
+                print(reply.decode(errors='replace').strip() if ok else f"Erro: {reply.decode()}")
+                return
+            data = read_block_reply(link, f'log:read:{args.index}')
+        finally:
+            link.close()
+        if args.save:
+            with open(args.save, 'wb') as f:
+                f.write(data)
+
+    summary = LogSummary()
+    records = parse_log(data, summary)
+    print(f"{len(data)} bytes, {summary.blocks} blocos, {summary.records} registros, "
+          f"{summary.dropped} descartados, {summary.errors} com erro, {summary.block_gaps} lacunas de bloco"
+          + (", arquivo truncado/corrompido" if summary.corrupt else ""))
+    if records:
+        span = (records[-1].timestamp_ms - records[0].timestamp_ms) / 1000.0
+        if span > 0:
+            print(f"{span:.1f} s registrados, {len(records) / span:.1f} registros/s")
+    if args.csv:
+        write_csv(args.csv, records)
+        print(f"CSV salvo em {args.csv}")
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,17 +1,20 @@
 # main_window.py
 
-import serial
-import sys
-from PyQt5.QtWidgets import (QApplication, QMainWindow, QWidget, QVBoxLayout,
+from PyQt5.QtWidgets import (QMainWindow, QWidget, QVBoxLayout,
                              QComboBox, QPushButton, QHBoxLayout, QLabel, QMessageBox)
-from PyQt5.QtCore import QThread, pyqtSlot
-from communication import SerialCommunicator, serial_ports
+from PyQt5.QtCore import QThread, QTimer
+from communication import ClientCommunicator, DataPortReader, serial_ports
+from update_model import FRAME_RATE_HZ, UpdateModel
+from plot_data import LivePlotData
 from widgets.get_wl_widget import GetWlWidget
 from widgets.set_wl_widget import SetWlWidget
 from widgets.get_iden_widget import GetIdenWidget
 from widgets.sweep_widget import SweepWidget
+from widgets.live_plot_widget import LivePlotWidget
 
 class MainWindow(QMainWindow):
+    NO_DATA_PORT = "(console)"
+
     def __init__(self, parent=None):
         super().__init__(parent)
         self.setWindowTitle("Controlador de Filtro Sercalo")
@@ -20,6 +23,14 @@ class MainWindow(QMainWindow):
         # Thread de comunicação
         self.comm_thread = None
         self.communicator = None
+        # Thread da porta de dados (opcional)
+        self.data_thread = None
+        self.data_reader = None
+        # Eventos das threads de comunicação, aplicados à tela a cada quadro
+        self.model = UpdateModel()
+        # Séries do gráfico ao vivo: recebem todos os quadros, não só o último
+        self.plot_data = LivePlotData()
+        self.model.add_frame_sink(self.plot_data.add_frames)
 
         # --- Layout Principal ---
         self.central_widget = QWidget()
@@ -30,6 +41,7 @@ class MainWindow(QMainWindow):
         # --- Seção de Conexão ---
         connection_layout = QHBoxLayout()
         self.port_selector = QComboBox()
+        self.port_selector.setEditable(True)    # Aceita também tcp://host:porta e unix://socket
         self.refresh_button = QPushButton("Atualizar")
         self.connect_button = QPushButton("Conectar")
         connection_layout.addWidget(QLabel("Porta Serial:"))
@@ -38,6 +50,13 @@ class MainWindow(QMainWindow):
         connection_layout.addWidget(self.connect_button)
         self.main_layout.addLayout(connection_layout)
 
+        # Porta opcional do plano de dados (UART dedicada à telemetria)
+        data_layout = QHBoxLayout()
+        self.data_port_selector = QComboBox()
+        data_layout.addWidget(QLabel("Porta de Dados:"))
+        data_layout.addWidget(self.data_port_selector)
+        self.main_layout.addLayout(data_layout)
+
         # --- Widgets de Comando (aqui está a escalabilidade!) ---
         self.command_widgets = []
         
@@ -46,6 +65,7 @@ class MainWindow(QMainWindow):
         self.set_wl_widget = SetWlWidget()
         self.get_iden_widget = GetIdenWidget()
         self.sweep_widget = SweepWidget()
+        self.plot_widget = LivePlotWidget(self.plot_data)
         
         # Adicione-os ao layout e a uma lista de gerenciamento
         self.main_layout.addWidget(self.get_wl_widget)
@@ -59,27 +79,43 @@ class MainWindow(QMainWindow):
 
         self.main_layout.addWidget(self.sweep_widget)
         self.command_widgets.append(self.sweep_widget)
+
+        self.main_layout.addWidget(self.plot_widget)
+        self.command_widgets.append(self.plot_widget)
         
         # Adicione aqui outros widgets que você criar
         
         self.main_layout.addStretch() # Empurra tudo para cima
 
+        # Estado do enlace: comandos pendentes, latência e telemetria
+        self.link_label = QLabel("Desconectado")
+        self.statusBar().addPermanentWidget(self.link_label)
+
         # --- Conectar Sinais e Slots ---
         self.refresh_button.clicked.connect(self.populate_ports)
         self.connect_button.clicked.connect(self.toggle_connection)
         
-        # Conecta o sinal de cada widget ao comunicador
+        # Conecta o sinal de cada widget ao comunicador; a resposta volta ao mesmo widget
         for widget in self.command_widgets:
-            widget.send_command_requested.connect(self.send_command_from_widget)
+            widget.send_command_requested.connect(
+                lambda command, w=widget: self.send_command_from_widget(w, command))
+
+        # Quadros de tela a taxa fixa, independentes do ritmo das respostas e da telemetria
+        self.frame_timer = QTimer(self)
+        self.frame_timer.timeout.connect(self.apply_updates)
+        self.frame_timer.start(1000 // FRAME_RATE_HZ)
 
         self.populate_ports()
 
     def populate_ports(self):
         """Busca e exibe as portas seriais disponíveis."""
         self.port_selector.clear()
+        self.data_port_selector.clear()
+        self.data_port_selector.addItem(self.NO_DATA_PORT)
         port_names = serial_ports()
         for port in port_names:
             self.port_selector.addItem(port)
+            self.data_port_selector.addItem(port)
 
     def toggle_connection(self):
         """Conecta ou desconecta do dispositivo serial."""
@@ -90,23 +126,45 @@ class MainWindow(QMainWindow):
                 return
 
             self.comm_thread = QThread()
-            self.communicator = SerialCommunicator(port_name)
+            self.communicator = ClientCommunicator(port_name, self.model)
             self.communicator.moveToThread(self.comm_thread)
 
-            # Conecta os sinais do comunicador à GUI
+            # Respostas e quadros chegam pelo modelo; só o fim da conexão é um sinal.
             self.comm_thread.started.connect(self.communicator.connect)
-            self.communicator.response_received.connect(self.handle_response)
-            self.communicator.error_received.connect(self.handle_error)
             self.communicator.port_closed.connect(self.on_disconnected)
 
             self.comm_thread.start()
+            self.start_data_port()
             self.connect_button.setText("Desconectar")
             self.refresh_button.setEnabled(False)
             self.port_selector.setEnabled(False)
+            self.data_port_selector.setEnabled(False)
 
         else: # Se está conectado
             self.communicator.disconnect()
 
+    def start_data_port(self):
+        """Abre a porta do plano de dados, se uma foi selecionada."""
+        data_port = self.data_port_selector.currentText()
+        if not data_port or data_port == self.NO_DATA_PORT:
+            return
+        self.data_thread = QThread()
+        self.data_reader = DataPortReader(data_port, self.model)
+        self.data_reader.moveToThread(self.data_thread)
+        self.data_thread.started.connect(self.data_reader.connect)
+        self.data_reader.port_closed.connect(self.data_thread.quit)
+        self.data_thread.start()
+
+    def stop_data_port(self):
+        """Fecha a porta do plano de dados, se aberta."""
+        if self.data_reader:
+            self.data_reader.disconnect()
+        if self.data_thread:
+            self.data_thread.quit()
+            self.data_thread.wait()
+        self.data_thread = None
+        self.data_reader = None
+
     def on_disconnected(self):
         """Chamado quando a porta é fechada."""
         if self.comm_thread:
@@ -114,34 +172,43 @@ class MainWindow(QMainWindow):
             self.comm_thread.wait()
         self.comm_thread = None
         self.communicator = None
+        self.stop_data_port()
         
         self.connect_button.setText("Conectar")
         self.refresh_button.setEnabled(True)
         self.port_selector.setEnabled(True)
+        self.data_port_selector.setEnabled(True)
 
-    @pyqtSlot(str)
-    def send_command_from_widget(self, command):
-        """Envia um comando vindo de qualquer widget."""
-        if self.communicator:
-            self.communicator.send_command(command)
-        else:
+    def send_command_from_widget(self, widget, command):
+        """Enfileira um comando vindo de um widget, sem esperar a resposta."""
+        if self.communicator is None:
             QMessageBox.warning(self, "Desconectado", "Conecte-se a uma porta serial primeiro.")
-
-    def handle_response(self, response):
-        """Distribui a resposta para o widget correto (se necessário)."""
-        # Lógica futura: se a resposta precisar atualizar um widget específico,
-        # você pode implementar um sistema de roteamento aqui.
-        # Por simplicidade, atualizamos todos por enquanto.
-        for widget in self.command_widgets:
-            widget.update_status(response)
-
-    def handle_error(self, error_message):
-        """Distribui a mensagem de erro."""
-        for widget in self.command_widgets:
-            widget.update_status(error_message, is_error=True)
+        elif self.communicator.submit(widget, command):
+            widget.update_status("Enviado...")
+        else:
+            widget.update_status("Conexão ainda não estabelecida.", is_error=True)
+
+    def apply_updates(self):
+        """Aplica à tela os eventos acumulados desde o último quadro (uma vez por widget)."""
+        updates = self.model.drain()
+        for widget, (ok, text) in updates.replies.items():
+            widget.update_status(text, is_error=not ok)
+        for frame in updates.frames.values():
+            self.sweep_widget.update_telemetry(frame)
+        self.plot_widget.refresh()
+        for message in updates.errors:
+            self.statusBar().showMessage(message, 5000)
+
+        if self.communicator is None:
+            self.link_label.setText("Desconectado")
+            return
+        link = updates.link
+        latency = f"{link.latency_ms:.0f} ms (última {link.last_latency_ms:.0f} ms)" if link.latency_ms is not None else "-"
+        self.link_label.setText(f"Fila: {link.pending} | Latência: {latency} | Telemetria: {link.frames_per_s:.0f} quadros/s")
 
     def closeEvent(self, event):
         """Garante que a conexão seja fechada ao fechar a janela."""
         if self.communicator:
             self.communicator.disconnect()
+        self.stop_data_port()
         event.accept()
\ No newline at end of file
@@ -0,0 +1,111 @@
+# metrics.py
+
+"""
+Bloco binário do comando `metrics` (ver main/metrics.h).
+
+Uma estrutura de tamanho fixo, little-endian e sem preenchimento, com todos os
+contadores de saúde do controlador. Os histogramas trazem as contagens por faixa
+(não cumulativas), a soma e o total; os limites das faixas vêm no próprio bloco.
+`decode` lê o bloco recebido (`await client.command('metrics')`); `encode` monta o
+mesmo bloco (usado pelo emulador).
+"""
+
+import struct
+from collections import namedtuple
+
+VERSION = 1
+CHANNELS = 2
+HIST_BINS = 13
+
+FLAG_SWEEP_EDF = 0x01
+FLAG_VERIFY = 0x02
+
+# Limites das faixas (us), os de metrics.c.
+BIN_LIMITS_US = (100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000)
+
+# `bins`: contagem por faixa; a última é acima de `limits[-1]`.
+Histogram = namedtuple('Histogram', ['bins', 'sum_us', 'count'])
+ChannelMetrics = namedtuple('ChannelMetrics', ['sweep_steps', 'sweep_overruns', 'verify_checks', 'verify_retried',
+                                               'verify_failed', 'sweep_lateness'])
+Snapshot = namedtuple('Snapshot', [
+    'version', 'flags', 'limits_us', 'uptime_us',
+    'commands_nack', 'commands_rejected', 'queue_depth', 'queue_wait', 'execution',
+    'bus_transactions', 'bus_errors', 'bus_invalid_responses', 'bus_crc_errors', 'bus_device_errors', 'bus_busy_us',
+    'dp_published', 'dp_dropped', 'dp_delivered', 'dp_sink_errors', 'dp_bytes',
+    'channels',
+    'scrapes', 'scrape_build_us', 'scrape_last_us', 'scrape_max_us',
+])
+
+_HIST = f'{HIST_BINS}IQI'
+_HEADER = struct.Struct('<BBBBI')
+_BODY = struct.Struct('<' + f'{HIST_BINS - 1}IQ' + 'III' + _HIST * 2 + '5IQ' + '4IQ'
+                      + ('5I' + _HIST) * CHANNELS + '4I')
+SIZE = _HEADER.size + _BODY.size
+
+
+def _hist(values, i):
+    return Histogram(tuple(values[i:i + HIST_BINS]), values[i + HIST_BINS], values[i + HIST_BINS + 1]), \
+        i + HIST_BINS + 2
+
+
+def decode(data):
+    """Snapshot de um bloco `metrics`; gera ValueError se a versão ou o tamanho não conferem."""
+    if len(data) < _HEADER.size:
+        raise ValueError(f"Bloco de métricas curto ({len(data)} bytes)")
+    version, bins, channels, flags, size = _HEADER.unpack_from(data)
+    if version != VERSION or bins != HIST_BINS or channels != CHANNELS or size != SIZE or len(data) < SIZE:
+        raise ValueError(f"Bloco de métricas incompatível (versão {version}, {size} bytes)")
+    v = _BODY.unpack_from(data, _HEADER.size)
+    limits, uptime_us = v[:HIST_BINS - 1], v[HIST_BINS - 1]
+    i = HIST_BINS
+    nack, rejected, depth = v[i:i + 3]
+    queue_wait, i = _hist(v, i + 3)
+    execution, i = _hist(v, i)
+    bus = v[i:i + 6]
+    dp = v[i + 6:i + 11]
+    i += 11
+    chans = []
+    for _ in range(CHANNELS):
+        counters = v[i:i + 5]
+        lateness, i = _hist(v, i + 5)
+        chans.append(ChannelMetrics(*counters, lateness))
+    return Snapshot(version, flags, limits, uptime_us, nack, rejected, depth, queue_wait, execution,
+                    *bus, *dp, tuple(chans), *v[i:i + 4])
+
+
+def encode(snap):
+    """Bloco `metrics` de um Snapshot (o inverso de `decode`)."""
+    def hist(h):
+        return (*h.bins, h.sum_us, h.count)
+
+    values = [*snap.limits_us, snap.uptime_us, snap.commands_nack, snap.commands_rejected, snap.queue_depth,
+              *hist(snap.queue_wait), *hist(snap.execution),
+              snap.bus_transactions, snap.bus_errors, snap.bus_invalid_responses, snap.bus_crc_errors,
+              snap.bus_device_errors, snap.bus_busy_us,
+              snap.dp_published, snap.dp_dropped, snap.dp_delivered, snap.dp_sink_errors, snap.dp_bytes]
+    for ch in snap.channels:
+        values += [ch.sweep_steps, ch.sweep_overruns, ch.verify_checks, ch.verify_retried, ch.verify_failed,
+                   *hist(ch.sweep_lateness)]
+    values += [snap.scrapes, snap.scrape_build_us, snap.scrape_last_us, snap.scrape_max_us]
+    return _HEADER.pack(VERSION, HIST_BINS, CHANNELS, snap.flags, SIZE) + _BODY.pack(*values)
+
+
+class HistogramAccumulator:
+    """Histograma mutável com as faixas do firmware (para o emulador)."""
+
+    def __init__(self):
+        self.bins = [0] * HIST_BINS
+        self.sum_us = 0
+        self.count = 0
+
+    def observe(self, us):
+        us = max(0, int(us))
+        b = 0
+        while b < HIST_BINS - 1 and us > BIN_LIMITS_US[b]:
+            b += 1
+        self.bins[b] += 1
+        self.sum_us += us
+        self.count += 1
+
+    def freeze(self):
+        return Histogram(tuple(self.bins), self.sum_us, self.count)
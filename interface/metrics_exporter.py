@@ -0,0 +1,271 @@
+# metrics_exporter.py
+
+"""
+Exportador das métricas de saúde do controlador em formato Prometheus.
+
+A cada coleta do Prometheus, o exportador envia um único comando `metrics` ao
+controlador e recebe todos os contadores em um bloco binário de tamanho fixo
+(main/metrics.h, decodificado por metrics.py). Coletas que chegam dentro de
+`--min-interval` segundos da anterior, ou enquanto ela ainda aguarda resposta,
+reaproveitam o mesmo bloco: o custo no controlador é no máximo uma coleta por
+intervalo, qualquer que seja o número de coletores.
+
+As métricas saem em texto (`GET /metrics`, somente em 127.0.0.1 por padrão):
+contadores com `_total`, medidas instantâneas e histogramas com as faixas do
+firmware preservadas (`_bucket{le=...}` cumulativos, `_sum` e `_count`, em
+segundos). O custo de cada coleta também é exportado: a montagem do bloco no
+controlador, a coleta completa anterior (montagem e envio), a maior delas e o
+tempo de ida e volta medido pelo exportador.
+
+Uso:
+    python metrics_exporter.py --port /dev/ttyUSB0                # http://127.0.0.1:9464/metrics
+    python metrics_exporter.py --unix /tmp/sercalo_mux --http-port 9100
+    python metrics_exporter.py --tcp 192.168.0.50 --min-interval 5
+"""
+
+import argparse
+import asyncio
+import time
+
+import metrics
+from data_plane import CHANNEL_NAMES
+from sercalo_client import DEFAULT_TCP_PORT, SercaloClient
+
+DEFAULT_HTTP_PORT = 9464
+RECONNECT_DELAY = 1.0           # Segundos entre tentativas de reabrir a conexão.
+REQUEST_LIMIT = 8192            # Bytes aceitos no cabeçalho de uma requisição HTTP.
+CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8'
+
+
+def _seconds(us):
+    return f'{us / 1e6:.6g}'
+
+
+def _labels(labels):
+    if not labels:
+        return ''
+    return '{' + ','.join(f'{k}="{v}"' for k, v in labels.items()) + '}'
+
+
+class MetricsText:
+    """Monta o texto de exposição do Prometheus, com um HELP/TYPE por família."""
+
+    def __init__(self, prefix='sercalo_'):
+        self.prefix = prefix
+        self.lines = []
+        self._declared = set()
+
+    def _declare(self, name, kind, help_text):
+        if name not in self._declared:
+            self._declared.add(name)
+            self.lines.append(f'# HELP {name} {help_text}')
+            self.lines.append(f'# TYPE {name} {kind}')
+
+    def sample(self, kind, name, help_text, value, /, **labels):
+        name = self.prefix + name
+        self._declare(name, kind, help_text)
+        self.lines.append(f'{name}{_labels(labels)} {value}')
+
+    def counter(self, name, help_text, value, /, **labels):
+        self.sample('counter', name + '_total', help_text, value, **labels)
+
+    def gauge(self, name, help_text, value, /, **labels):
+        self.sample('gauge', name, help_text, value, **labels)
+
+    def histogram(self, name, help_text, hist, limits_us, /, **labels):
+        """Histograma do firmware (contagens por faixa, em us) em faixas cumulativas, em segundos."""
+        name = self.prefix + name
+        self._declare(name, 'histogram', help_text)
+        cumulative = 0
+        for limit, count in zip(limits_us, hist.bins):
+            cumulative += count
+            self.lines.append(f'{name}_bucket{_labels({**labels, "le": _seconds(limit)})} {cumulative}')
+        self.lines.append(f'{name}_bucket{_labels({**labels, "le": "+Inf"})} {hist.count}')
+        self.lines.append(f'{name}_sum{_labels(labels)} {_seconds(hist.sum_us)}')
+        self.lines.append(f'{name}_count{_labels(labels)} {hist.count}')
+
+    def text(self):
+        return '\n'.join(self.lines) + '\n'
+
+
+def render(snap, round_trip_s, stats):
+    """Texto de exposição de um Snapshot (`snap` None: controlador inacessível)."""
+    out = MetricsText()
+    out.gauge('up', "1 se a última coleta no controlador teve sucesso", int(snap is not None))
+    out.counter('exporter_scrapes', "Coletas atendidas pelo exportador", stats['http'])
+    out.counter('exporter_device_requests', "Comandos metrics enviados ao controlador", stats['device'])
+    out.counter('exporter_device_errors', "Coletas no controlador sem resposta ou recusadas", stats['errors'])
+    if snap is None:
+        return out.text()
+
+    limits = snap.limits_us
+    out.gauge('uptime_seconds', "Tempo desde a partida do controlador", _seconds(snap.uptime_us))
+
+    out.counter('commands', "Comandos executados", snap.execution.count)
+    out.counter('command_nacks', "Comandos respondidos com NACK", snap.commands_nack)
+    out.counter('command_rejected', "Comandos recusados por fila cheia", snap.commands_rejected)
+    out.gauge('command_queue_depth', "Comandos aguardando na fila durante a coleta", snap.queue_depth)
+    out.histogram('command_queue_wait_seconds', "Espera dos comandos na fila", snap.queue_wait, limits)
+    out.histogram('command_duration_seconds', "Execução dos comandos (inclui as transações I2C)",
+                  snap.execution, limits)
+
+    out.counter('bus_transactions', "Transações I2C com os filtros", snap.bus_transactions)
+    help_errors = "Transações I2C com erro, por tipo"
+    out.counter('bus_errors', help_errors, snap.bus_errors, kind='bus')
+    out.counter('bus_errors', help_errors, snap.bus_invalid_responses, kind='invalid_response')
+    out.counter('bus_errors', help_errors, snap.bus_crc_errors, kind='crc')
+    out.counter('bus_errors', help_errors, snap.bus_device_errors, kind='device')
+    out.counter('bus_busy_seconds', "Tempo ocupado pelas transações I2C (a taxa é a ocupação do barramento)",
+                _seconds(snap.bus_busy_us))
+
+    help_frames = "Quadros do plano de dados, por resultado"
+    out.counter('data_plane_frames', help_frames, snap.dp_published, result='published')
+    out.counter('data_plane_frames', help_frames, snap.dp_dropped, result='dropped')
+    out.counter('data_plane_frames', help_frames, snap.dp_delivered, result='delivered')
+    out.counter('data_plane_frames', help_frames, snap.dp_sink_errors, result='sink_error')
+    out.counter('data_plane_bytes', "Bytes entregues aos destinos do plano de dados", snap.dp_bytes)
+
+    # Cada família com todos os canais em sequência (o formato não admite famílias intercaladas).
+    channels = [(CHANNEL_NAMES.get(i, str(i)), ch) for i, ch in enumerate(snap.channels)]
+    for name, ch in channels:
+        out.counter('sweep_steps', "Passos de varredura", ch.sweep_steps, channel=name)
+    for name, ch in channels:
+        out.counter('sweep_overruns', "Passos de varredura que esperaram o barramento além da folga",
+                    ch.sweep_overruns, channel=name)
+    for name, ch in channels:
+        out.histogram('sweep_bus_wait_seconds', "Espera dos passos de varredura pelo barramento",
+                      ch.sweep_lateness, limits, channel=name)
+    if snap.flags & metrics.FLAG_VERIFY:
+        for name, ch in channels:
+            out.counter('verify_checks', "Verificações por leitura de volta", ch.verify_checks, channel=name)
+        for name, ch in channels:
+            out.counter('verify_retries', "Verificações que repetiram a leitura", ch.verify_retried, channel=name)
+        for name, ch in channels:
+            out.counter('verify_failures', "Verificações fora da tolerância após as repetições",
+                        ch.verify_failed, channel=name)
+
+    out.counter('scrapes', "Coletas atendidas pelo controlador", snap.scrapes + 1)
+    out.gauge('scrape_build_seconds', "Montagem do bloco desta coleta no controlador",
+              _seconds(snap.scrape_build_us))
+    out.gauge('scrape_last_seconds', "Coleta anterior completa no controlador (montagem e envio)",
+              _seconds(snap.scrape_last_us))
+    out.gauge('scrape_max_seconds', "Maior coleta completa no controlador", _seconds(snap.scrape_max_us))
+    out.gauge('scrape_bytes', "Tamanho do bloco de métricas", metrics.SIZE)
+    out.gauge('scrape_round_trip_seconds', "Ida e volta do comando metrics medida pelo exportador",
+              f'{round_trip_s:.6g}')
+    return out.text()
+
+
+class Exporter:
+    def __init__(self, args):
+        self.args = args
+        self.client = None
+        self.snapshot = None
+        self.round_trip = 0.0
+        self.fetched = float('-inf')
+        self.fetching = None            # Future da coleta em andamento (compartilhada).
+        self.stats = dict.fromkeys(('http', 'device', 'errors'), 0)
+
+    async def connect(self):
+        args = self.args
+        if args.tcp:
+            return await SercaloClient.open_tcp(args.tcp, args.tcp_port, timeout=args.timeout)
+        if args.unix:
+            return await SercaloClient.open_unix(args.unix, timeout=args.timeout)
+        return await SercaloClient.open_serial(args.port, args.baudrate, timeout=args.timeout)
+
+    async def keep_connected(self):
+        while True:
+            try:
+                self.client = await self.connect()
+            except (OSError, ConnectionError) as e:
+                print(f"Falha ao conectar: {e}", flush=True)
+                await asyncio.sleep(RECONNECT_DELAY)
+                continue
+            await self.client.wait_disconnected()
+            self.client = None
+            self.snapshot = None
+            print("Conexão com o controlador perdida", flush=True)
+            await asyncio.sleep(RECONNECT_DELAY)
+
+    async def _fetch(self):
+        self.stats['device'] += 1
+        start = time.perf_counter()
+        try:
+            if self.client is None:
+                raise ConnectionError("sem conexão")
+            snap = metrics.decode(await self.client.command('metrics'))
+        except Exception as e:
+            self.stats['errors'] += 1
+            self.snapshot = None
+            print(f"Coleta falhou: {e}", flush=True)
+            return
+        self.round_trip = time.perf_counter() - start
+        self.snapshot = snap
+        self.fetched = time.monotonic()
+
+    async def scrape(self):
+        """Texto de exposição; no máximo um comando no controlador por `--min-interval`."""
+        self.stats['http'] += 1
+        if time.monotonic() - self.fetched >= self.args.min_interval:
+            if self.fetching is None:
+                self.fetching = asyncio.ensure_future(self._fetch())
+                self.fetching.add_done_callback(lambda _: setattr(self, 'fetching', None))
+            await asyncio.shield(self.fetching)
+        return render(self.snapshot, self.round_trip, self.stats)
+
+    async def handle_http(self, reader, writer):
+        try:
+            head = await reader.readuntil(b'\r\n\r\n')
+            method, path, *_ = head.split(b'\r\n', 1)[0].decode('latin-1').split(' ')
+            if method != 'GET':
+                status, body = '405 Method Not Allowed', 'Somente GET\n'
+            elif path.split('?', 1)[0] == '/metrics':
+                status, body = '200 OK', await self.scrape()
+            else:
+                status, body = '404 Not Found', 'Métricas em /metrics\n'
+            data = body.encode()
+            writer.write(f'HTTP/1.1 {status}\r\nContent-Type: {CONTENT_TYPE}\r\n'
+                         f'Content-Length: {len(data)}\r\nConnection: close\r\n\r\n'.encode() + data)
+            await writer.drain()
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, ValueError, ConnectionError):
+            pass
+        finally:
+            writer.close()
+
+    async def run(self):
+        connector = asyncio.ensure_future(self.keep_connected())
+        server = await asyncio.start_server(self.handle_http, self.args.listen, self.args.http_port,
+                                            limit=REQUEST_LIMIT)
+        print(f"Métricas em http://{self.args.listen}:{self.args.http_port}/metrics", flush=True)
+        try:
+            async with server:
+                await server.serve_forever()
+        finally:
+            connector.cancel()
+            if self.client is not None:
+                await self.client.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Exportador Prometheus das métricas do controlador")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--tcp', metavar='HOST', help="Servidor TCP do firmware")
+    source.add_argument('--port', help="Porta serial do console (ou pseudo-terminal do firmware de host)")
+    source.add_argument('--unix', metavar='SOCKET', help="Socket do mux_daemon.py")
+    parser.add_argument('--tcp-port', type=int, default=DEFAULT_TCP_PORT)
+    parser.add_argument('--baudrate', type=int, default=115200)
+    parser.add_argument('--listen', default='127.0.0.1', help="Endereço do servidor HTTP")
+    parser.add_argument('--http-port', type=int, default=DEFAULT_HTTP_PORT)
+    parser.add_argument('--min-interval', type=float, default=1.0,
+                        help="Idade máxima (s) de um bloco reaproveitado por outra coleta")
+    parser.add_argument('--timeout', type=float, default=2.0, help="Prazo do comando metrics (s)")
+    args = parser.parse_args()
+    try:
+        asyncio.run(Exporter(args).run())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,654 @@
+# mux_daemon.py
+
+"""
+Daemon que abre o enlace com o controlador e o compartilha entre vários clientes
+por um socket Unix.
+
+Só um processo consegue abrir a porta serial do console. Com o daemon, a GUI, a
+monitoração e os scripts de automação se conectam a `/tmp/sercalo_mux` (GUI:
+porta `unix:///tmp/sercalo_mux`; scripts: `SercaloClient.open_unix`) e falam o
+mesmo protocolo do firmware: `:cmd\\n`, com ou sem etiqueta `:@tag cmd`. O daemon
+é o único escritor do enlace e troca as etiquetas dos clientes pelas suas, de
+modo que os comandos de todos ficam pendentes ao mesmo tempo, até `--window`.
+
+- **Leituras iguais são agrupadas:** `iden`, `get-interval`, `get-wl`, `get-power`,
+  `metrics` e as consultas com `?` idênticas (mesmo comando e formato) a uma que ainda
+  aguarda resposta não são reenviadas; a resposta vai para todos.
+- **Propriedades estáticas em cache:** `iden` e `get-interval` são respondidos
+  localmente depois da primeira resposta, até o enlace ser reaberto.
+- **Escritas ordenadas por canal:** uma escrita (qualquer comando que não é
+  leitura) em um canal (`set-wl:C:...`, `sweep:C:...`) só é enviada depois da
+  resposta à escrita anterior no mesmo canal; os comandos seguintes daquele canal
+  esperam atrás dela, e os dos outros canais seguem. Uma escrita sem canal
+  (`powerup`) segura todos os comandos que chegam depois. Uma leitura nunca é
+  agrupada com outra que chegou antes de uma escrita no mesmo canal.
+- **Estado por cliente:** `format` é atendido pelo daemon e vale só para o
+  cliente; antes de um comando, o daemon troca o formato do enlace se preciso.
+  `stream:on|off` assina o plano de dados (`:DAT:`) para o cliente; o enlace fica
+  ligado enquanto houver assinantes, e a resposta informa o estado do enlace.
+- **Estatísticas:** `:mux?` retorna, no formato do cliente, os contadores do
+  daemon e de cada cliente (comandos, agrupados, cache, NACKs, sem resposta e
+  latência média e máxima). Ao encerrar, o daemon imprime o mesmo resumo.
+
+Comandos sem resposta em `--timeout` segundos terminam com
+`:NACK: Sem resposta do controlador`; com o enlace perdido, os pendentes terminam
+com `:NACK: Conexão com o controlador perdida`, e o daemon tenta reabri-lo a cada
+segundo, sem desconectar os clientes.
+
+Uso:
+    python mux_daemon.py --port /dev/ttyUSB0
+    python mux_daemon.py --port /tmp/sercalo_emu --socket /tmp/sercalo_mux --window 8
+    python mux_daemon.py --tcp 192.168.0.50
+    python client_bench.py --unix /tmp/sercalo_mux --window 1 8
+"""
+
+import argparse
+import asyncio
+import collections
+import itertools
+import os
+import re
+import signal
+import socket
+import struct
+import sys
+import time
+
+from response import ResponseWriter
+from sercalo_client import (BLOCK_HEADER, DEFAULT_TCP_PORT, DEFAULT_TIMEOUT, DEFAULT_WINDOW, STREAM_LIMIT,
+                            TAG_MODULUS, open_raw_serial)
+
+DEFAULT_SOCKET = '/tmp/sercalo_mux'
+CMD_BUFFER_SIZE = 128           # main/command.h
+COMMAND_TAG_MAX = 8
+RECONNECT_DELAY = 1.0           # Segundos entre tentativas de reabrir o enlace.
+TIMEOUT_CHECK = 0.05            # Período da verificação de prazos (s).
+OUTPUT_LIMIT = 1 << 20          # Bytes pendentes para um cliente; acima disso, quadros `:DAT:` são descartados.
+
+READ_COMMANDS = frozenset(('iden', 'get-interval', 'get-wl', 'get-power', 'metrics'))
+STATIC_COMMANDS = frozenset(('iden', 'get-interval'))
+FORMATS = ('text', 'kv', 'json')
+
+_COMMAND = re.compile(r'[?:]*([^?:]+)([?:]?)(.*)$')
+_TAG = re.compile(rb'@([0-9A-Za-z]+) ')
+_REPLY_TAG = re.compile(rb':N?ACK@([0-9A-Za-z]+)')
+
+
+class Op:
+    """Um comando enviado (ou a enviar) ao controlador e os clientes que aguardam a resposta."""
+
+    __slots__ = ('line', 'key', 'channel', 'write', 'fmt', 'static', 'waiters', 'deadline')
+
+    def __init__(self, line, fmt, channel=None, write=False, key=None, static=False):
+        self.line = line
+        self.fmt = fmt              # Formato exigido do enlace (None: qualquer um).
+        self.channel = channel
+        self.write = write
+        self.key = key              # Chave de agrupamento (leituras) ou None.
+        self.static = static
+        self.waiters = []           # (cliente, etiqueta ou posição na ordem do cliente, instante de chegada)
+        self.deadline = 0.0
+
+
+class ClientStats:
+    __slots__ = ('commands', 'coalesced', 'cached', 'local', 'nacks', 'timeouts', 'latency_sum', 'latency_max',
+                 'replies', 'dropped_frames')
+
+    def __init__(self):
+        for name in self.__slots__:
+            setattr(self, name, 0)
+
+
+class ClientConnection(asyncio.Protocol):
+    """Conexão de um cliente no socket Unix, com formato, assinatura e estatísticas próprios."""
+
+    def __init__(self, mux, name):
+        self.mux = mux
+        self.name = name
+        self.pid = 0
+        self.format = 'text'
+        self.stats = ClientStats()
+        self.transport = None
+        self.closed = False
+        self._buffer = b''
+        self._order = collections.deque()
+
+    def connection_made(self, transport):
+        self.transport = transport
+        sock = transport.get_extra_info('socket')
+        try:
+            creds = sock.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED, struct.calcsize('3i'))
+            self.pid = struct.unpack('3i', creds)[0]
+        except (AttributeError, OSError):
+            pass
+        self.mux.attach(self)
+
+    def connection_lost(self, exc):
+        self.closed = True
+        self.mux.detach(self)
+
+    def data_received(self, data):
+        # Como uart_command_monitor_task: ':' inicia o comando e '\n' ou '\r' o termina.
+        data = self._buffer + data if self._buffer else data
+        if b'\r' in data:
+            data = data.replace(b'\r', b'\n')
+        lines = data.split(b'\n')
+        self._buffer = lines.pop()
+        if len(self._buffer) > CMD_BUFFER_SIZE * 4:
+            self._buffer = b''      # Sem terminador: descartado.
+        for raw in lines:
+            start = raw.find(b':')
+            if start < 0 or len(raw) - start > CMD_BUFFER_SIZE:
+                continue            # Sem início de comando, ou longo demais (descartado, como no firmware).
+            command = raw[start + 1:]
+            if not command:
+                continue
+            if command[:1] != b'@':
+                # Sem etiqueta, o cliente associa as respostas pela ordem: cada comando
+                # reserva uma posição, e as respostas saem na ordem das posições.
+                slot = []
+                self._order.append(slot)
+                self.mux.submit(self, slot, command.decode('utf-8', errors='replace'))
+                continue
+            match = _TAG.match(command)
+            if match is None or len(match.group(1)) > COMMAND_TAG_MAX:
+                self.send(b":NACK: Etiqueta inv\xc3\xa1lida\n")
+                continue
+            self.mux.submit(self, match.group(1), command[match.end():].decode('utf-8', errors='replace'))
+
+    def send(self, data):
+        if not self.closed:
+            self.transport.write(data)
+
+    def reply(self, ok, tag, rest, latency):
+        """
+        Responde a um comando: `rest` é o trecho após `:ACK@tag` (ex.: `b': 1550.000\\n'`).
+        `tag` é a etiqueta do cliente ou, sem etiqueta, a posição reservada na ordem de chegada.
+        """
+        stats = self.stats
+        stats.replies += 1
+        stats.latency_sum += latency
+        if latency > stats.latency_max:
+            stats.latency_max = latency
+        if not ok:
+            stats.nacks += 1
+        if self.closed:
+            return
+        head = b':ACK' if ok else b':NACK'
+        if tag.__class__ is bytes:
+            self.transport.write(head + b'@' + tag + rest)
+            return
+        tag.append(head + rest)
+        order = self._order
+        while order and order[0]:
+            self.transport.write(order.popleft()[0])
+
+    def send_frame(self, raw):
+        if self.closed:
+            return
+        if self.transport.get_write_buffer_size() > OUTPUT_LIMIT:
+            self.stats.dropped_frames += 1
+            return
+        self.transport.write(raw)
+
+
+class Link:
+    """
+    Descritor do enlace (porta serial em modo raw ou socket TCP), lido e escrito
+    diretamente no event loop: cada linha completa vai para `on_line` sem passar
+    por coroutines, o que mantém baixo o custo do daemon por comando.
+    """
+
+    def __init__(self, fd, on_line):
+        self.fd = fd
+        self.on_line = on_line
+        self.loop = asyncio.get_running_loop()
+        self.lost = self.loop.create_future()
+        self._buffer = bytearray()
+        self._out = bytearray()
+        self.loop.add_reader(fd, self._on_readable)
+
+    def write(self, data):
+        if not self._out:
+            try:
+                sent = os.write(self.fd, data)
+            except BlockingIOError:
+                sent = 0
+            except OSError as e:
+                self._lose(e)
+                return
+            if sent == len(data):
+                return
+            self.loop.add_writer(self.fd, self._flush)
+            data = data[sent:]
+        self._out += data
+
+    def _flush(self):
+        try:
+            sent = os.write(self.fd, self._out)
+        except BlockingIOError:
+            return
+        except OSError as e:
+            self._lose(e)
+            return
+        del self._out[:sent]
+        if not self._out:
+            self.loop.remove_writer(self.fd)
+
+    def _on_readable(self):
+        try:
+            data = os.read(self.fd, 65536)
+        except BlockingIOError:
+            return
+        except OSError as e:     # EIO: o outro lado do pseudo-terminal fechou.
+            self._lose(e)
+            return
+        if not data:
+            self._lose(None)
+            return
+        buf = self._buffer
+        buf += data
+        start = 0
+        while True:
+            end = buf.find(b'\n', start)
+            if end < 0:
+                break
+            line = bytes(buf[start:end + 1])
+            block = BLOCK_HEADER.match(line)
+            if block is not None:
+                # `:ACK@tag: #<d><tamanho><dados>\n`: os dados podem conter '\n'.
+                digits = int(block.group(1))
+                try:
+                    length = int(buf[start + block.end():start + block.end() + digits])
+                except ValueError:
+                    length = 0
+                total = block.end() + digits + length + 1
+                if start + total > len(buf):
+                    break           # Bloco incompleto: espera o restante.
+                line = bytes(buf[start:start + total])
+                end = start + total - 1
+            start = end + 1
+            self.on_line(line)
+        del buf[:start]
+        if len(buf) > STREAM_LIMIT:
+            buf.clear()             # Linha longa demais, sem fim: descartada.
+
+    def _lose(self, exc):
+        if not self.lost.done():
+            self.lost.set_result(exc)
+
+    def close(self):
+        if self.fd >= 0:
+            self.loop.remove_reader(self.fd)
+            self.loop.remove_writer(self.fd)
+            os.close(self.fd)
+            self.fd = -1
+
+
+class Mux:
+    """Enlace compartilhado: fila de comandos, agrupamento, cache e ordem por canal."""
+
+    def __init__(self, args):
+        self.args = args
+        self.window = args.window
+        self.timeout = args.timeout
+        self.clients = []
+        self.subscribers = set()
+        self.queue = collections.deque()        # Comandos à espera de envio, na ordem de chegada.
+        self.pending = {}                       # Etiqueta do enlace -> Op enviado (em ordem de envio).
+        self.inflight = {}                      # Chave de leitura -> Op ainda sem resposta.
+        self.cache = {}                         # (comando, formato) -> resposta estática.
+        self.busy = collections.Counter()       # Canal -> escritas sem resposta (None: sem canal).
+        self.link_format = None                 # Formato do enlace (None: desconhecido).
+        self.link = None
+        self.stats = collections.Counter()
+        self._tags = itertools.count(1)
+        self._names = itertools.count(1)
+        self._out = []
+
+    # --- Clientes ---
+
+    def new_client(self):
+        return ClientConnection(self, f'c{next(self._names)}')
+
+    def attach(self, client):
+        self.clients.append(client)
+        self.log(f"{client.name} conectado (pid {client.pid})")
+
+    def detach(self, client):
+        if client in self.clients:
+            self.clients.remove(client)
+        s = client.stats
+        self.log(f"{client.name} desconectado: {s.commands} comandos, {s.coalesced} agrupados, "
+                 f"{s.cached} em cache, {s.nacks} NACK, {s.timeouts} sem resposta")
+        if client in self.subscribers:
+            self.subscribers.discard(client)
+            if not self.subscribers and self.link is not None:
+                self.enqueue(Op('stream:off', None))
+
+    # --- Comandos ---
+
+    def submit(self, client, tag, line):
+        client.stats.commands += 1
+        now = time.perf_counter()
+        match = _COMMAND.match(line)
+        if match is None:
+            client.reply(False, tag, b': Comando vazio\n', 0.0)
+            return
+        name, sep, args = match.groups()
+        if name == 'format':
+            self._handle_format(client, tag, args, now)
+            return
+        if name == 'stream':
+            self._handle_stream(client, tag, args, now)
+            return
+        if name == 'mux':
+            client.stats.local += 1
+            client.reply(True, tag, self._stats_reply(client.format), 0.0)
+            return
+        if self.link is None:
+            client.reply(False, tag, b': Sem conex\xc3\xa3o com o controlador\n', 0.0)
+            return
+
+        token = re.split(r'[:?]', args, 1)[0]
+        channel = token if len(token) == 1 and token.isalpha() else None
+        if name in READ_COMMANDS or sep == '?':
+            key = (line, client.format)
+            cached = self.cache.get(key)
+            if cached is not None:
+                client.stats.cached += 1
+                client.reply(True, tag, cached, 0.0)
+                return
+            op = self.inflight.get(key)
+            if op is not None:
+                client.stats.coalesced += 1
+                op.waiters.append((client, tag, now))
+                return
+            op = Op(line, client.format, channel, key=key, static=name in STATIC_COMMANDS)
+            self.inflight[key] = op
+        else:
+            op = Op(line, client.format, channel, write=True)
+            # Leituras anteriores à escrita não servem mais para os comandos seguintes.
+            if self.inflight:
+                for key in [k for k, o in self.inflight.items() if channel is None or o.channel == channel]:
+                    del self.inflight[key]
+        op.waiters.append((client, tag, now))
+        self.enqueue(op)
+
+    def enqueue(self, op):
+        self.queue.append(op)
+        self.pump()
+
+    def pump(self):
+        """Envia os comandos da fila que a janela e a ordem por canal permitem, em uma escrita."""
+        queue = self.queue
+        if not queue or self.link is None:
+            return
+        held = set()                # Canais com um comando retido nesta passada.
+        held_all = False            # Escrita sem canal retida: todos os seguintes esperam.
+        remaining = collections.deque()
+        while queue:
+            if len(self.pending) >= self.window:
+                remaining.extend(queue)
+                queue.clear()
+                break
+            op = queue.popleft()
+            channel = op.channel
+            if op.write:
+                if channel is None:
+                    blocked = held_all or bool(held) or self.busy[None] > 0
+                else:
+                    blocked = held_all or channel in held or self.busy[channel] > 0
+            else:
+                blocked = held_all or (channel is not None and channel in held)
+            if blocked:
+                remaining.append(op)
+                if op.write and channel is None:
+                    held_all = True
+                elif channel is not None:
+                    held.add(channel)
+                continue
+            self._send(op)
+        self.queue = remaining
+        if self._out:
+            self.link.write(b''.join(self._out))
+            self._out.clear()
+
+    def _send(self, op):
+        deadline = time.monotonic() + self.timeout
+        if op.fmt is not None and op.fmt != self.link_format:
+            switch = Op(f'format:{op.fmt}', None)
+            switch.deadline = deadline
+            self._emit(switch)
+            self.link_format = op.fmt
+        op.deadline = deadline
+        if op.write:
+            self.busy[op.channel] += 1
+        self._emit(op)
+
+    def _emit(self, op):
+        tag = str(next(self._tags) % TAG_MODULUS)
+        self.pending[tag] = op
+        self.stats['enviados'] += 1
+        self._out.append(f':@{tag} {op.line}\n'.encode())
+
+    def complete(self, op, ok, rest):
+        if op.write:
+            self.busy[op.channel] -= 1
+        if op.key is not None:
+            if self.inflight.get(op.key) is op:
+                del self.inflight[op.key]
+            if ok and op.static:
+                self.cache[op.key] = rest
+        if not op.waiters and not ok and op.line.startswith('format:'):
+            self.link_format = None     # Troca de formato recusada: refeita no próximo comando.
+        now = time.perf_counter()
+        for client, tag, start in op.waiters:
+            client.reply(ok, tag, rest, now - start)
+        self.pump()
+
+    # --- Comandos atendidos pelo daemon ---
+
+    def _handle_format(self, client, tag, args, now):
+        client.stats.local += 1
+        fmt = re.split(r'[:?]', args, 1)[0] if args else ''
+        if fmt:
+            if fmt not in FORMATS:
+                client.reply(False, tag, b': ESP_ERR_INVALID_ARG\n', 0.0)
+                return
+            client.format = fmt
+        resp = ResponseWriter(client.format)
+        resp.add_str('formato', client.format)
+        client.reply(True, tag, f': {resp.finish()}\n'.encode(), time.perf_counter() - now)
+
+    def _handle_stream(self, client, tag, args, now):
+        mode = re.split(r'[:?]', args, 1)[0] if args else ''
+        if mode not in ('', 'on', 'off'):
+            client.reply(False, tag, b': ESP_ERR_INVALID_ARG\n', 0.0)
+            return
+        if self.link is None:
+            client.reply(False, tag, b': Sem conex\xc3\xa3o com o controlador\n', 0.0)
+            return
+        was_on = bool(self.subscribers)
+        if mode == 'on':
+            self.subscribers.add(client)
+        elif mode == 'off':
+            self.subscribers.discard(client)
+        is_on = bool(self.subscribers)
+        # O firmware responde com o estado do enlace (compartilhado por todos os assinantes).
+        line = 'stream' if was_on == is_on else ('stream:on' if is_on else 'stream:off')
+        op = Op(line, client.format)
+        op.waiters.append((client, tag, now))
+        self.enqueue(op)
+
+    def _stats_reply(self, fmt):
+        resp = ResponseWriter(fmt)
+        resp.add_uint('clientes', len(self.clients))
+        resp.add_uint('enviados', self.stats['enviados'])
+        resp.add_uint('pendentes', len(self.pending))
+        resp.add_uint('na_fila', len(self.queue))
+        resp.add_uint('atrasadas', self.stats['atrasadas'])
+        resp.add_uint('sem_etiqueta', self.stats['sem_etiqueta'])
+        resp.add_uint('reconexoes', self.stats['reconexoes'])
+        for client in self.clients:
+            s = client.stats
+            resp.begin_group(client.name, client.name)
+            resp.add_uint('pid', client.pid)
+            resp.add_uint('comandos', s.commands)
+            resp.add_uint('agrupados', s.coalesced)
+            resp.add_uint('cache', s.cached)
+            resp.add_uint('locais', s.local)
+            resp.add_uint('nack', s.nacks)
+            resp.add_uint('sem_resposta', s.timeouts)
+            resp.add_float('latencia_ms', s.latency_sum / s.replies * 1000.0 if s.replies else 0.0, 3)
+            resp.add_float('latencia_max_ms', s.latency_max * 1000.0, 3)
+            resp.add_uint('quadros_descartados', s.dropped_frames)
+            resp.end_group()
+        return f': {resp.finish(limit=None)}\n'.encode()
+
+    # --- Enlace ---
+
+    def open_link(self):
+        args = self.args
+        if args.tcp:
+            sock = socket.create_connection((args.tcp, args.tcp_port))
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            sock.setblocking(False)
+            return Link(sock.detach(), self.on_line)
+        return Link(open_raw_serial(args.port, args.baudrate), self.on_line)
+
+    async def run_link(self):
+        """Mantém o enlace aberto, reabrindo-o quando cai."""
+        args = self.args
+        name = f"{args.tcp}:{args.tcp_port}" if args.tcp else args.port
+        while True:
+            try:
+                link = self.open_link()
+            except OSError as e:
+                self.log(f"Falha ao abrir {name}: {e}")
+                await asyncio.sleep(RECONNECT_DELAY)
+                continue
+            self.log(f"Enlace aberto: {name}")
+            self.link = link
+            self.link_format = None     # O formato da UART sobrevive a clientes anteriores.
+            self.enqueue(Op('stream:on' if self.subscribers else 'stream:off', None))
+            try:
+                await link.lost
+            finally:
+                self.link = None
+                link.close()
+            self._fail_all(b': Conex\xc3\xa3o com o controlador perdida\n')
+            self.stats['reconexoes'] += 1
+            self.log(f"Enlace perdido: {name}")
+            await asyncio.sleep(RECONNECT_DELAY)
+
+    def on_line(self, raw):
+        """Uma linha recebida do controlador (com o bloco binário, se houver)."""
+        if raw.startswith(b':DAT:'):
+            for client in self.subscribers:
+                client.send_frame(raw)
+            return
+        match = _REPLY_TAG.match(raw)
+        if match is None:
+            if raw.startswith(b':ACK') or raw.startswith(b':NACK'):
+                self.stats['sem_etiqueta'] += 1     # Resposta a outro escritor do enlace.
+            else:
+                for client in self.clients:         # Logs do console.
+                    client.send(raw)
+            return
+        op = self.pending.pop(match.group(1).decode(), None)
+        if op is None:
+            self.stats['atrasadas'] += 1            # Resposta depois do prazo.
+            return
+        self.complete(op, raw[1] == 0x41, raw[match.end():])   # 'A' de :ACK
+
+    async def check_timeouts(self):
+        while True:
+            await asyncio.sleep(TIMEOUT_CHECK)
+            now = time.monotonic()
+            expired = []
+            for tag, op in self.pending.items():
+                if op.deadline > now:
+                    break               # Em ordem de envio, com o mesmo prazo.
+                expired.append(tag)
+            for tag in expired:
+                op = self.pending.pop(tag)
+                for client, _, _ in op.waiters:
+                    client.stats.timeouts += 1
+                self.complete(op, False, b': Sem resposta do controlador\n')
+
+    def _fail_all(self, rest):
+        ops = list(self.pending.values()) + list(self.queue)
+        self.pending.clear()
+        self.queue.clear()
+        self.inflight.clear()
+        self.cache.clear()
+        self.busy.clear()
+        now = time.perf_counter()
+        for op in ops:
+            for client, tag, start in op.waiters:
+                client.reply(False, tag, rest, now - start)
+
+    # --- Relatório ---
+
+    def summary(self):
+        lines = [f"Comandos enviados ao controlador: {self.stats['enviados']}, "
+                 f"reconexões: {self.stats['reconexoes']}"]
+        for client in self.clients:
+            s = client.stats
+            mean = s.latency_sum / s.replies * 1000.0 if s.replies else 0.0
+            lines.append(f"  {client.name} (pid {client.pid}): {s.commands} comandos, {s.coalesced} agrupados, "
+                         f"{s.cached} em cache, {s.nacks} NACK, {s.timeouts} sem resposta, "
+                         f"latência média {mean:.3f} ms, máxima {s.latency_max * 1000.0:.3f} ms")
+        return '\n'.join(lines)
+
+    def log(self, text):
+        if not self.args.quiet:
+            print(f"[mux] {text}", flush=True)
+
+
+async def serve(args):
+    mux = Mux(args)
+    if os.path.exists(args.socket):
+        os.unlink(args.socket)
+    loop = asyncio.get_running_loop()
+    server = await loop.create_unix_server(mux.new_client, args.socket)
+    os.chmod(args.socket, 0o660)
+    mux.log(f"Aguardando clientes em {args.socket}")
+
+    stop = asyncio.Event()
+    for sig in (signal.SIGINT, signal.SIGTERM):
+        loop.add_signal_handler(sig, stop.set)
+    tasks = [asyncio.ensure_future(mux.run_link()), asyncio.ensure_future(mux.check_timeouts())]
+    try:
+        await stop.wait()
+    finally:
+        print(mux.summary(), flush=True)
+        for task in tasks:
+            task.cancel()
+        server.close()
+        if os.path.exists(args.socket):
+            os.unlink(args.socket)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compartilha o enlace com o controlador entre vários clientes")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help="Porta serial do console (ou pseudo-terminal do firmware de host/emulador)")
+    source.add_argument('--tcp', metavar='HOST', help="Servidor TCP do firmware")
+    parser.add_argument('--tcp-port', type=int, default=DEFAULT_TCP_PORT)
+    parser.add_argument('--baudrate', type=int, default=115200)
+    parser.add_argument('--socket', default=DEFAULT_SOCKET, help="Socket Unix dos clientes")
+    parser.add_argument('--window', type=int, default=DEFAULT_WINDOW, help="Comandos pendentes no controlador")
+    parser.add_argument('--timeout', type=float, default=DEFAULT_TIMEOUT, help="Prazo de cada comando (s)")
+    parser.add_argument('--quiet', action='store_true', help="Sem mensagens de conexão")
+    args = parser.parse_args()
+    try:
+        asyncio.run(serve(args))
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,251 @@
+# plot_data.py
+
+"""
+Dados dos gráficos ao vivo: buffers circulares numpy pré-alocados e decimação min/max.
+
+Os quadros do plano de dados são gravados em `LivePlotData` pela thread de
+comunicação, sem alocar memória a cada quadro: os passos de varredura vão para
+buffers circulares de tamanho fixo (instante e comprimento de onda, por canal) e
+os trechos de espectro, para um vetor por canal, do tamanho do espectro. Os
+payloads são lidos com `np.frombuffer`, sem cópia: os passos de um lote de
+quadros viram um único array estruturado, e as amostras de um trecho de espectro
+são uma view do payload.
+
+O gráfico não desenha cada ponto: `decimate_minmax` reduz a série a um par
+(mínimo, máximo) por coluna de pixels, de modo que o custo de desenho depende
+da largura do gráfico, e não da taxa de dados. Picos estreitos continuam
+visíveis, o que não acontece ao simplesmente descartar pontos.
+
+Uso (medição da decimação, sem interface gráfica):
+    python plot_data.py --points 1000000 --columns 800
+"""
+
+import argparse
+import threading
+import time
+
+import numpy as np
+
+from data_plane import (SPECTRUM_HEADER_LEN, TYPE_SPECTRUM, TYPE_SWEEP_STEP, decode_spectrum_chunk,
+                        encode_frame)
+
+DEFAULT_CAPACITY = 1 << 20      # Pontos guardados por canal (~17 min a 1 kHz).
+
+# Payload de TYPE_SWEEP_STEP (`dp_sweep_step_t`) e amostras de TYPE_SPECTRUM.
+SWEEP_STEP_DTYPE = np.dtype([('timestamp_ms', '<u4'), ('cycle', '<u4'), ('step', '<u2'), ('target_wl', '<f4')])
+SAMPLE_DTYPE = np.dtype('<u2')
+
+
+class RingBuffer:
+    """
+    Buffer circular pré-alocado de tamanho fixo.
+
+    Cada valor é gravado duas vezes (nas posições i e i + capacidade), de modo que
+    os últimos n valores são sempre uma fatia contígua: `latest` retorna uma view,
+    sem cópia e sem reordenação.
+    """
+
+    def __init__(self, capacity, dtype=np.float64):
+        self.capacity = capacity
+        self.count = 0
+        self._data = np.zeros(2 * capacity, dtype)
+        self._head = 0
+
+    def extend(self, values):
+        values = np.asarray(values, self._data.dtype)[-self.capacity:]
+        n = len(values)
+        if n == 0:
+            return
+        first = min(n, self.capacity - self._head)
+        for offset in (0, self.capacity):
+            self._data[offset + self._head:offset + self._head + first] = values[:first]
+            self._data[offset:offset + n - first] = values[first:]
+        self._head = (self._head + n) % self.capacity
+        self.count = min(self.capacity, self.count + n)
+
+    def latest(self, n=None):
+        """Os últimos `n` valores (todos, se None), do mais antigo ao mais recente."""
+        n = self.count if n is None else min(n, self.count)
+        end = self._head + self.capacity
+        return self._data[end - n:end]
+
+    def clear(self):
+        self.count = 0
+        self._head = 0
+
+
+def decimate_minmax(y, columns, x=None, x_range=None):
+    """
+    Reduz a série a no máximo dois pontos (mínimo e máximo) por coluna.
+
+    Sem `x`, os pontos são igualmente espaçados e o resultado usa o índice como
+    abscissa. Com `x` (crescente), as colunas dividem `x_range` (padrão: do primeiro
+    ao último x). Valores NaN são ignorados. Retorna (x, y) para desenhar como
+    polilinha; séries com até 2 * `columns` pontos são retornadas sem alteração.
+    """
+    n = len(y)
+    if x is None:
+        x = np.arange(n, dtype=np.float64)
+        if n <= 2 * columns:
+            return x, y
+        starts = np.unique(np.arange(columns) * n // columns)
+        xc = (starts + (np.append(starts[1:], n) - 1)) / 2.0
+    else:
+        if n <= 2 * columns:
+            return x, y
+        x0, x1 = x_range if x_range is not None else (x[0], x[-1])
+        width = (x1 - x0) or 1.0
+        col = np.clip(((x - x0) * (columns / width)).astype(np.intp), 0, columns - 1)
+        starts = np.flatnonzero(np.diff(col, prepend=-1))
+        xc = x0 + (col[starts] + 0.5) * (width / columns)
+    out_x = np.repeat(xc, 2)
+    out_y = np.empty(2 * len(starts), dtype=np.float64)
+    out_y[0::2] = np.fmin.reduceat(y, starts)
+    out_y[1::2] = np.fmax.reduceat(y, starts)
+    return out_x, out_y
+
+
+class Spectrum:
+    """Último espectro de um canal, montado a partir dos trechos recebidos."""
+
+    def __init__(self):
+        self.cycle = None
+        self.start_wl = 0.0
+        self.step_wl = 0.0
+        self.values = np.full(0, np.nan, dtype=np.float32)
+
+    def add_chunk(self, payload):
+        chunk, n = decode_spectrum_chunk(payload)
+        if len(self.values) != chunk.total:
+            self.values = np.full(chunk.total, np.nan, dtype=np.float32)
+        self.cycle, self.start_wl, self.step_wl = chunk.cycle, chunk.start_wl, chunk.step_wl
+        n = max(0, min(n, chunk.total - chunk.first))
+        samples = np.frombuffer(payload, SAMPLE_DTYPE, count=n, offset=SPECTRUM_HEADER_LEN)
+        self.values[chunk.first:chunk.first + n] = samples
+        return n
+
+
+class LivePlotData:
+    """
+    Séries do gráfico ao vivo, por canal. Escrita pela thread de comunicação
+    (`add_frames`, registrado como destino de quadros no `UpdateModel`) e lida
+    pela thread da interface; o acesso é protegido por um lock.
+    """
+
+    def __init__(self, capacity=DEFAULT_CAPACITY):
+        self.capacity = capacity
+        self.lock = threading.Lock()
+        self.sweep = {}             # canal -> (instantes em s, comprimentos de onda em nm)
+        self.spectra = {}           # canal -> Spectrum
+        self.points = 0             # Pontos recebidos (passos e amostras de espectro).
+        self.version = 0            # Muda a cada escrita; o gráfico só redesenha se mudou.
+
+    def add_frames(self, frames):
+        steps = {}
+        with self.lock:
+            for frame in frames:
+                if frame.type == TYPE_SWEEP_STEP:
+                    steps.setdefault(frame.channel, []).append(frame.payload)
+                elif frame.type == TYPE_SPECTRUM:
+                    self.points += self.spectra.setdefault(frame.channel, Spectrum()).add_chunk(frame.payload)
+                else:
+                    continue
+                self.version += 1
+            for channel, payloads in steps.items():
+                decoded = np.frombuffer(b''.join(payloads), SWEEP_STEP_DTYPE)
+                if channel not in self.sweep:
+                    self.sweep[channel] = (RingBuffer(self.capacity), RingBuffer(self.capacity, np.float32))
+                times, wavelengths = self.sweep[channel]
+                times.extend(decoded['timestamp_ms'] / 1000.0)
+                wavelengths.extend(decoded['target_wl'])
+                self.points += len(decoded)
+
+    def sweep_series(self, channel, span_s, columns):
+        """
+        Passos dos últimos `span_s` segundos do canal, decimados para `columns`
+        colunas. Os instantes são relativos ao passo mais recente (s, negativos).
+        """
+        with self.lock:
+            if channel not in self.sweep or self.sweep[channel][0].count == 0:
+                return None
+            times, wavelengths = (buffer.latest() for buffer in self.sweep[channel])
+            t1 = times[-1]
+            start = np.searchsorted(times, t1 - span_s)
+            x, y = decimate_minmax(wavelengths[start:], columns, times[start:], (t1 - span_s, t1))
+            # Cópia: sem decimação, x e y ainda são views dos buffers, reescritos pela comunicação.
+            return np.array(x) - t1, np.array(y)
+
+    def spectrum_series(self, channel, columns):
+        """Último espectro do canal (comprimento de onda, amostra), decimado para `columns` colunas."""
+        with self.lock:
+            spectrum = self.spectra.get(channel)
+            if spectrum is None or len(spectrum.values) == 0:
+                return None
+            x, y = decimate_minmax(spectrum.values, columns)
+            return spectrum.start_wl + spectrum.step_wl * x, np.array(y)
+
+    def clear(self):
+        with self.lock:
+            self.sweep.clear()
+            self.spectra.clear()
+            self.version += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Custo da gravação e da decimação dos gráficos ao vivo")
+    parser.add_argument('--points', type=int, default=1_000_000, help="Pontos de espectro gravados")
+    parser.add_argument('--columns', type=int, default=800, help="Largura do gráfico em pixels")
+    args = parser.parse_args()
+
+    total = 4096
+    rng = np.random.default_rng(1)
+    frames, first = [], 0
+    samples_per_frame = (512 - SPECTRUM_HEADER_LEN) // 2
+    for seq in range(args.points // samples_per_frame):
+        n = min(samples_per_frame, total - first)
+        header = np.array([(0, 1500.0, 0.025, first, total)],
+                          dtype=[('c', '<u4'), ('s', '<f4'), ('p', '<f4'), ('f', '<u2'), ('t', '<u2')])
+        payload = header.tobytes() + rng.integers(0, 65535, n, dtype='<u2').tobytes()
+        frames.append(encode_frame(TYPE_SPECTRUM, 0, seq, payload))
+        first = (first + n) % total
+
+    from data_plane import FrameDecoder
+    decoded = FrameDecoder().feed(b''.join(frames))
+    data = LivePlotData()
+    start = time.perf_counter()
+    for i in range(0, len(decoded), 32):
+        data.add_frames(decoded[i:i + 32])
+    write_s = time.perf_counter() - start
+    spectrum_points = data.points
+
+    steps = np.zeros(args.points, SWEEP_STEP_DTYPE)
+    steps['timestamp_ms'] = np.arange(args.points) // 10
+    steps['target_wl'] = 1530.0 + (np.arange(args.points) % 1000) * 0.035
+    from data_plane import Frame
+    step_frames = [Frame(TYPE_SWEEP_STEP, 1, 0, payload) for payload in
+                   np.frombuffer(steps.tobytes(), dtype=f'V{SWEEP_STEP_DTYPE.itemsize}').tolist()]
+    start = time.perf_counter()
+    for i in range(0, len(step_frames), 256):
+        data.add_frames(step_frames[i:i + 256])
+    step_s = time.perf_counter() - start
+
+    rounds = 100
+    start = time.perf_counter()
+    for _ in range(rounds):
+        x, _ = data.sweep_series(1, span_s=args.points / 10000.0, columns=args.columns)
+    sweep_ms = (time.perf_counter() - start) * 1000.0 / rounds
+    start = time.perf_counter()
+    for _ in range(rounds):
+        data.spectrum_series(0, args.columns)
+    spectrum_ms = (time.perf_counter() - start) * 1000.0 / rounds
+
+    print(f"Espectro: {len(decoded)} quadros, {spectrum_points} amostras gravadas em "
+          f"{write_s * 1000:.1f} ms ({spectrum_points / write_s / 1e6:.1f} M amostras/s)")
+    print(f"Varredura: {args.points} passos gravados em {step_s * 1000:.1f} ms "
+          f"({args.points / step_s / 1e6:.1f} M passos/s)")
+    print(f"Decimação para {args.columns} colunas: varredura ({args.points} pontos) {sweep_ms:.2f} ms -> "
+          f"{len(x)} pontos; espectro ({total} pontos) {spectrum_ms:.3f} ms")
+
+
+if __name__ == '__main__':
+    main()
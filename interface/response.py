@@ -0,0 +1,250 @@
+# response.py
+
+"""
+Decodificação das respostas de comando nos formatos de máquina do firmware
+(ver main/response.h), selecionados por conexão com `:format:kv` ou `:format:json`.
+
+    :ACK: C.modelo="TF1" C.sn="1234" L.erro="ESP_FAIL"        (kv)
+    :ACK: {"C":{"modelo":"TF1","sn":"1234"},"L":{"erro":"ESP_FAIL"}}   (json)
+    :ACK: 1550.123                                           (valor isolado, ex.: get-wl)
+    :ACK                                                     (sem dados)
+    :NACK: ESP_ERR_INVALID_ARG
+
+Nos dois formatos, os grupos (ex.: canais) viram dicionários aninhados, de modo que
+`parse_response` devolve a mesma estrutura para kv e json. O formato `text`
+(padrão) é destinado a pessoas e não é decodificado aqui.
+
+Comandos enviados com etiqueta (`:@17 get-wl?C`) têm a etiqueta repetida na
+resposta (`:ACK@17: 1550.000`); `split_tag` a separa do restante da linha.
+
+`ResponseWriter` faz o caminho inverso, como o `response_writer_t` do firmware:
+monta os dados de uma resposta nos três formatos (usado pelo emulador e pelas
+respostas locais do mux_daemon).
+"""
+
+import json
+import math
+from collections import namedtuple
+
+Response = namedtuple('Response', ['ok', 'data', 'error'])
+
+RESPONSE_DATA_BUFFER_SIZE = 512    # main/response.h
+
+
+def _convert(token):
+    """Converte um valor kv sem aspas em int ou float quando possível."""
+    try:
+        return int(token)
+    except ValueError:
+        pass
+    try:
+        return float(token)
+    except ValueError:
+        return token
+
+
+def _store(data, key, value):
+    group, dot, field = key.partition('.')
+    if dot:
+        data.setdefault(group, {})[field] = value
+    else:
+        data[key] = value
+
+
+def parse_kv(text):
+    """
+    Decodifica `chave=valor ...` em uma única passada.
+
+    Valores entre aspas são textos (com os escapes `\\"` e `\\\\` resolvidos); os
+    demais são números (int ou float), como no JSON. Um único token sem `=` é um
+    valor isolado e é devolvido diretamente.
+    """
+    data = {}
+    i, n = 0, len(text)
+    while i < n:
+        while i < n and text[i] == ' ':
+            i += 1
+        if i >= n:
+            break
+        start = i
+        while i < n and text[i] not in '= ':
+            i += 1
+        if i >= n or text[i] == ' ':
+            # Token sem chave: valor isolado (ex.: resposta do get-wl).
+            if data or i < n and text[i:].strip():
+                raise ValueError(f"Token sem chave em resposta kv: {text[start:i]!r}")
+            return _convert(text[start:i])
+        key = text[start:i]
+        i += 1  # '='
+        if i < n and text[i] == '"':
+            i += 1
+            chars = []
+            while i < n and text[i] != '"':
+                if text[i] == '\\' and i + 1 < n:
+                    i += 1
+                chars.append(text[i])
+                i += 1
+            if i >= n:
+                raise ValueError(f"Aspas não fechadas no campo {key!r}")
+            i += 1  # '"'
+            value = ''.join(chars)
+        else:
+            start = i
+            while i < n and text[i] != ' ':
+                i += 1
+            value = _convert(text[start:i])
+        _store(data, key, value)
+    return data
+
+
+def split_tag(line):
+    """
+    Separa a etiqueta de uma resposta: `:ACK@17: x` -> ('17', ':ACK: x').
+
+    Retorna (None, linha) em respostas sem etiqueta.
+    """
+    for prefix in (':ACK@', ':NACK@'):
+        if line.startswith(prefix):
+            start = len(prefix)
+            end = start
+            while end < len(line) and line[end].isalnum():
+                end += 1
+            return line[start:end], prefix[:-1] + line[end:]
+    return None, line
+
+
+def parse_response(line, fmt='json'):
+    """
+    Decodifica uma linha `:ACK...`/`:NACK...` no formato `fmt` ('kv', 'json' ou
+    'text'; em 'text', `data` é o texto após `:ACK: `, sem decodificação).
+
+    Retorna `Response(ok, data, error)`. `data` é None em `:ACK` sem dados. Uma
+    etiqueta na linha é ignorada (ver `split_tag`).
+    """
+    line = split_tag(line.strip())[1]
+    if line.startswith(':NACK'):
+        return Response(False, None, line[6:].strip())
+    if not line.startswith(':ACK'):
+        raise ValueError(f"Não é uma resposta de comando: {line!r}")
+    payload = line[5:].strip()
+    if not payload:
+        return Response(True, None, None)
+    if fmt == 'json':
+        return Response(True, json.loads(payload), None)
+    if fmt == 'kv':
+        return Response(True, parse_kv(payload), None)
+    if fmt == 'text':
+        return Response(True, payload, None)
+    raise ValueError(f"Formato sem decodificação: {fmt!r}")
+
+
+class ResponseWriter:
+    """Campos de uma resposta nos formatos text, kv e json, como o `response_writer_t`."""
+
+    def __init__(self, fmt):
+        self.fmt = fmt
+        self._parts = []
+        self._first = True
+        self._json_open = False
+        self._group = None
+
+    def _begin_field(self, key):
+        if self.fmt == 'text':
+            if not self._first:
+                self._parts.append(', ')
+            if key is not None:
+                self._parts.append(f'{key}=')
+        elif self.fmt == 'kv':
+            if self._parts:
+                self._parts.append(' ')
+            if key is not None:
+                self._parts.append(f'{self._group}.{key}=' if self._group else f'{key}=')
+        elif key is not None:
+            if not self._json_open:
+                self._parts.append('{')
+                self._json_open = True
+            elif not self._first:
+                self._parts.append(',')
+            self._parts.append(f'"{key}":')
+        self._first = False
+
+    def begin_group(self, key, label):
+        if self.fmt == 'text':
+            if self._parts:
+                self._parts.append(' | ')
+            self._parts.append(f'{label}: ')
+        elif self.fmt == 'kv':
+            self._group = key
+        else:
+            self._begin_field(key)
+            self._parts.append('{')
+        self._first = True
+
+    def end_group(self):
+        if self.fmt == 'json':
+            self._parts.append('}')
+        self._group = None
+        self._first = False
+
+    def add_str(self, key, value):
+        self._begin_field(key)
+        if self.fmt == 'json':
+            self._parts.append('"' + ''.join(
+                '\\' + c if c in '"\\' else (f'\\u{ord(c):04x}' if ord(c) < 0x20 else c) for c in value) + '"')
+        else:
+            text = ''.join('?' if ord(c) < 0x20 else c for c in value)
+            if self.fmt == 'kv':
+                text = '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+            self._parts.append(text)
+
+    def add_uint(self, key, value):
+        self._begin_field(key)
+        self._parts.append(str(int(value)))
+
+    add_int = add_uint
+
+    def add_float(self, key, value, decimals):
+        self._begin_field(key)
+        if math.isnan(value) or math.isinf(value):
+            self._parts.append('null' if self.fmt == 'json' else
+                               ('nan' if math.isnan(value) else ('inf' if value > 0 else '-inf')))
+            return
+        fixed = int(abs(value) * 10 ** decimals + 0.5)
+        sign = '-' if value < 0 and fixed else ''
+        whole, frac = divmod(fixed, 10 ** decimals)
+        self._parts.append(f'{sign}{whole}.{frac:0{decimals}d}' if decimals else f'{sign}{whole}')
+
+    def add_bool(self, key, value):
+        self._begin_field(key)
+        self._parts.append(('true' if value else 'false') if self.fmt == 'json' else ('1' if value else '0'))
+
+    def add_err(self, key, err):
+        self.add_str(key, err)
+
+    def set_format(self, fmt):
+        if not self._parts:
+            self.fmt = fmt
+
+    def finish(self, limit=RESPONSE_DATA_BUFFER_SIZE):
+        """Dados da resposta, ou None se excedem `limit` bytes (None: sem limite)."""
+        if self._json_open:
+            self._parts.append('}')
+            self._json_open = False
+        data = ''.join(self._parts)
+        return data if limit is None or len(data.encode()) <= limit else None
+
+
+if __name__ == '__main__':
+    # Verificação rápida com as respostas de exemplo do firmware.
+    kv = parse_response(':ACK: C.modelo="TF1 \\"x\\"" C.sn="1234" C.wl=1550.125 L.erro="ESP_FAIL" n=-3', 'kv')
+    js = parse_response(':ACK: {"C":{"modelo":"TF1 \\"x\\"","sn":"1234","wl":1550.125},"L":{"erro":"ESP_FAIL"},"n":-3}')
+    assert kv.data == js.data, (kv.data, js.data)
+    assert parse_response(':ACK: 1550.123', 'kv').data == 1550.123
+    assert parse_response(':ACK: 1550.123', 'json').data == 1550.123
+    assert parse_response(':NACK: ESP_FAIL').error == 'ESP_FAIL'
+    assert split_tag(':ACK@17: 1550.123') == ('17', ':ACK: 1550.123')
+    assert split_tag(':NACK@a1: ESP_FAIL') == ('a1', ':NACK: ESP_FAIL')
+    assert split_tag(':ACK@9') == ('9', ':ACK')
+    assert parse_response(':ACK@17: 1550.123', 'kv').data == 1550.123
+    assert parse_response(':NACK@18: ESP_FAIL').error == 'ESP_FAIL'
+    print("ok")
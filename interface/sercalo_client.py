@@ -0,0 +1,321 @@
+# sercalo_client.py
+
+"""
+Cliente asyncio do controlador, sem interface gráfica, para automação por scripts.
+
+Um coroutine escritor envia os comandos e um leitor recebe as respostas, de modo
+que vários comandos ficam pendentes ao mesmo tempo (pipelining) e cada um é uma
+future resolvida pela sua resposta. A associação é pela etiqueta repetida pelo
+firmware (`:@17 get-wl?C` -> `:ACK@17: ...`) ou, com `tagged=False`, pela ordem
+de chegada (FIFO), para firmwares sem etiquetas. O número de comandos pendentes
+é limitado por `window` (a fila do firmware guarda 16 comandos, somando todas as
+origens). Linhas `:DAT:` do plano de dados vão para `on_frame`; logs do console,
+para `on_line`.
+
+Uso:
+    async with await SercaloClient.open_tcp('127.0.0.1') as client:
+        wl = await client.command('get-wl?C')
+        replies = await client.batch(['get-wl?C', 'get-wl?L', 'iden?'])
+
+    client = await SercaloClient.open_serial('/tmp/sercalo_ctl', fmt='json')
+    client = await SercaloClient.open_unix('/tmp/sercalo_mux')     # via mux_daemon.py
+
+A porta serial usa o `pyserial-asyncio`, se instalado; sem ele, em sistemas POSIX,
+o dispositivo (porta USB ou pseudo-terminal do firmware de host) é aberto
+diretamente em modo raw.
+"""
+
+import asyncio
+import collections
+import itertools
+import os
+import re
+
+from data_plane import FrameDecoder, decode_console_line
+from response import Response, parse_response, split_tag
+
+DEFAULT_TCP_PORT = 5025
+DEFAULT_WINDOW = 8              # Metade da fila do firmware: sobra espaço para outras origens.
+DEFAULT_TIMEOUT = 2.0           # Segundos por comando, contados a partir do envio.
+STREAM_LIMIT = 1 << 20          # Blocos binários (`log:read`) chegam em uma única "linha".
+TAG_MODULUS = 10 ** 8           # Etiquetas de até 8 dígitos.
+
+BLOCK_HEADER = re.compile(rb'^:ACK(?:@[0-9A-Za-z]+)?: #(\d)')
+
+
+class CommandError(Exception):
+    """Resposta `:NACK` a um comando."""
+
+    def __init__(self, command, error):
+        super().__init__(f"{command}: {error}")
+        self.command = command
+        self.error = error
+
+
+class SercaloClient:
+    """
+    Conexão com o controlador (serial ou TCP) com vários comandos pendentes.
+
+    Os métodos são coroutines e devem ser chamados do mesmo event loop.
+    """
+
+    def __init__(self, reader, writer, *, tagged=True, window=DEFAULT_WINDOW,
+                 timeout=DEFAULT_TIMEOUT, fmt='text'):
+        self._reader = reader
+        self._writer = writer
+        self.tagged = tagged
+        self.timeout = timeout
+        self.fmt = fmt
+        self.on_frame = None        # Chamado com cada `data_plane.Frame` recebido em `:DAT:`.
+        self.on_line = None         # Chamado com as demais linhas (logs do console).
+        self.decoder = FrameDecoder()
+        self._window = asyncio.Semaphore(window)
+        self._outbox = asyncio.Queue()
+        self._by_tag = {}
+        self._fifo = collections.deque()
+        self._tags = itertools.count(1)
+        self._tasks = []
+        self._closed = False
+
+    # --- Abertura e encerramento ---
+
+    @classmethod
+    async def open_tcp(cls, host, port=DEFAULT_TCP_PORT, **kwargs):
+        """Conecta ao servidor TCP do firmware."""
+        reader, writer = await asyncio.open_connection(host, port, limit=STREAM_LIMIT)
+        return await cls(reader, writer, **kwargs)._start()
+
+    @classmethod
+    async def open_unix(cls, path, **kwargs):
+        """Conecta ao mux_daemon, que compartilha a porta serial entre vários clientes."""
+        reader, writer = await asyncio.open_unix_connection(path, limit=STREAM_LIMIT)
+        return await cls(reader, writer, **kwargs)._start()
+
+    @classmethod
+    async def open_serial(cls, port, baudrate=115200, **kwargs):
+        """Abre a porta serial do console (ou o pseudo-terminal do firmware de host)."""
+        reader, writer = await _open_serial(port, baudrate)
+        return await cls(reader, writer, **kwargs)._start()
+
+    async def _start(self):
+        self._tasks = [asyncio.ensure_future(self._write_loop()),
+                       asyncio.ensure_future(self._read_loop())]
+        if self.fmt != 'text':
+            await self.command(f'format:{self.fmt}')
+        return self
+
+    async def close(self):
+        """Encerra a conexão; os comandos pendentes falham com ConnectionError."""
+        if self._closed:
+            return
+        self._closed = True
+        for task in self._tasks:
+            task.cancel()
+        await asyncio.gather(*self._tasks, return_exceptions=True)
+        self._fail_pending(ConnectionError("Conexão encerrada"))
+        self._writer.close()
+        try:
+            await self._writer.wait_closed()
+        except (ConnectionError, OSError):
+            pass
+
+    async def wait_disconnected(self):
+        """Aguarda o fim da conexão (pelo dispositivo ou por `close`)."""
+        await asyncio.shield(self._tasks[1])
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, *exc):
+        await self.close()
+
+    # --- Comandos ---
+
+    async def request(self, command, timeout=None):
+        """
+        Envia um comando (sem ':' e '\\n') e aguarda a resposta.
+
+        Retorna `response.Response(ok, data, error)`; um `:NACK` não gera exceção.
+        `data` é decodificado conforme `fmt` (em 'text', o texto após `:ACK: `) ou,
+        em respostas com bloco binário, são os bytes do bloco.
+        Gera asyncio.TimeoutError se a resposta não chegar em `timeout` segundos.
+        """
+        await self._window.acquire()
+        if self._closed:
+            self._window.release()
+            raise ConnectionError("Conexão encerrada")
+        future = asyncio.get_running_loop().create_future()
+        future.add_done_callback(lambda _: self._window.release())
+        if self.tagged:
+            tag = str(next(self._tags) % TAG_MODULUS)
+            self._by_tag[tag] = future
+            line = f":@{tag} {command}\n"
+        else:
+            tag = None
+            self._fifo.append(future)
+            line = f":{command}\n"
+        self._outbox.put_nowait(line.encode())
+        try:
+            return await asyncio.wait_for(future, self.timeout if timeout is None else timeout)
+        except asyncio.TimeoutError:
+            # Sem etiqueta, a future cancelada continua na fila e consome a resposta atrasada.
+            if tag is not None:
+                self._by_tag.pop(tag, None)
+            raise
+
+    async def command(self, command, timeout=None):
+        """Como `request`, mas retorna só os dados e gera CommandError em `:NACK`."""
+        reply = await self.request(command, timeout)
+        if not reply.ok:
+            raise CommandError(command, reply.error)
+        return reply.data
+
+    async def batch(self, commands, timeout=None, return_exceptions=False):
+        """
+        Envia vários comandos de uma vez, até `window` pendentes, e retorna as
+        respostas (`Response`) na ordem dos comandos.
+        """
+        return await asyncio.gather(*(self.request(c, timeout) for c in commands),
+                                    return_exceptions=return_exceptions)
+
+    async def get_wl(self, band):
+        """Comprimento de onda atual do canal (nm)."""
+        return float(await self.command(f'get-wl?{band}'))
+
+    async def set_wl(self, band, wavelength):
+        """Sintoniza o canal; retorna os dados da resposta (a verificação, se ativa)."""
+        return await self.command(f'set-wl:{band}:{wavelength:.3f}')
+
+    # --- Coroutines de E/S ---
+
+    async def _write_loop(self):
+        while True:
+            chunks = [await self._outbox.get()]
+            # Comandos enfileirados juntos seguem em uma única escrita.
+            while not self._outbox.empty():
+                chunks.append(self._outbox.get_nowait())
+            self._writer.write(b''.join(chunks))
+            await self._writer.drain()
+
+    async def _read_loop(self):
+        error = ConnectionError("Conexão encerrada pelo dispositivo")
+        try:
+            while True:
+                raw = await self._reader.readline()
+                if not raw:
+                    break
+                if raw.startswith(b':DAT:'):
+                    frames = decode_console_line(raw.decode('ascii', errors='replace').strip(), self.decoder)
+                    if self.on_frame is not None:
+                        for frame in frames:
+                            self.on_frame(frame)
+                elif raw.startswith(b':ACK') or raw.startswith(b':NACK'):
+                    await self._dispatch(raw)
+                elif self.on_line is not None:
+                    line = raw.decode('utf-8', errors='replace').rstrip()
+                    if line:
+                        self.on_line(line)
+        except (ConnectionError, OSError, asyncio.IncompleteReadError, ValueError) as e:
+            error = ConnectionError(f"Conexão perdida: {e}")
+        finally:
+            self._fail_pending(error)
+
+    async def _dispatch(self, raw):
+        block = BLOCK_HEADER.match(raw)
+        if block is not None:
+            # `:ACK: #<d><tamanho><dados>\n`: os dados podem conter '\n'.
+            digits = int(block.group(1))
+            start = block.end() + digits
+            length = int(raw[block.end():start])
+            data = raw[start:]
+            if len(data) < length + 1:
+                data += await self._reader.readexactly(length + 1 - len(data))
+            text = raw[:block.start(1) - 2].decode('ascii')
+            reply = Response(True, data[:length], None)
+        else:
+            text = raw.decode('utf-8', errors='replace').strip()
+            reply = None
+
+        tag, rest = split_tag(text)
+        if tag is not None:
+            future = self._by_tag.pop(tag, None)
+        else:
+            future = self._fifo.popleft() if self._fifo else None
+        if future is None:
+            # Resposta a um comando que expirou (com etiqueta) ou que não é deste cliente.
+            if self.on_line is not None:
+                self.on_line(text)
+            return
+        if future.done():
+            return
+        if reply is None:
+            try:
+                reply = parse_response(rest, self.fmt)
+            except ValueError as e:
+                future.set_exception(e)
+                return
+        future.set_result(reply)
+
+    def _fail_pending(self, error):
+        pending = list(self._by_tag.values()) + list(self._fifo)
+        self._by_tag.clear()
+        self._fifo.clear()
+        for future in pending:
+            if not future.done():
+                future.set_exception(error)
+
+
+async def _open_serial(port, baudrate):
+    try:
+        import serial_asyncio
+    except ImportError:
+        serial_asyncio = None
+    if serial_asyncio is not None:
+        return await serial_asyncio.open_serial_connection(url=port, baudrate=baudrate, limit=STREAM_LIMIT)
+    if os.name != 'posix':
+        raise RuntimeError("Porta serial assíncrona requer o pacote pyserial-asyncio")
+
+    fd = open_raw_serial(port, baudrate)
+    loop = asyncio.get_running_loop()
+    reader = asyncio.StreamReader(limit=STREAM_LIMIT)
+    read_transport, _ = await loop.connect_read_pipe(lambda: asyncio.StreamReaderProtocol(reader),
+                                                     os.fdopen(fd, 'rb', buffering=0))
+    transport, protocol = await loop.connect_write_pipe(lambda: _PipeWriteProtocol(read_transport),
+                                                        os.fdopen(os.dup(fd), 'wb', buffering=0))
+    writer = asyncio.StreamWriter(transport, protocol, reader, loop)
+    return reader, writer
+
+
+def open_raw_serial(port, baudrate=115200):
+    """Abre o dispositivo serial (POSIX) em modo raw e não bloqueante; retorna o descritor."""
+    import termios
+    import tty
+    fd = os.open(port, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    try:
+        tty.setraw(fd)
+        speed = getattr(termios, f'B{baudrate}', None)
+        if speed is not None:
+            attrs = termios.tcgetattr(fd)
+            attrs[4] = attrs[5] = speed
+            termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    except termios.error:
+        pass  # Não é um terminal (ex.: FIFO de teste).
+    return fd
+
+
+class _PipeWriteProtocol(asyncio.streams.FlowControlMixin):
+    """Lado de escrita do dispositivo serial; fechá-lo fecha também a leitura."""
+
+    def __init__(self, read_transport):
+        super().__init__()
+        self._read_transport = read_transport
+        self._closed = asyncio.get_running_loop().create_future()
+
+    def connection_lost(self, exc):
+        super().connection_lost(exc)
+        self._read_transport.close()
+        if not self._closed.done():
+            self._closed.set_result(None)
+
+    def _get_close_waiter(self, stream):
+        return self._closed
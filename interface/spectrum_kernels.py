@@ -0,0 +1,259 @@
+# spectrum_kernels.py
+
+"""
+Análise de espectros com os kernels vetorizados do SDK C++ (sdk/include/sercalo/spectrum.hpp).
+
+Carrega a biblioteca `libsercalo_spectrum.so` (compilada com o SDK: `cmake -S sdk
+-B sdk/build && cmake --build sdk/build`; outro caminho em `SERCALO_SPECTRUM_LIB`)
+por ctypes e passa os arrays numpy sem cópia: a média de várias varreduras, a
+remoção da linha de base (abertura morfológica), os picos e a largura a meia
+altura (FWHM) rodam sobre os próprios vetores de float32, inclusive as colunas
+mapeadas do arquivo de histórico (archive.py). Os kernels usam AVX2 ou SSE2,
+conforme o processador.
+
+Uso:
+    import archive, spectrum_kernels as sk
+    cols = archive.Archive('historico.swa').query(start_us, end_us, channel=0)
+    wavelength, spectra = sk.archive_spectra(cols)      # uma linha por ciclo completo
+    corrected, peaks = sk.analyze(sk.average(spectra), window=101, threshold=200)
+    fwhm_nm = (peaks['right'] - peaks['left']) * (wavelength[1] - wavelength[0])
+
+    python spectrum_kernels.py --bench                  # contra laços Python
+    python spectrum_kernels.py --archive historico.swa --band C --window 101 --threshold 200
+"""
+
+import argparse
+import ctypes
+import os
+import time
+
+import numpy as np
+
+LIB_ENV = 'SERCALO_SPECTRUM_LIB'
+DEFAULT_LIB = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'sdk', 'build',
+                           'libsercalo_spectrum.so')
+SIMD_NAMES = {0: 'escalar', 1: 'SSE2', 2: 'AVX2'}
+
+# sercalo::Peak: índice do máximo, altura e posições (fracionárias) de meia altura.
+PEAK_DTYPE = np.dtype([('index', '<u4'), ('height', '<f4'), ('left', '<f4'), ('right', '<f4')])
+
+_FLOATS = np.ctypeslib.ndpointer(np.float32, flags='C_CONTIGUOUS')
+_PEAKS = np.ctypeslib.ndpointer(PEAK_DTYPE, flags='C_CONTIGUOUS')
+_lib = None
+
+
+def _load():
+    global _lib
+    if _lib is None:
+        path = os.environ.get(LIB_ENV, DEFAULT_LIB)
+        try:
+            lib = ctypes.CDLL(path)
+        except OSError as e:
+            raise OSError(f"Biblioteca dos kernels não encontrada ({path}); compile o SDK "
+                          f"(cmake -S sdk -B sdk/build && cmake --build sdk/build) ou defina {LIB_ENV}") from e
+        size = ctypes.c_size_t
+        lib.sercalo_simd_level.restype = ctypes.c_int
+        lib.sercalo_set_simd_level.argtypes = [ctypes.c_int]
+        lib.sercalo_set_simd_level.restype = ctypes.c_int
+        lib.sercalo_average.argtypes = [_FLOATS, size, size, _FLOATS]
+        lib.sercalo_average.restype = None
+        lib.sercalo_remove_baseline.argtypes = [_FLOATS, size, size, _FLOATS, _FLOATS]
+        lib.sercalo_remove_baseline.restype = None
+        lib.sercalo_analyze.argtypes = [_FLOATS, size, size, ctypes.c_float, size, _FLOATS, _PEAKS, size]
+        lib.sercalo_analyze.restype = size
+        lib.sercalo_find_peaks.argtypes = [_FLOATS, size, ctypes.c_float, size, _PEAKS, size]
+        lib.sercalo_find_peaks.restype = size
+        _lib = lib
+    return _lib
+
+
+def _floats(x):
+    return np.ascontiguousarray(x, np.float32)
+
+
+def simd_level():
+    """Nível em uso pelos kernels ('escalar', 'SSE2' ou 'AVX2')."""
+    return SIMD_NAMES[_load().sercalo_simd_level()]
+
+
+def set_simd_level(level):
+    """Força um nível (0 escalar, 1 SSE2, 2 AVX2), limitado ao processador; retorna o efetivo."""
+    return SIMD_NAMES[_load().sercalo_set_simd_level(level)]
+
+
+def average(spectra):
+    """Média das linhas de um array (varreduras x pontos)."""
+    spectra = _floats(spectra)
+    count, n = spectra.shape
+    out = np.empty(n, np.float32)
+    _load().sercalo_average(spectra, count, n, out)
+    return out
+
+
+def remove_baseline(x, window):
+    """(espectro sem a linha de base, linha de base); `window` em amostras (ímpar)."""
+    x = _floats(x)
+    out, baseline = np.empty_like(x), np.empty_like(x)
+    _load().sercalo_remove_baseline(x, len(x), window, out, baseline)
+    return out, baseline
+
+
+def find_peaks(x, threshold, min_distance=1, cap=1024):
+    """Picos (PEAK_DTYPE) de um espectro já sem linha de base, com FWHM."""
+    x = _floats(x)
+    peaks = np.empty(cap, PEAK_DTYPE)
+    count = _load().sercalo_find_peaks(x, len(x), threshold, min_distance, peaks, cap)
+    return peaks[:count]
+
+
+def analyze(x, window, threshold, min_distance=1, cap=1024):
+    """Linha de base, picos (`threshold` acima dela) e FWHM: (espectro corrigido, picos)."""
+    x = _floats(x)
+    corrected = np.empty_like(x)
+    peaks = np.empty(cap, PEAK_DTYPE)
+    count = _load().sercalo_analyze(x, len(x), window, threshold, min_distance, corrected, peaks, cap)
+    return corrected, peaks[:count]
+
+
+def archive_spectra(columns):
+    """
+    Espectros completos das linhas de uma consulta ao arquivo de histórico (um canal).
+
+    Retorna (comprimentos de onda, array ciclos x pontos) com os ciclos do tamanho mais
+    comum; ciclos com trechos perdidos ficam de fora.
+    """
+    mask = np.isfinite(columns.power)
+    cycle = columns.cycle[mask]
+    if len(cycle) == 0:
+        return np.zeros(0, np.float32), np.zeros((0, 0), np.float32)
+    starts = np.flatnonzero(np.diff(cycle, prepend=cycle[0] ^ 1))
+    lengths = np.diff(np.append(starts, len(cycle)))
+    points = np.bincount(lengths).argmax()
+    full = starts[lengths == points]
+    rows = full[:, None] + np.arange(points)
+    power = columns.power[mask]
+    return columns.wavelength[mask][rows[0]], power[rows]
+
+
+# --- Laços Python (a análise de hoje), para comparação ---
+
+def python_baseline(x, window):
+    half = (window | 1) // 2
+    n = len(x)
+    eroded = [min(x[max(0, i - half):i + half + 1]) for i in range(n)]
+    return [x[i] - max(eroded[max(0, i - half):i + half + 1]) for i in range(n)]
+
+
+def python_peaks(x, threshold, min_distance):
+    peaks = []
+    for i in range(1, len(x) - 1):
+        if x[i] > x[i - 1] and x[i] >= x[i + 1] and x[i] >= threshold:
+            if peaks and i - peaks[-1][0] < min_distance:
+                if x[i] > peaks[-1][1]:
+                    peaks[-1] = (i, x[i])
+            else:
+                peaks.append((i, x[i]))
+    widths = []
+    for i, height in peaks:
+        half = height / 2
+        r = i + 1
+        while r < len(x) and x[r] >= half:
+            r += 1
+        l = i
+        while l > 0 and x[l - 1] >= half:
+            l -= 1
+        widths.append((r - 1 + (x[r - 1] - half) / (x[r - 1] - x[r]) if r < len(x) else float('nan'))
+                      - (l - 1 + (half - x[l - 1]) / (x[l] - x[l - 1]) if l > 0 else float('nan')))
+    return peaks, widths
+
+
+def python_average(spectra):
+    count, n = len(spectra), len(spectra[0])
+    return [sum(spectra[s][i] for s in range(count)) / count for i in range(n)]
+
+
+def synthetic_spectra(points, sweeps, rng):
+    i = np.arange(points, dtype=np.float32)
+    t = i / points
+    clean = 1000.0 + 800.0 * t - 600.0 * t * t
+    for center, width, height in zip(rng.uniform(0, points, 24), rng.uniform(1.5, 7.5, 24), rng.uniform(500, 3500, 24)):
+        clean += height / (1.0 + ((i - center) / width) ** 2)
+    return (clean + rng.normal(0.0, 5.0, (sweeps, points))).astype(np.float32)
+
+
+def _timed(function, rounds):
+    start = time.perf_counter()
+    for _ in range(rounds):
+        result = function()
+    return (time.perf_counter() - start) / rounds * 1000.0, result
+
+
+def bench(args):
+    spectra = synthetic_spectra(args.points, args.sweeps, np.random.default_rng(1))
+    x = spectra[0]
+    as_list = [row.tolist() for row in spectra]
+    print(f"Espectro de {args.points} pontos, {args.sweeps} varreduras, janela {args.window}, kernels {simd_level()}")
+    py_base_ms, corrected_py = _timed(lambda: python_baseline(as_list[0], args.window), 1)
+    py_peaks_ms, (peaks_py, _) = _timed(lambda: python_peaks(corrected_py, args.threshold, args.min_distance), 3)
+    py_avg_ms, _ = _timed(lambda: python_average(as_list), 1)
+    base_ms, (corrected, _) = _timed(lambda: remove_baseline(x, args.window), 200)
+    peaks_ms, peaks = _timed(lambda: find_peaks(corrected, args.threshold, args.min_distance), 200)
+    avg_ms, _ = _timed(lambda: average(spectra), 200)
+    all_ms, _ = _timed(lambda: analyze(x, args.window, args.threshold, args.min_distance), 200)
+    same = [p[0] for p in peaks_py] == peaks['index'].tolist() and \
+        np.allclose(corrected, np.array(corrected_py, np.float32), atol=1e-3)
+    print(f"{'ms por espectro':<20} {'Python':>10} {'kernels':>10} {'ganho':>8}")
+    for name, py, kernel in (("linha de base", py_base_ms, base_ms), ("picos + FWHM", py_peaks_ms, peaks_ms),
+                             (f"média de {args.sweeps}", py_avg_ms, avg_ms)):
+        print(f"{name:<20} {py:>10.2f} {kernel:>10.3f} {py / kernel:>7.0f}x")
+    print(f"Análise completa (kernels): {all_ms:.3f} ms, {1000.0 / all_ms:.0f} espectros/s; "
+          f"{len(peaks)} picos, {'iguais' if same else 'DIFERENTES'} aos do Python")
+
+
+def analyze_archive(args):
+    import archive
+    from data_plane import CHANNEL_NAMES
+    channel = {name: ch for ch, name in CHANNEL_NAMES.items()}[args.band]
+    with archive.Archive(args.archive) as arch:
+        start = time.perf_counter()
+        wavelength, spectra = archive_spectra(arch.query(channel=channel))
+        load_ms = (time.perf_counter() - start) * 1000.0
+        if len(spectra) == 0:
+            print("Nenhum espectro completo no arquivo")
+            return
+        step = float(wavelength[1] - wavelength[0]) if len(wavelength) > 1 else 0.0
+        start = time.perf_counter()
+        total = 0
+        for row in spectra:
+            total += len(analyze(row, args.window, args.threshold, args.min_distance)[1])
+        elapsed = time.perf_counter() - start
+        _, peaks = analyze(average(spectra), args.window, args.threshold, args.min_distance)
+    print(f"{len(spectra)} espectros de {spectra.shape[1]} pontos lidos em {load_ms:.1f} ms; analisados em "
+          f"{elapsed * 1000:.1f} ms ({len(spectra) / elapsed:.0f} espectros/s, {total} picos)")
+    print(f"Média ({simd_level()}): {len(peaks)} picos")
+    for p in peaks:
+        print(f"  {wavelength[p['index']]:.3f} nm: altura {p['height']:.0f}, FWHM {(p['right'] - p['left']) * step:.4f} nm")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Análise de espectros com os kernels vetorizados do SDK")
+    parser.add_argument('--bench', action='store_true', help="Compara os kernels com laços Python")
+    parser.add_argument('--archive', help="Analisa os espectros de um arquivo de histórico (archive.py)")
+    parser.add_argument('--band', default='C', help="Banda dos espectros do arquivo")
+    parser.add_argument('--points', type=int, default=4096)
+    parser.add_argument('--sweeps', type=int, default=64)
+    parser.add_argument('--window', type=int, default=101, help="Janela da linha de base (amostras)")
+    parser.add_argument('--threshold', type=float, default=200.0, help="Altura mínima dos picos")
+    parser.add_argument('--min-distance', type=int, default=5, help="Distância mínima entre picos (amostras)")
+    parser.add_argument('--simd', type=int, choices=(0, 1, 2), help="Força o nível (0 escalar, 1 SSE2, 2 AVX2)")
+    args = parser.parse_args()
+    if args.simd is not None:
+        set_simd_level(args.simd)
+    if args.archive:
+        analyze_archive(args)
+    else:
+        bench(args)
+
+
+if __name__ == '__main__':
+    main()
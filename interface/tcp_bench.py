@@ -0,0 +1,79 @@
+# tcp_bench.py
+
+"""
+Medição de vazão e latência do servidor TCP de controle com vários clientes.
+
+Cada cliente simulado abre uma conexão e envia comandos em sequência (um por vez,
+aguardando a resposta), de modo que a latência medida é a de ida e volta de um
+comando. Os clientes rodam em paralelo e disputam a mesma fila de comandos do
+firmware.
+
+Uso:
+    python tcp_bench.py 192.168.0.50 --clients 1 4 16 --commands 200
+    python tcp_bench.py 127.0.0.1 --command "get-wl?C"
+
+O comando padrão (`stream`) não acessa o barramento I2C e mede apenas o caminho
+de rede + fila + despacho. Comandos como `get-wl?C` incluem o tempo do filtro.
+"""
+
+import argparse
+import asyncio
+import statistics
+import time
+
+
+async def run_client(host, port, command, count, latencies):
+    reader, writer = await asyncio.open_connection(host, port)
+    payload = f":{command}\n".encode()
+    try:
+        for _ in range(count):
+            start = time.perf_counter()
+            writer.write(payload)
+            await writer.drain()
+            while True:
+                line = await reader.readline()
+                if not line:
+                    raise ConnectionError("Conexão encerrada pelo servidor")
+                if line.startswith(b':ACK') or line.startswith(b':NACK'):
+                    break
+                # Linhas :DAT: (plano de dados) são ignoradas.
+            latencies.append(time.perf_counter() - start)
+    finally:
+        writer.close()
+        await writer.wait_closed()
+
+
+async def run_round(host, port, command, clients, count):
+    latencies = []
+    start = time.perf_counter()
+    await asyncio.gather(*(run_client(host, port, command, count, latencies) for _ in range(clients)))
+    elapsed = time.perf_counter() - start
+    return latencies, elapsed
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark do servidor TCP do controlador Sercalo")
+    parser.add_argument('host')
+    parser.add_argument('--port', type=int, default=5025)
+    parser.add_argument('--clients', type=int, nargs='+', default=[1, 4, 16])
+    parser.add_argument('--commands', type=int, default=200, help="Comandos por cliente")
+    parser.add_argument('--command', default='stream', help="Comando enviado (sem ':' e '\\n')")
+    args = parser.parse_args()
+
+    print(f"Comando: :{args.command}  ({args.commands} por cliente)")
+    print(f"{'clientes':>8} {'cmd/s':>10} {'p50 (ms)':>10} {'p95 (ms)':>10} {'p99 (ms)':>10} {'máx (ms)':>10}")
+    for clients in args.clients:
+        latencies, elapsed = asyncio.run(run_round(args.host, args.port, args.command, clients, args.commands))
+        ms = [x * 1000.0 for x in latencies]
+        print(f"{clients:>8} {len(latencies) / elapsed:>10.1f} {statistics.median(ms):>10.2f} "
+              f"{percentile(ms, 95):>10.2f} {percentile(ms, 99):>10.2f} {max(ms):>10.2f}")
+
+
+if __name__ == '__main__':
+    main()
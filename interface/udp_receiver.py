@@ -0,0 +1,327 @@
+# udp_receiver.py
+
+"""
+Receptor do streaming UDP do plano de dados (ver main/udp_stream.h).
+
+Datagrama de dados (firmware -> receptor), little-endian:
+    | 'U' | 'D' | flags | reservado | useq (u32) | quadro do plano de dados |
+
+Relatório de lacunas (receptor -> porta de origem dos datagramas):
+    | 'N' | 'K' | n (u8) | reservado | n x { primeiro useq (u32), quantidade (u16) } |
+
+Os quadros são entregues assim que chegam, fora de ordem se preciso: uma perda
+não atrasa os datagramas seguintes. Cada lacuna na numeração é pedida de volta
+ao firmware algumas vezes antes de ser dada como perdida.
+
+Uso:
+    python udp_receiver.py --port 5026                 # recebe do firmware (`:udp:<ip-do-host>:5026`)
+    python udp_receiver.py --selftest --loss 0.05      # emissor simulado em loopback com perdas
+"""
+
+import argparse
+import random
+import select
+import socket
+import struct
+import threading
+import time
+from collections import OrderedDict
+
+import data_plane
+
+MAGIC = b'UD'
+GAP_MAGIC = b'NK'
+HEADER_LEN = 8
+FLAG_RETRANSMIT = 0x01
+GAP_MAX_RANGES = 32
+RETX_MAX_FRAMES = 256
+
+_HEADER = struct.Struct('<2sBBI')
+_GAP_HEADER = struct.Struct('<2sBB')
+_GAP_RANGE = struct.Struct('<IH')
+
+
+def encode_gap_report(ranges):
+    """Monta um relatório de lacunas a partir de uma lista de (primeiro useq, quantidade)."""
+    ranges = ranges[:GAP_MAX_RANGES]
+    return _GAP_HEADER.pack(GAP_MAGIC, len(ranges), 0) + b''.join(
+        _GAP_RANGE.pack(first & 0xFFFFFFFF, count) for first, count in ranges)
+
+
+def decode_gap_report(data):
+    """Retorna a lista de (primeiro useq, quantidade) de um relatório, ou None se inválido."""
+    if len(data) < _GAP_HEADER.size:
+        return None
+    magic, count, _ = _GAP_HEADER.unpack_from(data)
+    if magic != GAP_MAGIC or count > GAP_MAX_RANGES or len(data) < _GAP_HEADER.size + count * _GAP_RANGE.size:
+        return None
+    return [_GAP_RANGE.unpack_from(data, _GAP_HEADER.size + i * _GAP_RANGE.size) for i in range(count)]
+
+
+def _to_ranges(seqs):
+    """Agrupa números de sequência ordenados em faixas contíguas."""
+    ranges = []
+    for seq in seqs:
+        if ranges and ranges[-1][0] + ranges[-1][1] == seq and ranges[-1][1] < 0xFFFF:
+            ranges[-1][1] += 1
+        else:
+            ranges.append([seq, 1])
+    return [tuple(r) for r in ranges]
+
+
+class UdpStreamReceiver:
+    """
+    Recebe os datagramas, entrega os quadros e pede o reenvio das lacunas.
+
+    Uma lacuna é pedida assim que detectada e novamente a cada `retry_interval`
+    segundos, até `max_retries` pedidos; depois disso os datagramas são contados
+    como perdidos.
+    """
+
+    def __init__(self, port=5026, bind='0.0.0.0', retry_interval=0.05, max_retries=3):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+        self.sock.bind((bind, port))
+        self.sock.setblocking(False)
+        self.retry_interval = retry_interval
+        self.max_retries = max_retries
+        self.sender = None
+        self._next_useq = None
+        self._missing = OrderedDict()  # useq -> [próximo pedido, pedidos feitos]
+        self.received = 0        # Datagramas novos entregues (inclui os recuperados)
+        self.recovered = 0       # Entregues por reenvio
+        self.lost = 0            # Lacunas abandonadas
+        self.duplicates = 0
+        self.invalid = 0
+        self.gap_reports = 0
+
+    @property
+    def pending(self):
+        """Datagramas faltantes ainda aguardando reenvio."""
+        return len(self._missing)
+
+    def close(self):
+        self.sock.close()
+
+    def poll(self, timeout=0.1):
+        """Processa os datagramas disponíveis. Retorna a lista de (useq, quadro) recebidos."""
+        frames = []
+        deadline = time.monotonic() + timeout
+        while True:
+            wait = max(0.0, deadline - time.monotonic())
+            if self._missing:
+                wait = min(wait, max(0.0, next(iter(self._missing.values()))[0] - time.monotonic()))
+            readable, _, _ = select.select([self.sock], [], [], wait)
+            if readable:
+                # Esvazia o socket antes de tratar as lacunas.
+                while True:
+                    try:
+                        data, addr = self.sock.recvfrom(2048)
+                    except BlockingIOError:
+                        break
+                    self._handle_datagram(data, addr, frames)
+            self._service_gaps()
+            if time.monotonic() >= deadline:
+                return frames
+
+    def _handle_datagram(self, data, addr, frames):
+        if len(data) < HEADER_LEN:
+            self.invalid += 1
+            return
+        magic, flags, _, useq = _HEADER.unpack_from(data)
+        frame = data_plane.decode_frame(data[HEADER_LEN:]) if magic == MAGIC else None
+        if frame is None:
+            self.invalid += 1
+            return
+        self.sender = addr
+
+        if self._next_useq is None:
+            self._next_useq = useq
+        delta = (useq - self._next_useq) & 0xFFFFFFFF
+        if delta < 0x80000000:
+            # Datagrama novo; tudo entre o esperado e ele é lacuna.
+            now = time.monotonic()
+            for missing in range(self._next_useq, self._next_useq + min(delta, RETX_MAX_FRAMES)):
+                self._missing[missing & 0xFFFFFFFF] = [now, 0]
+            self.lost += max(0, delta - RETX_MAX_FRAMES)  # Além do buffer do firmware: irrecuperável
+            self._next_useq = (useq + 1) & 0xFFFFFFFF
+        elif self._missing.pop(useq, None) is not None:
+            self.recovered += 1
+        else:
+            self.duplicates += 1
+            return
+        self.received += 1
+        frames.append((useq, frame))
+
+    def _service_gaps(self):
+        if not self._missing or self.sender is None:
+            return
+        now = time.monotonic()
+        due = []
+        for useq, state in list(self._missing.items()):
+            if state[0] > now:
+                continue
+            if state[1] >= self.max_retries:
+                del self._missing[useq]
+                self.lost += 1
+                continue
+            state[0] = now + self.retry_interval
+            state[1] += 1
+            due.append(useq)
+            # Mantém o dicionário ordenado pelo próximo pedido.
+            self._missing.move_to_end(useq)
+        ranges = _to_ranges(sorted(due))
+        for start in range(0, len(ranges), GAP_MAX_RANGES):
+            self.sock.sendto(encode_gap_report(ranges[start:start + GAP_MAX_RANGES]), self.sender)
+            self.gap_reports += 1
+
+
+class LoopbackSender(threading.Thread):
+    """
+    Emissor simulado com o mesmo protocolo do firmware, para validar o receptor.
+
+    Perde cada datagrama (novo ou reenviado) com probabilidade `loss`.
+    """
+
+    def __init__(self, target, count, loss=0.0, rate=0.0, payload_len=14, seed=1):
+        super().__init__(daemon=True)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind(('127.0.0.1', 0))
+        self.target = target
+        self.count = count
+        self.loss = loss
+        self.rate = rate
+        self.payload_len = payload_len
+        self.random = random.Random(seed)
+        self.retx = OrderedDict()
+        self.sent = 0
+        self.dropped = 0
+        self.retransmitted = 0
+        self.expired = 0
+        self.done = threading.Event()
+
+    @staticmethod
+    def payload_for(useq, payload_len):
+        return bytes((useq + i) & 0xFF for i in range(payload_len))
+
+    def _send(self, datagram, addr):
+        if self.random.random() < self.loss:
+            self.dropped += 1
+            return
+        self.sock.sendto(datagram, addr)
+
+    def _service_reports(self, timeout):
+        readable, _, _ = select.select([self.sock], [], [], timeout)
+        if not readable:
+            return
+        data, addr = self.sock.recvfrom(2048)
+        for first, count in decode_gap_report(data) or []:
+            for useq in range(first, first + count):
+                datagram = self.retx.get(useq & 0xFFFFFFFF)
+                if datagram is None:
+                    self.expired += 1
+                    continue
+                self.retransmitted += 1
+                self._send(bytes([datagram[0], datagram[1], datagram[2] | FLAG_RETRANSMIT]) + datagram[3:], addr)
+
+    def run(self):
+        interval = 1.0 / self.rate if self.rate > 0 else 0.0
+        next_send = time.monotonic()
+        for useq in range(self.count):
+            frame = data_plane.encode_frame(data_plane.TYPE_SPECTRUM, 0, useq,
+                                            self.payload_for(useq, self.payload_len))
+            datagram = _HEADER.pack(MAGIC, 0, 0, useq) + frame
+            self.retx[useq] = datagram
+            if len(self.retx) > RETX_MAX_FRAMES:
+                self.retx.popitem(last=False)
+            self._send(datagram, self.target)
+            self.sent += 1
+            self._service_reports(0)
+            if interval:
+                next_send += interval
+                self._service_reports(max(0.0, next_send - time.monotonic()))
+        # Continua atendendo os pedidos de reenvio das últimas lacunas.
+        end = time.monotonic() + 1.0
+        while time.monotonic() < end:
+            self._service_reports(0.05)
+        self.done.set()
+
+
+def print_stats(receiver, elapsed, received_before=0):
+    print(f"{(receiver.received - received_before) / elapsed:10.1f} pkt/s | recebidos {receiver.received}, "
+          f"recuperados {receiver.recovered}, perdidos {receiver.lost}, pendentes {receiver.pending}, "
+          f"duplicados {receiver.duplicates}, pedidos de reenvio {receiver.gap_reports}")
+
+
+def run_receiver(args):
+    receiver = UdpStreamReceiver(args.port, args.bind, args.retry_interval, args.max_retries)
+    print(f"Aguardando datagramas na porta {args.port}...")
+    start = last = time.monotonic()
+    last_received = 0
+    try:
+        while args.duration <= 0 or time.monotonic() - start < args.duration:
+            for useq, frame in receiver.poll(0.1):
+                if args.verbose:
+                    print(f"[{useq}] {data_plane.describe(frame)}")
+            now = time.monotonic()
+            if now - last >= 1.0:
+                print_stats(receiver, now - last, last_received)
+                last, last_received = now, receiver.received
+    except KeyboardInterrupt:
+        pass
+    finally:
+        receiver.close()
+
+
+def run_selftest(args):
+    receiver = UdpStreamReceiver(0, '127.0.0.1', args.retry_interval, args.max_retries)
+    sender = LoopbackSender(receiver.sock.getsockname(), args.count, args.loss, args.rate)
+    seen = set()
+    corrupt = 0
+
+    start = time.monotonic()
+    sender.start()
+    while not sender.done.is_set() or receiver.pending:
+        for useq, frame in receiver.poll(0.05):
+            if useq in seen:
+                corrupt += 1  # Entrega repetida
+            seen.add(useq)
+            if frame.payload != LoopbackSender.payload_for(useq, len(frame.payload)):
+                corrupt += 1
+        if sender.done.is_set() and not receiver.pending:
+            break
+    elapsed = time.monotonic() - start
+    receiver.close()
+
+    # Perdas no fim do fluxo não aparecem como lacuna (não há datagrama posterior).
+    tail = args.count - len(seen) - receiver.lost
+    print(f"Enviados {sender.sent} (+{sender.retransmitted} reenvios, {sender.dropped} descartados "
+          f"propositalmente, {sender.expired} fora do buffer) em {elapsed:.2f} s")
+    print(f"Recebidos {len(seen)}/{args.count} ({len(seen) / elapsed:.0f} pkt/s), recuperados {receiver.recovered}, "
+          f"perdidos {receiver.lost} + {tail} no fim do fluxo, inválidos {corrupt + receiver.invalid}")
+    ok = corrupt == 0 and receiver.invalid == 0 and len(seen) + receiver.lost + tail == args.count
+    print("OK" if ok else "FALHA")
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Receptor do streaming UDP do controlador Sercalo")
+    parser.add_argument('--port', type=int, default=5026)
+    parser.add_argument('--bind', default='0.0.0.0')
+    parser.add_argument('--duration', type=float, default=0, help="Segundos de recepção (0 = até Ctrl+C)")
+    parser.add_argument('--retry-interval', type=float, default=0.05, help="Intervalo entre pedidos de reenvio (s)")
+    parser.add_argument('--max-retries', type=int, default=3)
+    parser.add_argument('--verbose', action='store_true', help="Imprime cada quadro recebido")
+    parser.add_argument('--selftest', action='store_true', help="Emissor simulado em loopback")
+    parser.add_argument('--count', type=int, default=50000, help="Datagramas do teste em loopback")
+    parser.add_argument('--loss', type=float, default=0.05, help="Probabilidade de perda no teste em loopback")
+    parser.add_argument('--rate', type=float, default=0, help="Datagramas/s do teste em loopback (0 = máximo)")
+    args = parser.parse_args()
+
+    if args.selftest:
+        raise SystemExit(run_selftest(args))
+    run_receiver(args)
+
+
+if __name__ == '__main__':
+    main()
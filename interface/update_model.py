@@ -0,0 +1,102 @@
+# update_model.py
+
+"""
+Modelo de atualizações da interface, agrupadas por quadro de tela.
+
+A thread de comunicação não emite um sinal Qt por linha recebida: ela deposita
+cada evento aqui, e a janela drena o modelo a uma taxa fixa (FRAME_RATE_HZ). Os
+eventos são coalescidos: de cada widget, só a última resposta; de cada tipo de
+quadro e canal, só o último quadro (os demais são apenas contados). Assim, uma
+rajada de telemetria custa uma repintura por quadro de tela, e não uma por linha.
+Quem precisa de todos os quadros (ex.: o gráfico ao vivo) se registra com
+`add_frame_sink` e os recebe na thread de comunicação, em lotes.
+
+Não depende do Qt; o acesso é protegido por um lock, pois o modelo é escrito pela
+thread de comunicação e lido pela thread da interface.
+"""
+
+import threading
+import time
+from collections import namedtuple
+
+FRAME_RATE_HZ = 30
+LATENCY_EWMA = 0.2              # Peso de cada nova medida na latência média.
+MAX_ERRORS = 8                  # Mensagens de erro guardadas entre dois quadros de tela.
+
+Updates = namedtuple('Updates', ['replies', 'frames', 'frame_count', 'errors', 'link'])
+LinkStats = namedtuple('LinkStats', ['pending', 'latency_ms', 'last_latency_ms', 'frames_per_s'])
+
+
+class UpdateModel:
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._replies = {}          # widget -> (ok, texto)
+        self._frames = {}           # (tipo, canal) -> último quadro
+        self._frame_count = 0
+        self._errors = []
+        self._pending = 0
+        self._latency_ms = None
+        self._last_latency_ms = None
+        self._rate_start = time.monotonic()
+        self._rate_frames = 0
+        self._frames_per_s = 0.0
+        self._sinks = []
+
+    def add_frame_sink(self, sink):
+        """Registra `sink(frames)`, chamado na thread de comunicação com cada lote de quadros."""
+        self._sinks.append(sink)
+
+    # --- Escrita (thread de comunicação) ---
+
+    def command_queued(self):
+        with self._lock:
+            self._pending += 1
+
+    def post_reply(self, key, ok, text, latency_s=None):
+        """Resposta ao comando enviado pelo widget `key` (substitui a anterior ainda não exibida)."""
+        with self._lock:
+            self._pending = max(0, self._pending - 1)
+            self._replies[key] = (ok, text)
+            if latency_s is not None:
+                ms = latency_s * 1000.0
+                self._last_latency_ms = ms
+                self._latency_ms = ms if self._latency_ms is None else \
+                    self._latency_ms + LATENCY_EWMA * (ms - self._latency_ms)
+
+    def post_frame(self, frame):
+        self.post_frames((frame,))
+
+    def post_frames(self, frames):
+        if not frames:
+            return
+        with self._lock:
+            for frame in frames:
+                self._frames[(frame.type, frame.channel)] = frame
+            self._frame_count += len(frames)
+            self._rate_frames += len(frames)
+        for sink in self._sinks:
+            sink(frames)
+
+    def post_error(self, message):
+        with self._lock:
+            self._errors.append(message)
+            del self._errors[:-MAX_ERRORS]
+
+    def reset_link(self):
+        """Conexão encerrada: nada mais está pendente."""
+        with self._lock:
+            self._pending = 0
+
+    # --- Leitura (thread da interface) ---
+
+    def drain(self):
+        """Retorna e limpa os eventos acumulados desde o último quadro de tela."""
+        now = time.monotonic()
+        with self._lock:
+            if now - self._rate_start >= 1.0:
+                self._frames_per_s = self._rate_frames / (now - self._rate_start)
+                self._rate_start, self._rate_frames = now, 0
+            updates = Updates(self._replies, self._frames, self._frame_count, self._errors,
+                              LinkStats(self._pending, self._latency_ms, self._last_latency_ms, self._frames_per_s))
+            self._replies, self._frames, self._frame_count, self._errors = {}, {}, 0, []
+        return updates
@@ -0,0 +1,150 @@
+# widgets/live_plot_widget.py
+
+import time
+from PyQt5.QtWidgets import QWidget, QPushButton, QComboBox, QCheckBox, QHBoxLayout, QLabel
+from PyQt5.QtGui import QPainter, QPen, QColor, QPolygonF
+from PyQt5.QtCore import Qt, QPointF, QRectF
+from .base_widget import BaseCommandWidget
+from data_plane import CHANNEL_NAMES
+
+MODE_SWEEP = "Varredura (λ × tempo)"
+MODE_SPECTRUM = "Espectro"
+SPANS_S = {"10 s": 10.0, "1 min": 60.0, "10 min": 600.0}
+
+
+class PlotCanvas(QWidget):
+    """Área de desenho: uma polilinha (já decimada) com eixos e escalas mínimas."""
+    LEFT = 80           # Espaço das escalas do eixo y.
+    MARGIN = 16
+
+    def __init__(self, parent=None):
+        super().__init__(parent)
+        self.setMinimumHeight(180)
+        self._x = self._y = None
+        self._x_range = None
+        self._x_label = ""
+        self._y_label = ""
+
+    def columns(self):
+        """Colunas de pixels da área útil: a resolução da decimação."""
+        return max(1, self.width() - self.LEFT - self.MARGIN)
+
+    def set_series(self, x, y, x_range=None, x_label="", y_label=""):
+        self._x, self._y = x, y
+        self._x_range = x_range
+        self._x_label, self._y_label = x_label, y_label
+        self.update()
+
+    def paintEvent(self, event):
+        painter = QPainter(self)
+        area = QRectF(self.LEFT, 12, self.columns(), max(1, self.height() - 56))
+        painter.fillRect(self.rect(), Qt.white)
+        painter.setPen(QPen(Qt.gray))
+        painter.drawRect(area)
+        if self._x is None or len(self._x) == 0:
+            painter.drawText(area, Qt.AlignCenter, "Sem dados")
+            return
+
+        valid = self._y == self._y          # Descarta NaN (pontos do espectro ainda não recebidos).
+        x, y = self._x[valid], self._y[valid]
+        if len(x) == 0:
+            painter.drawText(area, Qt.AlignCenter, "Sem dados")
+            return
+        x0, x1 = self._x_range if self._x_range is not None else (x[0], x[-1])
+        y0, y1 = float(y.min()), float(y.max())
+        if y1 == y0:
+            y0, y1 = y0 - 0.5, y1 + 0.5
+        sx = area.width() / ((x1 - x0) or 1.0)
+        sy = area.height() / (y1 - y0)
+        px = area.left() + (x - x0) * sx
+        py = area.bottom() - (y - y0) * sy
+        painter.setPen(QPen(QColor(0, 90, 200), 1))
+        painter.drawPolyline(QPolygonF([QPointF(a, b) for a, b in zip(px.tolist(), py.tolist())]))
+
+        painter.setPen(QPen(Qt.black))
+        painter.drawText(QRectF(0, area.top() - 9, self.LEFT - 6, 18), Qt.AlignRight, f"{y1:.6g}")
+        painter.drawText(QRectF(0, area.bottom() - 9, self.LEFT - 6, 18), Qt.AlignRight, f"{y0:.6g}")
+        painter.drawText(QRectF(area.left(), area.bottom() + 2, 120, 18), Qt.AlignLeft, f"{x0:.6g}")
+        painter.drawText(QRectF(area.right() - 120, area.bottom() + 2, 120, 18), Qt.AlignRight, f"{x1:.6g}")
+        painter.drawText(QRectF(area.left(), area.bottom() + 20, area.width(), 18), Qt.AlignCenter,
+                         f"{self._y_label} × {self._x_label}")
+
+
+class LivePlotWidget(BaseCommandWidget):
+    """
+    Gráfico ao vivo da telemetria: comprimento de onda dos passos de varredura ao
+    longo do tempo, ou o último espectro recebido de um canal.
+
+    Os dados vêm de `plot_data.LivePlotData`, alimentado pela thread de
+    comunicação; `refresh` é chamado a cada quadro de tela e só redesenha se
+    chegaram dados novos, com a série decimada para a largura do gráfico.
+    """
+    def __init__(self, data, parent=None):
+        super().__init__("Gráfico ao Vivo", parent)
+        self.data = data
+        self._drawn = None
+        self._rate_start = time.monotonic()
+        self._rate_points = data.points
+        self._rate = 0.0
+
+        controls = QHBoxLayout()
+        self.mode_selector = QComboBox()
+        self.mode_selector.addItems([MODE_SWEEP, MODE_SPECTRUM])
+        self.band_selector = QComboBox()
+        self.band_selector.addItems([CHANNEL_NAMES[ch] for ch in sorted(CHANNEL_NAMES)])
+        self.span_selector = QComboBox()
+        self.span_selector.addItems(list(SPANS_S))
+        self.stream_checkbox = QCheckBox("Telemetria no console")
+        self.clear_button = QPushButton("Limpar")
+        controls.addWidget(self.mode_selector)
+        controls.addWidget(QLabel("Banda:"))
+        controls.addWidget(self.band_selector)
+        controls.addWidget(QLabel("Janela:"))
+        controls.addWidget(self.span_selector)
+        controls.addWidget(self.stream_checkbox)
+        controls.addWidget(self.clear_button)
+
+        self.canvas = PlotCanvas()
+        self.info_label = QLabel("0 pontos")
+        self.info_label.setStyleSheet("color: gray;")
+
+        self.group_box_layout.insertLayout(0, controls)
+        self.group_box_layout.insertWidget(1, self.canvas)
+        self.group_box_layout.insertWidget(2, self.info_label)
+
+        # --- Conexões ---
+        self.stream_checkbox.toggled.connect(
+            lambda on: self.send_command_requested.emit("stream:on" if on else "stream:off"))
+        self.clear_button.clicked.connect(self.data.clear)
+
+    def refresh(self):
+        """Redesenha se chegaram dados ou se a seleção ou o tamanho mudaram."""
+        now = time.monotonic()
+        if now - self._rate_start >= 1.0:
+            self._rate = (self.data.points - self._rate_points) / (now - self._rate_start)
+            self._rate_start, self._rate_points = now, self.data.points
+            self.info_label.setText(f"{self.data.points} pontos, {self._rate:.0f} pontos/s")
+
+        channel = self.band_selector.currentIndex()
+        mode = self.mode_selector.currentText()
+        columns = self.canvas.columns()
+        state = (self.data.version, mode, channel, self.span_selector.currentText(), columns)
+        if state == self._drawn:
+            return
+        self._drawn = state
+
+        if mode == MODE_SWEEP:
+            span = SPANS_S[self.span_selector.currentText()]
+            series = self.data.sweep_series(channel, span, columns)
+            if series is None:
+                self.canvas.set_series(None, None)
+                return
+            x, y = series
+            self.canvas.set_series(x, y, (-span, 0.0), "tempo (s)", "λ (nm)")
+        else:
+            series = self.data.spectrum_series(channel, columns)
+            if series is None:
+                self.canvas.set_series(None, None)
+                return
+            x, y = series
+            self.canvas.set_series(x, y, None, "λ (nm)", "amostra")
@@ -3,6 +3,7 @@
 from PyQt5.QtWidgets import QPushButton, QComboBox, QLineEdit, QHBoxLayout, QVBoxLayout, QLabel, QFormLayout
 from PyQt5.QtGui import QDoubleValidator, QIntValidator
 from .base_widget import BaseCommandWidget
+from data_plane import TYPE_SWEEP_STEP, TYPE_TRACE, describe
 
 class SweepWidget(BaseCommandWidget):
     """
@@ -47,6 +48,11 @@ class SweepWidget(BaseCommandWidget):
         self.group_box_layout.insertLayout(0, form_layout)
         self.group_box_layout.insertWidget(1, self.start_button)
 
+        # Último passo recebido pelo plano de dados (telemetria)
+        self.telemetry_label = QLabel("Telemetria: -")
+        self.telemetry_label.setStyleSheet("color: gray;")
+        self.group_box_layout.insertWidget(2, self.telemetry_label)
+
         # --- Conexões ---
         self.start_button.clicked.connect(self.on_start_sweep_clicked)
 
@@ -69,4 +75,9 @@ class SweepWidget(BaseCommandWidget):
             
         # Formata o comando conforme especificado no firmware
         command = f"sweep:{band}:{min_wl}:{max_wl}:{step_wl}:{time_ms}"
-        self.send_command_requested.emit(command)
\ No newline at end of file
+        self.send_command_requested.emit(command)
+
+    def update_telemetry(self, frame):
+        """Exibe o último passo de varredura (ou trace) recebido pelo plano de dados."""
+        if frame.type in (TYPE_SWEEP_STEP, TYPE_TRACE):
+            self.telemetry_label.setText(f"Telemetria: {describe(frame)}")
@@ -0,0 +1,187 @@
+/**************************************************************************************************
+* Arquivo:      bus_budget.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Implementação do orçamento de ocupação do barramento (ver bus_budget.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio monotônico comum (monotonic_us).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "bus_budget.h"
+
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "monotonic_clock.h"
+
+static const char *TAG = "BUS_BUDGET";
+
+#define BUS_BUDGET_LIMIT_PERMILLE   (CONFIG_SERCALO_BUS_BUDGET_PCT * 10)
+#define BUS_BUDGET_MIN_PERMILLE     10          // Abaixo de 1% livre, a atividade é recusada mesmo com `degrade`.
+#define BUS_BUDGET_EWMA_SHIFT       3           // Peso 1/8 para cada nova medida.
+
+// Bytes de parâmetros enviados e de resposta lidos de cada comando (os do interface/bus_sim.py).
+static const uint8_t s_op_bytes[BUS_BUDGET_OP_COUNT][2] = {
+    {4, 4},     // wvl_set
+    {8, 0},     // set
+    {0, 8},     // pos
+};
+
+static uint32_t s_cost_us[BUS_BUDGET_OP_COUNT];
+static bus_budget_entry_t s_entries[BUS_BUDGET_MAX_CHANNELS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Funções Auxiliares Internas ---
+
+/**
+ * @brief Carga de uma atividade, em milésimos (arredondada para cima).
+ */
+static uint32_t load_permille(uint32_t cost_us, uint32_t interval_ms) {
+    uint64_t period_us = (uint64_t)cost_us + (uint64_t)interval_ms * 1000;
+    if (period_us == 0) return 0;
+    return (uint32_t)(((uint64_t)cost_us * 1000 + period_us - 1) / period_us);
+}
+
+/**
+ * @brief Soma das cargas dos canais, exceto `skip`. Chamada dentro de `s_lock`.
+ */
+static uint32_t committed_except(int skip) {
+    uint32_t total = 0;
+    for (int i = 0; i < BUS_BUDGET_MAX_CHANNELS; i++) {
+        if (i != skip) total += s_entries[i].load_permille;
+    }
+    return total;
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t bus_budget_init(uint32_t bus_hz) {
+    if (bus_hz == 0) return ESP_ERR_INVALID_ARG;
+    for (int op = 0; op < BUS_BUDGET_OP_COUNT; op++) {
+        // Escrita: endereço + Cmd + Len + parâmetros + CRC; leitura: endereço + eco + Len + resposta + CRC.
+        uint32_t bits = 9 * ((1 + s_op_bytes[op][0] + 3) + (1 + s_op_bytes[op][1] + 3)) + 4;
+        s_cost_us[op] = (uint32_t)((uint64_t)bits * 1000000 / bus_hz) + CONFIG_SERCALO_REPLY_WAIT_MS * 1000;
+    }
+    memset(s_entries, 0, sizeof(s_entries));
+    ESP_LOGI(TAG, "Orçamento de %d%% do barramento; wvl_set=%lu us", CONFIG_SERCALO_BUS_BUDGET_PCT,
+             (unsigned long)s_cost_us[BUS_BUDGET_OP_WVL_SET]);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *bus_budget_op_name(bus_budget_op_t op) {
+    static const char *const names[BUS_BUDGET_OP_COUNT] = {"wvl_set", "set", "pos"};
+    return (op < BUS_BUDGET_OP_COUNT) ? names[op] : "?";
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_budget_observe(bus_budget_op_t op, uint32_t elapsed_us) {
+    if (op >= BUS_BUDGET_OP_COUNT) return;
+    taskENTER_CRITICAL(&s_lock);
+    int64_t cost = s_cost_us[op];
+    cost += ((int64_t)elapsed_us - cost) / (1 << BUS_BUDGET_EWMA_SHIFT);
+    s_cost_us[op] = (uint32_t)cost;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t bus_budget_cost_us(bus_budget_op_t op) {
+    return (op < BUS_BUDGET_OP_COUNT) ? s_cost_us[op] : 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t bus_budget_admit(uint8_t channel, uint32_t cost_us, uint32_t *interval_ms, bool degrade) {
+    if (channel >= BUS_BUDGET_MAX_CHANNELS || interval_ms == NULL) return ESP_ERR_INVALID_ARG;
+
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t committed = committed_except(channel);
+    taskEXIT_CRITICAL(&s_lock);
+    uint32_t available = (committed < BUS_BUDGET_LIMIT_PERMILLE) ? BUS_BUDGET_LIMIT_PERMILLE - committed : 0;
+    uint32_t load = load_permille(cost_us, *interval_ms);
+    if (load <= available) return ESP_OK;
+
+    if (!degrade || available < BUS_BUDGET_MIN_PERMILLE) {
+        ESP_LOGW(TAG, "Canal %u: carga de %lu‰ recusada (%lu‰ livres)", channel, (unsigned long)load, (unsigned long)available);
+        return ESP_ERR_INVALID_STATE;
+    }
+    // custo / (custo + intervalo) <= disponível  =>  intervalo >= custo * (1000 - disponível) / disponível.
+    uint64_t min_interval_us = ((uint64_t)cost_us * (1000 - available) + available - 1) / available;
+    uint32_t interval = (uint32_t)((min_interval_us + 999) / 1000);
+    interval = (interval + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS * portTICK_PERIOD_MS; // As esperas são em ticks.
+    ESP_LOGI(TAG, "Canal %u: intervalo alongado de %lu para %lu ms (%lu‰ livres)", channel,
+             (unsigned long)*interval_ms, (unsigned long)interval, (unsigned long)available);
+    *interval_ms = interval;
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_budget_commit(uint8_t channel, bus_budget_kind_t kind, uint32_t cost_us, uint32_t interval_ms) {
+    if (channel >= BUS_BUDGET_MAX_CHANNELS) return;
+    bus_budget_entry_t entry = {
+        .kind = kind,
+        .cost_us = cost_us,
+        .interval_ms = interval_ms,
+        .load_permille = load_permille(cost_us, interval_ms),
+    };
+    taskENTER_CRITICAL(&s_lock);
+    s_entries[channel] = entry;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_budget_release(uint8_t channel) {
+    if (channel >= BUS_BUDGET_MAX_CHANNELS) return;
+    taskENTER_CRITICAL(&s_lock);
+    memset(&s_entries[channel], 0, sizeof(s_entries[channel]));
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_budget_get_entry(uint8_t channel, bus_budget_entry_t *entry) {
+    memset(entry, 0, sizeof(*entry));
+    if (channel >= BUS_BUDGET_MAX_CHANNELS) return;
+    taskENTER_CRITICAL(&s_lock);
+    *entry = s_entries[channel];
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t bus_budget_committed_permille(void) {
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t total = committed_except(-1);
+    taskEXIT_CRITICAL(&s_lock);
+    return total;
+}
+
+#endif // CONFIG_SERCALO_BUS_BUDGET_ENABLE
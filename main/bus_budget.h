@@ -0,0 +1,133 @@
+/**************************************************************************************************
+* Arquivo:      bus_budget.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Orçamento de ocupação do barramento I2C e controle de admissão
+* das atividades periódicas (varreduras e rasters). Cada atividade ocupa o
+* barramento por um custo fixo a cada período (as transações de um passo ou
+* ponto, seguidas do intervalo sem transações); a carga é custo / período.
+* Uma nova atividade só é admitida se a soma das cargas comprometidas couber
+* no orçamento; caso contrário, é recusada ou tem o intervalo alongado até
+* caber. O custo de cada comando do protocolo parte do modelo de tempo do
+* TF1 (quadros no barramento + espera da resposta) e é aprendido das
+* transações medidas.
+*
+* Os comandos avulsos ficam fora do orçamento: usam a fração restante do
+* barramento. O plano de dados (stream, UDP) não gera transações I2C.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio no monotonic_clock.h; desabilitado por padrão.
+*
+**************************************************************************************************/
+
+#ifndef BUS_BUDGET_H
+#define BUS_BUDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUS_BUDGET_MAX_CHANNELS     2
+
+/**
+ * @brief Comandos do protocolo usados pelas atividades periódicas.
+ */
+typedef enum {
+    BUS_BUDGET_OP_WVL_SET = 0,  /*!< "wvl_set": um passo de varredura. */
+    BUS_BUDGET_OP_SET,          /*!< "set": um ponto de raster. */
+    BUS_BUDGET_OP_POS,          /*!< "pos": leitura da posição do espelho. */
+    BUS_BUDGET_OP_COUNT,
+} bus_budget_op_t;
+
+/**
+ * @brief Atividade periódica de um canal (no máximo uma por canal).
+ */
+typedef enum {
+    BUS_BUDGET_NONE = 0,
+    BUS_BUDGET_SWEEP,
+    BUS_BUDGET_RASTER,
+} bus_budget_kind_t;
+
+/**
+ * @struct bus_budget_entry_t
+ * @brief  Carga comprometida por um canal.
+ */
+typedef struct {
+    bus_budget_kind_t kind;
+    uint32_t cost_us;           /*!< Ocupação do barramento a cada período. */
+    uint32_t interval_ms;       /*!< Intervalo sem transações entre os períodos. */
+    uint32_t load_permille;     /*!< custo / (custo + intervalo), em milésimos. */
+} bus_budget_entry_t;
+
+/**
+ * @brief Inicializa os custos pelo modelo de tempo do TF1.
+ * @param bus_hz Frequência do barramento I2C.
+ */
+esp_err_t bus_budget_init(uint32_t bus_hz);
+
+/**
+ * @brief Nome curto de um comando ("wvl_set", "set", "pos").
+ */
+const char *bus_budget_op_name(bus_budget_op_t op);
+
+/**
+ * @brief Incorpora a duração medida de uma transação ao custo do comando (média móvel).
+ */
+void bus_budget_observe(bus_budget_op_t op, uint32_t elapsed_us);
+
+/**
+ * @brief Custo atual de um comando, em microssegundos.
+ */
+uint32_t bus_budget_cost_us(bus_budget_op_t op);
+
+/**
+ * @brief Verifica se a atividade do canal cabe no orçamento, sem comprometê-la.
+ *
+ * A carga atual do canal é desconsiderada (a atividade nova a substitui). Se a
+ * carga pedida não cabe no que resta do orçamento e `degrade` é verdadeiro, o
+ * intervalo é alongado até caber.
+ *
+ * @param channel Índice do canal (0 = C, 1 = L).
+ * @param cost_us Ocupação do barramento a cada período.
+ * @param[in,out] interval_ms Intervalo pedido; o admitido no retorno.
+ * @param degrade Permite alongar o intervalo.
+ * @return ESP_OK se admitida (com `*interval_ms` possivelmente alongado).
+ * @return ESP_ERR_INVALID_STATE se não cabe no orçamento.
+ */
+esp_err_t bus_budget_admit(uint8_t channel, uint32_t cost_us, uint32_t *interval_ms, bool degrade);
+
+/**
+ * @brief Compromete a carga da atividade admitida (substitui a anterior do canal).
+ */
+void bus_budget_commit(uint8_t channel, bus_budget_kind_t kind, uint32_t cost_us, uint32_t interval_ms);
+
+/**
+ * @brief Libera a carga comprometida pelo canal.
+ */
+void bus_budget_release(uint8_t channel);
+
+/**
+ * @brief Obtém a carga comprometida por um canal.
+ */
+void bus_budget_get_entry(uint8_t channel, bus_budget_entry_t *entry);
+
+/**
+ * @brief Soma das cargas comprometidas, em milésimos.
+ */
+uint32_t bus_budget_committed_permille(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUS_BUDGET_H
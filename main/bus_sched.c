@@ -0,0 +1,195 @@
+/**************************************************************************************************
+* Arquivo:      bus_sched.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.2
+*
+* Descrição:    Implementação do escalonamento EDF dos passos de varredura (ver bus_sched.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio monotônico comum (monotonic_us).
+* [2026-10-18] - [Barino] - [0.1.2] - bus_sched_acquire_until (transações fora dos passos).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "bus_sched.h"
+
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+
+#include <string.h>
+#include "freertos/task.h"
+#include "monotonic_clock.h"
+
+/**
+ * @brief Passo de um canal. O escalonador tem uma vez (`s_turn_taken`): o passo
+ * que a detém toma o mutex; os demais aguardam em `pending`, por prazo.
+ * Os campos de estado são alterados dentro de `s_lock`.
+ */
+typedef struct {
+    TaskHandle_t task;
+    int64_t deadline_us;
+    volatile bool pending;      /*!< Aguardando a vez. */
+    volatile bool granted;      /*!< Recebeu a vez (de `bus_sched_release` ou na chegada). */
+    uint32_t jobs;
+    uint32_t misses;
+    uint64_t lateness_total_us;
+    uint32_t lateness_max_us;
+    uint32_t slack_ms;
+} sched_job_t;
+
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static sched_job_t s_jobs[BUS_SCHED_MAX_CHANNELS];
+static bool s_turn_taken = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Funções Auxiliares Internas ---
+
+/**
+ * @brief Passa a vez ao passo pendente de prazo mais cedo, ou a libera.
+ */
+static void dispatch_next(void) {
+    TaskHandle_t wake = NULL;
+
+    taskENTER_CRITICAL(&s_lock);
+    sched_job_t *next = NULL;
+    for (int i = 0; i < BUS_SCHED_MAX_CHANNELS; i++) {
+        sched_job_t *job = &s_jobs[i];
+        if (job->pending && (next == NULL || job->deadline_us < next->deadline_us)) {
+            next = job;
+        }
+    }
+    if (next != NULL) {
+        next->pending = false;
+        next->granted = true;
+        wake = next->task;
+    } else {
+        s_turn_taken = false;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (wake != NULL) {
+        xTaskNotifyGive(wake);
+    }
+}
+
+/**
+ * @brief Aguarda a vez com o prazo `deadline_us` e toma o mutex do barramento.
+ */
+static esp_err_t take_turn(uint8_t channel, int64_t deadline_us, volatile bool *cancel) {
+    sched_job_t *job = &s_jobs[channel];
+
+    taskENTER_CRITICAL(&s_lock);
+    job->task = xTaskGetCurrentTaskHandle();
+    job->deadline_us = deadline_us;
+    job->granted = !s_turn_taken;
+    job->pending = s_turn_taken;
+    s_turn_taken = true;
+    taskEXIT_CRITICAL(&s_lock);
+
+    while (!job->granted) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (*cancel) {
+            taskENTER_CRITICAL(&s_lock);
+            bool withdrawn = job->pending;
+            job->pending = false;
+            taskEXIT_CRITICAL(&s_lock);
+            if (withdrawn) return ESP_ERR_INVALID_STATE;
+        }
+    }
+    job->granted = false;
+    if (*cancel) {
+        dispatch_next(); // Recebeu a vez junto com o pedido de parada: repassa.
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_bus_mutex, portMAX_DELAY);
+    return ESP_OK;
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t bus_sched_init(SemaphoreHandle_t bus_mutex) {
+    if (bus_mutex == NULL) return ESP_ERR_INVALID_ARG;
+    s_bus_mutex = bus_mutex;
+    memset(s_jobs, 0, sizeof(s_jobs));
+    s_turn_taken = false;
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t bus_sched_acquire(uint8_t channel, int64_t release_us, uint32_t slack_ms, volatile bool *cancel) {
+    if (channel >= BUS_SCHED_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = take_turn(channel, release_us + (int64_t)slack_ms * 1000, cancel);
+    if (ret != ESP_OK) return ret;
+    int64_t lateness_us = monotonic_us() - release_us;
+    if (lateness_us < 0) lateness_us = 0;
+
+    sched_job_t *job = &s_jobs[channel];
+    taskENTER_CRITICAL(&s_lock);
+    job->slack_ms = slack_ms;
+    job->jobs++;
+    job->lateness_total_us += (uint64_t)lateness_us;
+    if (lateness_us > job->lateness_max_us) job->lateness_max_us = (uint32_t)lateness_us;
+    if (lateness_us > (int64_t)slack_ms * 1000) job->misses++;
+    taskEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t bus_sched_acquire_until(uint8_t channel, int64_t deadline_us, volatile bool *cancel) {
+    if (channel >= BUS_SCHED_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    return take_turn(channel, deadline_us, cancel);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_sched_release(uint8_t channel) {
+    xSemaphoreGive(s_bus_mutex);
+    dispatch_next();
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_sched_reset_stats(uint8_t channel) {
+    if (channel >= BUS_SCHED_MAX_CHANNELS) return;
+    sched_job_t *job = &s_jobs[channel];
+    taskENTER_CRITICAL(&s_lock);
+    job->jobs = 0;
+    job->misses = 0;
+    job->lateness_total_us = 0;
+    job->lateness_max_us = 0;
+    job->slack_ms = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void bus_sched_get_stats(uint8_t channel, bus_sched_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (channel >= BUS_SCHED_MAX_CHANNELS) return;
+    const sched_job_t *job = &s_jobs[channel];
+    taskENTER_CRITICAL(&s_lock);
+    stats->jobs = job->jobs;
+    stats->misses = job->misses;
+    stats->lateness_mean_ms = (job->jobs > 0) ? (float)job->lateness_total_us / job->jobs / 1000.0f : 0.0f;
+    stats->lateness_max_ms = job->lateness_max_us / 1000;
+    stats->slack_ms = job->slack_ms;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+#endif // CONFIG_SERCALO_SWEEP_EDF_ENABLE
@@ -0,0 +1,105 @@
+/**************************************************************************************************
+* Arquivo:      bus_sched.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.2
+*
+* Descrição:    Escalonamento EDF (earliest deadline first) dos passos de varredura
+* no barramento I2C. Cada passo é um job com instante de liberação (quando a
+* task acorda para enviá-lo) e prazo (liberação + folga, uma fração da
+* permanência no passo). Entre os passos de varreduras concorrentes que
+* aguardam o barramento, o de prazo mais cedo toma o mutex primeiro, em vez
+* de quem acordar antes. O atraso de cada passo em relação à liberação e os
+* prazos perdidos são contabilizados por canal.
+*
+* Os demais usuários do barramento (comandos, raster, energia) continuam
+* tomando o mutex diretamente; o escalonador ordena apenas as varreduras entre
+* si: os passos e as leituras de volta da verificação de cada passo.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio no monotonic_clock.h; desabilitado por padrão.
+* [2026-10-18] - [Barino] - [0.1.2] - bus_sched_acquire_until.
+*
+**************************************************************************************************/
+
+#ifndef BUS_SCHED_H
+#define BUS_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUS_SCHED_MAX_CHANNELS      2
+
+/**
+ * @struct bus_sched_stats_t
+ * @brief  Pontualidade dos passos de um canal.
+ */
+typedef struct {
+    uint32_t jobs;              /*!< Passos que tomaram o barramento. */
+    uint32_t misses;            /*!< Passos com atraso maior que a folga. */
+    float lateness_mean_ms;     /*!< Atraso médio: da liberação até tomar o barramento. */
+    uint32_t lateness_max_ms;   /*!< Maior atraso. */
+    uint32_t slack_ms;          /*!< Folga do último passo. */
+} bus_sched_stats_t;
+
+/**
+ * @brief Inicializa o escalonador.
+ * @param bus_mutex Mutex que protege o barramento I2C.
+ */
+esp_err_t bus_sched_init(SemaphoreHandle_t bus_mutex);
+
+/**
+ * @brief Aguarda a vez do passo (EDF) e toma o mutex do barramento.
+ *
+ * Usa a notificação da task chamadora: uma notificação externa (pedido de
+ * parada) interrompe a espera se `*cancel` for verdadeiro.
+ *
+ * @param channel Índice do canal (0 = C, 1 = L).
+ * @param release_us Liberação do passo (relógio de `monotonic_us`).
+ * @param slack_ms Folga: o prazo é `release_us + slack_ms`.
+ * @param cancel Pedido de parada da task chamadora.
+ * @return ESP_OK com o mutex tomado (liberar com `bus_sched_release`).
+ * @return ESP_ERR_INVALID_STATE se a espera foi cancelada (mutex não tomado).
+ */
+esp_err_t bus_sched_acquire(uint8_t channel, int64_t release_us, uint32_t slack_ms, volatile bool *cancel);
+
+/**
+ * @brief Como `bus_sched_acquire`, para uma transação da varredura que não é um
+ *        passo (a leitura de volta da verificação): concorre pelo prazo
+ *        absoluto `deadline_us` e não entra nos contadores de pontualidade.
+ * @return ESP_OK com o mutex tomado (liberar com `bus_sched_release`).
+ * @return ESP_ERR_INVALID_STATE se a espera foi cancelada (mutex não tomado).
+ */
+esp_err_t bus_sched_acquire_until(uint8_t channel, int64_t deadline_us, volatile bool *cancel);
+
+/**
+ * @brief Libera o mutex e passa a vez ao passo pendente de prazo mais cedo.
+ */
+void bus_sched_release(uint8_t channel);
+
+/**
+ * @brief Zera os contadores do canal (início de uma varredura).
+ */
+void bus_sched_reset_stats(uint8_t channel);
+
+/**
+ * @brief Obtém os contadores do canal.
+ */
+void bus_sched_get_stats(uint8_t channel, bus_sched_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUS_SCHED_H
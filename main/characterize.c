@@ -0,0 +1,238 @@
+/**************************************************************************************************
+* Arquivo:      characterize.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Implementação da autocaracterização dos filtros (ver characterize.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio monotônico comum (monotonic_us).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "characterize.h"
+
+#if CONFIG_SERCALO_CHARACTERIZE_ENABLE
+
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "move_planner.h"
+#include "monotonic_clock.h"
+
+static const char *TAG = "CHARACTERIZE";
+
+#define CHARACTERIZE_LATENCY_SAMPLES    5
+#define CHARACTERIZE_RATE_STEPS         10
+#define CHARACTERIZE_RATE_STEP_NM       0.1f
+
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static characterize_report_t s_reports[CHARACTERIZE_MAX_CHANNELS];
+
+// Saltos medidos; 0 = faixa completa. Os que excedem a faixa são ignorados.
+static const float s_jumps_nm[CHARACTERIZE_MAX_JUMPS] = {0.1f, 0.5f, 2.0f, 10.0f, 0.0f};
+
+// --- Funções Auxiliares Internas ---
+
+/**
+ * @brief Executa uma transação do comando `op`, com o barramento tomado apenas durante ela.
+ * @param[out] elapsed_us Duração da transação.
+ */
+static esp_err_t run_op(sercalo_dev_t *dev, characterize_op_t op, float set_wl, uint32_t *elapsed_us) {
+    esp_err_t ret = ESP_FAIL;
+    if (xSemaphoreTake(s_bus_mutex, portMAX_DELAY) != pdTRUE) return ret;
+
+    int64_t start = monotonic_us();
+    switch (op) {
+    case CHARACTERIZE_OP_ID: {
+        sercalo_id_t id;
+        ret = sercalo_get_id(dev, &id);
+        break;
+    }
+    case CHARACTERIZE_OP_POW: {
+        sercalo_power_mode_t mode;
+        ret = sercalo_get_set_power_mode(dev, NULL, &mode);
+        break;
+    }
+    case CHARACTERIZE_OP_TMP: {
+        int8_t temperature;
+        ret = sercalo_get_temperature(dev, &temperature);
+        break;
+    }
+    case CHARACTERIZE_OP_WVL_GET: {
+        float wl;
+        ret = sercalo_get_set_wavelength(dev, NULL, &wl);
+        break;
+    }
+    case CHARACTERIZE_OP_WVL_SET: {
+        float readback;
+        ret = sercalo_get_set_wavelength(dev, &set_wl, &readback);
+        break;
+    }
+    default: {
+        sercalo_mirror_pos_t pos;
+        ret = sercalo_get_mirror_position(dev, &pos);
+        break;
+    }
+    }
+    *elapsed_us = (uint32_t)(monotonic_us() - start);
+    xSemaphoreGive(s_bus_mutex);
+    return ret;
+}
+
+/**
+ * @brief Mede a latência de cada comando. O WVL é redefinido no valor mínimo, sem mover o espelho.
+ */
+static esp_err_t measure_latency(sercalo_dev_t *dev, characterize_report_t *report) {
+    for (int op = 0; op < CHARACTERIZE_OP_COUNT; op++) {
+        characterize_latency_t *lat = &report->latency[op];
+        uint64_t total = 0;
+        lat->min_us = UINT32_MAX;
+        lat->max_us = 0;
+        for (int i = 0; i < CHARACTERIZE_LATENCY_SAMPLES; i++) {
+            uint32_t elapsed;
+            esp_err_t ret = run_op(dev, (characterize_op_t)op, report->min_wl, &elapsed);
+            if (ret != ESP_OK) return ret;
+            total += elapsed;
+            if (elapsed < lat->min_us) lat->min_us = elapsed;
+            if (elapsed > lat->max_us) lat->max_us = elapsed;
+        }
+        lat->mean_us = (uint32_t)(total / CHARACTERIZE_LATENCY_SAMPLES);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Mede a estabilização de cada salto, subindo e descendo a partir do mínimo da faixa.
+ *
+ * Os saltos são diretos (um ponto), como os passos de uma varredura.
+ */
+static esp_err_t measure_settle(sercalo_dev_t *dev, characterize_report_t *report) {
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+    const float range = report->max_wl - report->min_wl;
+    const uint32_t set_ms = report->latency[CHARACTERIZE_OP_WVL_SET].mean_us / 1000;
+    report->jumps = 0;
+
+    for (int i = 0; i < CHARACTERIZE_MAX_JUMPS; i++) {
+        float jump = (s_jumps_nm[i] > 0.0f) ? s_jumps_nm[i] : range;
+        if (jump > range) continue;
+        float from = report->min_wl, to = report->min_wl + jump;
+        move_result_t up, down;
+
+        esp_err_t ret = move_planner_move(dev, from, to, false, true, &up);
+        if (ret == ESP_OK) ret = move_planner_move(dev, to, from, false, true, &down);
+        if (ret != ESP_OK) return ret;
+
+        characterize_settle_t *settle = &report->settle[report->jumps++];
+        settle->jump_nm = jump;
+        settle->up_ms = up.settle_ms;
+        settle->down_ms = down.settle_ms;
+        // O intervalo da varredura começa ao fim da transação do passo.
+        uint32_t worst = (up.settle_ms > down.settle_ms) ? up.settle_ms : down.settle_ms;
+        settle->dwell_ms = (worst > set_ms) ? worst - set_ms : 0;
+    }
+#else
+    report->jumps = 0;
+#endif
+    return ESP_OK;
+}
+
+/**
+ * @brief Mede a taxa de passos em sequência (sem intervalo), com ou sem leitura de POS.
+ */
+static esp_err_t measure_rate(sercalo_dev_t *dev, const characterize_report_t *report, bool with_pos, float *rate) {
+    int64_t start = monotonic_us();
+    for (int i = 1; i <= CHARACTERIZE_RATE_STEPS; i++) {
+        float wl = fminf(report->min_wl + i * CHARACTERIZE_RATE_STEP_NM, report->max_wl);
+        uint32_t elapsed;
+        esp_err_t ret = run_op(dev, CHARACTERIZE_OP_WVL_SET, wl, &elapsed);
+        if (ret == ESP_OK && with_pos) ret = run_op(dev, CHARACTERIZE_OP_POS, 0.0f, &elapsed);
+        if (ret != ESP_OK) return ret;
+    }
+    int64_t total = monotonic_us() - start;
+    *rate = (total > 0) ? (float)(CHARACTERIZE_RATE_STEPS * 1e6 / total) : 0.0f;
+    return ESP_OK;
+}
+
+/**
+ * @brief Leva o espelho ao mínimo da faixa e aguarda estabilizar.
+ */
+static esp_err_t park(sercalo_dev_t *dev, float wl) {
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+    move_result_t result;
+    return move_planner_move(dev, NAN, wl, false, true, &result);
+#else
+    uint32_t elapsed;
+    return run_op(dev, CHARACTERIZE_OP_WVL_SET, wl, &elapsed);
+#endif
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t characterize_init(SemaphoreHandle_t bus_mutex) {
+    if (bus_mutex == NULL) return ESP_ERR_INVALID_ARG;
+    s_bus_mutex = bus_mutex;
+    memset(s_reports, 0, sizeof(s_reports));
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *characterize_op_name(characterize_op_t op) {
+    static const char *const names[CHARACTERIZE_OP_COUNT] = {"id", "pow", "tmp", "wvl", "wvl_set", "pos"};
+    return (op < CHARACTERIZE_OP_COUNT) ? names[op] : "?";
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t characterize_run(sercalo_dev_t *dev, uint8_t channel, characterize_report_t *report) {
+    if (dev == NULL || report == NULL || channel >= CHARACTERIZE_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    memset(report, 0, sizeof(*report));
+    int64_t start = monotonic_us();
+
+    esp_err_t ret = ESP_FAIL;
+    if (xSemaphoreTake(s_bus_mutex, portMAX_DELAY) == pdTRUE) {
+        ret = sercalo_get_min_wavelength(dev, &report->min_wl);
+        if (ret == ESP_OK) ret = sercalo_get_max_wavelength(dev, &report->max_wl);
+        xSemaphoreGive(s_bus_mutex);
+    }
+    if (ret == ESP_OK) ret = park(dev, report->min_wl);
+    if (ret == ESP_OK) ret = measure_latency(dev, report);
+    if (ret == ESP_OK) ret = measure_settle(dev, report);
+    if (ret == ESP_OK) ret = measure_rate(dev, report, false, &report->step_rate);
+    if (ret == ESP_OK) ret = measure_rate(dev, report, true, &report->step_rate_pos);
+    if (ret == ESP_OK) ret = park(dev, report->min_wl);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Canal %u: caracterização interrompida: %s", channel, esp_err_to_name(ret));
+        return ret;
+    }
+
+    report->duration_ms = (uint32_t)((monotonic_us() - start) / 1000);
+    report->valid = true;
+    s_reports[channel] = *report;
+    ESP_LOGI(TAG, "Canal %u: %.2f passos/s (%.2f com POS), %u saltos em %lu ms", channel,
+             report->step_rate, report->step_rate_pos, report->jumps, (unsigned long)report->duration_ms);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool characterize_get_report(uint8_t channel, characterize_report_t *report) {
+    if (channel >= CHARACTERIZE_MAX_CHANNELS || !s_reports[channel].valid) return false;
+    *report = s_reports[channel];
+    return true;
+}
+
+#endif // CONFIG_SERCALO_CHARACTERIZE_ENABLE
@@ -0,0 +1,126 @@
+/**************************************************************************************************
+* Arquivo:      characterize.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Autocaracterização de um filtro: sequência curta e automática que
+* mede a latência de cada comando do protocolo, o tempo de estabilização
+* do espelho para saltos de vários tamanhos (nos dois sentidos) e a maior
+* taxa de passos sustentada, com e sem leitura de posição. O resultado
+* indica o menor `passo_tempo_ms` de uma varredura para cada tamanho de
+* passo, em vez de valores estimados. Funciona igualmente com o filtro
+* real e com o simulado.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef CHARACTERIZE_H
+#define CHARACTERIZE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sercalo_i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHARACTERIZE_MAX_CHANNELS   2
+#define CHARACTERIZE_MAX_JUMPS      5
+
+/**
+ * @brief Comandos do protocolo cuja latência é medida.
+ */
+typedef enum {
+    CHARACTERIZE_OP_ID = 0,     /*!< "id": identificação. */
+    CHARACTERIZE_OP_POW,        /*!< "pow": consulta do modo de energia. */
+    CHARACTERIZE_OP_TMP,        /*!< "tmp": temperatura. */
+    CHARACTERIZE_OP_WVL_GET,    /*!< "wvl": consulta do comprimento de onda. */
+    CHARACTERIZE_OP_WVL_SET,    /*!< "wvl_set": definição do comprimento de onda (um passo de varredura). */
+    CHARACTERIZE_OP_POS,        /*!< "pos": leitura da posição do espelho. */
+    CHARACTERIZE_OP_COUNT,
+} characterize_op_t;
+
+/**
+ * @struct characterize_latency_t
+ * @brief  Duração de uma transação completa (comando, espera e resposta).
+ */
+typedef struct {
+    uint32_t min_us;
+    uint32_t mean_us;
+    uint32_t max_us;
+} characterize_latency_t;
+
+/**
+ * @struct characterize_settle_t
+ * @brief  Estabilização de um tamanho de salto, medida pela leitura de POS.
+ */
+typedef struct {
+    float jump_nm;
+    uint32_t up_ms;             /*!< Do envio até a posição estabilizar, subindo. */
+    uint32_t down_ms;           /*!< Idem, descendo. */
+    uint32_t dwell_ms;          /*!< Menor `passo_tempo_ms` de uma varredura com este passo. */
+} characterize_settle_t;
+
+/**
+ * @struct characterize_report_t
+ * @brief  Resultado da caracterização de um canal.
+ */
+typedef struct {
+    bool valid;                 /*!< false até a primeira caracterização completa. */
+    float min_wl;               /*!< Faixa do filtro (nm). */
+    float max_wl;
+    characterize_latency_t latency[CHARACTERIZE_OP_COUNT];
+    uint8_t jumps;              /*!< Entradas válidas em `settle` (0 sem o planejador de movimentos). */
+    characterize_settle_t settle[CHARACTERIZE_MAX_JUMPS];
+    float step_rate;            /*!< Passos/s em sequência, só o comando WVL. */
+    float step_rate_pos;        /*!< Passos/s com leitura de POS a cada passo. */
+    uint32_t duration_ms;       /*!< Duração da caracterização. */
+} characterize_report_t;
+
+/**
+ * @brief Inicializa o módulo.
+ * @param bus_mutex Mutex que protege o barramento I2C (tomado a cada transação).
+ */
+esp_err_t characterize_init(SemaphoreHandle_t bus_mutex);
+
+/**
+ * @brief Nome curto de um comando medido ("id", "pow", ...).
+ */
+const char *characterize_op_name(characterize_op_t op);
+
+/**
+ * @brief Executa a caracterização do canal e guarda o resultado.
+ *
+ * O filtro deve estar em modo normal. O espelho é movido dentro da faixa e
+ * termina no comprimento de onda mínimo, estável. Leva cerca de 1 minuto com
+ * o tempo padrão de resposta do driver; o barramento é liberado entre as
+ * transações, e o outro canal continua atendido.
+ *
+ * @param channel Índice do canal (0 = C, 1 = L).
+ * @param[out] report Resultado (também guardado para `characterize_get_report`).
+ * @return ESP_OK em sucesso, ESP_ERR_TIMEOUT se uma estabilização expirou, ou
+ *         o erro da comunicação.
+ */
+esp_err_t characterize_run(sercalo_dev_t *dev, uint8_t channel, characterize_report_t *report);
+
+/**
+ * @brief Obtém o resultado da última caracterização completa do canal.
+ * @return false se o canal ainda não foi caracterizado.
+ */
+bool characterize_get_report(uint8_t channel, characterize_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHARACTERIZE_H
@@ -0,0 +1,105 @@
+/**************************************************************************************************
+* Arquivo:      command.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.3.0
+*
+* Descrição:    Fila de comandos da aplicação. Cada origem de comandos (UART do console,
+* clientes TCP, ...) entrega linhas já enquadradas à fila, junto com a
+* origem que deve receber a resposta. A `command_processor_task` executa
+* os comandos em ordem e devolve cada resposta à sua origem.
+*
+* Um comando pode trazer uma etiqueta (`:@<etiqueta> <comando>`), repetida
+* na resposta (`:ACK@<etiqueta>: ...`, `:NACK@<etiqueta>: ...`), para que um
+* cliente com vários comandos pendentes associe cada resposta ao seu pedido
+* mesmo quando uma rejeição (fila cheia) chega antes das anteriores.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.2.0] - Respostas com bloco binário e formato de resposta por origem.
+* [2026-10-18] - [Barino] - [0.3.0] - Etiquetas de comando repetidas na resposta; rejeições respondidas pela fila.
+*
+**************************************************************************************************/
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "response.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CMD_BUFFER_SIZE             128         // Tamanho máximo do buffer para comandos recebidos.
+#define CMD_QUEUE_LENGTH            16          // Comandos aguardando execução (somando todas as origens).
+#define COMMAND_TAG_MAX             8           // Caracteres de uma etiqueta de comando (letras e dígitos).
+
+/**
+ * @struct command_source_t
+ * @brief  Descreve uma origem de comandos e como responder a ela.
+ */
+typedef struct {
+    const char *name;                                           /*!< Nome da origem ("uart", "tcp"). */
+    void (*reply)(void *ctx, const char *line, size_t len);     /*!< Envia uma linha de resposta completa (com '\n') ou parte de um bloco binário. */
+    esp_err_t (*set_stream)(void *ctx, bool enabled);           /*!< Assina/cancela o plano de dados para esta origem. NULL se não suportado. */
+    bool (*stream_enabled)(void *ctx);                          /*!< Indica se a origem assina o plano de dados. */
+    void (*binary_mode)(void *ctx, bool enabled);               /*!< Prepara a origem para bytes arbitrários (ex.: sem tradução de fim de linha). NULL se não necessário. */
+    esp_err_t (*set_format)(void *ctx, response_format_t format); /*!< Define o formato das respostas para esta origem. NULL se fixo (TEXT). */
+    response_format_t (*get_format)(void *ctx);                 /*!< Formato das respostas para esta origem. */
+} command_source_t;
+
+/**
+ * @brief Entrega uma linha de comando (sem o ':' inicial e sem o terminador) à fila.
+ *
+ * Uma linha recusada já é respondida à origem (`:NACK[@etiqueta]: ...`).
+ *
+ * @param line Comando, ex.: "get-wl?C" ou "@17 get-wl?C".
+ * @param source Origem que receberá a resposta.
+ * @param ctx Contexto da origem (ex.: identificação do cliente).
+ * @return ESP_OK se o comando foi enfileirado.
+ * @return ESP_ERR_INVALID_ARG se a etiqueta for inválida.
+ * @return ESP_ERR_TIMEOUT se a fila estiver cheia.
+ */
+esp_err_t command_submit(const char *line, const command_source_t *source, void *ctx);
+
+/**
+ * @brief Retorna a origem do comando em execução (válido apenas dentro de um handler).
+ * @param[out] ctx Recebe o contexto da origem. Pode ser NULL.
+ */
+const command_source_t *command_current_source(void **ctx);
+
+/**
+ * @brief Inicia uma resposta com bloco binário de tamanho definido, como no SCPI:
+ * `:ACK: #<d><tamanho><dados>\n`, onde `<d>` é o número de dígitos de `<tamanho>`.
+ *
+ * Válido apenas dentro de um handler. Os dados seguem com command_reply_block_write()
+ * e a resposta termina com command_reply_block_end(); o handler então retorna
+ * ESP_OK e a resposta padrão não é enviada. Durante o bloco, a origem não recebe
+ * quadros do plano de dados.
+ *
+ * @param len Tamanho exato do bloco.
+ * @return ESP_ERR_INVALID_STATE fora de um handler.
+ */
+esp_err_t command_reply_block_begin(size_t len);
+
+/**
+ * @brief Envia parte dos dados de um bloco iniciado com command_reply_block_begin().
+ */
+void command_reply_block_write(const void *data, size_t len);
+
+/**
+ * @brief Termina o bloco binário (envia o '\n' final e restaura a origem).
+ */
+void command_reply_block_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMMAND_H
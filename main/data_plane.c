@@ -0,0 +1,375 @@
+/**************************************************************************************************
+* Arquivo:      data_plane.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Implementação do plano de dados: enquadramento, buffer de despacho e
+* destinos (UART dedicada e console).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/message_buffer.h"
+#include "esp_log.h"
+#include "sercalo_i2c.h" // Reaproveita o CRC-8 do protocolo do TF1
+#include "data_plane.h"
+
+#if CONFIG_SERCALO_DATA_UART_ENABLE
+#if CONFIG_IDF_TARGET_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#else
+#include "driver/uart.h"
+#endif
+#endif
+
+static const char *TAG = "DATA_PLANE";
+
+/**
+ * @struct data_plane_sink_t
+ * @brief  Um destino registrado para os quadros.
+ */
+typedef struct {
+    data_plane_write_fn_t write;    /*!< Função de escrita. NULL se a posição está livre. */
+    void *ctx;                      /*!< Contexto repassado à função. */
+    uint32_t type_mask;             /*!< Tipos de quadro aceitos. */
+} data_plane_sink_t;
+
+static MessageBufferHandle_t s_frame_buffer = NULL;    /*!< Quadros aguardando despacho. */
+static SemaphoreHandle_t s_publish_mutex = NULL;       /*!< Serializa os produtores (numeração e ordem dos quadros). */
+static SemaphoreHandle_t s_sinks_mutex = NULL;         /*!< Protege a tabela de destinos. */
+static data_plane_sink_t s_sinks[DATA_PLANE_MAX_SINKS];
+static volatile uint32_t s_active_mask = 0;             /*!< União das máscaras dos destinos registrados. */
+static uint16_t s_next_seq = 0;
+static int s_console_sink_id = -1;
+static bool s_uart_enabled = false;
+
+static data_plane_stats_t s_stats;
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Destinos ---
+
+/**
+ * @brief Destino console: cada quadro vira uma linha `:DAT:<hex>` na UART de comandos.
+ *
+ * A linha é montada inteira e escrita com uma única chamada, para não se misturar
+ * com as respostas impressas pela task de comandos.
+ */
+static bool console_sink_write(void *ctx, const uint8_t *frame, size_t len) {
+    static char line[DATA_PLANE_MAX_LINE];
+    size_t line_len = data_plane_format_line(frame, len, line, sizeof(line));
+    if (line_len == 0) return false;
+    fwrite(line, 1, line_len, stdout);
+    fflush(stdout);
+    return true;
+}
+
+#if CONFIG_SERCALO_DATA_UART_ENABLE
+#if CONFIG_IDF_TARGET_LINUX
+
+static int s_data_fd = -1;
+
+static bool uart_sink_write(void *ctx, const uint8_t *frame, size_t len) {
+    while (len > 0) {
+        ssize_t written = write(s_data_fd, frame, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        frame += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+static esp_err_t data_uart_init(void) {
+    s_data_fd = open(CONFIG_SERCALO_DATA_PTY_PATH, O_WRONLY | O_NOCTTY);
+    if (s_data_fd < 0) {
+        ESP_LOGE(TAG, "Falha ao abrir %s: %s", CONFIG_SERCALO_DATA_PTY_PATH, strerror(errno));
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Plano de dados no pseudo-terminal %s", CONFIG_SERCALO_DATA_PTY_PATH);
+    return ESP_OK;
+}
+
+#else
+
+static bool uart_sink_write(void *ctx, const uint8_t *frame, size_t len) {
+    // O driver copia o quadro para o seu buffer de TX e a transmissão segue por
+    // interrupção; esta task só bloqueia se esse buffer estiver cheio.
+    return uart_write_bytes(CONFIG_SERCALO_DATA_UART_NUM, frame, len) == (int)len;
+}
+
+static esp_err_t data_uart_init(void) {
+    const uart_config_t uart_config = {
+        .baud_rate = CONFIG_SERCALO_DATA_UART_BAUDRATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    // O buffer de RX precisa ser maior que a FIFO de hardware, mesmo sem recepção.
+    esp_err_t ret = uart_driver_install(CONFIG_SERCALO_DATA_UART_NUM, 256, CONFIG_SERCALO_DATA_UART_TX_BUFFER_SIZE, 0, NULL, 0);
+    if (ret != ESP_OK) return ret;
+    ret = uart_param_config(CONFIG_SERCALO_DATA_UART_NUM, &uart_config);
+    if (ret != ESP_OK) return ret;
+    ret = uart_set_pin(CONFIG_SERCALO_DATA_UART_NUM, CONFIG_SERCALO_DATA_UART_TX_GPIO, CONFIG_SERCALO_DATA_UART_RX_GPIO,
+                       UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    if (ret != ESP_OK) return ret;
+    ESP_LOGI(TAG, "Plano de dados na UART%d (TX=GPIO%d, %d bps)", CONFIG_SERCALO_DATA_UART_NUM,
+             CONFIG_SERCALO_DATA_UART_TX_GPIO, CONFIG_SERCALO_DATA_UART_BAUDRATE);
+    return ESP_OK;
+}
+
+#endif
+#endif // CONFIG_SERCALO_DATA_UART_ENABLE
+
+// --- Funções Auxiliares Internas ---
+
+static void update_active_mask(void) {
+    uint32_t mask = 0;
+    for (int i = 0; i < DATA_PLANE_MAX_SINKS; i++) {
+        if (s_sinks[i].write != NULL) {
+            mask |= s_sinks[i].type_mask;
+        }
+    }
+    s_active_mask = mask;
+}
+
+/**
+ * @brief Task que entrega os quadros pendentes a cada destino interessado.
+ */
+static void data_plane_dispatch_task(void *pvParameters) {
+    static uint8_t frame[DATA_PLANE_MAX_FRAME];
+
+    while (1) {
+        size_t len = xMessageBufferReceive(s_frame_buffer, frame, sizeof(frame), portMAX_DELAY);
+        if (len < DATA_PLANE_HEADER_LEN + 1) {
+            continue;
+        }
+        uint32_t type_bit = DATA_PLANE_MASK(frame[2]);
+        uint32_t delivered = 0, errors = 0;
+
+        xSemaphoreTake(s_sinks_mutex, portMAX_DELAY);
+        for (int i = 0; i < DATA_PLANE_MAX_SINKS; i++) {
+            data_plane_sink_t *sink = &s_sinks[i];
+            if (sink->write == NULL || !(sink->type_mask & type_bit)) {
+                continue;
+            }
+            if (sink->write(sink->ctx, frame, len)) {
+                delivered++;
+            } else {
+                errors++;
+            }
+        }
+        xSemaphoreGive(s_sinks_mutex);
+
+        taskENTER_CRITICAL(&s_stats_spinlock);
+        s_stats.delivered += delivered;
+        s_stats.sink_errors += errors;
+        s_stats.bytes += (uint64_t)delivered * len;
+        taskEXIT_CRITICAL(&s_stats_spinlock);
+    }
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t data_plane_init(void) {
+    s_frame_buffer = xMessageBufferCreate(CONFIG_SERCALO_DATA_PLANE_BUFFER_SIZE);
+    s_publish_mutex = xSemaphoreCreateMutex();
+    s_sinks_mutex = xSemaphoreCreateMutex();
+    if (s_frame_buffer == NULL || s_publish_mutex == NULL || s_sinks_mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+#if CONFIG_SERCALO_DATA_UART_ENABLE
+    esp_err_t ret = data_uart_init();
+    if (ret == ESP_OK) {
+        data_plane_add_sink(uart_sink_write, NULL, DATA_PLANE_MASK_ALL);
+        s_uart_enabled = true;
+    } else {
+        ESP_LOGE(TAG, "UART de dados indisponível (%s). Use o comando 'stream' para o console.", esp_err_to_name(ret));
+    }
+#endif
+
+    // Prioridade abaixo da task de comandos: a telemetria nunca atrasa uma resposta.
+    if (xTaskCreate(data_plane_dispatch_task, "DataPlaneTask", 4096, NULL, 4, NULL) != pdPASS) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool data_plane_wants(data_plane_type_t type) {
+    return (s_active_mask & DATA_PLANE_MASK(type)) != 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t data_plane_publish(data_plane_type_t type, uint8_t channel, const void *payload, uint16_t len) {
+    if (s_frame_buffer == NULL) return ESP_ERR_INVALID_STATE;
+    if (len > DATA_PLANE_MAX_PAYLOAD) return ESP_ERR_INVALID_SIZE;
+    if (!data_plane_wants(type)) return ESP_OK;
+
+    uint8_t frame[DATA_PLANE_MAX_FRAME];
+    size_t frame_len = DATA_PLANE_HEADER_LEN + len + 1;
+
+    frame[0] = DATA_PLANE_SYNC_0;
+    frame[1] = DATA_PLANE_SYNC_1;
+    frame[2] = (uint8_t)type;
+    frame[3] = channel;
+    frame[6] = len & 0xFF;
+    frame[7] = len >> 8;
+    if (len > 0) {
+        memcpy(&frame[DATA_PLANE_HEADER_LEN], payload, len);
+    }
+
+    size_t sent;
+    xSemaphoreTake(s_publish_mutex, portMAX_DELAY);
+    // A numeração avança mesmo quando o quadro é descartado, para que o
+    // receptor perceba a lacuna.
+    frame[4] = s_next_seq & 0xFF;
+    frame[5] = s_next_seq >> 8;
+    s_next_seq++;
+    frame[frame_len - 1] = sercalo_calculate_crc8(&frame[2], frame_len - 3);
+    sent = xMessageBufferSend(s_frame_buffer, frame, frame_len, 0);
+    xSemaphoreGive(s_publish_mutex);
+
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    if (sent == frame_len) {
+        s_stats.published++;
+    } else {
+        s_stats.dropped++;
+    }
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+
+    return (sent == frame_len) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t data_plane_trace(uint8_t channel, const char *fmt, ...) {
+    if (!data_plane_wants(DATA_PLANE_TYPE_TRACE)) return ESP_OK;
+
+    char text[128];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    if (len < 0) return ESP_FAIL;
+    if (len >= (int)sizeof(text)) len = sizeof(text) - 1;
+
+    return data_plane_publish(DATA_PLANE_TYPE_TRACE, channel, text, (uint16_t)len);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int data_plane_add_sink(data_plane_write_fn_t write, void *ctx, uint32_t type_mask) {
+    if (write == NULL || s_sinks_mutex == NULL) return -1;
+
+    int id = -1;
+    xSemaphoreTake(s_sinks_mutex, portMAX_DELAY);
+    for (int i = 0; i < DATA_PLANE_MAX_SINKS; i++) {
+        if (s_sinks[i].write == NULL) {
+            s_sinks[i].write = write;
+            s_sinks[i].ctx = ctx;
+            s_sinks[i].type_mask = type_mask;
+            id = i;
+            break;
+        }
+    }
+    update_active_mask();
+    xSemaphoreGive(s_sinks_mutex);
+    return id;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void data_plane_remove_sink(int sink_id) {
+    if (sink_id < 0 || sink_id >= DATA_PLANE_MAX_SINKS || s_sinks_mutex == NULL) return;
+
+    // A task de despacho segura o mutex durante as entregas, então ao retornar
+    // nenhuma escrita para este destino está em andamento.
+    xSemaphoreTake(s_sinks_mutex, portMAX_DELAY);
+    s_sinks[sink_id].write = NULL;
+    s_sinks[sink_id].ctx = NULL;
+    s_sinks[sink_id].type_mask = 0;
+    update_active_mask();
+    xSemaphoreGive(s_sinks_mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t data_plane_format_line(const uint8_t *frame, size_t len, char *line, size_t line_len) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    size_t pos = 5;
+
+    if (line_len < 5 + 2 * len + 1) return 0;
+    memcpy(line, ":DAT:", 5);
+    for (size_t i = 0; i < len; i++) {
+        line[pos++] = hex_digits[frame[i] >> 4];
+        line[pos++] = hex_digits[frame[i] & 0x0F];
+    }
+    line[pos++] = '\n';
+    return pos;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void data_plane_set_console(bool enabled) {
+    if (enabled && s_console_sink_id < 0) {
+        s_console_sink_id = data_plane_add_sink(console_sink_write, NULL, DATA_PLANE_MASK_ALL);
+    } else if (!enabled && s_console_sink_id >= 0) {
+        data_plane_remove_sink(s_console_sink_id);
+        s_console_sink_id = -1;
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool data_plane_console_enabled(void) {
+    return s_console_sink_id >= 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool data_plane_uart_enabled(void) {
+    return s_uart_enabled;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void data_plane_get_stats(data_plane_stats_t *stats) {
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+}
@@ -0,0 +1,213 @@
+/**************************************************************************************************
+* Arquivo:      data_plane.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.2.1
+*
+* Descrição:    Plano de dados da aplicação. Telemetria de varredura, espectros e traces
+* são publicados como quadros binários e entregues de forma assíncrona aos
+* destinos registrados (UART dedicada, console, ...), sem disputar a UART de
+* comandos nem bloquear quem publica.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.2.0] - Quadro de ponto da varredura do espelho (raster).
+* [2026-10-18] - [Barino] - [0.2.1] - Formato do payload de espectro (`dp_spectrum_chunk_t`).
+*
+**************************************************************************************************/
+
+#ifndef DATA_PLANE_H
+#define DATA_PLANE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Formato do quadro (todos os campos multibyte em little-endian):
+ *
+ *   | 0xA5 | 0x5A | tipo | canal | seq (u16) | len (u16) | payload (len bytes) | CRC-8 |
+ *
+ * O CRC-8 (polinômio 0x07, o mesmo do protocolo I2C do TF1) cobre os bytes de
+ * `tipo` até o fim do payload.
+ */
+#define DATA_PLANE_SYNC_0           0xA5
+#define DATA_PLANE_SYNC_1           0x5A
+#define DATA_PLANE_HEADER_LEN       8
+#define DATA_PLANE_MAX_PAYLOAD      512
+#define DATA_PLANE_MAX_FRAME        (DATA_PLANE_HEADER_LEN + DATA_PLANE_MAX_PAYLOAD + 1)
+#define DATA_PLANE_MAX_LINE         (5 + 2 * DATA_PLANE_MAX_FRAME + 1) // Quadro como linha `:DAT:<hex>\n`
+#define DATA_PLANE_NO_CHANNEL       0xFF        // Valor de `canal` para quadros que não pertencem a um canal.
+#define DATA_PLANE_MAX_SINKS        8
+
+/**
+ * @brief Tipos de quadro do plano de dados.
+ */
+typedef enum {
+    DATA_PLANE_TYPE_SWEEP_STEP = 0x01,  /*!< Um passo de varredura (`dp_sweep_step_t`). */
+    DATA_PLANE_TYPE_SPECTRUM   = 0x02,  /*!< Trecho do espectro de um ciclo (`dp_spectrum_chunk_t`). */
+    DATA_PLANE_TYPE_TRACE      = 0x03,  /*!< Texto de diagnóstico (UTF-8, sem terminador). */
+    DATA_PLANE_TYPE_RASTER_POINT = 0x04, /*!< Um ponto da varredura do espelho (`dp_raster_point_t`). */
+} data_plane_type_t;
+
+/** @brief Máscara de tipo para registro de destinos. */
+#define DATA_PLANE_MASK(type)       (1u << (type))
+#define DATA_PLANE_MASK_ALL         0xFFFFFFFFu
+
+/**
+ * @struct dp_sweep_step_t
+ * @brief  Payload de um quadro DATA_PLANE_TYPE_SWEEP_STEP.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_ms;  /*!< Instante do passo, em ms desde o boot. */
+    uint32_t cycle;         /*!< Número do ciclo de varredura (0 no primeiro). */
+    uint16_t step;          /*!< Índice do passo dentro do ciclo. */
+    float    target_wl;     /*!< Comprimento de onda comandado (nm). */
+} dp_sweep_step_t;
+
+/**
+ * @struct dp_spectrum_chunk_t
+ * @brief  Cabeçalho do payload de um quadro DATA_PLANE_TYPE_SPECTRUM. Um espectro
+ *         de `total` pontos é enviado em trechos; cada um traz as amostras
+ *         `first` a `first + n - 1` (u16, little-endian) logo após o cabeçalho,
+ *         com `n = (len - sizeof(dp_spectrum_chunk_t)) / 2`. O ponto `i` está em
+ *         `start_wl + i * step_wl`.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t cycle;         /*!< Número do ciclo de varredura. */
+    float    start_wl;      /*!< Comprimento de onda do ponto 0 (nm). */
+    float    step_wl;       /*!< Passo entre pontos (nm). */
+    uint16_t first;         /*!< Índice da primeira amostra deste trecho. */
+    uint16_t total;         /*!< Número de pontos do espectro completo. */
+} dp_spectrum_chunk_t;
+
+#define DP_SPECTRUM_MAX_SAMPLES     ((DATA_PLANE_MAX_PAYLOAD - sizeof(dp_spectrum_chunk_t)) / 2)
+
+/** @brief Bits de `dp_raster_point_t.flags`. */
+#define DP_RASTER_FLAG_READBACK     0x01    /*!< `readback` é válido. */
+#define DP_RASTER_FLAG_ADC          0x02    /*!< `adc` é válido. */
+#define DP_RASTER_FLAG_ERROR        0x04    /*!< O filtro recusou ou não respondeu ao SET. */
+
+/**
+ * @struct dp_raster_point_t
+ * @brief  Payload de um quadro DATA_PLANE_TYPE_RASTER_POINT. Os atuadores seguem a
+ *         ordem de `sercalo_mirror_pos_t` (x_neg, x_pos, y_neg, y_pos).
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_ms;  /*!< Instante do ponto, em ms desde o boot. */
+    uint32_t pass;          /*!< Número da passagem pela grade (0 na primeira). */
+    uint16_t row;           /*!< Índice no eixo lento. */
+    uint16_t col;           /*!< Índice no eixo rápido. */
+    uint16_t target[4];     /*!< Valores comandados (SET). */
+    uint16_t readback[4];   /*!< Posição lida (POS), se DP_RASTER_FLAG_READBACK. */
+    uint16_t adc;           /*!< Fotodetector, se DP_RASTER_FLAG_ADC. */
+    uint8_t  flags;         /*!< DP_RASTER_FLAG_*. */
+} dp_raster_point_t;
+
+/**
+ * @brief Função de escrita de um destino. Deve enviar o quadro completo.
+ * @return true se o quadro foi aceito pelo destino.
+ */
+typedef bool (*data_plane_write_fn_t)(void *ctx, const uint8_t *frame, size_t len);
+
+/**
+ * @struct data_plane_stats_t
+ * @brief  Contadores do plano de dados.
+ */
+typedef struct {
+    uint32_t published;     /*!< Quadros aceitos no buffer de despacho. */
+    uint32_t dropped;       /*!< Quadros descartados por buffer cheio. */
+    uint32_t delivered;     /*!< Entregas bem-sucedidas (um quadro conta uma vez por destino). */
+    uint32_t sink_errors;   /*!< Entregas recusadas pelos destinos. */
+    uint64_t bytes;         /*!< Bytes entregues aos destinos. */
+} data_plane_stats_t;
+
+/**
+ * @brief Inicializa o plano de dados, a UART dedicada (se habilitada) e a task de despacho.
+ * @return ESP_OK em sucesso, ou um código de erro.
+ */
+esp_err_t data_plane_init(void);
+
+/**
+ * @brief Publica um quadro. Nunca bloqueia: se o buffer estiver cheio, o quadro é descartado.
+ *
+ * Se nenhum destino registrado aceita o tipo, a chamada retorna imediatamente
+ * sem montar o quadro.
+ *
+ * @param type Tipo do quadro.
+ * @param channel Índice do canal (0 = C, 1 = L) ou DATA_PLANE_NO_CHANNEL.
+ * @param payload Dados do quadro.
+ * @param len Tamanho do payload (até DATA_PLANE_MAX_PAYLOAD).
+ * @return ESP_OK se publicado ou se não há interessados.
+ * @return ESP_ERR_INVALID_SIZE se o payload for grande demais.
+ * @return ESP_ERR_NO_MEM se o quadro foi descartado.
+ */
+esp_err_t data_plane_publish(data_plane_type_t type, uint8_t channel, const void *payload, uint16_t len);
+
+/**
+ * @brief Publica um quadro de trace formatado ao estilo printf.
+ */
+esp_err_t data_plane_trace(uint8_t channel, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Indica se algum destino aceita o tipo (permite evitar trabalho de preparação).
+ */
+bool data_plane_wants(data_plane_type_t type);
+
+/**
+ * @brief Registra um destino de quadros.
+ * @param write Função de escrita.
+ * @param ctx Contexto repassado à função.
+ * @param type_mask Tipos aceitos (DATA_PLANE_MASK(...)).
+ * @return Identificador do destino (>= 0) ou -1 se não houver espaço.
+ */
+int data_plane_add_sink(data_plane_write_fn_t write, void *ctx, uint32_t type_mask);
+
+/**
+ * @brief Remove um destino. Ao retornar, o destino não será mais chamado.
+ */
+void data_plane_remove_sink(int sink_id);
+
+/**
+ * @brief Formata um quadro como linha de texto `:DAT:<hex>\n`, para links que transportam texto.
+ * @param frame Quadro completo.
+ * @param len Tamanho do quadro.
+ * @param[out] line Buffer de destino (ao menos 5 + 2 * len + 1 bytes; DATA_PLANE_MAX_LINE basta).
+ * @param line_len Tamanho do buffer de destino.
+ * @return Tamanho da linha, ou 0 se o buffer for pequeno demais.
+ */
+size_t data_plane_format_line(const uint8_t *frame, size_t len, char *line, size_t line_len);
+
+/**
+ * @brief Habilita ou desabilita a cópia dos quadros para o console (linhas `:DAT:<hex>`).
+ */
+void data_plane_set_console(bool enabled);
+
+/**
+ * @brief Indica se a cópia para o console está habilitada.
+ */
+bool data_plane_console_enabled(void);
+
+/**
+ * @brief Indica se a UART dedicada ao plano de dados está ativa.
+ */
+bool data_plane_uart_enabled(void);
+
+/**
+ * @brief Copia os contadores atuais.
+ */
+void data_plane_get_stats(data_plane_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DATA_PLANE_H
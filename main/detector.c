@@ -0,0 +1,80 @@
+/**************************************************************************************************
+* Arquivo:      detector.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Implementação da leitura do fotodetector pelo ADC1 (modo oneshot).
+*
+* Plataforma:   ESP32
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "detector.h"
+
+#if CONFIG_SERCALO_DETECTOR_ADC_ENABLE
+
+#include "esp_log.h"
+#include "esp_adc/adc_oneshot.h"
+
+static const char *TAG = "DETECTOR";
+
+static adc_oneshot_unit_handle_t s_adc_handle = NULL;
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t detector_init(void) {
+    const adc_oneshot_unit_init_cfg_t unit_config = {
+        .unit_id = ADC_UNIT_1,
+    };
+    esp_err_t ret = adc_oneshot_new_unit(&unit_config, &s_adc_handle);
+    if (ret != ESP_OK) return ret;
+
+    const adc_oneshot_chan_cfg_t channel_config = {
+        .atten = ADC_ATTEN_DB_12,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    ret = adc_oneshot_config_channel(s_adc_handle, CONFIG_SERCALO_DETECTOR_ADC_CHANNEL, &channel_config);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Detector no ADC1, canal %d.", CONFIG_SERCALO_DETECTOR_ADC_CHANNEL);
+    }
+    return ret;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t detector_read(uint16_t *raw) {
+    int value;
+    if (s_adc_handle == NULL) return ESP_ERR_INVALID_STATE;
+    esp_err_t ret = adc_oneshot_read(s_adc_handle, CONFIG_SERCALO_DETECTOR_ADC_CHANNEL, &value);
+    if (ret == ESP_OK) {
+        *raw = (uint16_t)value;
+    }
+    return ret;
+}
+
+#else
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t detector_init(void) {
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t detector_read(uint16_t *raw) {
+    *raw = DETECTOR_NO_SAMPLE;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_SERCALO_DETECTOR_ADC_ENABLE
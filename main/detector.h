@@ -0,0 +1,49 @@
+/**************************************************************************************************
+* Arquivo:      detector.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Leitura opcional de um fotodetector externo pelo ADC do ESP32. A placa
+* não tem detector; com CONFIG_SERCALO_DETECTOR_ADC_ENABLE, um canal do
+* ADC1 é amostrado a cada passo de varredura.
+*
+* Plataforma:   ESP32
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DETECTOR_NO_SAMPLE          0xFFFF      // Valor registrado quando não há detector.
+
+/**
+ * @brief Configura o canal do ADC (se habilitado).
+ * @return ESP_OK em sucesso ou se o detector está desabilitado.
+ */
+esp_err_t detector_init(void);
+
+/**
+ * @brief Lê o valor bruto do detector.
+ * @param[out] raw Valor do ADC (12 bits).
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_NOT_SUPPORTED se o detector está desabilitado.
+ */
+esp_err_t detector_read(uint16_t *raw);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DETECTOR_H
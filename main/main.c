@@ -1,8 +1,8 @@
 /**************************************************************************************************
 * Arquivo:      sercalo_i2c.c
 * Autor:        Felipe Oliveira Barino
-* Data:         2024-07-22
-* Versão:       1.0.0
+* Data:         2026-10-18
+* Versão:       1.16.0
 *
 * Descrição:    Implementação das funções de driver para comunicação I2C com o
 * Filtro Óptico Sintonizável Sercalo TF1.
@@ -19,18 +19,56 @@
 * 2024-07-17 - Barino - 0.1.0 - Versão inicial (sem testes)
 * 2024-07-18 - Barino - 0.1.1 - Documentação e comentários
 * 2024-07-22 - Barino - 1.0.0 - Mínima versão funcional
+* 2026-10-18 - Barino - 1.1.0 - Plano de dados (UART dedicada), comando stream e filtros simulados
+* 2026-10-18 - Barino - 1.2.0 - Fila de comandos com origens (UART, TCP) e servidor TCP multi-cliente
+* 2026-10-18 - Barino - 1.3.0 - Streaming UDP do plano de dados com reenvio de lacunas (comando udp)
+* 2026-10-18 - Barino - 1.4.0 - Registro das varreduras em flash (LittleFS), comando log e detector opcional
+* 2026-10-18 - Barino - 1.5.0 - Escritor de respostas tipado (texto, kv, JSON) e comando format
+* 2026-10-18 - Barino - 1.6.0 - Planejador de movimentos (saltos moldados, estabilização por POS) e comando move
+* 2026-10-18 - Barino - 1.7.0 - Modelo preditivo de estabilização, passo automático na varredura e comando settle
+* 2026-10-18 - Barino - 1.8.0 - Varredura direta do espelho (raster) com quadros pré-codificados e comando raster
+* 2026-10-18 - Barino - 1.9.0 - Repouso automático dos filtros por inatividade com despertar antecipado
+* 2026-10-18 - Barino - 1.10.0 - Comando characterize (latências, estabilização e taxa máxima de passos)
+* 2026-10-18 - Barino - 1.11.0 - Passos de varredura escalonados por EDF, parada cooperativa da varredura e sweep?
+* 2026-10-18 - Barino - 1.12.0 - Orçamento do barramento com admissão de varreduras e rasters e comando budget
+* 2026-10-18 - Barino - 1.13.0 - Atualização dos parâmetros da varredura em andamento, sem recriar a task
+* 2026-10-18 - Barino - 1.14.0 - Verificação por leitura de volta no set-wl e nas varreduras e comando verify
+* 2026-10-18 - Barino - 1.15.0 - Etiquetas de comando repetidas nas respostas (clientes com vários comandos pendentes)
+* 2026-10-18 - Barino - 1.16.0 - Métricas de saúde (latências, erros do barramento, passos atrasados) e comando metrics
 * 
 **************************************************************************************************/
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
-#include "driver/i2c.h"
 #include "sercalo_i2c.h" // Inclui o driver de baixo nível do dispositivo Sercalo
+#include "monotonic_clock.h" // Relógio monotônico comum (monotonic_us)
+#include "command.h"     // Fila de comandos e origens (UART, TCP)
+#include "response.h"    // Escritor de respostas (texto, chave=valor, JSON)
+#include "data_plane.h"  // Telemetria (UART dedicada ou console)
+#include "tcp_server.h"  // Servidor TCP de controle (opcional)
+#include "udp_stream.h"  // Streaming UDP do plano de dados (opcional)
+#include "sweep_log.h"   // Registro das varreduras em flash (opcional)
+#include "detector.h"    // Fotodetector no ADC (opcional)
+#include "move_planner.h" // Saltos moldados e detecção de estabilização (opcional)
+#include "settle_model.h" // Modelo do tempo de estabilização (opcional)
+#include "raster.h"      // Varredura direta do espelho (opcional)
+#include "power_manager.h" // Repouso automático dos filtros (opcional)
+#include "characterize.h" // Autocaracterização dos filtros (opcional)
+#include "bus_sched.h"    // Escalonamento EDF dos passos de varredura (opcional)
+#include "bus_budget.h"   // Orçamento de ocupação do barramento (opcional)
+#include "verify.h"       // Verificação dos comprimentos de onda comandados (opcional)
+#include "metrics.h"      // Métricas de saúde para monitoramento (opcional)
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/uart_vfs.h" // Fim de linha do console durante blocos binários
+#endif
 
 // --- Configurações do Barramento I2C ---
 #define I2C_MASTER_SCL_IO           22          // Pino GPIO para o clock I2C (SCL)
@@ -43,8 +81,17 @@
 #define L_BAND_FILTER_ADDR          0x7F        // Endereço I2C do filtro da Banda L
 
 // --- Definições de Buffers ---
-#define CMD_BUFFER_SIZE             128         // Tamanho máximo do buffer para comandos recebidos via UART.
-#define RESPONSE_DATA_BUFFER_SIZE   256         // Tamanho máximo do buffer para respostas de comandos.
+#define RESPONSE_DATA_BUFFER_SIZE   512         // Tamanho máximo dos dados de uma resposta (maiores são recusadas com ESP_ERR_INVALID_SIZE).
+#define RESPONSE_ACK_PREFIX_MAX_LEN (sizeof(":ACK@: ") - 1 + COMMAND_TAG_MAX) // Prefixo com a maior etiqueta.
+#define RESPONSE_LINE_BUFFER_SIZE   (RESPONSE_DATA_BUFFER_SIZE + 32) // Resposta com prefixo (:ACK:/:NACK:) e terminador.
+
+// --- Varredura ---
+#define SWEEP_STOP_POLL_MS          10          // Intervalo de verificação do fim da task ao parar uma varredura.
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+#define SWEEP_SLACK_PCT             CONFIG_SERCALO_SWEEP_SLACK_PCT
+#else
+#define SWEEP_SLACK_PCT             10          // Sem EDF, a folga só define os passos atrasados (metrics).
+#endif
 
 // --- Variáveis Globais ---
 static const char *TAG = "SERCALO_FILTER_APP";
@@ -56,24 +103,46 @@ static const char *TAG = "SERCALO_FILTER_APP";
 typedef struct {
     sercalo_dev_t device_handle;    /*!< Handle para o driver de baixo nível do dispositivo Sercalo. */
     char name[2];                   /*!< Nome do canal para identificação ("C" ou "L"). */
+    const char *label;              /*!< Rótulo do canal nas respostas em texto ("Canal C"). */
     TaskHandle_t sweep_task_handle; /*!< Handle para a task de sweep, se ativa. NULL caso contrário. */
+    volatile bool sweep_stop;       /*!< Pedido de parada da task de sweep (atendido entre passos). */
+    volatile bool sweep_running;    /*!< A task de sweep ainda não terminou. */
+    float last_wl;                  /*!< Último comprimento de onda aplicado (NaN se desconhecido). */
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    settle_model_t settle_model;    /*!< Tempo de estabilização previsto para este filtro. */
+#endif
 } filter_channel_t;
 
 // Array global contendo os dois canais de filtro.
 static filter_channel_t g_filter_channels[2]; // Posição 0: Banda C, Posição 1: Banda L
 
+/**
+ * @struct command_request_t
+ * @brief  Um comando aguardando execução, com a origem que receberá a resposta.
+ */
+typedef struct {
+    char line[CMD_BUFFER_SIZE];         /*!< Comando sem o ':' inicial e sem o terminador. */
+    const command_source_t *source;     /*!< Origem do comando (para onde vai a resposta). */
+    void *ctx;                          /*!< Contexto da origem. */
+    char tag[COMMAND_TAG_MAX + 2];      /*!< "@<etiqueta>" repetida na resposta, ou vazia. */
+    bool replied;                       /*!< O handler já enviou a resposta (bloco binário). */
+    bool stream_suspended;              /*!< Plano de dados suspenso durante um bloco binário. */
+#if CONFIG_SERCALO_METRICS_ENABLE
+    int64_t queued_us;                  /*!< Entrada na fila (monotonic_us). */
+#endif
+} command_request_t;
+
 // --- Primitivas de Sincronização e Comunicação Inter-Task ---
-static char g_received_cmd_buffer[CMD_BUFFER_SIZE];                             /*!< Buffer global para armazenar o último comando recebido da UART. */
+static QueueHandle_t g_command_queue;                                           /*!< Fila de comandos recebidos de todas as origens. */
 static SemaphoreHandle_t g_command_mutex;                                       /*!< Mutex para garantir acesso exclusivo aos periféricos I2C, evitando colisões. */
-static TaskHandle_t g_command_processor_task_handle = NULL;                     /*!< Handle da task processadora de comandos, para notificação. */
-static portMUX_TYPE g_command_buffer_spinlock = portMUX_INITIALIZER_UNLOCKED;   /*!< Spinlock de baixo nível (mux) para proteger o acesso ao buffer global g_received_cmd_buffer. */
+static command_request_t *g_current_request = NULL;                             /*!< Comando em execução (acessado apenas pela task de comandos). */
 
 // --- Estrutura para Tabela de Despacho de Comandos (Command Dispatcher) ---
 
 /**
  * @brief  Define a assinatura padrão para todas as funções que manipulam um comando. 
  */
-typedef esp_err_t (*command_handler_t)(char *args, char *response_buf, size_t response_buf_len);
+typedef esp_err_t (*command_handler_t)(char *args, response_writer_t *resp);
 
 /**
  * @struct command_entry_t
@@ -82,26 +151,87 @@ typedef esp_err_t (*command_handler_t)(char *args, char *response_buf, size_t re
 typedef struct {
     const char *command_name;       /*!< A string exata que aciona o comando. */
     command_handler_t handler;      /*!< Ponteiro para a função que executa a lógica do comando. */
+    uint8_t flags;                  /*!< COMMAND_FLAG_*. */
 } command_entry_t;
 
+#define COMMAND_FLAG_USES_CHANNEL   0x01    // Opera o filtro da banda indicada nos argumentos (despertar antecipado).
+
 // Protótipos dos Handlers de Comando
-esp_err_t handle_get_iden(char *args, char *response_buf, size_t response_buf_len);
-esp_err_t handle_get_interval(char *args, char *response_buf, size_t response_buf_len);
-esp_err_t handle_get_wl(char *args, char *response_buf, size_t response_buf_len);
-esp_err_t handle_set_wl(char *args, char *response_buf, size_t response_buf_len);
-esp_err_t handle_sweep(char *args, char *response_buf, size_t response_buf_len);
-esp_err_t handle_powerup(char *args, char *response_buf, size_t response_buf_len);
-esp_err_t handle_get_power(char *args, char *response_buf, size_t response_buf_len);
+esp_err_t handle_get_iden(char *args, response_writer_t *resp);
+esp_err_t handle_get_interval(char *args, response_writer_t *resp);
+esp_err_t handle_get_wl(char *args, response_writer_t *resp);
+esp_err_t handle_set_wl(char *args, response_writer_t *resp);
+esp_err_t handle_sweep(char *args, response_writer_t *resp);
+esp_err_t handle_powerup(char *args, response_writer_t *resp);
+esp_err_t handle_get_power(char *args, response_writer_t *resp);
+esp_err_t handle_stream(char *args, response_writer_t *resp);
+esp_err_t handle_format(char *args, response_writer_t *resp);
+#if CONFIG_SERCALO_UDP_STREAM_ENABLE
+esp_err_t handle_udp(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_LOG_ENABLE
+esp_err_t handle_log(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+esp_err_t handle_move(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+esp_err_t handle_settle(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_RASTER_ENABLE
+esp_err_t handle_raster(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_CHARACTERIZE_ENABLE
+esp_err_t handle_characterize(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+esp_err_t handle_budget(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_VERIFY_ENABLE
+esp_err_t handle_verify(char *args, response_writer_t *resp);
+#endif
+#if CONFIG_SERCALO_METRICS_ENABLE
+esp_err_t handle_metrics(char *args, response_writer_t *resp);
+#endif
 
 // Tabela de Comandos: adicionar novas linhas com comando e sua função.
 static const command_entry_t command_table[] = {
     {"iden", handle_get_iden},
     {"get-interval", handle_get_interval},
-    {"get-wl", handle_get_wl},
-    {"set-wl", handle_set_wl},
-    {"sweep", handle_sweep},
+    {"get-wl", handle_get_wl, COMMAND_FLAG_USES_CHANNEL},
+    {"set-wl", handle_set_wl, COMMAND_FLAG_USES_CHANNEL},
+    {"sweep", handle_sweep, COMMAND_FLAG_USES_CHANNEL},
     {"powerup", handle_powerup},
     {"get-power", handle_get_power},
+    {"stream", handle_stream},
+    {"format", handle_format},
+#if CONFIG_SERCALO_UDP_STREAM_ENABLE
+    {"udp", handle_udp},
+#endif
+#if CONFIG_SERCALO_LOG_ENABLE
+    {"log", handle_log},
+#endif
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+    {"move", handle_move, COMMAND_FLAG_USES_CHANNEL},
+#endif
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    {"settle", handle_settle},
+#endif
+#if CONFIG_SERCALO_RASTER_ENABLE
+    {"raster", handle_raster, COMMAND_FLAG_USES_CHANNEL},
+#endif
+#if CONFIG_SERCALO_CHARACTERIZE_ENABLE
+    {"characterize", handle_characterize, COMMAND_FLAG_USES_CHANNEL},
+#endif
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    {"budget", handle_budget},
+#endif
+#if CONFIG_SERCALO_VERIFY_ENABLE
+    {"verify", handle_verify},
+#endif
+#if CONFIG_SERCALO_METRICS_ENABLE
+    {"metrics", handle_metrics},
+#endif
 };
 // Calcula o número de comandos na tabela em tempo de compilação.
 static const int num_commands = sizeof(command_table) / sizeof(command_entry_t);
@@ -124,15 +254,32 @@ static filter_channel_t* select_filter_channel(const char band_char) {
 }
 
 /**
- * @brief Para e deleta uma tarefa de sweep, se ela estiver ativa para um determinado canal.
+ * @brief Para uma tarefa de sweep, se ela estiver ativa para um determinado canal.
+ *
+ * A parada é cooperativa: a task termina o passo em andamento e sai sozinha,
+ * nunca com o mutex do barramento tomado. A espera entre passos é interrompida.
+ * A varredura direta do espelho (raster) do canal também é parada.
  * @param channel Ponteiro para o canal de filtro cuja tarefa de sweep deve ser parada.
  */
 static void stop_sweep_if_active(filter_channel_t *channel) {
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    power_manager_set_busy((uint8_t)(channel - g_filter_channels), false);
+#endif
     if (channel->sweep_task_handle != NULL) {
         ESP_LOGI(TAG, "Parando task de sweep para o canal %s", channel->name);
-        vTaskDelete(channel->sweep_task_handle);
+        channel->sweep_stop = true;
+        xTaskNotifyGive(channel->sweep_task_handle);
+        while (channel->sweep_running) {
+            vTaskDelay(pdMS_TO_TICKS(SWEEP_STOP_POLL_MS));
+        }
         channel->sweep_task_handle = NULL;
     }
+#if CONFIG_SERCALO_RASTER_ENABLE
+    raster_stop((uint8_t)(channel - g_filter_channels));
+#endif
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    bus_budget_release((uint8_t)(channel - g_filter_channels));
+#endif
 }
 
 /**
@@ -142,11 +289,17 @@ static void stop_sweep_if_active(filter_channel_t *channel) {
  * em baixo consumo (idle), ela envia o comando para ativar o modo normal
  * e aguarda um tempo para a estabilização do dispositivo.
  *
+ * Com o repouso automático, o estado é acompanhado pelo gerenciador de energia:
+ * com o filtro sabidamente ligado, não há transações no barramento.
+ *
  * @param channel Ponteiro para o canal de filtro a ser verificado e ativado.
  * @return ESP_OK se o canal está ou foi colocado com sucesso em modo normal.
  * @return ESP_FAIL se a comunicação ou ativação falhar.
  */
 static esp_err_t ensure_power_on(filter_channel_t *channel) {
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    return power_manager_ensure_awake((uint8_t)(channel - g_filter_channels));
+#else
     sercalo_power_mode_t current_mode;
     esp_err_t ret;
 
@@ -171,8 +324,133 @@ static esp_err_t ensure_power_on(filter_channel_t *channel) {
     }
 
     return ESP_OK;
+#endif
+}
+
+/**
+ * @brief Espera dentro de uma task de varredura; um pedido de parada (notificação) a interrompe.
+ */
+static void sweep_sleep(TickType_t ticks) {
+    ulTaskNotifyTake(pdTRUE, ticks);
+}
+
+/**
+ * @brief Toma o barramento para um passo de varredura.
+ *
+ * Com o escalonamento EDF, o passo, liberado agora, concorre com os passos das
+ * outras varreduras pelo prazo: liberação + CONFIG_SERCALO_SWEEP_SLACK_PCT da
+ * permanência no passo anterior (`dwell_ms`). Com as métricas, a espera entra no
+ * histograma do canal, e a que excede a folga conta como passo atrasado.
+ * @return true com o mutex tomado; false se a varredura foi parada durante a espera.
+ */
+static bool sweep_bus_take(filter_channel_t *channel, uint32_t dwell_ms) {
+    uint32_t slack_ms = dwell_ms * SWEEP_SLACK_PCT / 100;
+#if CONFIG_SERCALO_METRICS_ENABLE
+    int64_t release_us = monotonic_us();
+#endif
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+    bool taken = bus_sched_acquire((uint8_t)(channel - g_filter_channels), monotonic_us(), slack_ms,
+                                   &channel->sweep_stop) == ESP_OK;
+#else
+    bool taken = xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE;
+#endif
+#if CONFIG_SERCALO_METRICS_ENABLE
+    if (taken) {
+        uint32_t lateness_us = (uint32_t)(monotonic_us() - release_us);
+        metrics_sweep_step((uint8_t)(channel - g_filter_channels), lateness_us, lateness_us > slack_ms * 1000);
+    }
+#endif
+    (void)slack_ms;
+    return taken;
+}
+
+static void sweep_bus_give(filter_channel_t *channel) {
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+    bus_sched_release((uint8_t)(channel - g_filter_channels));
+#else
+    xSemaphoreGive(g_command_mutex);
+#endif
+}
+
+#if CONFIG_SERCALO_VERIFY_ENABLE
+/**
+ * @brief Acesso ao barramento da leitura de volta de um passo de varredura.
+ */
+typedef struct {
+    filter_channel_t *channel;
+    int64_t deadline_us;        /*!< Liberação do próximo passo. */
+} sweep_verify_bus_t;
+
+static bool sweep_verify_take(void *ctx) {
+    sweep_verify_bus_t *bus = ctx;
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+    // Concorre com os passos das outras varreduras pelo prazo: o próximo passo deste canal.
+    return bus_sched_acquire_until((uint8_t)(bus->channel - g_filter_channels), bus->deadline_us,
+                                   &bus->channel->sweep_stop) == ESP_OK;
+#else
+    return !bus->channel->sweep_stop && xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE;
+#endif
+}
+
+static void sweep_verify_give(void *ctx) {
+    sweep_bus_give(((sweep_verify_bus_t *)ctx)->channel);
+}
+
+/**
+ * @brief Verifica o passo `step` durante a sua permanência `dwell_ms`.
+ *
+ * A leitura de volta ocupa a permanência, sem encurtá-la nem alongá-la: o
+ * próximo passo é liberado `dwell_ms` após o início, descontado o tempo da
+ * verificação. No modo WVL, a consulta é feita logo após o passo; no modo
+ * POS, que compara leituras do espelho já parado, começa `verify_cost_ms`
+ * antes do fim. Cada transação toma o barramento como um passo da varredura.
+ * @return O restante da permanência.
+ */
+static uint32_t sweep_verify_step(filter_channel_t *channel, uint16_t step, float target_wl, uint32_t dwell_ms) {
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+    int64_t start_us = monotonic_us();
+    sweep_verify_bus_t bus_ctx = { .channel = channel, .deadline_us = start_us + (int64_t)dwell_ms * 1000 };
+    const verify_bus_t bus = { .take = sweep_verify_take, .give = sweep_verify_give, .ctx = &bus_ctx };
+
+    if (verify_get_mode(channel_index) == VERIFY_MODE_POS) {
+        uint32_t verify_ms = verify_cost_ms(channel_index);
+        if (dwell_ms > verify_ms) sweep_sleep(pdMS_TO_TICKS(dwell_ms - verify_ms));
+        if (channel->sweep_stop) return 0;
+    }
+    verify_result_t verified;
+    if (verify_check(&channel->device_handle, channel_index, target_wl, &bus, &verified) == ESP_OK && !verified.passed) {
+        data_plane_trace(channel_index, "sweep %s: passo %u (%.3f nm) não verificado, erro %lu após %u leituras",
+                         channel->name, step, target_wl, (unsigned long)verified.error, verified.attempts);
+    }
+    uint32_t elapsed_ms = (uint32_t)((monotonic_us() - start_us) / 1000);
+    return (elapsed_ms < dwell_ms) ? dwell_ms - elapsed_ms : 0;
 }
+#endif
 
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+/**
+ * @brief Aguarda a estabilização de um passo enviado em `sent_us`.
+ *
+ * Normalmente, apenas espera o tempo previsto pelo modelo do canal, sem
+ * transações no barramento. Alguns passos (ver settle_model_should_probe) são
+ * medidos pela leitura de POS; a medida atualiza o modelo e o erro de previsão.
+ */
+static void wait_step_settled(filter_channel_t *channel, float jump_nm, int64_t sent_us, uint32_t step) {
+    settle_model_t *model = &channel->settle_model;
+
+    if (settle_model_should_probe(model, jump_nm, step)) {
+        uint32_t settle_ms;
+        if (move_planner_wait_settled(&channel->device_handle, sent_us, &settle_ms) == ESP_OK) {
+            settle_model_observe(model, jump_nm, settle_ms);
+        }
+        return;
+    }
+    int64_t wait_us = sent_us + (int64_t)settle_model_predict_ms(model, jump_nm) * 1000 - monotonic_us();
+    if (wait_us > 0) {
+        sweep_sleep(pdMS_TO_TICKS((wait_us + 999) / 1000) + 1); // Arredonda para cima: nunca antes da previsão.
+    }
+}
+#endif
 
 // --- Tasks ---
 
@@ -188,18 +466,77 @@ typedef struct {
     int time_interval_ms;
 } sweep_params_t;
 
+/**
+ * @brief Limite em que uma atualização da varredura em andamento é aplicada.
+ */
+typedef enum {
+    SWEEP_SWAP_STEP = 0,            /*!< "passo": ao fim da permanência no passo atual. */
+    SWEEP_SWAP_CYCLE,               /*!< "ciclo": ao fim do ciclo atual. */
+} sweep_swap_t;
+
+/**
+ * @struct sweep_update_t
+ * @brief  Segundo buffer de parâmetros de um canal: escrito pelo comando `sweep`
+ *         e trocado pela task no limite pedido, sem recriá-la.
+ */
+typedef struct {
+    sweep_params_t params;
+    sweep_swap_t boundary;
+    TickType_t requested;           /*!< Instante do pedido (latência da troca). */
+    bool pending;
+    uint32_t swaps;                 /*!< Trocas aplicadas desde o início da varredura. */
+    uint32_t last_latency_ms;       /*!< Do pedido até a troca, na última troca. */
+} sweep_update_t;
+
+static sweep_params_t s_sweep_params[2];    /*!< Parâmetros iniciais, até a task copiá-los. */
+static sweep_update_t s_sweep_updates[2];
+static portMUX_TYPE s_sweep_update_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Aplica a atualização pendente do canal, se pedida para este limite.
+ *
+ * Uma troca pedida para o próximo passo também é aplicada ao fim do ciclo.
+ * @return true se `params` foi substituído.
+ */
+static bool sweep_swap_params(uint8_t channel_index, sweep_swap_t boundary, sweep_params_t *params) {
+    sweep_update_t *update = &s_sweep_updates[channel_index];
+    bool swapped = false;
+
+    taskENTER_CRITICAL(&s_sweep_update_lock);
+    if (update->pending && (update->boundary == SWEEP_SWAP_STEP || boundary == SWEEP_SWAP_CYCLE)) {
+        *params = update->params;
+        update->pending = false;
+        update->swaps++;
+        update->last_latency_ms = (uint32_t)((xTaskGetTickCount() - update->requested) * portTICK_PERIOD_MS);
+        swapped = true;
+    }
+    taskEXIT_CRITICAL(&s_sweep_update_lock);
+    return swapped;
+}
+
 /**
  * @brief Task que realiza uma varredura contínua de comprimento de onda.
  *
  * Esta tarefa entra em um loop infinito, varrendo de um `min_wl` a um `max_wl`
  * com um passo e atraso definidos. A tarefa é criada pelo comando 'sweep' e
- * destruída pelos comandos 'set-wl' ou por um novo comando 'sweep' no mesmo canal.
+ * termina, ao fim do passo em andamento, quando `stop_sweep_if_active` pede a
+ * parada (comandos 'set-wl', 'move', 'raster' ou um novo 'sweep' no mesmo canal).
+ * Cada passo aplicado é publicado no plano de dados (`DATA_PLANE_TYPE_SWEEP_STEP`).
+ * Com o planejador de movimentos, o retorno ao início de cada ciclo é um salto
+ * moldado, e o primeiro passo só é registrado com o espelho estável. Com o
+ * modelo de estabilização e `time_interval_ms` 0, cada passo é registrado (e o
+ * próximo enviado) assim que o modelo prevê o espelho estável.
+ * Novos parâmetros (comando `sweep` com `passo` ou `ciclo`) são trocados ao fim
+ * da permanência no passo ou ao fim do ciclo; na troca a cada passo, a varredura
+ * continua da posição atual, com o novo passo e a nova faixa.
  * @param pvParameters Ponteiro para uma estrutura `sweep_params_t` contendo os parâmetros da varredura.
  */
 void wavelength_sweep_task(void *pvParameters) {
     // Copia os parâmetros para a stack da task para liberar a memória do chamador.
     sweep_params_t params = *(sweep_params_t *)pvParameters;
     filter_channel_t *channel = params.channel;
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+    uint32_t cycle = 0;
 
     char task_tag[32];
     snprintf(task_tag, sizeof(task_tag), "SWEEP_%s", channel->name);
@@ -207,20 +544,135 @@ void wavelength_sweep_task(void *pvParameters) {
     ESP_LOGI(task_tag, "Iniciando varredura: min=%.3f, max=%.3f, step=%.3f, delay=%dms",
              params.min_wl, params.max_wl, params.wl_interval, params.time_interval_ms);
 
-    while (1) {
-        for (float current_wl = params.min_wl; current_wl <= params.max_wl; current_wl += params.wl_interval) {
+    while (!channel->sweep_stop) {
+        uint16_t step = 0;
+        for (float current_wl = params.min_wl; current_wl <= params.max_wl && !channel->sweep_stop; current_wl += params.wl_interval) {
             ESP_LOGD(task_tag, "Definindo wl: %.3f nm", current_wl);
             float target_wl = current_wl;
-
+            // Permanência no passo anterior (base da folga do prazo): o intervalo ou a estabilização prevista.
+            uint32_t step_dwell_ms = (uint32_t)params.time_interval_ms;
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+            if (params.time_interval_ms == 0) {
+                step_dwell_ms = settle_model_estimate_ms(&channel->settle_model, params.wl_interval);
+            }
+#endif
+            float readback_wl = 0.0f;
+            esp_err_t ret = ESP_FAIL;
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+            float jump_nm = current_wl - channel->last_wl;
+            int64_t sent_us = 0;
+#endif
+
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+            if (step == 0) {
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+                // O retorno vem após a maior pausa do ciclo: religa o filtro antes do WVL, se preciso.
+                if (sweep_bus_take(channel, step_dwell_ms)) {
+                    ensure_power_on(channel);
+                    sweep_bus_give(channel);
+                }
+#endif
+                move_result_t move;
+                ret = move_planner_move(&channel->device_handle, channel->last_wl, target_wl, true, true, &move);
+                if (ret == ESP_ERR_TIMEOUT) {
+                    ESP_LOGW(task_tag, "Espelho não estabilizou no início do ciclo %lu", (unsigned long)cycle);
+                    ret = ESP_OK; // O destino foi aplicado; apenas a espera expirou.
+                }
+                readback_wl = move.readback_wl;
+            } else
+#endif
             // Usa o mutex para garantir que esta operação não conflite com outros comandos I2C.
-            if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
-                sercalo_get_set_wavelength(&channel->device_handle, &target_wl, NULL);
-                xSemaphoreGive(g_command_mutex);
+            // A resposta do WVL traz o comprimento de onda aplicado pelo filtro (readback).
+            if (sweep_bus_take(channel, step_dwell_ms)) {
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+                ensure_power_on(channel); // Sem transações se o filtro já foi religado antes do passo.
+#endif
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+                sent_us = monotonic_us();
+#endif
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+                int64_t step_start_us = monotonic_us();
+#endif
+                ret = sercalo_get_set_wavelength(&channel->device_handle, &target_wl, &readback_wl);
+                sweep_bus_give(channel);
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+                if (ret == ESP_OK) bus_budget_observe(BUS_BUDGET_OP_WVL_SET, (uint32_t)(monotonic_us() - step_start_us));
+#endif
+            }
+            if (ret == ESP_OK) {
+                channel->last_wl = current_wl;
+            }
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+            if (ret == ESP_OK && step > 0 && params.time_interval_ms == 0) {
+                // Passo automático: a amostra (ADC) e o próximo passo esperam a estabilização.
+                wait_step_settled(channel, jump_nm, sent_us, step);
             }
-            vTaskDelay(pdMS_TO_TICKS(params.time_interval_ms));
+#endif
+            uint32_t timestamp_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+            if (ret == ESP_OK && data_plane_wants(DATA_PLANE_TYPE_SWEEP_STEP)) {
+                dp_sweep_step_t record = {
+                    .timestamp_ms = timestamp_ms,
+                    .cycle = cycle,
+                    .step = step,
+                    .target_wl = current_wl,
+                };
+                data_plane_publish(DATA_PLANE_TYPE_SWEEP_STEP, channel_index, &record, sizeof(record));
+            }
+
+#if CONFIG_SERCALO_LOG_ENABLE
+            if (sweep_log_active()) {
+                sweep_log_record_t log_record = {
+                    .timestamp_ms = timestamp_ms,
+                    .cycle = cycle,
+                    .step = step,
+                    .channel = channel_index,
+                    .flags = (ret == ESP_OK) ? SWEEP_LOG_FLAG_READBACK : SWEEP_LOG_FLAG_ERROR,
+                    .target_wl = current_wl,
+                    .readback_wl = readback_wl,
+                };
+                uint16_t adc = DETECTOR_NO_SAMPLE;
+                if (detector_read(&adc) == ESP_OK) {
+                    log_record.flags |= SWEEP_LOG_FLAG_ADC;
+                }
+                log_record.adc = adc;
+                sweep_log_append(&log_record); // Nunca bloqueia; descartes são contabilizados.
+            }
+#endif
+            step++;
+            uint32_t wait_ms = (uint32_t)params.time_interval_ms;
+#if CONFIG_SERCALO_VERIFY_ENABLE
+            if (ret == ESP_OK && verify_get_mode(channel_index) != VERIFY_MODE_OFF && !channel->sweep_stop) {
+                wait_ms = sweep_verify_step(channel, step - 1, current_wl, wait_ms);
+            }
+#endif
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+            // Intervalos longos são passados em repouso; o filtro é religado antes do próximo passo.
+            power_manager_expect(channel_index, wait_ms);
+#endif
+            sweep_sleep(pdMS_TO_TICKS(wait_ms));
+
+            if (sweep_swap_params(channel_index, SWEEP_SWAP_STEP, &params)) {
+                // Continua da posição atual; abaixo da nova faixa, o próximo passo é o seu início.
+                if (current_wl + params.wl_interval < params.min_wl) {
+                    current_wl = params.min_wl - params.wl_interval;
+                }
+                data_plane_trace(channel_index, "sweep %s: parâmetros trocados no passo %u, %lu ms após o pedido",
+                                 channel->name, step, (unsigned long)s_sweep_updates[channel_index].last_latency_ms);
+            }
+        }
+        if (channel->sweep_stop) break;
+        if (sweep_swap_params(channel_index, SWEEP_SWAP_CYCLE, &params)) {
+            data_plane_trace(channel_index, "sweep %s: parâmetros trocados no fim do ciclo %lu, %lu ms após o pedido",
+                             channel->name, (unsigned long)cycle, (unsigned long)s_sweep_updates[channel_index].last_latency_ms);
         }
         ESP_LOGI(task_tag, "Varredura concluída. Reiniciando...");
+        data_plane_trace(channel_index, "sweep %s: ciclo %lu concluído (%u passos)", channel->name, (unsigned long)cycle, step);
+        cycle++;
     }
+    ESP_LOGI(task_tag, "Varredura parada no ciclo %lu", (unsigned long)cycle);
+    channel->sweep_running = false;
+    vTaskDelete(NULL);
 }
 
 // --- Implementações dos Handlers de Comando ---
@@ -228,42 +680,40 @@ void wavelength_sweep_task(void *pvParameters) {
 /**
  * @brief Handler para o comando `iden?`.
  *
- * Obtém os dados de identificação (Modelo, S/N, FW) de ambos os canais (C e L)
- * e os concatena no buffer de resposta.
+ * Obtém os dados de identificação (Modelo, S/N, FW) de ambos os canais (C e L),
+ * um grupo de campos por canal.
  *
  * @param args Não utilizado neste comando.
- * @param response_buf Buffer para onde a string de resposta formatada será escrita.
- * @param response_buf_len Tamanho total do buffer de resposta.
+ * @param resp Escritor da resposta.
  *
  * @return ESP_OK Sempre retorna sucesso, mesmo que a leitura de um dos canais falhe
- * (nesse caso, uma mensagem de falha é incluída na própria resposta).
+ * (nesse caso, o grupo do canal traz o campo `erro`).
  *
  * @note **Respostas pela Serial:**
- * - **Sucesso (:ACK):** `:ACK: Canal C: Modelo=..., S/N=..., FW=... | Canal L: Modelo=..., S/N=..., FW=... |\n`
- * - **Falha (:NACK):** Este comando não gera NACK. Falhas de leitura são reportadas dentro da string de ACK.
+ * - **Sucesso (:ACK):** `:ACK: Canal C: modelo=..., sn=..., fw=... | Canal L: erro=ESP_FAIL\n`
+ * - **Sucesso (:ACK, json):** `:ACK: {"C":{"modelo":"...","sn":"...","fw":"..."},"L":{"erro":"ESP_FAIL"}}\n`
+ * - **Falha (:NACK):** Este comando não gera NACK. Falhas de leitura são reportadas dentro da resposta.
  */
-esp_err_t handle_get_iden(char *args, char *response_buf, size_t response_buf_len) {
-    char temp_buf[RESPONSE_DATA_BUFFER_SIZE / 2];
-    response_buf[0] = '\0'; // Assegura que o buffer de resposta está vazio.
-
+esp_err_t handle_get_iden(char *args, response_writer_t *resp) {
     for (int i = 0; i < 2; i++) { // Itera sobre os dois canais
         filter_channel_t *channel = &g_filter_channels[i];
         sercalo_id_t id_data;
-        esp_err_t ret;
+        esp_err_t ret = ESP_FAIL;
 
         if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
             ret = sercalo_get_id(&channel->device_handle, &id_data);
             xSemaphoreGive(g_command_mutex);
+        }
 
-            if (ret == ESP_OK) {
-                snprintf(temp_buf, sizeof(temp_buf), "Canal %s: Modelo=%s, S/N=%s, FW=%s | ",
-                         channel->name, id_data.model, id_data.serial_number, id_data.fw_version);
-            } else {
-                snprintf(temp_buf, sizeof(temp_buf), "Canal %s: Falha ao ler ID | ", channel->name);
-            }
-            // Concatena a resposta do canal no buffer final, com segurança.
-            strncat(response_buf, temp_buf, response_buf_len - strlen(response_buf) - 1);
+        response_begin_group(resp, channel->name, channel->label);
+        if (ret == ESP_OK) {
+            response_add_str(resp, "modelo", id_data.model);
+            response_add_str(resp, "sn", id_data.serial_number);
+            response_add_str(resp, "fw", id_data.fw_version);
+        } else {
+            response_add_err(resp, "erro", ret);
         }
+        response_end_group(resp);
     }
     return ESP_OK;
 }
@@ -275,18 +725,17 @@ esp_err_t handle_get_iden(char *args, char *response_buf, size_t response_buf_le
  * para um canal especificado.
  *
  * @param args Ponteiro para a string de argumentos. Espera um caractere de banda ('C' ou 'L'). Ex: "C"
- * @param response_buf Buffer para onde a resposta `(min,max)` será escrita.
- * @param response_buf_len Tamanho do buffer de resposta.
+ * @param resp Escritor da resposta (campos `min` e `max`, em nm).
  *
  * @return ESP_OK se a leitura do intervalo for bem-sucedida.
  * @return ESP_ERR_INVALID_ARG se a banda especificada for inválida.
  * @return ESP_FAIL se a comunicação I2C com o dispositivo falhar.
  *
  * @note **Respostas pela Serial:**
- * - **Sucesso (:ACK):** `:ACK: (1527.608,1565.503)\n`
+ * - **Sucesso (:ACK):** `:ACK: min=1527.608, max=1565.503\n`
  * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n` ou `:NACK: ESP_FAIL\n`
  */
-esp_err_t handle_get_interval(char *args, char *response_buf, size_t response_buf_len) {
+esp_err_t handle_get_interval(char *args, response_writer_t *resp) {
     char *band_char_str = strtok_r(args, "?", &args);
     if (!band_char_str) return ESP_ERR_INVALID_ARG;
     
@@ -303,7 +752,8 @@ esp_err_t handle_get_interval(char *args, char *response_buf, size_t response_bu
     } else { return ESP_FAIL; }
 
     if (ret_min == ESP_OK && ret_max == ESP_OK) {
-        snprintf(response_buf, response_buf_len, "(%.3f,%.3f)", min_lambda, max_lambda);
+        response_add_float(resp, "min", min_lambda, 3);
+        response_add_float(resp, "max", max_lambda, 3);
         return ESP_OK;
     }
     return ESP_FAIL;
@@ -315,8 +765,7 @@ esp_err_t handle_get_interval(char *args, char *response_buf, size_t response_bu
  * Obtém o comprimento de onda atual em que um canal específico está sintonizado.
  *
  * @param args Ponteiro para a string de argumentos. Espera um caractere de banda ('C' ou 'L'). Ex: "L"
- * @param response_buf Buffer para onde o valor do comprimento de onda será escrito.
- * @param response_buf_len Tamanho do buffer de resposta.
+ * @param resp Escritor da resposta (apenas o valor, em nm, em todos os formatos).
  *
  * @return ESP_OK se a leitura for bem-sucedida.
  * @return ESP_ERR_INVALID_ARG se a banda especificada for inválida.
@@ -326,7 +775,7 @@ esp_err_t handle_get_interval(char *args, char *response_buf, size_t response_bu
  * - **Sucesso (:ACK):** `:ACK: 1550.123\n`
  * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n` ou `:NACK: ESP_FAIL\n`
  */
-esp_err_t handle_get_wl(char *args, char *response_buf, size_t response_buf_len) {
+esp_err_t handle_get_wl(char *args, response_writer_t *resp) {
     char *band_char_str = strtok_r(args, "?", &args);
     if (!band_char_str) return ESP_ERR_INVALID_ARG;
 
@@ -347,7 +796,7 @@ esp_err_t handle_get_wl(char *args, char *response_buf, size_t response_buf_len)
     } else { return ESP_FAIL; }
 
     if (ret == ESP_OK) {
-        snprintf(response_buf, response_buf_len, "%.3f", current_lambda);
+        response_add_float(resp, NULL, current_lambda, 3);
         return ESP_OK;
     }
     return ESP_FAIL;
@@ -357,21 +806,24 @@ esp_err_t handle_get_wl(char *args, char *response_buf, size_t response_buf_len)
  * @brief Handler para o comando `set-wl`.
  *
  * Define um novo comprimento de onda para um canal específico. Se uma tarefa de
- * varredura (`sweep`) estiver ativa no canal, ela será interrompida.
+ * varredura (`sweep`) estiver ativa no canal, ela será interrompida. Com o
+ * planejador de movimentos, saltos grandes são moldados (a resposta vem após o
+ * último ponto, sem aguardar a estabilização). Com a verificação ativa no
+ * canal (comando `verify`), o valor é lido de volta antes da resposta.
  *
  * @param args Ponteiro para os argumentos. Formato esperado: "[banda]:[wavelength]". Ex: "C:1550.5"
- * @param response_buf Não utilizado neste comando (a resposta de sucesso não contém dados).
- * @param response_buf_len Não utilizado.
+ * @param resp Escritor da resposta (vazia sem verificação; com ela, a leitura, o erro e as leituras feitas).
  *
  * @return ESP_OK se o comprimento de onda for definido com sucesso.
  * @return ESP_ERR_INVALID_ARG se os argumentos forem malformados, a banda for inválida ou o valor de wl for inválido.
+ * @return ESP_ERR_INVALID_RESPONSE se a leitura de volta ficou fora da tolerância após as repetições.
  * @return ESP_FAIL se a comunicação I2C falhar.
  *
  * @note **Respostas pela Serial:**
- * - **Sucesso (:ACK):** `:ACK\n`
+ * - **Sucesso (:ACK):** `:ACK\n`, ou `:ACK: leitura=1550.500, erro=0, leituras=1\n` com verificação
  * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n` ou `:NACK: ESP_FAIL\n`
  */
-esp_err_t handle_set_wl(char *args, char *response_buf, size_t response_buf_len) {
+esp_err_t handle_set_wl(char *args, response_writer_t *resp) {
     char *band_str = strtok_r(args, ":", &args);
     char *wl_str = strtok_r(NULL, ":", &args);
 
@@ -391,10 +843,32 @@ esp_err_t handle_set_wl(char *args, char *response_buf, size_t response_buf_len)
     stop_sweep_if_active(channel);
     
     esp_err_t ret;
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+    move_result_t move;
+    ret = move_planner_move(&channel->device_handle, channel->last_wl, target_wl, true, false, &move);
+#else
     if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
         ret = sercalo_get_set_wavelength(&channel->device_handle, &target_wl, NULL);
         xSemaphoreGive(g_command_mutex);
     } else { return ESP_FAIL; }
+#endif
+    channel->last_wl = (ret == ESP_OK) ? target_wl : NAN;
+#if CONFIG_SERCALO_VERIFY_ENABLE
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+    if (ret == ESP_OK && verify_get_mode(channel_index) != VERIFY_MODE_OFF) {
+        verify_result_t verified;
+        ret = verify_check(&channel->device_handle, channel_index, target_wl, NULL, &verified);
+        if (ret == ESP_OK && !verified.passed) {
+            channel->last_wl = NAN;
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (ret == ESP_OK) {
+            if (verify_get_mode(channel_index) == VERIFY_MODE_WVL) response_add_float(resp, "leitura", verified.readback_wl, 3);
+            response_add_uint(resp, "erro", verified.error);
+            response_add_uint(resp, "leituras", verified.attempts);
+        }
+    }
+#endif
     
     return ret;
 }
@@ -403,32 +877,76 @@ esp_err_t handle_set_wl(char *args, char *response_buf, size_t response_buf_len)
  * @brief Handler para o comando `sweep`.
  *
  * Inicia uma tarefa de varredura contínua de comprimento de onda para um canal.
- * Se uma varredura já estiver ativa, ela é parada e substituída pela nova.
+ * Se uma varredura já estiver ativa, ela é parada e substituída pela nova. Com
+ * `passo` ou `ciclo` ao fim, a varredura ativa não é parada: os novos parâmetros
+ * são trocados pela task ao fim do passo atual (continuando da posição atual)
+ * ou do ciclo atual. Sem varredura ativa, a opção é ignorada.
+ * Sem argumentos (`sweep?`), informa, por canal, se há varredura ativa, as trocas
+ * de parâmetros (`trocas`, latência da última em `troca_ms`, `troca_pendente`)
+ * e, com o escalonamento EDF, a pontualidade dos passos: `passos`, `perdidos`
+ * (atraso maior que a folga), `atraso_medio_ms`, `atraso_max_ms` e `folga_ms`.
  *
- * @param args Ponteiro para os argumentos. Formato: "[banda]:[min_wl]:[max_wl]:[passo_wl]:[passo_tempo_ms]".
- * Ex: "L:1570:1605:0.5:1000"
- * @param response_buf Não utilizado (a resposta de sucesso não contém dados).
- * @param response_buf_len Não utilizado.
+ * @param args Ponteiro para os argumentos. Formato: "[banda]:[min_wl]:[max_wl]:[passo_wl]:[passo_tempo_ms][:passo|:ciclo]".
+ * Ex: "L:1570:1605:0.5:1000". Com o modelo de estabilização, `passo_tempo_ms` 0
+ * agenda cada passo pelo tempo de estabilização previsto.
+ * Com o orçamento do barramento, a varredura só é iniciada se a sua carga (um WVL
+ * por passo) couber no que resta do orçamento; senão, é recusada ou, com
+ * CONFIG_SERCALO_BUS_BUDGET_DEGRADE, tem o `passo_tempo_ms` alongado até caber.
+ * A resposta traz o `passo_tempo_ms` aplicado, a carga e se foi `ajustado`.
+ * @param resp Escritor da resposta (consulta e, com o orçamento, a carga admitida).
  *
  * @return ESP_OK se a tarefa de sweep for criada com sucesso.
  * @return ESP_ERR_INVALID_ARG se os argumentos forem malformados ou inválidos.
+ * @return ESP_ERR_INVALID_STATE se a carga não cabe no orçamento do barramento.
  * @return ESP_FAIL se a criação da task falhar (por exemplo, por falta de memória).
  *
  * @note **Respostas pela Serial:**
- * - **Sucesso (:ACK):** `:ACK\n`
+ * - **Sucesso (:ACK):** `:ACK\n` (com o orçamento: `:ACK: passo_tempo_ms=1000, carga_pct=13.2, ajustado=0\n`)
+ * - **Sucesso (troca):** `:ACK: troca=passo\n` (mais os campos do orçamento)
+ * - **Sucesso (consulta):** `:ACK: Canal C: ativo=1, trocas=2, troca_ms=850, troca_pendente=0, passos=412, perdidos=3, atraso_medio_ms=12.4, atraso_max_ms=161, folga_ms=100 | Canal L: ativo=0, ...\n`
  * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n` ou `:NACK: ESP_FAIL\n`
  */
-esp_err_t handle_sweep(char *args, char *response_buf, size_t response_buf_len) {
+esp_err_t handle_sweep(char *args, response_writer_t *resp) {
     // Extrai todos os 5 parâmetros do comando.
     char *band_str = strtok_r(args, ":", &args);
+    if (band_str == NULL) {
+        for (int i = 0; i < 2; i++) {
+            filter_channel_t *channel = &g_filter_channels[i];
+            response_begin_group(resp, channel->name, channel->label);
+            response_add_bool(resp, "ativo", channel->sweep_running);
+            response_add_uint(resp, "trocas", s_sweep_updates[i].swaps);
+            response_add_uint(resp, "troca_ms", s_sweep_updates[i].last_latency_ms);
+            response_add_bool(resp, "troca_pendente", s_sweep_updates[i].pending);
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+            bus_sched_stats_t stats;
+            bus_sched_get_stats((uint8_t)i, &stats);
+            response_add_uint(resp, "passos", stats.jobs);
+            response_add_uint(resp, "perdidos", stats.misses);
+            response_add_float(resp, "atraso_medio_ms", stats.lateness_mean_ms, 1);
+            response_add_uint(resp, "atraso_max_ms", stats.lateness_max_ms);
+            response_add_uint(resp, "folga_ms", stats.slack_ms);
+#endif
+            response_end_group(resp);
+        }
+        return ESP_OK;
+    }
     char *min_wl_str = strtok_r(NULL, ":", &args);
     char *max_wl_str = strtok_r(NULL, ":", &args);
     char *wl_interval_str = strtok_r(NULL, ":", &args);
     char *time_interval_str = strtok_r(NULL, ":", &args);
+    char *boundary_str = strtok_r(NULL, ":", &args);
 
     if (!band_str || !min_wl_str || !max_wl_str || !wl_interval_str || !time_interval_str) {
         return ESP_ERR_INVALID_ARG;
     }
+    sweep_swap_t boundary = SWEEP_SWAP_STEP;
+    if (boundary_str != NULL) {
+        if (strcmp(boundary_str, "ciclo") == 0) {
+            boundary = SWEEP_SWAP_CYCLE;
+        } else if (strcmp(boundary_str, "passo") != 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
 
     filter_channel_t *channel = select_filter_channel(band_str[0]);
     if (!channel) return ESP_ERR_INVALID_ARG;
@@ -441,20 +959,87 @@ esp_err_t handle_sweep(char *args, char *response_buf, size_t response_buf_len)
         .time_interval_ms = atoi(time_interval_str)
     };
     
-    if (params.min_wl <= 0 || params.max_wl <= params.min_wl || params.wl_interval <= 0 || params.time_interval_ms <= 0) {
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    const int min_time_interval_ms = 0; // 0: passo automático (modelo de estabilização).
+#else
+    const int min_time_interval_ms = 1;
+#endif
+    if (params.min_wl <= 0 || params.max_wl <= params.min_wl || params.wl_interval <= 0 || params.time_interval_ms < min_time_interval_ms) {
         return ESP_ERR_INVALID_ARG;
     }
-
-    stop_sweep_if_active(channel);
-
-    char task_name[16];
-    snprintf(task_name, sizeof(task_name), "sweep_%s_task", channel->name);
-
-    // Cria a task de varredura.
-    if (xTaskCreate(wavelength_sweep_task, task_name, 4096, &params, 5, &channel->sweep_task_handle) != pdPASS) {
-        channel->sweep_task_handle = NULL;
-        return ESP_FAIL;
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    // Admissão: um WVL por passo, seguido do intervalo (no passo automático, do
+    // restante da estabilização prevista, contada a partir do envio).
+    uint32_t step_cost_us = bus_budget_cost_us(BUS_BUDGET_OP_WVL_SET);
+#if CONFIG_SERCALO_VERIFY_ENABLE
+    // A leitura de volta de cada passo, com as repetições, também ocupa o barramento a cada período.
+    step_cost_us += verify_cost_ms(channel_index) * 1000;
+#endif
+    uint32_t interval_ms = (uint32_t)params.time_interval_ms;
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    if (params.time_interval_ms == 0) {
+        uint32_t settle_ms = settle_model_estimate_ms(&channel->settle_model, params.wl_interval);
+        interval_ms = (settle_ms > step_cost_us / 1000) ? settle_ms - step_cost_us / 1000 : 0;
+    }
+#endif
+    bool degrade = false;
+#if CONFIG_SERCALO_BUS_BUDGET_DEGRADE
+    degrade = true;
+#endif
+    uint32_t admitted_ms = interval_ms;
+    esp_err_t ret = bus_budget_admit(channel_index, step_cost_us, &admitted_ms, degrade);
+    if (ret != ESP_OK) return ret;
+    if (admitted_ms != interval_ms) {
+        params.time_interval_ms = (int)admitted_ms; // Degradado: intervalo fixo que cabe no orçamento.
     }
+#endif
+
+    if (boundary_str != NULL && channel->sweep_running) {
+        // Varredura em andamento: os parâmetros vão para o segundo buffer, e a task
+        // os troca no limite pedido, sem parar nem recomeçar de `min_wl`.
+        sweep_update_t *update = &s_sweep_updates[channel_index];
+        taskENTER_CRITICAL(&s_sweep_update_lock);
+        update->params = params;
+        update->boundary = boundary;
+        update->requested = xTaskGetTickCount();
+        update->pending = true;
+        taskEXIT_CRITICAL(&s_sweep_update_lock);
+        response_add_str(resp, "troca", boundary_str);
+    } else {
+        stop_sweep_if_active(channel);
+
+        char task_name[16];
+        snprintf(task_name, sizeof(task_name), "sweep_%s_task", channel->name);
+
+        // Os parâmetros ficam em memória estática até a task copiá-los (a anterior já terminou).
+        s_sweep_params[channel_index] = params;
+        memset(&s_sweep_updates[channel_index], 0, sizeof(s_sweep_updates[channel_index]));
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+        bus_sched_reset_stats(channel_index);
+#endif
+
+        // Cria a task de varredura.
+        channel->sweep_stop = false;
+        channel->sweep_running = true;
+        if (xTaskCreate(wavelength_sweep_task, task_name, 4096, &s_sweep_params[channel_index], 5, &channel->sweep_task_handle) != pdPASS) {
+            channel->sweep_task_handle = NULL;
+            channel->sweep_running = false;
+            return ESP_FAIL;
+        }
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+        power_manager_set_busy(channel_index, true);
+#endif
+    }
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    bus_budget_commit(channel_index, BUS_BUDGET_SWEEP, step_cost_us, admitted_ms);
+    bus_budget_entry_t entry;
+    bus_budget_get_entry(channel_index, &entry);
+    response_add_uint(resp, "passo_tempo_ms", (uint32_t)params.time_interval_ms);
+    response_add_float(resp, "carga_pct", entry.load_permille / 10.0, 1);
+    response_add_bool(resp, "ajustado", admitted_ms != interval_ms);
+#endif
     
     return ESP_OK;
 }
@@ -465,34 +1050,35 @@ esp_err_t handle_sweep(char *args, char *response_buf, size_t response_buf_len)
  * Liga os dispositivos
  *
  * @param args Não utilizado neste comando.
- * @param response_buf Buffer para onde a string de resposta formatada será escrita.
- * @param response_buf_len Tamanho total do buffer de resposta.
+ * @param resp Escritor da resposta (um grupo por canal).
  *
- * @return ESP_OK Sempre retorna sucesso, mesmo que a leitura de um dos canais falhe
- * (nesse caso, uma mensagem de falha é incluída na própria resposta).
+ * @return ESP_OK Sempre retorna sucesso, mesmo que um dos canais falhe
+ * (nesse caso, o grupo do canal traz o campo `erro`).
  *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: Canal C: ligado=1 | Canal L: erro=ESP_FAIL\n`
  */
-esp_err_t handle_powerup(char *args, char *response_buf, size_t response_buf_len) {
-    char temp_buf[RESPONSE_DATA_BUFFER_SIZE / 2];
-    response_buf[0] = '\0'; // Assegura que o buffer de resposta está vazio.
-
+esp_err_t handle_powerup(char *args, response_writer_t *resp) {
     for (int i = 0; i < 2; i++) { // Itera sobre os dois canais
         filter_channel_t *channel = &g_filter_channels[i];
         sercalo_power_mode_t powerup = SERCALO_POWER_NORMAL; // Define o modo de energia para "ligado" (1)
-        esp_err_t ret;
-        
+        esp_err_t ret = ESP_FAIL;
+
         if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
             ret = sercalo_get_set_power_mode(&channel->device_handle, &powerup, NULL);
             xSemaphoreGive(g_command_mutex);
+        }
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+        if (ret == ESP_OK) power_manager_note_mode((uint8_t)i, powerup);
+#endif
 
-            if (ret == ESP_OK) {
-                snprintf(temp_buf, sizeof(temp_buf), "Canal %s: Ligado ", channel->name);
-            } else {
-                snprintf(temp_buf, sizeof(temp_buf), "Canal %s: Falha ao ligar | ", channel->name);
-            }
-            // Concatena a resposta do canal no buffer final, com segurança.
-            strncat(response_buf, temp_buf, response_buf_len - strlen(response_buf) - 1);
+        response_begin_group(resp, channel->name, channel->label);
+        if (ret == ESP_OK) {
+            response_add_bool(resp, "ligado", true);
+        } else {
+            response_add_err(resp, "erro", ret);
         }
+        response_end_group(resp);
     }
     return ESP_OK;
 }
@@ -503,38 +1089,1152 @@ esp_err_t handle_powerup(char *args, char *response_buf, size_t response_buf_len
  * Ver estado dos dispositivos
  *
  * @param args Não utilizado neste comando.
- * @param response_buf Buffer para onde a string de resposta formatada será escrita.
- * @param response_buf_len Tamanho total do buffer de resposta.
+ * @param resp Escritor da resposta (um grupo por canal, com o modo de energia).
  *
  * @return ESP_OK Sempre retorna sucesso, mesmo que a leitura de um dos canais falhe
- * (nesse caso, uma mensagem de falha é incluída na própria resposta).
+ * (nesse caso, o grupo do canal traz o campo `erro`).
+ *
+ * Com o repouso automático, cada grupo traz também o tempo sem atividade e os
+ * contadores de repousos e despertares (antecipados ou no caminho do comando,
+ * e a espera total de comandos pela estabilização de um despertar antecipado).
  *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: Canal C: modo=1 | Canal L: modo=0\n` (1 = normal, 0 = repouso)
  */
-esp_err_t handle_get_power(char *args, char *response_buf, size_t response_buf_len) {
-    char temp_buf[RESPONSE_DATA_BUFFER_SIZE / 2];
-    response_buf[0] = '\0'; // Assegura que o buffer de resposta está vazio.
-
+esp_err_t handle_get_power(char *args, response_writer_t *resp) {
     for (int i = 0; i < 2; i++) { // Itera sobre os dois canais
         filter_channel_t *channel = &g_filter_channels[i];
         sercalo_power_mode_t state;
-        esp_err_t ret;
-        
+        esp_err_t ret = ESP_FAIL;
+
         if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
             ret = sercalo_get_set_power_mode(&channel->device_handle, NULL, &state);
             xSemaphoreGive(g_command_mutex);
+        }
 
-            if (ret == ESP_OK) {
-                snprintf(temp_buf, sizeof(temp_buf), "Canal %s: %i ", channel->name, state);
-            } else {
-                snprintf(temp_buf, sizeof(temp_buf), "Canal %s: Falha ao ler | ", channel->name);
+        response_begin_group(resp, channel->name, channel->label);
+        if (ret == ESP_OK) {
+            response_add_int(resp, "modo", state);
+        } else {
+            response_add_err(resp, "erro", ret);
+        }
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+        power_manager_status_t power;
+        power_manager_get_status((uint8_t)i, &power);
+        response_add_uint(resp, "ocioso_ms", power.idle_ms);
+        response_add_uint(resp, "repousos", power.sleeps);
+        response_add_uint(resp, "antecipados", power.early_wakes);
+        response_add_uint(resp, "no_comando", power.inline_wakes);
+        response_add_uint(resp, "espera_ms", power.wake_wait_ms);
+#endif
+        response_end_group(resp);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Handler para o comando `stream`.
+ *
+ * Assina ou cancela o plano de dados (telemetria de varredura e traces) para a
+ * origem do comando: no console, os quadros chegam como linhas `:DAT:<hex>`;
+ * em uma conexão TCP, pela própria conexão, no mesmo formato. Com a UART de
+ * dados habilitada (CONFIG_SERCALO_DATA_UART_ENABLE), os quadros já seguem por
+ * ela e este comando é necessário apenas para espelhá-los.
+ *
+ * @param args `on`, `off` ou vazio (apenas consulta).
+ * @param resp Escritor da resposta (estado atual do plano de dados).
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG se o argumento não for `on` nem `off`.
+ * @return ESP_ERR_NOT_SUPPORTED se a origem não aceita o plano de dados.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: origem=uart, stream=1, uart=0, publicados=120, descartados=0\n`
+ * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n`
+ */
+esp_err_t handle_stream(char *args, response_writer_t *resp) {
+    char *mode_str = strtok_r(args, ":?", &args);
+    void *source_ctx;
+    const command_source_t *source = command_current_source(&source_ctx);
+
+    if (source == NULL || source->set_stream == NULL) return ESP_ERR_NOT_SUPPORTED;
+
+    if (mode_str != NULL) {
+        esp_err_t ret;
+        if (strcmp(mode_str, "on") == 0) {
+            ret = source->set_stream(source_ctx, true);
+        } else if (strcmp(mode_str, "off") == 0) {
+            ret = source->set_stream(source_ctx, false);
+        } else {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (ret != ESP_OK) return ret;
+    }
+
+    data_plane_stats_t stats;
+    data_plane_get_stats(&stats);
+    response_add_str(resp, "origem", source->name);
+    response_add_bool(resp, "stream", source->stream_enabled(source_ctx));
+    response_add_bool(resp, "uart", data_plane_uart_enabled());
+    response_add_uint(resp, "publicados", stats.published);
+    response_add_uint(resp, "descartados", stats.dropped);
+    return ESP_OK;
+}
+
+/**
+ * @brief Handler para o comando `format`.
+ *
+ * Define o formato das respostas para a origem do comando (console ou conexão
+ * TCP): `text` (legível, padrão), `kv` (`chave=valor` separados por espaço) ou
+ * `json` (um objeto JSON por linha). A própria resposta já usa o novo formato.
+ *
+ * @param args `text`, `kv`, `json` ou vazio (apenas consulta).
+ * @param resp Escritor da resposta.
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG se o formato for desconhecido.
+ * @return ESP_ERR_NOT_SUPPORTED se a origem não permite trocar o formato.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: {"formato":"json"}\n`
+ * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n`
+ */
+esp_err_t handle_format(char *args, response_writer_t *resp) {
+    char *format_str = strtok_r(args, ":?", &args);
+    void *source_ctx;
+    const command_source_t *source = command_current_source(&source_ctx);
+
+    if (format_str != NULL) {
+        response_format_t format;
+        if (response_format_from_name(format_str, &format) != ESP_OK) return ESP_ERR_INVALID_ARG;
+        if (source == NULL || source->set_format == NULL) return ESP_ERR_NOT_SUPPORTED;
+        esp_err_t ret = source->set_format(source_ctx, format);
+        if (ret != ESP_OK) return ret;
+        response_set_format(resp, format);
+    }
+
+    response_add_str(resp, "formato", response_format_name(response_format(resp)));
+    return ESP_OK;
+}
+
+#if CONFIG_SERCALO_UDP_STREAM_ENABLE
+/**
+ * @brief Handler para o comando `udp`.
+ *
+ * Define o destino do streaming UDP do plano de dados ou o desliga. Sem argumentos,
+ * apenas informa o destino e os contadores de envio e retransmissão.
+ *
+ * @param args `<ip>:<porta>`, `off` ou vazio (apenas consulta).
+ * @param resp Escritor da resposta (estado atual do streaming).
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG se o endereço ou a porta forem inválidos.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: destino=192.168.0.10:5026, enviados=5120, erros=0, lacunas=3, reenviados=7, expirados=0, retidos=256\n`
+ * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n`
+ */
+esp_err_t handle_udp(char *args, response_writer_t *resp) {
+    char *host_str = strtok_r(args, ":?", &args);
+    char *port_str = strtok_r(args, ":", &args);
+
+    if (host_str != NULL) {
+        esp_err_t ret;
+        if (strcmp(host_str, "off") == 0) {
+            ret = udp_stream_set_target(NULL, 0);
+        } else {
+            long port = (port_str != NULL) ? strtol(port_str, NULL, 10) : CONFIG_SERCALO_UDP_STREAM_PORT;
+            if (port <= 0 || port > 65535) return ESP_ERR_INVALID_ARG;
+            ret = udp_stream_set_target(host_str, (uint16_t)port);
+        }
+        if (ret != ESP_OK) return ret;
+    }
+
+    char target[32];
+    udp_stream_stats_t stats;
+    udp_stream_get_target(target, sizeof(target));
+    udp_stream_get_stats(&stats);
+    response_add_str(resp, "destino", target);
+    response_add_uint(resp, "enviados", stats.sent);
+    response_add_uint(resp, "erros", stats.send_errors);
+    response_add_uint(resp, "lacunas", stats.gap_reports);
+    response_add_uint(resp, "reenviados", stats.retransmitted);
+    response_add_uint(resp, "expirados", stats.expired);
+    response_add_uint(resp, "retidos", stats.retained);
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_UDP_STREAM_ENABLE
+
+#if CONFIG_SERCALO_LOG_ENABLE
+/**
+ * @brief Envia um trecho de arquivo de registro como parte do bloco binário da resposta.
+ */
+static void log_replay_chunk(void *ctx, const uint8_t *data, size_t len) {
+    command_reply_block_write(data, len);
+    *(size_t *)ctx += len;
+}
+
+/**
+ * @brief Acrescenta um arquivo de registro à resposta do `log:list` (`índice=tamanho`).
+ */
+static void log_list_file(void *ctx, uint32_t index, size_t size) {
+    char key[12];
+    snprintf(key, sizeof(key), "%lu", (unsigned long)index);
+    response_add_uint((response_writer_t *)ctx, key, size);
+}
+
+/**
+ * @brief Grava `count` registros sintéticos o mais rápido possível e mede a taxa sustentada.
+ *
+ * Diferente da varredura, o benchmark espera quando os dois buffers estão
+ * ocupados, de modo que o tempo total reflete a vazão da flash.
+ */
+static esp_err_t run_log_bench(uint32_t count, response_writer_t *resp) {
+    sweep_log_stats_t before, after;
+    bool was_active = sweep_log_active();
+
+    if (!was_active) {
+        esp_err_t ret = sweep_log_set_active(true);
+        if (ret != ESP_OK) return ret;
+    }
+    sweep_log_get_stats(&before);
+
+    TickType_t start = xTaskGetTickCount();
+    for (uint32_t i = 0; i < count; i++) {
+        sweep_log_record_t record = {
+            .timestamp_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS),
+            .cycle = i / 1000,
+            .step = (uint16_t)(i % 1000),
+            .channel = DATA_PLANE_NO_CHANNEL,
+            .flags = SWEEP_LOG_FLAG_SYNTHETIC,
+            .target_wl = 1550.0f + (float)(i % 1000) * 0.01f,
+            .readback_wl = 1550.0f + (float)(i % 1000) * 0.01f,
+            .adc = DETECTOR_NO_SAMPLE,
+        };
+        while (sweep_log_append(&record) == ESP_ERR_NO_MEM) {
+            vTaskDelay(1);
+        }
+    }
+    sweep_log_flush(10000);
+    uint32_t elapsed_ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+    sweep_log_get_stats(&after);
+
+    if (!was_active) {
+        sweep_log_set_active(false);
+    }
+
+    uint64_t record_bytes = after.record_bytes - before.record_bytes;
+    uint64_t bytes_written = after.bytes_written - before.bytes_written;
+    // As retentativas acima também aparecem em `descartados` no `:log?`.
+    response_add_uint(resp, "registros", count);
+    response_add_uint(resp, "tempo_ms", elapsed_ms);
+    response_add_float(resp, "taxa_reg_s", elapsed_ms > 0 ? count * 1000.0 / elapsed_ms : 0.0, 0);
+    response_add_float(resp, "vazao_kib_s", elapsed_ms > 0 ? bytes_written * 1000.0 / 1024.0 / elapsed_ms : 0.0, 1);
+    response_add_float(resp, "amplificacao", record_bytes > 0 ? (double)bytes_written / (double)record_bytes : 0.0, 3);
+    response_add_uint(resp, "blocos", after.blocks - before.blocks);
+    response_add_uint(resp, "syncs", after.syncs - before.syncs);
+    return ESP_OK;
+}
+
+/**
+ * @brief Handler para o comando `log`.
+ *
+ * Controla o registro das varreduras em flash e devolve os arquivos gravados.
+ * - `on` / `off`: inicia (em um novo arquivo) ou encerra o registro.
+ * - `flush`: grava o bloco parcial e sincroniza o arquivo.
+ * - `list`: lista os arquivos (`índice=tamanho`).
+ * - `read:<índice>[:<início>[:<tamanho>]]`: envia o arquivo (ou um trecho) como
+ *   bloco binário `#<d><tamanho><dados>`.
+ * - `bench:<n>`: grava `n` registros sintéticos e mede a taxa sustentada.
+ * - Sem argumento: estado e contadores. `taxa` é a média de registros aceitos
+ *   por segundo com o registro habilitado; `amplificacao` é bytes gravados /
+ *   bytes de registros (cabeçalhos e blocos parciais; os metadados do LittleFS
+ *   a cada `sync` não estão incluídos).
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG para subcomando ou argumentos inválidos.
+ * @return ESP_ERR_NOT_FOUND se o arquivo pedido não existe.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: ativo=1, arquivo=3, registros=5120, descartados=0, blocos=31, taxa_reg_s=6.7, amplificacao=1.004, ...\n`
+ * - **Sucesso (read):** `:ACK: #48192<8192 bytes>\n`
+ * - **Falha (:NACK):** `:NACK: ESP_ERR_NOT_FOUND\n`
+ */
+esp_err_t handle_log(char *args, response_writer_t *resp) {
+    char *sub = strtok_r(args, ":?", &args);
+    esp_err_t ret = ESP_OK;
+
+    if (sub == NULL) {
+        // Apenas consulta.
+    } else if (strcmp(sub, "on") == 0 || strcmp(sub, "off") == 0) {
+        ret = sweep_log_set_active(strcmp(sub, "on") == 0);
+    } else if (strcmp(sub, "flush") == 0) {
+        ret = sweep_log_flush(5000);
+    } else if (strcmp(sub, "list") == 0) {
+        sweep_log_list(log_list_file, resp);
+        return ESP_OK;
+    } else if (strcmp(sub, "bench") == 0) {
+        char *count_str = strtok_r(args, ":", &args);
+        long count = (count_str != NULL) ? strtol(count_str, NULL, 10) : 0;
+        if (count <= 0) return ESP_ERR_INVALID_ARG;
+        return run_log_bench((uint32_t)count, resp);
+    } else if (strcmp(sub, "read") == 0) {
+        char *index_str = strtok_r(args, ":", &args);
+        char *offset_str = strtok_r(args, ":", &args);
+        char *len_str = strtok_r(args, ":", &args);
+        if (index_str == NULL) return ESP_ERR_INVALID_ARG;
+
+        uint32_t index = (uint32_t)strtoul(index_str, NULL, 10);
+        sweep_log_stats_t stats;
+        sweep_log_get_stats(&stats);
+        if (stats.active && stats.file_index == index) {
+            sweep_log_flush(5000); // Torna visíveis os blocos ainda em buffer.
+        }
+
+        size_t size;
+        ret = sweep_log_file_size(index, &size);
+        if (ret != ESP_OK) return ret;
+        size_t offset = (offset_str != NULL) ? strtoul(offset_str, NULL, 10) : 0;
+        if (offset > size) return ESP_ERR_INVALID_ARG;
+        size_t len = size - offset;
+        if (len_str != NULL && strtoul(len_str, NULL, 10) < len) {
+            len = strtoul(len_str, NULL, 10);
+        }
+
+        ret = command_reply_block_begin(len);
+        if (ret != ESP_OK) return ret;
+        size_t sent = 0;
+        esp_err_t replay_ret = sweep_log_replay(index, offset, len, log_replay_chunk, &sent);
+        if (replay_ret != ESP_OK) {
+            // O tamanho já foi anunciado: completa com zeros para não desalinhar o fluxo.
+            static const uint8_t zeros[64];
+            while (sent < len) {
+                size_t n = (len - sent < sizeof(zeros)) ? len - sent : sizeof(zeros);
+                command_reply_block_write(zeros, n);
+                sent += n;
             }
-            // Concatena a resposta do canal no buffer final, com segurança.
-            strncat(response_buf, temp_buf, response_buf_len - strlen(response_buf) - 1);
         }
+        command_reply_block_end();
+        if (replay_ret != ESP_OK) {
+            // Só após o fim do bloco: no console, o log entraria no meio dos dados.
+            ESP_LOGE(TAG, "Falha ao ler o arquivo de registro %lu: %s", (unsigned long)index, esp_err_to_name(replay_ret));
+        }
+        return ESP_OK;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ret != ESP_OK) return ret;
+
+    sweep_log_stats_t stats;
+    sweep_log_get_stats(&stats);
+    response_add_bool(resp, "ativo", stats.active);
+    response_add_int(resp, "arquivo", stats.file_index == SWEEP_LOG_NO_FILE ? -1 : (int64_t)stats.file_index);
+    response_add_uint(resp, "registros", stats.records);
+    response_add_uint(resp, "descartados", stats.dropped);
+    response_add_uint(resp, "blocos", stats.blocks);
+    response_add_float(resp, "taxa_reg_s", stats.active_ms > 0 ? stats.records * 1000.0 / stats.active_ms : 0.0, 1);
+    response_add_float(resp, "amplificacao",
+                       stats.record_bytes > 0 ? (double)stats.bytes_written / (double)stats.record_bytes : 0.0, 3);
+    response_add_uint(resp, "syncs", stats.syncs);
+    response_add_uint(resp, "rotacoes", stats.rotations);
+    response_add_uint(resp, "erros", stats.write_errors);
+    response_add_uint(resp, "escrita_max_ms", stats.max_write_ms);
+    response_add_uint(resp, "livre_kib", (stats.fs_total - stats.fs_used) / 1024);
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_LOG_ENABLE
+
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+/**
+ * @brief Mede o tempo até a estabilização de saltos diretos e moldados de vários tamanhos.
+ *
+ * Cada salto parte do início da faixa do canal, já estável. Um grupo por tamanho,
+ * com o salto em nm, os tempos (do primeiro ponto até a posição estabilizar),
+ * os pontos do salto moldado e o ganho (direto / moldado).
+ */
+static esp_err_t run_move_bench(filter_channel_t *channel, response_writer_t *resp) {
+    static const float jumps_nm[] = {0.5f, 2.0f, 5.0f, 10.0f, 20.0f, 0.0f}; // 0: faixa completa
+    sercalo_dev_t *dev = &channel->device_handle;
+    float min_wl, max_wl;
+    esp_err_t ret = ESP_FAIL;
+
+    if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
+        ret = ensure_power_on(channel);
+        if (ret == ESP_OK) ret = sercalo_get_min_wavelength(dev, &min_wl);
+        if (ret == ESP_OK) ret = sercalo_get_max_wavelength(dev, &max_wl);
+        xSemaphoreGive(g_command_mutex);
+    }
+    if (ret != ESP_OK) return ret;
+
+    for (int i = 0; i < (int)(sizeof(jumps_nm) / sizeof(jumps_nm[0])); i++) {
+        float jump = (jumps_nm[i] > 0.0f) ? jumps_nm[i] : max_wl - min_wl;
+        if (jump > max_wl - min_wl) continue;
+        float from = min_wl, to = min_wl + jump;
+        move_result_t direct, shaped;
+
+        // Parte sempre do mesmo ponto estável; os tempos de ida e volta não entram na medida.
+        ret = move_planner_move(dev, channel->last_wl, from, true, true, &shaped);
+        if (ret == ESP_OK) ret = move_planner_move(dev, from, to, false, true, &direct);
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+        if (ret == ESP_OK) settle_model_observe(&channel->settle_model, to - from, direct.settle_ms);
+#endif
+        if (ret == ESP_OK) ret = move_planner_move(dev, to, from, true, true, &shaped);
+        if (ret == ESP_OK) ret = move_planner_move(dev, from, to, true, true, &shaped);
+        channel->last_wl = NAN; // Uma falha deixa a posição incerta.
+        if (ret != ESP_OK) return ret;
+        channel->last_wl = to;
+
+        char key[4];
+        snprintf(key, sizeof(key), "%d", i + 1);
+        response_begin_group(resp, key, key);
+        response_add_float(resp, "salto_nm", jump, 1);
+        response_add_uint(resp, "direto_ms", direct.settle_ms);
+        response_add_uint(resp, "moldado_ms", shaped.settle_ms);
+        response_add_uint(resp, "pontos", shaped.points);
+        response_add_float(resp, "ganho", shaped.settle_ms > 0 ? (double)direct.settle_ms / shaped.settle_ms : 0.0, 2);
+        response_end_group(resp);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Handler para o comando `move`.
+ *
+ * Movimentos moldados com detecção de estabilização pela leitura de POS.
+ * - `<banda>:<wl>`: salto moldado até `wl`, aguardando o espelho estabilizar
+ *   (`pontos`, `estavel_ms` desde o primeiro ponto, `leitura` do WVL).
+ * - `bench:<banda>`: compara saltos diretos e moldados de 0,5 nm até a faixa
+ *   completa (cerca de 1 minuto; o canal fica ocupado durante a medida).
+ * - Sem argumento: parâmetros do modelo e contadores.
+ * A varredura ativa no canal é interrompida.
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG para banda ou comprimento de onda inválidos.
+ * @return ESP_ERR_TIMEOUT se a posição não estabilizou no tempo máximo.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: pontos=3, estavel_ms=650, leitura=1565.503\n`
+ * - **Sucesso (bench):** `:ACK: 1: salto_nm=0.5, direto_ms=2250, moldado_ms=2250, pontos=1, ganho=1.00 | 2: ...\n`
+ * - **Sucesso (consulta):** `:ACK: modelador=zvd, ressonancia_hz=2.00, amortecimento=0.150, ...\n`
+ * - **Falha (:NACK):** `:NACK: ESP_ERR_TIMEOUT\n`
+ */
+esp_err_t handle_move(char *args, response_writer_t *resp) {
+    char *sub = strtok_r(args, ":?", &args);
+
+    if (sub == NULL) {
+        move_planner_status_t status;
+        move_planner_get_status(&status);
+        response_add_str(resp, "modelador", status.shaper);
+        response_add_float(resp, "ressonancia_hz", status.resonance_hz, 2);
+        response_add_float(resp, "amortecimento", status.damping, 3);
+        response_add_float(resp, "salto_min_nm", status.min_jump_nm, 3);
+        response_add_uint(resp, "transacao_ms", status.bus_gap_ms);
+        response_add_uint(resp, "intervalo_ms", status.spacing_ms);
+        response_add_uint(resp, "movimentos", status.moves);
+        response_add_uint(resp, "moldados", status.shaped_moves);
+        response_add_uint(resp, "expirados", status.settle_timeouts);
+        return ESP_OK;
+    }
+
+    bool bench = (strcmp(sub, "bench") == 0);
+    char *band_str = bench ? strtok_r(args, ":", &args) : sub;
+    filter_channel_t *channel = (band_str != NULL) ? select_filter_channel(band_str[0]) : NULL;
+    if (!channel) return ESP_ERR_INVALID_ARG;
+
+    stop_sweep_if_active(channel);
+    if (bench) {
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+        // As medidas passam do tempo de inatividade: o canal não pode entrar em repouso no meio delas.
+        uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+        power_manager_set_busy(channel_index, true);
+#endif
+        esp_err_t ret = run_move_bench(channel, resp);
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+        power_manager_set_busy(channel_index, false);
+#endif
+        return ret;
+    }
+
+    char *wl_str = strtok_r(args, ":", &args);
+    float target_wl = (wl_str != NULL) ? atof(wl_str) : 0.0f;
+    if (target_wl <= 0) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t ret = ESP_FAIL;
+    if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
+        ret = ensure_power_on(channel);
+        xSemaphoreGive(g_command_mutex);
+    }
+    if (ret != ESP_OK) return ret;
+
+    move_result_t move;
+    float from_wl = channel->last_wl;
+    ret = move_planner_move(&channel->device_handle, from_wl, target_wl, true, true, &move);
+    channel->last_wl = (ret == ESP_OK || ret == ESP_ERR_TIMEOUT) ? target_wl : NAN;
+    if (ret != ESP_OK) return ret;
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    if (move.points == 1 && !isnan(from_wl)) {
+        settle_model_observe(&channel->settle_model, target_wl - from_wl, move.settle_ms); // Salto direto: mesma dinâmica dos passos.
+    }
+#endif
+
+    response_add_uint(resp, "pontos", move.points);
+    response_add_uint(resp, "estavel_ms", move.settle_ms);
+    response_add_float(resp, "leitura", move.readback_wl, 3);
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+/**
+ * @brief Handler para o comando `settle`.
+ *
+ * Informa o modelo do tempo de estabilização de cada canal, por sentido:
+ * `t = a_ms + tau_ms · ln(|salto| / 0,01 nm)`, com as medidas efetivas, o erro
+ * de previsão (médio e RMS, verificado nos passos medidos) e os contadores de
+ * passos medidos e previstos. `reset` descarta as medidas dos dois canais.
+ *
+ * @return ESP_OK em sucesso, ESP_ERR_INVALID_ARG para subcomando inválido.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: C subida: n=12.4, a_ms=610, tau_ms=350, erro_ms=48, rms_ms=61, medidos=14, previstos=201 | ...\n`
+ */
+esp_err_t handle_settle(char *args, response_writer_t *resp) {
+    static const char *const dir_keys[SETTLE_DIR_COUNT] = {"sobe", "desce"};
+    static const char *const dir_labels[SETTLE_DIR_COUNT] = {"subida", "descida"};
+    char *sub = strtok_r(args, ":?", &args);
+
+    if (sub != NULL) {
+        if (strcmp(sub, "reset") != 0) return ESP_ERR_INVALID_ARG;
+        for (int i = 0; i < 2; i++) {
+            settle_model_reset(&g_filter_channels[i].settle_model);
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        filter_channel_t *channel = &g_filter_channels[i];
+        for (int dir = 0; dir < SETTLE_DIR_COUNT; dir++) {
+            char key[12], label[16];
+            settle_model_stats_t stats;
+            settle_model_get_stats(&channel->settle_model, (settle_dir_t)dir, &stats);
+            snprintf(key, sizeof(key), "%s_%s", channel->name, dir_keys[dir]);
+            snprintf(label, sizeof(label), "%s %s", channel->name, dir_labels[dir]);
+            response_begin_group(resp, key, label);
+            response_add_float(resp, "n", stats.samples, 1);
+            response_add_float(resp, "a_ms", stats.a_ms, 0);
+            response_add_float(resp, "tau_ms", stats.tau_ms, 0);
+            response_add_float(resp, "erro_ms", stats.err_mean_ms, 0);
+            response_add_float(resp, "rms_ms", stats.err_rms_ms, 0);
+            response_add_uint(resp, "medidos", stats.probes);
+            response_add_uint(resp, "previstos", stats.predictions);
+            response_end_group(resp);
+        }
+    }
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+
+#if CONFIG_SERCALO_RASTER_ENABLE
+/**
+ * @brief Lê um eixo da grade do raster: `<eixo>:<inicio>:<passo>:<n>`.
+ * @param axis_str Nome do eixo (primeiro campo, já separado).
+ * @param saveptr Estado do strtok_r com os campos seguintes.
+ * @return true se os quatro campos são válidos.
+ */
+static bool parse_raster_line(const char *axis_str, char **saveptr, raster_line_t *line) {
+    char *start_str = strtok_r(*saveptr, ":", saveptr);
+    char *step_str = strtok_r(*saveptr, ":", saveptr);
+    char *count_str = strtok_r(*saveptr, ":", saveptr);
+
+    if (!axis_str || !start_str || !step_str || !count_str || !raster_axis_from_name(axis_str, &line->axis)) {
+        return false;
+    }
+    long start = atol(start_str), count = atol(count_str);
+    if (start < 0 || start > 0xFFFF || count < 1 || count > 0xFFFF) {
+        return false;
+    }
+    line->start = (uint16_t)start;
+    line->step = (int32_t)atol(step_str);
+    line->count = (uint16_t)count;
+    return true;
+}
+
+/**
+ * @brief Handler para o comando `raster`.
+ *
+ * Varredura direta dos atuadores do espelho (comando SET), em uma grade 1D ou 2D,
+ * repetida até ser parada. Os atuadores fora da grade mantêm a posição lida (POS)
+ * no início. Cada ponto é publicado no plano de dados (`DATA_PLANE_TYPE_RASTER_POINT`).
+ * - `<banda>:<eixo>:<inicio>:<passo>:<n>[:<eixo>:<inicio>:<passo>:<n>][:pos][:adc]`:
+ *   inicia a varredura; o primeiro eixo é o rápido. Eixos: `xn`, `xp`, `yn`, `yp`.
+ *   `pos` lê a posição e `adc` o fotodetector a cada ponto.
+ * - `<banda>:stop`: para a varredura do canal (também parada por set-wl, sweep e move).
+ * - Sem argumento: estado e taxa (pontos/s) de cada canal.
+ * Com o orçamento do barramento, a varredura ocupa no máximo o que resta do
+ * orçamento: um intervalo sem transações (`intervalo_ms`) segue cada ponto.
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG para argumentos inválidos ou valores fora de 0..65535.
+ * @return ESP_ERR_INVALID_SIZE se a grade excede CONFIG_SERCALO_RASTER_MAX_POINTS.
+ * @return ESP_ERR_NOT_SUPPORTED para `adc` sem o detector habilitado.
+ * @return ESP_ERR_INVALID_STATE se o orçamento do barramento está esgotado.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: pontos=256\n` (com o orçamento: `:ACK: pontos=256, intervalo_ms=40, carga_pct=79.2\n`)
+ * - **Sucesso (consulta):** `:ACK: Canal C: ativo=sim, pontos_grade=256, pontos=1093, passagens=4, erros=0, pontos_s=6.21 | Canal L: ...\n`
+ */
+esp_err_t handle_raster(char *args, response_writer_t *resp) {
+    char *band_str = strtok_r(args, ":?", &args);
+
+    if (band_str == NULL) {
+        for (int i = 0; i < 2; i++) {
+            raster_stats_t stats;
+            raster_get_stats((uint8_t)i, &stats);
+            response_begin_group(resp, g_filter_channels[i].name, g_filter_channels[i].label);
+            response_add_bool(resp, "ativo", stats.active);
+            response_add_uint(resp, "pontos_grade", stats.pass_points);
+            response_add_uint(resp, "pontos", stats.points);
+            response_add_uint(resp, "passagens", stats.passes);
+            response_add_uint(resp, "erros", stats.errors);
+            response_add_float(resp, "pontos_s", stats.points_per_s, 2);
+            response_end_group(resp);
+        }
+        return ESP_OK;
+    }
+
+    filter_channel_t *channel = select_filter_channel(band_str[0]);
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+
+    char *token = strtok_r(args, ":", &args);
+    if (token != NULL && strcmp(token, "stop") == 0) {
+        stop_sweep_if_active(channel);
+        return ESP_OK;
+    }
+
+    raster_config_t config = {0};
+    if (!parse_raster_line(token, &args, &config.fast)) return ESP_ERR_INVALID_ARG;
+    config.slow = (raster_line_t){ .axis = config.fast.axis, .start = config.fast.start, .step = 0, .count = 1 };
+
+    token = strtok_r(args, ":", &args);
+    raster_axis_t axis;
+    if (token != NULL && raster_axis_from_name(token, &axis)) {
+        if (!parse_raster_line(token, &args, &config.slow)) return ESP_ERR_INVALID_ARG;
+        token = strtok_r(args, ":", &args);
+    }
+    for (; token != NULL; token = strtok_r(args, ":", &args)) {
+        if (strcmp(token, "pos") == 0) {
+            config.readback = true;
+        } else if (strcmp(token, "adc") == 0) {
+            config.adc = true;
+        } else {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+#if !CONFIG_SERCALO_DETECTOR_ADC_ENABLE
+    if (config.adc) return ESP_ERR_NOT_SUPPORTED;
+#endif
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    // O raster pede a taxa máxima: sempre é ajustado ao que resta do orçamento.
+    uint32_t point_cost_us = bus_budget_cost_us(BUS_BUDGET_OP_SET);
+    if (config.readback) point_cost_us += bus_budget_cost_us(BUS_BUDGET_OP_POS);
+    esp_err_t admit_ret = bus_budget_admit(channel_index, point_cost_us, &config.point_interval_ms, true);
+    if (admit_ret != ESP_OK) return admit_ret;
+#endif
+
+    stop_sweep_if_active(channel);
+
+    esp_err_t ret = ESP_FAIL;
+    if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
+        ret = ensure_power_on(channel);
+        if (ret == ESP_OK) ret = sercalo_get_mirror_position(&channel->device_handle, &config.base);
+        xSemaphoreGive(g_command_mutex);
+    }
+    if (ret != ESP_OK) return ret;
+
+    channel->last_wl = NAN; // O espelho deixa de estar em um comprimento de onda conhecido.
+    ret = raster_start(&channel->device_handle, channel_index, &config);
+    if (ret != ESP_OK) return ret;
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    power_manager_set_busy(channel_index, true);
+#endif
+
+    response_add_uint(resp, "pontos", (uint32_t)config.fast.count * config.slow.count);
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    bus_budget_commit(channel_index, BUS_BUDGET_RASTER, point_cost_us, config.point_interval_ms);
+    bus_budget_entry_t entry;
+    bus_budget_get_entry(channel_index, &entry);
+    response_add_uint(resp, "intervalo_ms", config.point_interval_ms);
+    response_add_float(resp, "carga_pct", entry.load_permille / 10.0, 1);
+#endif
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_RASTER_ENABLE
+
+#if CONFIG_SERCALO_CHARACTERIZE_ENABLE
+/**
+ * @brief Escreve o resultado de uma caracterização: um grupo por comando, um por salto e o resumo.
+ */
+static void add_characterize_report(const characterize_report_t *report, bool saved, response_writer_t *resp) {
+    for (int op = 0; op < CHARACTERIZE_OP_COUNT; op++) {
+        const characterize_latency_t *lat = &report->latency[op];
+        const char *name = characterize_op_name((characterize_op_t)op);
+        response_begin_group(resp, name, name);
+        response_add_float(resp, "min_ms", lat->min_us / 1000.0, 1);
+        response_add_float(resp, "media_ms", lat->mean_us / 1000.0, 1);
+        response_add_float(resp, "max_ms", lat->max_us / 1000.0, 1);
+        response_end_group(resp);
+    }
+    for (int i = 0; i < report->jumps; i++) {
+        const characterize_settle_t *settle = &report->settle[i];
+        char key[12];
+        snprintf(key, sizeof(key), "salto%d", i + 1);
+        response_begin_group(resp, key, key);
+        response_add_float(resp, "salto_nm", settle->jump_nm, 1);
+        response_add_uint(resp, "subida_ms", settle->up_ms);
+        response_add_uint(resp, "descida_ms", settle->down_ms);
+        response_add_uint(resp, "intervalo_min_ms", settle->dwell_ms);
+        response_end_group(resp);
+    }
+    response_begin_group(resp, "resumo", "resumo");
+    response_add_float(resp, "wl_min", report->min_wl, 3);
+    response_add_float(resp, "wl_max", report->max_wl, 3);
+    response_add_float(resp, "passos_s", report->step_rate, 2);
+    response_add_float(resp, "passos_pos_s", report->step_rate_pos, 2);
+    response_add_uint(resp, "duracao_ms", report->duration_ms);
+    response_add_bool(resp, "salvo", saved);
+    response_end_group(resp);
+}
+
+/**
+ * @brief Handler para o comando `characterize`.
+ *
+ * Sequência automática de medidas no canal (ver characterize.h), menos de 1 minuto:
+ * - `<B>`: latência de cada comando (`min_ms`, `media_ms`, `max_ms`), estabilização
+ *   de saltos de 0,1 nm até a faixa completa nos dois sentidos, com o menor
+ *   `passo_tempo_ms` de uma varredura com aquele passo (`intervalo_min_ms`), e a
+ *   taxa máxima de passos, só com WVL e com leitura de POS.
+ * - `<B>:save`: idem, e incorpora as estabilizações medidas ao modelo usado pelas
+ *   varreduras automáticas (requer o modelo de estabilização).
+ * - `<B>:last`: resultado da última caracterização, sem medir.
+ * A varredura ativa no canal é interrompida; o espelho termina no mínimo da faixa.
+ *
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG para banda ou opção inválidas.
+ * @return ESP_ERR_NOT_FOUND para `last` sem caracterização anterior.
+ * @return ESP_ERR_NOT_SUPPORTED para `save` sem o modelo de estabilização.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: id: min_ms=150.0, media_ms=150.0, max_ms=150.0 | ... | salto1: salto_nm=0.1, subida_ms=1500, descida_ms=1200, intervalo_min_ms=1350 | ... | resumo: wl_min=1527.608, ..., passos_s=6.67, passos_pos_s=3.33, duracao_ms=44700, salvo=0\n`
+ */
+esp_err_t handle_characterize(char *args, response_writer_t *resp) {
+    char *band_str = strtok_r(args, ":", &args);
+    filter_channel_t *channel = (band_str != NULL) ? select_filter_channel(band_str[0]) : NULL;
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+    characterize_report_t report;
+
+    char *option = strtok_r(args, ":", &args);
+    bool save = false;
+    if (option != NULL) {
+        if (strcmp(option, "last") == 0) {
+            if (!characterize_get_report(channel_index, &report)) return ESP_ERR_NOT_FOUND;
+            add_characterize_report(&report, false, resp);
+            return ESP_OK;
+        } else if (strcmp(option, "save") == 0) {
+#if !CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+            return ESP_ERR_NOT_SUPPORTED;
+#endif
+            save = true;
+        } else {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    stop_sweep_if_active(channel);
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    // As medidas passam do tempo de inatividade: o canal não pode entrar em repouso no meio delas.
+    power_manager_set_busy(channel_index, true);
+#endif
+    esp_err_t ret = ESP_FAIL;
+    if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
+        ret = ensure_power_on(channel);
+        xSemaphoreGive(g_command_mutex);
+    }
+    if (ret == ESP_OK) {
+        channel->last_wl = NAN; // O espelho percorre a faixa durante as medidas.
+        ret = characterize_run(&channel->device_handle, channel_index, &report);
+    }
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    power_manager_set_busy(channel_index, false);
+#endif
+    if (ret != ESP_OK) return ret;
+    channel->last_wl = report.min_wl;
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    // As latências medidas também são custos do orçamento do barramento.
+    bus_budget_observe(BUS_BUDGET_OP_WVL_SET, report.latency[CHARACTERIZE_OP_WVL_SET].mean_us);
+    bus_budget_observe(BUS_BUDGET_OP_POS, report.latency[CHARACTERIZE_OP_POS].mean_us);
+#endif
+
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    if (save) {
+        for (int i = 0; i < report.jumps; i++) {
+            settle_model_observe(&channel->settle_model, report.settle[i].jump_nm, report.settle[i].up_ms);
+            settle_model_observe(&channel->settle_model, -report.settle[i].jump_nm, report.settle[i].down_ms);
+        }
+    }
+#endif
+    add_characterize_report(&report, save, resp);
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_CHARACTERIZE_ENABLE
+
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+/**
+ * @brief Handler para o comando `budget`.
+ *
+ * Informa a carga comprometida no barramento: por canal, a atividade periódica
+ * (`nenhuma`, `varredura` ou `raster`), a sua carga, o custo de cada passo ou
+ * ponto e o intervalo entre eles; os custos aprendidos de cada comando; e o
+ * total comprometido, o limite (CONFIG_SERCALO_BUS_BUDGET_PCT) e o que resta.
+ *
+ * @param args Não utilizado neste comando.
+ * @param resp Escritor da resposta (um grupo por canal, `custos` e `total`).
+ * @return ESP_OK sempre.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: Canal C: atividade=varredura, carga_pct=13.2, custo_ms=152.6, intervalo_ms=1000 | Canal L: atividade=nenhuma, ... | custos: wvl_set_ms=152.6, set_ms=152.0, pos_ms=152.0 | total: comprometido_pct=13.2, limite_pct=80, livre_pct=66.8\n`
+ */
+esp_err_t handle_budget(char *args, response_writer_t *resp) {
+    static const char *const kinds[] = {"nenhuma", "varredura", "raster"};
+
+    for (int i = 0; i < 2; i++) {
+        bus_budget_entry_t entry;
+        bus_budget_get_entry((uint8_t)i, &entry);
+        response_begin_group(resp, g_filter_channels[i].name, g_filter_channels[i].label);
+        response_add_str(resp, "atividade", kinds[entry.kind]);
+        response_add_float(resp, "carga_pct", entry.load_permille / 10.0, 1);
+        response_add_float(resp, "custo_ms", entry.cost_us / 1000.0, 1);
+        response_add_uint(resp, "intervalo_ms", entry.interval_ms);
+        response_end_group(resp);
+    }
+
+    response_begin_group(resp, "custos", "custos");
+    for (int op = 0; op < BUS_BUDGET_OP_COUNT; op++) {
+        char key[16];
+        snprintf(key, sizeof(key), "%s_ms", bus_budget_op_name((bus_budget_op_t)op));
+        response_add_float(resp, key, bus_budget_cost_us((bus_budget_op_t)op) / 1000.0, 1);
+    }
+    response_end_group(resp);
+
+    uint32_t committed = bus_budget_committed_permille();
+    uint32_t limit = CONFIG_SERCALO_BUS_BUDGET_PCT * 10;
+    response_begin_group(resp, "total", "total");
+    response_add_float(resp, "comprometido_pct", committed / 10.0, 1);
+    response_add_uint(resp, "limite_pct", CONFIG_SERCALO_BUS_BUDGET_PCT);
+    response_add_float(resp, "livre_pct", (committed < limit) ? (limit - committed) / 10.0 : 0.0, 1);
+    response_end_group(resp);
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_BUS_BUDGET_ENABLE
+
+#if CONFIG_SERCALO_VERIFY_ENABLE
+/**
+ * @brief Adiciona à resposta os contadores e o histograma de um canal.
+ */
+static void add_verify_stats(uint8_t channel_index, response_writer_t *resp) {
+    verify_stats_t stats;
+    verify_get_stats(channel_index, &stats);
+    response_begin_group(resp, g_filter_channels[channel_index].name, g_filter_channels[channel_index].label);
+    response_add_str(resp, "modo", verify_mode_name(stats.mode));
+    response_add_uint(resp, "verificacoes", stats.checks);
+    response_add_uint(resp, "aprovadas", stats.passed);
+    response_add_uint(resp, "repetidas", stats.retried);
+    response_add_uint(resp, "falhas", stats.failed);
+    response_add_uint(resp, "erro_max", stats.max_error);
+    for (int bin = 0; bin < VERIFY_HIST_BINS; bin++) {
+        char key[16];
+        if (bin < VERIFY_HIST_BINS - 1) {
+            snprintf(key, sizeof(key), "le%lu", (unsigned long)verify_bin_limit(bin));
+        } else {
+            snprintf(key, sizeof(key), "gt%lu", (unsigned long)verify_bin_limit(bin - 1));
+        }
+        response_add_uint(resp, key, stats.hist[bin]);
+    }
+    response_end_group(resp);
+}
+
+/**
+ * @brief Handler para o comando `verify`.
+ *
+ * Seleciona a verificação por leitura de volta de um canal (`off`, `wvl` ou
+ * `pos`; a troca zera os contadores), zera os contadores (`reset`) ou informa,
+ * por canal, o modo, os contadores e o histograma do erro final (em pm no modo
+ * `wvl`, em contagens no modo `pos`), com as faixas `le1` ... `le100` e `gt100`.
+ *
+ * @param args Vazio (todos os canais), "[banda]" ou "[banda]:[off|wvl|pos|reset]". Ex: "C:wvl"
+ * @param resp Escritor da resposta (um grupo por canal informado).
+ * @return ESP_OK em caso de sucesso.
+ * @return ESP_ERR_INVALID_ARG se a banda ou o modo forem inválidos.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: Canal C: modo=wvl, verificacoes=120, aprovadas=119, repetidas=3, falhas=1, erro_max=140, le1=101, le2=9, ...\n`
+ * - **Falha (:NACK):** `:NACK: ESP_ERR_INVALID_ARG\n`
+ */
+esp_err_t handle_verify(char *args, response_writer_t *resp) {
+    char *band_str = strtok_r(args, ":", &args);
+    char *action_str = strtok_r(NULL, ":", &args);
+
+    if (band_str == NULL) {
+        for (uint8_t i = 0; i < 2; i++) add_verify_stats(i, resp);
+        return ESP_OK;
+    }
+    filter_channel_t *channel = select_filter_channel(band_str[0]);
+    if (!channel) return ESP_ERR_INVALID_ARG;
+    uint8_t channel_index = (uint8_t)(channel - g_filter_channels);
+
+    if (action_str != NULL) {
+        verify_mode_t mode;
+        if (strcmp(action_str, "reset") == 0) {
+            verify_reset_stats(channel_index);
+        } else if (verify_mode_from_name(action_str, &mode)) {
+            verify_set_mode(channel_index, mode);
+        } else {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    add_verify_stats(channel_index, resp);
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_VERIFY_ENABLE
+
+#if CONFIG_SERCALO_METRICS_ENABLE
+/**
+ * @brief Handler para o comando `metrics`.
+ *
+ * Envia todas as métricas de saúde em um único bloco binário de tamanho fixo
+ * (`metrics_snapshot_t`, little-endian, ver metrics.h): latência dos comandos
+ * na fila e na execução, recusas por fila cheia, contadores do driver I2C e do
+ * plano de dados e, por canal, os passos de varredura (atrasados e histograma
+ * da espera pelo barramento) e a verificação. A coleta apenas copia contadores,
+ * sem transações no barramento; a montagem desta e a duração completa da coleta
+ * anterior vão no próprio bloco.
+ *
+ * @param args Não utilizado neste comando.
+ * @param resp Não utilizado (a resposta é o bloco).
+ * @return ESP_OK em caso de sucesso, ou o erro de command_reply_block_begin.
+ *
+ * @note **Respostas pela Serial:**
+ * - **Sucesso (:ACK):** `:ACK: #3440<440 bytes>\n`
+ */
+esp_err_t handle_metrics(char *args, response_writer_t *resp) {
+    static metrics_snapshot_t snap; // Só a task de comandos executa handlers.
+    int64_t start_us = monotonic_us();
+
+    metrics_snapshot(&snap, (uint32_t)uxQueueMessagesWaiting(g_command_queue), start_us);
+    esp_err_t ret = command_reply_block_begin(sizeof(snap));
+    if (ret != ESP_OK) return ret;
+    command_reply_block_write(&snap, sizeof(snap));
+    command_reply_block_end();
+    metrics_scrape_done((uint32_t)(monotonic_us() - start_us));
+    return ESP_OK;
+}
+#endif // CONFIG_SERCALO_METRICS_ENABLE
+
+// --- Fila de Comandos e Origens ---
+
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+/**
+ * @brief Canal que um comando recém-recebido vai operar, para o despertar antecipado.
+ *
+ * Considera apenas comandos com COMMAND_FLAG_USES_CHANNEL; a banda é o primeiro
+ * argumento de uma letra (ex.: `set-wl:C:...`, `move:bench:L`).
+ * @return Índice do canal, ou -1 se o comando não opera um filtro.
+ */
+static int queued_command_channel(const char *line) {
+    size_t name_len = strcspn(line, "?:");
+    for (int i = 0; i < num_commands; i++) {
+        const char *name = command_table[i].command_name;
+        if (strlen(name) != name_len || strncmp(line, name, name_len) != 0) continue;
+        if (!(command_table[i].flags & COMMAND_FLAG_USES_CHANNEL)) return -1;
+
+        for (const char *arg = line + name_len; *arg != '\0'; ) {
+            arg++; // Separador ('?' ou ':').
+            size_t arg_len = strcspn(arg, "?:");
+            filter_channel_t *channel = (arg_len == 1) ? select_filter_channel(arg[0]) : NULL;
+            if (channel != NULL) return (int)(channel - g_filter_channels);
+            arg += arg_len;
+        }
+        return -1;
     }
+    return -1;
+}
+#endif
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t command_submit(const char *line, const command_source_t *source, void *ctx) {
+    command_request_t request = { .source = source, .ctx = ctx };
+    char reject[48];
+
+    if (line[0] == '@') {
+        // Etiqueta: "@<letras e dígitos> <comando>".
+        size_t tag_len = 1;
+        while (isalnum((unsigned char)line[tag_len]) && tag_len <= COMMAND_TAG_MAX + 1) tag_len++;
+        if (tag_len == 1 || tag_len > COMMAND_TAG_MAX + 1 || line[tag_len] != ' ') {
+            int len = snprintf(reject, sizeof(reject), ":NACK: Etiqueta inválida\n");
+            source->reply(ctx, reject, (size_t)len);
+            return ESP_ERR_INVALID_ARG;
+        }
+        memcpy(request.tag, line, tag_len);
+        request.tag[tag_len] = '\0';
+        line += tag_len + 1;
+    }
+    strncpy(request.line, line, CMD_BUFFER_SIZE - 1);
+    request.line[CMD_BUFFER_SIZE - 1] = '\0';
+
+#if CONFIG_SERCALO_METRICS_ENABLE
+    request.queued_us = monotonic_us();
+#endif
+    // A fila copia a requisição; a origem pode reutilizar seu buffer imediatamente.
+    if (xQueueSend(g_command_queue, &request, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Fila de comandos cheia. Comando de '%s' descartado.", source->name);
+#if CONFIG_SERCALO_METRICS_ENABLE
+        metrics_command_rejected();
+#endif
+        int len = snprintf(reject, sizeof(reject), ":NACK%s: Fila de comandos cheia\n", request.tag);
+        source->reply(ctx, reject, (size_t)len);
+        return ESP_ERR_TIMEOUT;
+    }
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    // O filtro é religado enquanto o comando aguarda a vez na fila.
+    int channel = queued_command_channel(request.line);
+    if (channel >= 0) power_manager_request_wake((uint8_t)channel);
+#endif
     return ESP_OK;
 }
 
+/**
+ * {@inheritdoc}
+ */
+const command_source_t *command_current_source(void **ctx) {
+    if (g_current_request == NULL) return NULL;
+    if (ctx != NULL) *ctx = g_current_request->ctx;
+    return g_current_request->source;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t command_reply_block_begin(size_t len) {
+    command_request_t *request = g_current_request;
+    if (request == NULL || request->replied) return ESP_ERR_INVALID_STATE;
+    const command_source_t *source = request->source;
+
+    // Quadros `:DAT:` no meio do bloco corromperiam a contagem de bytes.
+    if (source->set_stream != NULL && source->stream_enabled(request->ctx)) {
+        source->set_stream(request->ctx, false);
+        request->stream_suspended = true;
+    }
+    if (source->binary_mode != NULL) {
+        source->binary_mode(request->ctx, true);
+    }
+
+    char digits[16], header[48];
+    int digit_count = snprintf(digits, sizeof(digits), "%lu", (unsigned long)len);
+    int header_len = snprintf(header, sizeof(header), ":ACK%s: #%d%s", request->tag, digit_count, digits);
+    source->reply(request->ctx, header, (size_t)header_len);
+    request->replied = true;
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void command_reply_block_write(const void *data, size_t len) {
+    command_request_t *request = g_current_request;
+    if (request == NULL || !request->replied) return;
+    request->source->reply(request->ctx, (const char *)data, len);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void command_reply_block_end(void) {
+    command_request_t *request = g_current_request;
+    if (request == NULL || !request->replied) return;
+    const command_source_t *source = request->source;
+
+    source->reply(request->ctx, "\n", 1);
+    if (source->binary_mode != NULL) {
+        source->binary_mode(request->ctx, false);
+    }
+    if (request->stream_suspended) {
+        source->set_stream(request->ctx, true);
+        request->stream_suspended = false;
+    }
+}
+
+static response_format_t s_console_format = RESPONSE_FORMAT_TEXT; /*!< Formato das respostas no console (comando `format`). */
+
+/**
+ * @brief Envia uma linha de resposta pelo console (UART0).
+ */
+static void console_reply(void *ctx, const char *line, size_t len) {
+    fwrite(line, 1, len, stdout);
+    fflush(stdout);
+}
+
+static esp_err_t console_set_stream(void *ctx, bool enabled) {
+    data_plane_set_console(enabled);
+    return ESP_OK;
+}
+
+static bool console_stream_enabled(void *ctx) {
+    return data_plane_console_enabled();
+}
+
+static esp_err_t console_set_format(void *ctx, response_format_t format) {
+    s_console_format = format;
+    return ESP_OK;
+}
+
+static response_format_t console_get_format(void *ctx) {
+    return s_console_format;
+}
+
+/**
+ * @brief Reserva o console para um bloco binário.
+ *
+ * O stdout fica travado (logs de outras tasks aguardam) e a tradução de '\n'
+ * para "\r\n" é desligada, para que os bytes cheguem intactos.
+ */
+static void console_binary_mode(void *ctx, bool enabled) {
+    fflush(stdout);
+    if (enabled) {
+        flockfile(stdout);
+#if !CONFIG_IDF_TARGET_LINUX
+        uart_vfs_dev_port_set_tx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, ESP_LINE_ENDINGS_LF);
+#endif
+    } else {
+#if !CONFIG_IDF_TARGET_LINUX
+        uart_vfs_dev_port_set_tx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, ESP_LINE_ENDINGS_CRLF);
+#endif
+        funlockfile(stdout);
+    }
+}
+
+/** @brief Origem dos comandos recebidos pela UART do console. */
+static const command_source_t s_console_source = {
+    .name = "uart",
+    .reply = console_reply,
+    .set_stream = console_set_stream,
+    .stream_enabled = console_stream_enabled,
+    .binary_mode = console_binary_mode,
+    .set_format = console_set_format,
+    .get_format = console_get_format,
+};
+
 // --- Tasks de Monitoramento e Processamento ---
 
 /**
@@ -543,7 +2243,7 @@ esp_err_t handle_get_power(char *args, char *response_buf, size_t response_buf_l
  * Esta task roda em um loop contínuo, lendo caracteres da UART. Ela implementa
  * uma máquina de estados simples para detectar o início de um comando (':') e
  * seu fim ('\n' ou '\r'). Uma vez que um comando válido é recebido, ele é
- * copiado para o buffer global e a task `command_processor_task` é notificada.
+ * entregue à fila de comandos, com o console como origem da resposta.
  * @param pvParameters Não utilizado.
  */
 void uart_command_monitor_task(void *pvParameters) {
@@ -569,14 +2269,7 @@ void uart_command_monitor_task(void *pvParameters) {
             if (c == '\n' || c == '\r') {
                 if (idx > 0) { // Se algum caractere foi recebido.
                     uart_buf[idx] = '\0'; // Termina a string.
-
-                    // Usa mutex para garantir escrita segura no buffer global e notificar.
-                    if (xSemaphoreTake(g_command_mutex, portMAX_DELAY) == pdTRUE) {
-                        strncpy(g_received_cmd_buffer, uart_buf, CMD_BUFFER_SIZE - 1);
-                        g_received_cmd_buffer[CMD_BUFFER_SIZE - 1] = '\0';
-                        xTaskNotifyGive(g_command_processor_task_handle);
-                        xSemaphoreGive(g_command_mutex);
-                    }
+                    command_submit(uart_buf, &s_console_source, NULL); // Uma recusa já é respondida.
                 }
                 cmd_started = false; // Retorna ao estado inicial.
             } else if (idx < CMD_BUFFER_SIZE - 1) {
@@ -590,74 +2283,120 @@ void uart_command_monitor_task(void *pvParameters) {
     }
 }
 
+/**
+ * @brief Executa um comando e monta a linha de resposta (`:ACK...` ou `:NACK...`).
+ *
+ * O handler escreve os campos diretamente em `line`, após o espaço reservado ao
+ * maior prefixo (`:ACK@<etiqueta>: `); o prefixo real é escrito logo antes dos
+ * dados, de modo que a linha é enviada sem cópias. Uma resposta que não cabe em
+ * RESPONSE_DATA_BUFFER_SIZE vira `:NACK: ESP_ERR_INVALID_SIZE`.
+ *
+ * @param cmd_line Comando a ser executado (é modificado pela análise).
+ * @param format Formato das respostas da origem.
+ * @param tag Etiqueta do comando ("@<etiqueta>" ou vazia).
+ * @param line Buffer da linha de resposta (RESPONSE_LINE_BUFFER_SIZE bytes).
+ * @param[out] len Tamanho da linha de resposta.
+ * @return Início da linha de resposta, dentro de `line`.
+ */
+static const char *execute_command(char *cmd_line, response_format_t format, const char *tag, char *line, size_t *len) {
+    char *data = line + RESPONSE_ACK_PREFIX_MAX_LEN;
+    int written;
+
+    // Analisa o comando para separar o nome dos argumentos.
+    char *saveptr;
+    char *cmd_name = strtok_r(cmd_line, "?:", &saveptr);
+    char *cmd_args = saveptr;
+
+    if (cmd_name == NULL) {
+        ESP_LOGE(TAG, "Comando inválido ou vazio.");
+        written = snprintf(line, RESPONSE_LINE_BUFFER_SIZE, ":NACK%s: Comando vazio\n", tag);
+        *len = (size_t)written;
+        return line;
+    }
+
+    // Procura e executa o comando correspondente na tabela.
+    for (int i = 0; i < num_commands; i++) {
+        if (strcmp(cmd_name, command_table[i].command_name) == 0) {
+            response_writer_t resp;
+            response_init(&resp, data, RESPONSE_DATA_BUFFER_SIZE, format);
+
+            ESP_LOGD(TAG, "Executando handler para: %s", cmd_name);
+            esp_err_t result = command_table[i].handler(cmd_args, &resp);
+            size_t data_len = response_finish(&resp);
+
+            if (result == ESP_OK && response_overflowed(&resp)) {
+                ESP_LOGE(TAG, "Resposta de \"%s\" excede %d bytes.", cmd_name, RESPONSE_DATA_BUFFER_SIZE);
+                result = ESP_ERR_INVALID_SIZE;
+            }
+
+            // Formata a resposta.
+            if (result != ESP_OK) {
+                written = snprintf(line, RESPONSE_LINE_BUFFER_SIZE, ":NACK%s: %s\n", tag, esp_err_to_name(result));
+                *len = (size_t)written;
+                return line;
+            }
+            if (data_len == 0) {
+                written = snprintf(line, RESPONSE_LINE_BUFFER_SIZE, ":ACK%s\n", tag);
+                *len = (size_t)written;
+                return line;
+            }
+            size_t tag_len = strlen(tag);
+            char *start = data - (sizeof(":ACK: ") - 1) - tag_len;
+            memcpy(start, ":ACK", 4);
+            memcpy(start + 4, tag, tag_len);
+            memcpy(data - 2, ": ", 2);
+            data[data_len] = '\n';
+            *len = (size_t)(data + data_len + 1 - start);
+            return start;
+        }
+    }
+
+    ESP_LOGE(TAG, "Comando desconhecido: \"%s\"", cmd_name);
+    written = snprintf(line, RESPONSE_LINE_BUFFER_SIZE, ":NACK%s: Comando desconhecido\n", tag);
+    *len = (size_t)written;
+    return line;
+}
+
 /**
  * @brief Task que processa os comandos recebidos.
  *
- * Esta tarefa permanece bloqueada até ser notificada pela `uart_command_monitor_task`.
- * Ao ser notificada, ela copia o comando do buffer global, analisa-o, encontra o
- * handler correspondente na `command_table` e o executa. Finalmente, ela imprime
- * a resposta formatada de volta para a UART.
+ * Esta tarefa permanece bloqueada na fila de comandos. A cada comando recebido
+ * (de qualquer origem), ela o analisa, encontra o handler correspondente na
+ * `command_table` e o executa. Finalmente, ela envia a resposta formatada de
+ * volta para a origem do comando.
  * @param pvParameters Não utilizado.
  */
 void command_processor_task(void *pvParameters)
 {
-    g_command_processor_task_handle = xTaskGetCurrentTaskHandle();
-
-    char local_cmd_buffer[CMD_BUFFER_SIZE];
-    char response_buffer[RESPONSE_DATA_BUFFER_SIZE];
+    command_request_t request;
+    char response_line[RESPONSE_LINE_BUFFER_SIZE];
 
     while (1) {
-        // Aguarda a notificação de forma eficiente, sem consumir CPU.
-        if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0) {
-            
-            // Copia o comando para um buffer local para processamento seguro.
-            // A seção crítica garante que a cópia seja atômica.
-            taskENTER_CRITICAL(&g_command_buffer_spinlock);
-            strncpy(local_cmd_buffer, g_received_cmd_buffer, CMD_BUFFER_SIZE - 1);
-            local_cmd_buffer[CMD_BUFFER_SIZE - 1] = '\0';
-            taskEXIT_CRITICAL(&g_command_buffer_spinlock);
-
-            ESP_LOGI(TAG, "Processando comando: \"%s\"", local_cmd_buffer);
-
-            // Analisa o comando para separar o nome dos argumentos.
-            char *saveptr;
-            char *cmd_name = strtok_r(local_cmd_buffer, "?:", &saveptr);
-            char *cmd_args = saveptr;
-
-            if (cmd_name == NULL) {
-                ESP_LOGE(TAG, "Comando inválido ou vazio.");
-                continue;
-            }
-
-            // Procura e executa o comando correspondente na tabela.
-            bool command_found = false;
-            for (int i = 0; i < num_commands; i++) {
-                if (strcmp(cmd_name, command_table[i].command_name) == 0) {
-                    command_found = true;
-                    response_buffer[0] = '\0';
-
-                    ESP_LOGD(TAG, "Executando handler para: %s", cmd_name);
-                    esp_err_t result = command_table[i].handler(cmd_args, response_buffer, RESPONSE_DATA_BUFFER_SIZE);
-
-                    // Imprime a resposta formatada.
-                    if (result == ESP_OK) {
-                        if (strlen(response_buffer) > 0) {
-                            printf(":ACK: %s\n", response_buffer);
-                        } else {
-                            printf(":ACK\n");
-                        }
-                    } else {
-                        printf(":NACK: %s\n", esp_err_to_name(result));
-                    }
-                    
-                    break; // Comando encontrado e executado, sai do loop.
-                }
-            }
+        // Aguarda o próximo comando de forma eficiente, sem consumir CPU.
+        if (xQueueReceive(g_command_queue, &request, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
 
-            if (!command_found) {
-                ESP_LOGE(TAG, "Comando desconhecido: \"%s\"", cmd_name);
-                printf(":NACK: Comando desconhecido\n");
-            }
+        ESP_LOGI(TAG, "Processando comando (%s): \"%s\"", request.source->name, request.line);
+
+        request.replied = false;
+        request.stream_suspended = false;
+        response_format_t format = (request.source->get_format != NULL)
+                                 ? request.source->get_format(request.ctx) : RESPONSE_FORMAT_TEXT;
+        g_current_request = &request;
+#if CONFIG_SERCALO_METRICS_ENABLE
+        int64_t start_us = monotonic_us();
+#endif
+        size_t len;
+        const char *reply = execute_command(request.line, format, request.tag, response_line, &len);
+        g_current_request = NULL;
+#if CONFIG_SERCALO_METRICS_ENABLE
+        metrics_command_done((uint32_t)(start_us - request.queued_us), (uint32_t)(monotonic_us() - start_us),
+                             request.replied || strncmp(reply, ":ACK", 4) == 0);
+#endif
+
+        if (!request.replied) {
+            request.source->reply(request.ctx, reply, len);
         }
     }
 }
@@ -670,6 +2409,10 @@ void command_processor_task(void *pvParameters)
  * @return `ESP_OK` em caso de sucesso, ou um código de erro em caso de falha.
  */
 static esp_err_t i2c_master_init(void) {
+#if CONFIG_SERCALO_I2C_SIMULATOR
+    ESP_LOGW(TAG, "Usando filtros TF1 simulados (CONFIG_SERCALO_I2C_SIMULATOR).");
+    return ESP_OK;
+#else
     i2c_config_t conf = {
         .mode = I2C_MODE_MASTER,
         .sda_io_num = I2C_MASTER_SDA_IO,
@@ -680,6 +2423,7 @@ static esp_err_t i2c_master_init(void) {
     };
     i2c_param_config(I2C_MASTER_NUM, &conf);
     return i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0);
+#endif
 }
 
 /**
@@ -693,22 +2437,96 @@ void app_main(void) {
 
     // Inicializa o Canal da Banda C.
     strncpy(g_filter_channels[0].name, "C", 2);
+    g_filter_channels[0].label = "Canal C";
     g_filter_channels[0].sweep_task_handle = NULL;
+    g_filter_channels[0].last_wl = NAN;
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    settle_model_init(&g_filter_channels[0].settle_model);
+#endif
     ESP_ERROR_CHECK(sercalo_i2c_init_device(&g_filter_channels[0].device_handle, I2C_MASTER_NUM, C_BAND_FILTER_ADDR));
     ESP_LOGI(TAG, "Filtro Banda C inicializado no endereço 0x%02X.", C_BAND_FILTER_ADDR);
 
     // Inicializa o Canal da Banda L.
     strncpy(g_filter_channels[1].name, "L", 2);
+    g_filter_channels[1].label = "Canal L";
     g_filter_channels[1].sweep_task_handle = NULL;
+    g_filter_channels[1].last_wl = NAN;
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+    settle_model_init(&g_filter_channels[1].settle_model);
+#endif
     ESP_ERROR_CHECK(sercalo_i2c_init_device(&g_filter_channels[1].device_handle, I2C_MASTER_NUM, L_BAND_FILTER_ADDR));
     ESP_LOGI(TAG, "Filtro Banda L inicializado no endereço 0x%02X.", L_BAND_FILTER_ADDR);
 
-    // Cria o mutex para proteger o acesso ao I2C.
+    // Cria o mutex para proteger o acesso ao I2C e a fila de comandos.
     g_command_mutex = xSemaphoreCreateMutex();
+    g_command_queue = xQueueCreate(CMD_QUEUE_LENGTH, sizeof(command_request_t));
+
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+    // Planejador de movimentos: usa o mesmo mutex do barramento.
+    ESP_ERROR_CHECK(move_planner_init(g_command_mutex));
+#endif
+#if CONFIG_SERCALO_RASTER_ENABLE
+    // Varredura do espelho: usa o mesmo mutex do barramento.
+    ESP_ERROR_CHECK(raster_init(g_command_mutex));
+#endif
+#if CONFIG_SERCALO_CHARACTERIZE_ENABLE
+    // Autocaracterização: usa o mesmo mutex do barramento.
+    ESP_ERROR_CHECK(characterize_init(g_command_mutex));
+#endif
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+    // Escalonamento EDF dos passos de varredura: ordena o acesso ao mesmo mutex.
+    ESP_ERROR_CHECK(bus_sched_init(g_command_mutex));
+#endif
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    // Orçamento do barramento: custos iniciais pelo modelo de tempo do TF1.
+    ESP_ERROR_CHECK(bus_budget_init(I2C_MASTER_FREQ_HZ));
+#endif
+#if CONFIG_SERCALO_VERIFY_ENABLE
+    // Verificação por leitura de volta: todos os canais começam sem verificação.
+    ESP_ERROR_CHECK(verify_init(g_command_mutex));
+#endif
+#if CONFIG_SERCALO_METRICS_ENABLE
+    // Métricas: antes da primeira origem de comandos.
+    ESP_ERROR_CHECK(metrics_init());
+#endif
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+    // Repouso automático: usa o mesmo mutex do barramento.
+    sercalo_dev_t *const power_devs[] = {&g_filter_channels[0].device_handle, &g_filter_channels[1].device_handle};
+    ESP_ERROR_CHECK(power_manager_init(g_command_mutex, power_devs, 2));
+#endif
+
+    // Inicializa o plano de dados (telemetria) antes das tasks que publicam nele.
+    ESP_ERROR_CHECK(data_plane_init());
+
+    // Detector opcional: sem ADC configurado, os registros saem sem leitura de potência.
+    if (detector_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Detector (ADC) indisponível.");
+    }
+
+#if CONFIG_SERCALO_LOG_ENABLE
+    // Registro em flash: monta a partição antes de qualquer varredura poder registrar.
+    if (sweep_log_init() != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar o registro em flash.");
+    }
+#endif
 
     // Cria as tasks principais da aplicação.
     xTaskCreate(command_processor_task, "CmdProcessorTask", 4096, NULL, 5, NULL); // Prioridade 5
     xTaskCreate(uart_command_monitor_task, "UartMonitorTask", 4096, NULL, 6, NULL); // Prioridade maior para não perder comandos
 
+#if CONFIG_SERCALO_TCP_SERVER_ENABLE
+    // Servidor TCP: mesmos comandos, vários clientes simultâneos.
+    if (tcp_server_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar o servidor TCP.");
+    }
+#endif
+
+#if CONFIG_SERCALO_UDP_STREAM_ENABLE
+    // Streaming UDP: quadros do plano de dados numerados, com reenvio sob pedido.
+    if (udp_stream_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar o streaming UDP.");
+    }
+#endif
+
     ESP_LOGI(TAG, "Sistema pronto. Aguardando comandos via UART...");
 }
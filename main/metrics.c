@@ -0,0 +1,189 @@
+/**************************************************************************************************
+* Arquivo:      metrics.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Implementação das métricas de saúde do controlador (ver metrics.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Tempo de atividade desde metrics_init; relógio no monotonic_clock.h.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "metrics.h"
+
+#if CONFIG_SERCALO_METRICS_ENABLE
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sercalo_i2c.h"
+#include "data_plane.h"
+#include "verify.h"
+#include "monotonic_clock.h"
+
+// Limites das faixas (us): de 100 us (comandos sem transação) a 1 s (travamentos do barramento).
+static const uint32_t s_bin_limit_us[METRICS_HIST_BINS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000,
+};
+
+static struct {
+    uint32_t commands_nack;
+    uint32_t commands_rejected;
+    metrics_hist_t queue_wait;
+    metrics_hist_t execution;
+    uint32_t sweep_steps[METRICS_CHANNELS];
+    uint32_t sweep_overruns[METRICS_CHANNELS];
+    metrics_hist_t sweep_lateness[METRICS_CHANNELS];
+    uint32_t scrapes;
+    uint32_t scrape_last_us;
+    uint32_t scrape_max_us;
+} s_metrics;
+static int64_t s_boot_us;      // Instante de metrics_init, origem do tempo de atividade.
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Funções Auxiliares Internas ---
+
+/**
+ * @brief Soma uma observação ao histograma. Chamada dentro de `s_lock`.
+ */
+static void hist_observe(metrics_hist_t *hist, uint32_t us) {
+    int bin = 0;
+    while (bin < METRICS_HIST_BINS - 1 && us > s_bin_limit_us[bin]) bin++;
+    hist->bins[bin]++;
+    hist->sum_us += us;
+    hist->count++;
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t metrics_init(void) {
+    memset(&s_metrics, 0, sizeof(s_metrics));
+    s_boot_us = monotonic_us();
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t metrics_bin_limit_us(int bin) {
+    return (bin >= 0 && bin < METRICS_HIST_BINS - 1) ? s_bin_limit_us[bin] : UINT32_MAX;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void metrics_command_done(uint32_t queue_us, uint32_t exec_us, bool ok) {
+    taskENTER_CRITICAL(&s_lock);
+    hist_observe(&s_metrics.queue_wait, queue_us);
+    hist_observe(&s_metrics.execution, exec_us);
+    if (!ok) s_metrics.commands_nack++;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void metrics_command_rejected(void) {
+    taskENTER_CRITICAL(&s_lock);
+    s_metrics.commands_rejected++;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void metrics_sweep_step(uint8_t channel, uint32_t lateness_us, bool overrun) {
+    if (channel >= METRICS_CHANNELS) return;
+    taskENTER_CRITICAL(&s_lock);
+    s_metrics.sweep_steps[channel]++;
+    if (overrun) s_metrics.sweep_overruns[channel]++;
+    hist_observe(&s_metrics.sweep_lateness[channel], lateness_us);
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void metrics_snapshot(metrics_snapshot_t *snap, uint32_t queue_depth, int64_t start_us) {
+    memset(snap, 0, sizeof(*snap));
+    snap->version = METRICS_VERSION;
+    snap->bins = METRICS_HIST_BINS;
+    snap->channels = METRICS_CHANNELS;
+#if CONFIG_SERCALO_SWEEP_EDF_ENABLE
+    snap->flags |= METRICS_FLAG_SWEEP_EDF;
+#endif
+#if CONFIG_SERCALO_VERIFY_ENABLE
+    snap->flags |= METRICS_FLAG_VERIFY;
+#endif
+    snap->size = sizeof(*snap);
+    memcpy(snap->bin_limit_us, s_bin_limit_us, sizeof(s_bin_limit_us));
+    snap->uptime_us = (uint64_t)(start_us - s_boot_us);
+    snap->queue_depth = queue_depth;
+
+    taskENTER_CRITICAL(&s_lock);
+    snap->commands_nack = s_metrics.commands_nack;
+    snap->commands_rejected = s_metrics.commands_rejected;
+    snap->queue_wait = s_metrics.queue_wait;
+    snap->execution = s_metrics.execution;
+    for (int i = 0; i < METRICS_CHANNELS; i++) {
+        snap->channel[i].sweep_steps = s_metrics.sweep_steps[i];
+        snap->channel[i].sweep_overruns = s_metrics.sweep_overruns[i];
+        snap->channel[i].sweep_lateness = s_metrics.sweep_lateness[i];
+    }
+    snap->scrapes = s_metrics.scrapes;
+    snap->scrape_last_us = s_metrics.scrape_last_us;
+    snap->scrape_max_us = s_metrics.scrape_max_us;
+    taskEXIT_CRITICAL(&s_lock);
+
+    sercalo_bus_stats_t bus;
+    sercalo_get_bus_stats(&bus);
+    snap->bus_transactions = bus.transactions;
+    snap->bus_errors = bus.bus_errors;
+    snap->bus_invalid_responses = bus.invalid_responses;
+    snap->bus_crc_errors = bus.crc_errors;
+    snap->bus_device_errors = bus.device_errors;
+    snap->bus_busy_us = bus.busy_us;
+
+    data_plane_stats_t dp;
+    data_plane_get_stats(&dp);
+    snap->dp_published = dp.published;
+    snap->dp_dropped = dp.dropped;
+    snap->dp_delivered = dp.delivered;
+    snap->dp_sink_errors = dp.sink_errors;
+    snap->dp_bytes = dp.bytes;
+
+#if CONFIG_SERCALO_VERIFY_ENABLE
+    for (uint8_t i = 0; i < METRICS_CHANNELS && i < VERIFY_MAX_CHANNELS; i++) {
+        verify_stats_t verify;
+        verify_get_stats(i, &verify);
+        snap->channel[i].verify_checks = verify.checks;
+        snap->channel[i].verify_retried = verify.retried;
+        snap->channel[i].verify_failed = verify.failed;
+    }
+#endif
+
+    snap->scrape_build_us = (uint32_t)(monotonic_us() - start_us);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void metrics_scrape_done(uint32_t elapsed_us) {
+    taskENTER_CRITICAL(&s_lock);
+    s_metrics.scrapes++;
+    s_metrics.scrape_last_us = elapsed_us;
+    if (elapsed_us > s_metrics.scrape_max_us) s_metrics.scrape_max_us = elapsed_us;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+#endif // CONFIG_SERCALO_METRICS_ENABLE
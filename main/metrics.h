@@ -0,0 +1,162 @@
+/**************************************************************************************************
+* Arquivo:      metrics.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Métricas de saúde do controlador para monitoramento. Os contadores
+* espalhados pelos módulos (driver I2C, plano de dados, verificação) e os
+* medidos aqui (latência dos comandos na fila e na execução, recusas por fila
+* cheia, passos de varredura atrasados) são copiados para uma estrutura de
+* tamanho fixo e enviados como um único bloco binário pelo comando `metrics`.
+* Os histogramas guardam as contagens por faixa (não cumulativas), a soma e o
+* total, de modo que o host os reproduz sem perda (ex.: em formato Prometheus,
+* interface/metrics_exporter.py).
+*
+* Os contadores nunca são zerados: o host calcula as taxas pelas diferenças.
+* A coleta não aloca memória nem acessa o barramento; o seu tempo é medido e
+* enviado na própria estrutura.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio no monotonic_clock.h (sem metrics_now_us).
+*
+**************************************************************************************************/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_VERSION             1
+#define METRICS_CHANNELS            2
+#define METRICS_HIST_BINS           13      // 12 limites (ver metrics_bin_limit_us) e a faixa acima do maior.
+
+#define METRICS_FLAG_SWEEP_EDF      0x01    // Passos de varredura escalonados por EDF.
+#define METRICS_FLAG_VERIFY         0x02    // Contadores da verificação presentes.
+
+/**
+ * @struct metrics_hist_t
+ * @brief  Histograma de durações em microssegundos.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t bins[METRICS_HIST_BINS];   /*!< Contagem por faixa (não cumulativa); a última não tem limite. */
+    uint64_t sum_us;                    /*!< Soma das durações. */
+    uint32_t count;                     /*!< Total de observações. */
+} metrics_hist_t;
+
+/**
+ * @struct metrics_channel_t
+ * @brief  Contadores de um canal.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t sweep_steps;               /*!< Passos de varredura que tomaram o barramento. */
+    uint32_t sweep_overruns;            /*!< Passos que esperaram o barramento além da folga. */
+    uint32_t verify_checks;             /*!< Verificações por leitura de volta. */
+    uint32_t verify_retried;            /*!< Verificações que repetiram a leitura. */
+    uint32_t verify_failed;             /*!< Verificações fora da tolerância após as repetições. */
+    metrics_hist_t sweep_lateness;      /*!< Espera de cada passo pelo barramento. */
+} metrics_channel_t;
+
+/**
+ * @struct metrics_snapshot_t
+ * @brief  Bloco enviado pelo comando `metrics` (little-endian, sem preenchimento).
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  version;                   /*!< METRICS_VERSION. */
+    uint8_t  bins;                      /*!< METRICS_HIST_BINS. */
+    uint8_t  channels;                  /*!< METRICS_CHANNELS. */
+    uint8_t  flags;                     /*!< METRICS_FLAG_*. */
+    uint32_t size;                      /*!< sizeof(metrics_snapshot_t). */
+    uint32_t bin_limit_us[METRICS_HIST_BINS - 1]; /*!< Limite superior (inclusivo) de cada faixa. */
+    uint64_t uptime_us;                 /*!< Desde metrics_init, na inicialização do firmware. */
+
+    // Fila de comandos.
+    uint32_t commands_nack;             /*!< Comandos respondidos com :NACK. */
+    uint32_t commands_rejected;         /*!< Recusados por fila cheia. */
+    uint32_t queue_depth;               /*!< Comandos aguardando na fila durante a coleta. */
+    metrics_hist_t queue_wait;          /*!< Da entrada na fila ao início da execução. */
+    metrics_hist_t execution;           /*!< Execução do handler (inclui as transações I2C). */
+
+    // Driver I2C (sercalo_get_bus_stats).
+    uint32_t bus_transactions;
+    uint32_t bus_errors;
+    uint32_t bus_invalid_responses;
+    uint32_t bus_crc_errors;
+    uint32_t bus_device_errors;
+    uint64_t bus_busy_us;
+
+    // Plano de dados (data_plane_get_stats).
+    uint32_t dp_published;
+    uint32_t dp_dropped;
+    uint32_t dp_delivered;
+    uint32_t dp_sink_errors;
+    uint64_t dp_bytes;
+
+    metrics_channel_t channel[METRICS_CHANNELS];
+
+    // Custo das coletas.
+    uint32_t scrapes;                   /*!< Coletas anteriores a esta. */
+    uint32_t scrape_build_us;           /*!< Montagem desta estrutura. */
+    uint32_t scrape_last_us;            /*!< Coleta anterior completa (montagem e envio do bloco). */
+    uint32_t scrape_max_us;             /*!< Maior coleta completa. */
+} metrics_snapshot_t;
+
+/**
+ * @brief Zera os contadores e marca a origem do tempo de atividade.
+ */
+esp_err_t metrics_init(void);
+
+/**
+ * @brief Limite superior (inclusivo) da faixa `bin` dos histogramas, em microssegundos.
+ */
+uint32_t metrics_bin_limit_us(int bin);
+
+/**
+ * @brief Contabiliza um comando executado.
+ * @param queue_us Espera na fila.
+ * @param exec_us Duração da execução.
+ * @param ok false se respondido com :NACK.
+ */
+void metrics_command_done(uint32_t queue_us, uint32_t exec_us, bool ok);
+
+/**
+ * @brief Contabiliza um comando recusado por fila cheia.
+ */
+void metrics_command_rejected(void);
+
+/**
+ * @brief Contabiliza um passo de varredura.
+ * @param channel Índice do canal.
+ * @param lateness_us Espera pelo barramento.
+ * @param overrun A espera excedeu a folga do passo.
+ */
+void metrics_sweep_step(uint8_t channel, uint32_t lateness_us, bool overrun);
+
+/**
+ * @brief Copia todos os contadores para `snap`.
+ * @param snap Estrutura de destino.
+ * @param queue_depth Comandos aguardando na fila.
+ * @param start_us Início da coleta (monotonic_us), para `scrape_build_us`.
+ */
+void metrics_snapshot(metrics_snapshot_t *snap, uint32_t queue_depth, int64_t start_us);
+
+/**
+ * @brief Registra a duração de uma coleta completa (montagem e envio).
+ */
+void metrics_scrape_done(uint32_t elapsed_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,240 @@
+/**************************************************************************************************
+* Arquivo:      move_planner.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.3
+*
+* Descrição:    Implementação do planejador de movimentos (ver move_planner.h).
+*
+* Para um oscilador com ressonância w e amortecimento z, um degrau excita uma
+* oscilação de período amortecido Td. Dividindo o degrau em impulsos com
+* amplitudes proporcionais a 1, K (ZV) ou 1, 2K, K² (ZVD), com K = exp(-zπ/√(1-z²)),
+* separados por Td/2, as oscilações se cancelam. O barramento não permite
+* pontos mais próximos que a duração de uma transação; nesse caso o intervalo
+* passa ao menor múltiplo ímpar m de Td/2 que caiba, com K^m no lugar de K
+* (a oscilação do primeiro impulso também está em oposição de fase após m·Td/2).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Intervalo inicial do barramento a partir da espera configurável do driver.
+* [2026-10-18] - [Barino] - [0.1.2] - Barramento reservado só durante cada impulso, não na espera entre eles.
+* [2026-10-18] - [Barino] - [0.1.3] - Relógio monotônico comum (monotonic_us).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "move_planner.h"
+
+#if CONFIG_SERCALO_MOVE_PLANNER_ENABLE
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "monotonic_clock.h"
+
+static const char *TAG = "MOVE_PLANNER";
+
+#define MOVE_RESONANCE_HZ           (CONFIG_SERCALO_MOVE_RESONANCE_CHZ / 100.0)
+#define MOVE_DAMPING                (CONFIG_SERCALO_MOVE_DAMPING_PERMILLE / 1000.0)
+#define MOVE_BUS_GAP_INITIAL_US     ((CONFIG_SERCALO_REPLY_WAIT_MS + 10) * 1000) // Espera do driver mais a transferência.
+#define MOVE_MAX_MULTIPLE           9           // Acima disso, o cancelamento fica sensível demais ao modelo.
+
+#if CONFIG_SERCALO_MOVE_SHAPER_ZV
+#define MOVE_SHAPER_NAME            "zv"
+#else
+#define MOVE_SHAPER_NAME            "zvd"
+#endif
+
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static double s_half_period_us;             // Td/2 do modelo.
+static double s_k;                          // Razão entre impulsos consecutivos.
+static int64_t s_bus_gap_us = MOVE_BUS_GAP_INITIAL_US;
+static uint32_t s_moves = 0;
+static uint32_t s_shaped_moves = 0;
+static uint32_t s_settle_timeouts = 0;
+
+// --- Funções Auxiliares Internas ---
+
+/**
+ * @brief Menor múltiplo ímpar de Td/2 não menor que uma transação (0 se não houver).
+ */
+static uint32_t spacing_multiple(void) {
+    for (uint32_t m = 1; m <= MOVE_MAX_MULTIPLE; m += 2) {
+        if (m * s_half_period_us >= (double)s_bus_gap_us) {
+            return m;
+        }
+    }
+    return 0;
+}
+
+static uint16_t axis_delta(uint16_t a, uint16_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+static uint16_t pos_delta(const sercalo_mirror_pos_t *a, const sercalo_mirror_pos_t *b) {
+    uint16_t d = axis_delta(a->x_neg, b->x_neg);
+    uint16_t e = axis_delta(a->x_pos, b->x_pos);
+    if (e > d) d = e;
+    e = axis_delta(a->y_neg, b->y_neg);
+    if (e > d) d = e;
+    e = axis_delta(a->y_pos, b->y_pos);
+    return (e > d) ? e : d;
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t move_planner_init(SemaphoreHandle_t bus_mutex) {
+    if (bus_mutex == NULL) return ESP_ERR_INVALID_ARG;
+    s_bus_mutex = bus_mutex;
+
+    double root = sqrt(1.0 - MOVE_DAMPING * MOVE_DAMPING);
+    s_half_period_us = 1e6 / (2.0 * MOVE_RESONANCE_HZ * root);
+    s_k = exp(-MOVE_DAMPING * M_PI / root);
+    ESP_LOGI(TAG, "Modelador %s: ressonância %.2f Hz, amortecimento %.3f, Td/2 = %.1f ms",
+             MOVE_SHAPER_NAME, MOVE_RESONANCE_HZ, MOVE_DAMPING, s_half_period_us / 1000.0);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void move_planner_plan(float from_wl, float to_wl, move_plan_t *plan) {
+    plan->count = 1;
+    plan->wl[0] = to_wl;
+    plan->at_ms[0] = 0;
+
+    if (isnan(from_wl) || fabsf(to_wl - from_wl) * 1000.0f < CONFIG_SERCALO_MOVE_MIN_JUMP_PM) {
+        return;
+    }
+    uint32_t m = spacing_multiple();
+    if (m == 0) {
+        return; // Ressonância rápida demais para o barramento: o salto direto é o melhor possível.
+    }
+
+    double km = pow(s_k, m);
+#if CONFIG_SERCALO_MOVE_SHAPER_ZV
+    const double amps[] = {1.0 / (1.0 + km), km / (1.0 + km)};
+#else
+    double norm = (1.0 + km) * (1.0 + km);
+    const double amps[] = {1.0 / norm, 2.0 * km / norm, km * km / norm};
+#endif
+    const int count = sizeof(amps) / sizeof(amps[0]);
+    double spacing_ms = m * s_half_period_us / 1000.0;
+    double fraction = 0.0;
+
+    for (int i = 0; i < count; i++) {
+        fraction += amps[i];
+        plan->wl[i] = from_wl + (float)((to_wl - from_wl) * fraction);
+        plan->at_ms[i] = (uint32_t)(i * spacing_ms + 0.5);
+    }
+    plan->wl[count - 1] = to_wl; // Sem erro de arredondamento no destino.
+    plan->count = (uint8_t)count;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t move_planner_move(sercalo_dev_t *dev, float from_wl, float to_wl, bool shaped,
+                            bool wait_settled, move_result_t *result) {
+    move_plan_t plan = { .count = 1, .wl = {to_wl}, .at_ms = {0} };
+    if (shaped) {
+        move_planner_plan(from_wl, to_wl, &plan);
+    }
+    memset(result, 0, sizeof(*result));
+
+    esp_err_t ret = ESP_OK;
+    int64_t start = monotonic_us();
+    for (int i = 0; i < plan.count && ret == ESP_OK; i++) {
+        // A espera entre impulsos é feita sem o barramento; os instantes contam de `start`,
+        // então uma concessão atrasada atrasa só o próprio impulso.
+        int64_t wait_us = start + (int64_t)plan.at_ms[i] * 1000 - monotonic_us();
+        if (wait_us > 0) {
+            vTaskDelay(pdMS_TO_TICKS((wait_us + 500) / 1000));
+        }
+        if (xSemaphoreTake(s_bus_mutex, portMAX_DELAY) != pdTRUE) return ESP_FAIL;
+        if (i == 0) {
+            s_moves++;
+            if (plan.count > 1) s_shaped_moves++;
+        }
+        float wl = plan.wl[i];
+        int64_t sent = monotonic_us();
+        ret = sercalo_get_set_wavelength(dev, &wl, &result->readback_wl);
+        int64_t duration = monotonic_us() - sent;
+        if (duration > s_bus_gap_us) {
+            s_bus_gap_us = duration; // Os próximos planos respeitam o barramento real.
+        }
+        xSemaphoreGive(s_bus_mutex);
+        if (ret == ESP_OK) {
+            result->points++;
+        }
+    }
+
+    if (ret != ESP_OK || !wait_settled) return ret;
+    return move_planner_wait_settled(dev, start, &result->settle_ms);
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t move_planner_wait_settled(sercalo_dev_t *dev, int64_t since_us, uint32_t *settle_ms) {
+    sercalo_mirror_pos_t prev = {0}, pos;
+    int64_t prev_us = 0, stable_since_us = 0;
+    int64_t deadline = since_us + (int64_t)CONFIG_SERCALO_MOVE_SETTLE_TIMEOUT_MS * 1000;
+    bool have_prev = false;
+    int stable = 0;
+
+    while (1) {
+        esp_err_t ret = ESP_FAIL;
+        int64_t now = 0;
+        // O barramento é liberado entre leituras: o outro canal continua atendido.
+        if (xSemaphoreTake(s_bus_mutex, portMAX_DELAY) == pdTRUE) {
+            now = monotonic_us(); // A posição é amostrada no envio do comando, não na resposta.
+            ret = sercalo_get_mirror_position(dev, &pos);
+            xSemaphoreGive(s_bus_mutex);
+        }
+        if (ret != ESP_OK) return ret;
+
+        if (have_prev && pos_delta(&prev, &pos) <= CONFIG_SERCALO_MOVE_SETTLE_TOLERANCE) {
+            if (stable == 0) stable_since_us = prev_us;
+            if (++stable >= CONFIG_SERCALO_MOVE_SETTLE_READS) {
+                *settle_ms = (uint32_t)((stable_since_us - since_us) / 1000);
+                return ESP_OK;
+            }
+        } else {
+            stable = 0;
+        }
+        if (now >= deadline) {
+            s_settle_timeouts++;
+            return ESP_ERR_TIMEOUT;
+        }
+        prev = pos;
+        prev_us = now;
+        have_prev = true;
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void move_planner_get_status(move_planner_status_t *status) {
+    uint32_t m = spacing_multiple();
+    status->shaper = MOVE_SHAPER_NAME;
+    status->resonance_hz = MOVE_RESONANCE_HZ;
+    status->damping = MOVE_DAMPING;
+    status->min_jump_nm = CONFIG_SERCALO_MOVE_MIN_JUMP_PM / 1000.0f;
+    status->bus_gap_ms = (uint32_t)(s_bus_gap_us / 1000);
+    status->spacing_ms = (uint32_t)(m * s_half_period_us / 1000.0 + 0.5);
+    status->moves = s_moves;
+    status->shaped_moves = s_shaped_moves;
+    status->settle_timeouts = s_settle_timeouts;
+}
+
+#endif // CONFIG_SERCALO_MOVE_PLANNER_ENABLE
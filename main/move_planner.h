@@ -0,0 +1,130 @@
+/**************************************************************************************************
+* Arquivo:      move_planner.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.2
+*
+* Descrição:    Planejador de movimentos do espelho MEMS. Um salto grande de
+* comprimento de onda (ex.: o retorno ao início de cada ciclo de varredura)
+* faz o espelho oscilar por muito mais tempo que um passo pequeno. O
+* planejador divide o salto em uma sequência moldada de pontos intermediários
+* (input shaping ZV/ZVD), com instantes calculados a partir da ressonância e
+* do amortecimento do espelho, de modo que as oscilações excitadas por cada
+* ponto se cancelem. A estabilização é detectada pela leitura da posição
+* (comando POS).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Barramento reservado a cada ponto do movimento, não durante toda a sequência.
+* [2026-10-18] - [Barino] - [0.1.2] - Relógio no monotonic_clock.h (monotonic_us).
+*
+**************************************************************************************************/
+
+#ifndef MOVE_PLANNER_H
+#define MOVE_PLANNER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sercalo_i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOVE_PLANNER_MAX_POINTS     3           // ZVD: três impulsos.
+
+/**
+ * @struct move_plan_t
+ * @brief  Sequência de pontos de um movimento. O último ponto é sempre o destino.
+ */
+typedef struct {
+    uint8_t count;                              /*!< Número de pontos (1 = salto direto). */
+    float wl[MOVE_PLANNER_MAX_POINTS];          /*!< Comprimento de onda de cada ponto (nm). */
+    uint32_t at_ms[MOVE_PLANNER_MAX_POINTS];    /*!< Instante de cada ponto, relativo ao primeiro. */
+} move_plan_t;
+
+/**
+ * @struct move_result_t
+ * @brief  Resultado de um movimento executado.
+ */
+typedef struct {
+    uint8_t points;             /*!< Pontos enviados ao filtro. */
+    float readback_wl;          /*!< Comprimento de onda reportado na resposta do último ponto. */
+    uint32_t settle_ms;         /*!< Do primeiro ponto até a posição estabilizar (0 se não aguardado). */
+} move_result_t;
+
+/**
+ * @struct move_planner_status_t
+ * @brief  Parâmetros em uso e contadores do planejador.
+ */
+typedef struct {
+    const char *shaper;         /*!< "zv" ou "zvd". */
+    float resonance_hz;         /*!< Ressonância do modelo do espelho. */
+    float damping;              /*!< Razão de amortecimento do modelo. */
+    float min_jump_nm;          /*!< Saltos menores são enviados diretamente. */
+    uint32_t bus_gap_ms;        /*!< Maior duração observada de uma transação (intervalo mínimo entre pontos). */
+    uint32_t spacing_ms;        /*!< Intervalo entre pontos de um movimento moldado. */
+    uint32_t moves;             /*!< Movimentos executados. */
+    uint32_t shaped_moves;      /*!< Dos quais moldados (mais de um ponto). */
+    uint32_t settle_timeouts;   /*!< Esperas de estabilização que expiraram. */
+} move_planner_status_t;
+
+/**
+ * @brief Inicializa o planejador.
+ * @param bus_mutex Mutex que protege o barramento I2C (tomado a cada transação).
+ */
+esp_err_t move_planner_init(SemaphoreHandle_t bus_mutex);
+
+/**
+ * @brief Calcula a sequência de pontos de `from_wl` a `to_wl`.
+ *
+ * Saltos menores que CONFIG_SERCALO_MOVE_MIN_JUMP_PM, ou com origem desconhecida
+ * (`from_wl` NaN), resultam em um único ponto. Os pontos de um salto moldado
+ * ficam separados por um múltiplo ímpar de meio período amortecido, o menor
+ * que não seja mais curto que uma transação no barramento.
+ */
+void move_planner_plan(float from_wl, float to_wl, move_plan_t *plan);
+
+/**
+ * @brief Move o filtro de `from_wl` até `to_wl`.
+ *
+ * O barramento é reservado a cada ponto da sequência e liberado na espera entre
+ * eles e entre as leituras da estabilização. Os instantes contam do início do
+ * movimento: uma concessão atrasada atrasa só aquele ponto.
+ *
+ * @param shaped false envia o destino diretamente (referência para comparação).
+ * @param wait_settled Aguarda a posição estabilizar (`result->settle_ms`).
+ * @return ESP_OK em sucesso, ESP_ERR_TIMEOUT se a posição não estabilizou em
+ *         CONFIG_SERCALO_MOVE_SETTLE_TIMEOUT_MS, ou o erro da comunicação.
+ */
+esp_err_t move_planner_move(sercalo_dev_t *dev, float from_wl, float to_wl, bool shaped,
+                            bool wait_settled, move_result_t *result);
+
+/**
+ * @brief Aguarda a posição do espelho estabilizar.
+ *
+ * A posição é considerada estável quando CONFIG_SERCALO_MOVE_SETTLE_READS
+ * leituras consecutivas de POS variam no máximo CONFIG_SERCALO_MOVE_SETTLE_TOLERANCE
+ * contagens em relação à anterior, em todos os eixos.
+ *
+ * @param since_us Início do movimento (relógio de `monotonic_us`).
+ * @param[out] settle_ms Tempo de `since_us` até a primeira leitura estável.
+ */
+esp_err_t move_planner_wait_settled(sercalo_dev_t *dev, int64_t since_us, uint32_t *settle_ms);
+
+/**
+ * @brief Obtém os parâmetros e contadores do planejador.
+ */
+void move_planner_get_status(move_planner_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOVE_PLANNER_H
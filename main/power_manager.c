@@ -0,0 +1,333 @@
+/**************************************************************************************************
+* Arquivo:      power_manager.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Implementação do gerenciamento de energia dos filtros (ver power_manager.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Relógio monotônico comum (monotonic_us).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "power_manager.h"
+
+#if CONFIG_SERCALO_IDLE_POWER_ENABLE
+
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "monotonic_clock.h"
+
+static const char *TAG = "POWER";
+
+#define POWER_TASK_STACK_SIZE       3072
+#define POWER_TASK_PRIORITY         4           // Abaixo das varreduras e dos comandos.
+#define POWER_MAX_POLL_MS           1000
+// Antecedência do despertar antes de um passo anunciado: a transação POW, a
+// estabilização e uma folga para esperar o barramento.
+#define POWER_WAKE_LEAD_US          ((int64_t)(CONFIG_SERCALO_REPLY_WAIT_MS + 10 + CONFIG_SERCALO_WAKE_SETTLE_MS + 50) * 1000)
+
+/**
+ * @brief Estado de um canal. `state` só muda com o mutex do barramento tomado;
+ * todos os campos são lidos e escritos dentro de `s_lock`.
+ */
+typedef struct {
+    sercalo_dev_t *dev;
+    power_state_t state;
+    int64_t last_activity_us;
+    int64_t expected_us;        /*!< Próxima atividade anunciada (0: nenhuma). */
+    int64_t wake_at_us;         /*!< Despertar agendado (0: nenhum). */
+    int64_t ready_at_us;        /*!< Fim da estabilização do último despertar. */
+    bool busy;
+    bool wake_requested;
+    uint32_t sleeps;
+    uint32_t early_wakes;
+    uint32_t inline_wakes;
+    uint32_t wake_wait_ms;
+} power_channel_t;
+
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static TaskHandle_t s_task = NULL;
+static power_channel_t s_channels[POWER_MANAGER_MAX_CHANNELS];
+static uint8_t s_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Funções Auxiliares Internas ---
+
+static TickType_t us_to_ticks(int64_t us) {
+    return (us > 0) ? pdMS_TO_TICKS((us + 999) / 1000) : 0;
+}
+
+/**
+ * @brief Indica se o canal deve entrar em repouso agora. Chamar dentro de `s_lock`.
+ */
+static bool should_sleep(const power_channel_t *ch, int64_t now) {
+    if (ch->state == POWER_STATE_ASLEEP || ch->wake_requested) return false;
+    if (!ch->busy) {
+        return now - ch->last_activity_us >= (int64_t)CONFIG_SERCALO_IDLE_TIMEOUT_MS * 1000;
+    }
+    // Ocupado: só dorme em um intervalo anunciado longo o bastante.
+    return ch->expected_us != 0 && ch->expected_us - now >= (int64_t)CONFIG_SERCALO_IDLE_GAP_MIN_MS * 1000;
+}
+
+/**
+ * @brief Próximo instante em que a task precisa reavaliar algum canal.
+ */
+static TickType_t next_poll_ticks(void) {
+    int64_t now = monotonic_us();
+    int64_t wait = (int64_t)POWER_MAX_POLL_MS * 1000;
+
+    taskENTER_CRITICAL(&s_lock);
+    for (uint8_t i = 0; i < s_count; i++) {
+        const power_channel_t *ch = &s_channels[i];
+        if (ch->wake_at_us != 0 && ch->wake_at_us - now < wait) {
+            wait = ch->wake_at_us - now;
+        }
+        if (!ch->busy && ch->state != POWER_STATE_ASLEEP) {
+            int64_t idle_end = ch->last_activity_us + (int64_t)CONFIG_SERCALO_IDLE_TIMEOUT_MS * 1000;
+            if (idle_end - now < wait) wait = idle_end - now;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return us_to_ticks(wait);
+}
+
+/**
+ * @brief Aplica um modo de energia. Chamar com o mutex do barramento tomado.
+ */
+static esp_err_t set_mode(power_channel_t *ch, sercalo_power_mode_t mode) {
+    esp_err_t ret = sercalo_get_set_power_mode(ch->dev, &mode, NULL);
+    if (ret == ESP_OK) {
+        taskENTER_CRITICAL(&s_lock);
+        ch->state = (mode == SERCALO_POWER_NORMAL) ? POWER_STATE_AWAKE : POWER_STATE_ASLEEP;
+        if (mode == SERCALO_POWER_NORMAL) {
+            ch->ready_at_us = monotonic_us() + (int64_t)CONFIG_SERCALO_WAKE_SETTLE_MS * 1000;
+        }
+        taskEXIT_CRITICAL(&s_lock);
+    }
+    return ret;
+}
+
+/**
+ * @brief Despertares pedidos/agendados e repousos por inatividade de um canal.
+ */
+static void service_channel(uint8_t index) {
+    power_channel_t *ch = &s_channels[index];
+    int64_t now = monotonic_us();
+
+    taskENTER_CRITICAL(&s_lock);
+    bool wake = ch->wake_requested || (ch->wake_at_us != 0 && now >= ch->wake_at_us);
+    bool sleep = !wake && should_sleep(ch, now);
+    taskEXIT_CRITICAL(&s_lock);
+    if (!wake && !sleep) return;
+
+    if (xSemaphoreTake(s_bus_mutex, portMAX_DELAY) != pdTRUE) return;
+    taskENTER_CRITICAL(&s_lock);
+    // Reavalia com o barramento tomado: um comando pode ter religado o filtro enquanto esperávamos.
+    now = monotonic_us();
+    wake = wake && ch->state != POWER_STATE_AWAKE;
+    sleep = sleep && should_sleep(ch, now);
+    ch->wake_requested = false;
+    if (!sleep) ch->wake_at_us = 0;
+    int64_t wake_at = (ch->busy && ch->expected_us != 0) ? ch->expected_us - POWER_WAKE_LEAD_US : 0;
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (wake) {
+        if (set_mode(ch, SERCALO_POWER_NORMAL) == ESP_OK) {
+            taskENTER_CRITICAL(&s_lock);
+            ch->early_wakes++;
+            taskEXIT_CRITICAL(&s_lock);
+            ESP_LOGD(TAG, "Canal %u religado antecipadamente", index);
+        }
+    } else if (sleep) {
+        if (set_mode(ch, SERCALO_POWER_LOW) == ESP_OK) {
+            taskENTER_CRITICAL(&s_lock);
+            ch->sleeps++;
+            ch->wake_at_us = wake_at; // Intervalo anunciado: religa antes do próximo passo.
+            taskEXIT_CRITICAL(&s_lock);
+            ESP_LOGI(TAG, "Canal %u em repouso", index);
+        }
+    }
+    xSemaphoreGive(s_bus_mutex);
+}
+
+/**
+ * @brief Task de energia: aguarda pedidos ou o próximo prazo e atende os canais.
+ */
+static void power_task(void *pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, next_poll_ticks());
+        for (uint8_t i = 0; i < s_count; i++) {
+            service_channel(i);
+        }
+    }
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t power_manager_init(SemaphoreHandle_t bus_mutex, sercalo_dev_t *const devs[], uint8_t count) {
+    if (bus_mutex == NULL || devs == NULL || count == 0 || count > POWER_MANAGER_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_bus_mutex = bus_mutex;
+    memset(s_channels, 0, sizeof(s_channels));
+    int64_t now = monotonic_us();
+    for (uint8_t i = 0; i < count; i++) {
+        s_channels[i].dev = devs[i];
+        s_channels[i].last_activity_us = now;
+    }
+    s_count = count;
+
+    if (xTaskCreate(power_task, "power_task", POWER_TASK_STACK_SIZE, NULL, POWER_TASK_PRIORITY, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Repouso após %d ms sem atividade (intervalos de varredura a partir de %d ms)",
+             CONFIG_SERCALO_IDLE_TIMEOUT_MS, CONFIG_SERCALO_IDLE_GAP_MIN_MS);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t power_manager_ensure_awake(uint8_t channel) {
+    if (channel >= s_count) return ESP_ERR_INVALID_ARG;
+    power_channel_t *ch = &s_channels[channel];
+
+    power_manager_touch(channel);
+    taskENTER_CRITICAL(&s_lock);
+    power_state_t state = ch->state;
+    int64_t remaining = ch->ready_at_us - monotonic_us();
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (state == POWER_STATE_UNKNOWN) {
+        sercalo_power_mode_t mode;
+        esp_err_t ret = sercalo_get_set_power_mode(ch->dev, NULL, &mode);
+        if (ret != ESP_OK) return ESP_FAIL;
+        if (mode == SERCALO_POWER_NORMAL) {
+            taskENTER_CRITICAL(&s_lock);
+            ch->state = POWER_STATE_AWAKE;
+            taskEXIT_CRITICAL(&s_lock);
+            return ESP_OK;
+        }
+        state = POWER_STATE_ASLEEP;
+    }
+
+    if (state == POWER_STATE_AWAKE) {
+        if (remaining > 0) {
+            // Despertar antecipado ainda estabilizando: espera apenas o restante.
+            vTaskDelay(us_to_ticks(remaining));
+            taskENTER_CRITICAL(&s_lock);
+            ch->wake_wait_ms += (uint32_t)((remaining + 999) / 1000);
+            taskEXIT_CRITICAL(&s_lock);
+        }
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Canal %u em repouso. Ativando...", channel);
+    if (set_mode(ch, SERCALO_POWER_NORMAL) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao ativar o modo de energia para o canal %u", channel);
+        return ESP_FAIL;
+    }
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_SERCALO_WAKE_SETTLE_MS));
+    taskENTER_CRITICAL(&s_lock);
+    ch->inline_wakes++;
+    taskEXIT_CRITICAL(&s_lock);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void power_manager_touch(uint8_t channel) {
+    if (channel >= s_count) return;
+    taskENTER_CRITICAL(&s_lock);
+    s_channels[channel].last_activity_us = monotonic_us();
+    s_channels[channel].expected_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void power_manager_request_wake(uint8_t channel) {
+    if (channel >= s_count) return;
+    bool notify;
+    taskENTER_CRITICAL(&s_lock);
+    power_channel_t *ch = &s_channels[channel];
+    ch->last_activity_us = monotonic_us();
+    notify = (ch->state != POWER_STATE_AWAKE);
+    if (notify) ch->wake_requested = true;
+    taskEXIT_CRITICAL(&s_lock);
+    if (notify && s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void power_manager_set_busy(uint8_t channel, bool busy) {
+    if (channel >= s_count) return;
+    taskENTER_CRITICAL(&s_lock);
+    s_channels[channel].busy = busy;
+    s_channels[channel].last_activity_us = monotonic_us();
+    s_channels[channel].expected_us = 0;
+    if (!busy) s_channels[channel].wake_at_us = 0;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void power_manager_expect(uint8_t channel, uint32_t delay_ms) {
+    if (channel >= s_count) return;
+    int64_t now = monotonic_us();
+    taskENTER_CRITICAL(&s_lock);
+    s_channels[channel].last_activity_us = now;
+    s_channels[channel].expected_us = now + (int64_t)delay_ms * 1000;
+    taskEXIT_CRITICAL(&s_lock);
+    if (delay_ms >= CONFIG_SERCALO_IDLE_GAP_MIN_MS && s_task != NULL) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void power_manager_note_mode(uint8_t channel, sercalo_power_mode_t mode) {
+    if (channel >= s_count) return;
+    taskENTER_CRITICAL(&s_lock);
+    s_channels[channel].state = (mode == SERCALO_POWER_NORMAL) ? POWER_STATE_AWAKE : POWER_STATE_ASLEEP;
+    s_channels[channel].last_activity_us = monotonic_us();
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void power_manager_get_status(uint8_t channel, power_manager_status_t *status) {
+    memset(status, 0, sizeof(*status));
+    if (channel >= s_count) return;
+    int64_t now = monotonic_us();
+    taskENTER_CRITICAL(&s_lock);
+    const power_channel_t *ch = &s_channels[channel];
+    status->state = ch->state;
+    status->idle_ms = (uint32_t)((now - ch->last_activity_us) / 1000);
+    status->sleeps = ch->sleeps;
+    status->early_wakes = ch->early_wakes;
+    status->inline_wakes = ch->inline_wakes;
+    status->wake_wait_ms = ch->wake_wait_ms;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+#endif // CONFIG_SERCALO_IDLE_POWER_ENABLE
@@ -0,0 +1,125 @@
+/**************************************************************************************************
+* Arquivo:      power_manager.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Gerenciamento automático de energia dos filtros. Um canal sem
+* atividade por CONFIG_SERCALO_IDLE_TIMEOUT_MS passa ao modo de baixo consumo
+* (SERCALO_POWER_LOW). O despertar é antecipado: quando um comando para o
+* canal entra na fila, ou antes do próximo passo anunciado por uma varredura,
+* uma task própria religa o filtro, de modo que a espera do despertar se
+* sobrepõe a outras atividades em vez de atrasar a resposta do comando.
+*
+* O estado de cada filtro é acompanhado pelo módulo: com o filtro sabidamente
+* ligado, garantir o modo normal não custa nenhuma transação no barramento.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Medidas longas também marcam o canal como ocupado.
+*
+**************************************************************************************************/
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sercalo_i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POWER_MANAGER_MAX_CHANNELS  2
+
+/**
+ * @brief Estado conhecido de um filtro.
+ */
+typedef enum {
+    POWER_STATE_UNKNOWN = 0,    /*!< Ainda não consultado (início). */
+    POWER_STATE_AWAKE,          /*!< Modo normal. */
+    POWER_STATE_ASLEEP,         /*!< Modo de baixo consumo. */
+} power_state_t;
+
+/**
+ * @struct power_manager_status_t
+ * @brief  Estado e contadores de um canal.
+ */
+typedef struct {
+    power_state_t state;
+    uint32_t idle_ms;           /*!< Tempo desde a última atividade. */
+    uint32_t sleeps;            /*!< Passagens ao modo de baixo consumo. */
+    uint32_t early_wakes;       /*!< Despertares antecipados (fila de comandos ou varredura). */
+    uint32_t inline_wakes;      /*!< Despertares no caminho do comando (espera inteira). */
+    uint32_t wake_wait_ms;      /*!< Espera total de comandos por um despertar em andamento. */
+} power_manager_status_t;
+
+/**
+ * @brief Inicializa o módulo e cria a task de energia.
+ * @param bus_mutex Mutex que protege o barramento I2C.
+ * @param devs Dispositivos, indexados pelo canal.
+ * @param count Número de canais (até POWER_MANAGER_MAX_CHANNELS).
+ */
+esp_err_t power_manager_init(SemaphoreHandle_t bus_mutex, sercalo_dev_t *const devs[], uint8_t count);
+
+/**
+ * @brief Garante o modo normal do canal. Deve ser chamada com o mutex do barramento tomado.
+ *
+ * Com o filtro sabidamente ligado, retorna sem transações (aguardando apenas o
+ * restante da estabilização de um despertar antecipado recente). Caso contrário,
+ * religa o filtro no próprio caminho do comando.
+ */
+esp_err_t power_manager_ensure_awake(uint8_t channel);
+
+/**
+ * @brief Registra atividade no canal (adia o repouso).
+ */
+void power_manager_touch(uint8_t channel);
+
+/**
+ * @brief Pede o despertar antecipado do canal. Nunca bloqueia.
+ *
+ * Chamada quando um comando para o canal entra na fila: a task de energia religa
+ * o filtro enquanto o comando aguarda a sua vez.
+ */
+void power_manager_request_wake(uint8_t channel);
+
+/**
+ * @brief Marca o canal como em uso contínuo: uma task (varredura, raster) ou uma
+ *        medida longa (characterize, move:bench).
+ *
+ * Um canal ocupado não entra em repouso por inatividade, apenas nos intervalos
+ * anunciados com `power_manager_expect`.
+ */
+void power_manager_set_busy(uint8_t channel, bool busy);
+
+/**
+ * @brief Anuncia a próxima atividade do canal daqui a `delay_ms`.
+ *
+ * Intervalos a partir de CONFIG_SERCALO_IDLE_GAP_MIN_MS são passados em repouso,
+ * e o filtro é religado antes do fim do intervalo, a tempo de estar estável.
+ */
+void power_manager_expect(uint8_t channel, uint32_t delay_ms);
+
+/**
+ * @brief Registra um modo aplicado fora do módulo (ex.: comando powerup).
+ */
+void power_manager_note_mode(uint8_t channel, sercalo_power_mode_t mode);
+
+/**
+ * @brief Obtém o estado e os contadores de um canal.
+ */
+void power_manager_get_status(uint8_t channel, power_manager_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,290 @@
+/**************************************************************************************************
+* Arquivo:      raster.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.2.2
+*
+* Descrição:    Implementação da varredura direta do espelho (ver raster.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.2.0] - Intervalo entre os pontos e custos medidos para o orçamento do barramento.
+* [2026-10-18] - [Barino] - [0.2.1] - Relógio monotônico comum (monotonic_us).
+* [2026-10-18] - [Barino] - [0.2.2] - Tempos das transações medidos só com o orçamento.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "raster.h"
+
+#if CONFIG_SERCALO_RASTER_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "data_plane.h"
+#include "detector.h"
+#include "bus_budget.h"
+#include "monotonic_clock.h"
+
+static const char *TAG = "RASTER";
+
+#define RASTER_TASK_STACK_SIZE      4096
+#define RASTER_TASK_PRIORITY        5           // A mesma das varreduras de comprimento de onda.
+#define RASTER_STOP_POLL_MS         10
+
+/**
+ * @brief Estado da varredura de um canal. `frames` e `config` pertencem à task
+ * enquanto `running`; só são alterados com a task parada.
+ */
+typedef struct {
+    sercalo_dev_t *dev;
+    uint8_t channel;
+    raster_config_t config;
+    uint8_t (*frames)[SERCALO_SET_FRAME_LEN];   /*!< Quadro SET de cada ponto, na ordem da grade. */
+    uint32_t count;
+    volatile bool running;
+    volatile bool stop;
+    uint32_t points;
+    uint32_t passes;
+    uint32_t errors;
+    int64_t start_us;
+    float pass_rate;                            /*!< Pontos/s da última passagem completa. */
+} raster_state_t;
+
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static raster_state_t s_raster[RASTER_MAX_CHANNELS];
+
+// --- Funções Auxiliares Internas ---
+
+static uint16_t *axis_value(sercalo_mirror_pos_t *pos, raster_axis_t axis) {
+    switch (axis) {
+    case RASTER_AXIS_X_NEG: return &pos->x_neg;
+    case RASTER_AXIS_X_POS: return &pos->x_pos;
+    case RASTER_AXIS_Y_NEG: return &pos->y_neg;
+    default:                return &pos->y_pos;
+    }
+}
+
+static bool line_in_range(const raster_line_t *line) {
+    int64_t last = (int64_t)line->start + (int64_t)line->step * (line->count - 1);
+    return line->count > 0 && line->axis < RASTER_AXIS_COUNT && last >= 0 && last <= 0xFFFF;
+}
+
+/**
+ * @brief Posição comandada no ponto (`row`, `col`) da grade.
+ */
+static void point_position(const raster_config_t *config, uint16_t row, uint16_t col, sercalo_mirror_pos_t *pos) {
+    *pos = config->base;
+    *axis_value(pos, config->slow.axis) = (uint16_t)(config->slow.start + config->slow.step * row);
+    *axis_value(pos, config->fast.axis) = (uint16_t)(config->fast.start + config->fast.step * col);
+}
+
+/**
+ * @brief Copia os eixos para um campo do registro (empacotado, sem alinhamento garantido).
+ */
+static void copy_axes(void *out, const sercalo_mirror_pos_t *pos) {
+    const uint16_t axes[4] = {pos->x_neg, pos->x_pos, pos->y_neg, pos->y_pos};
+    memcpy(out, axes, sizeof(axes));
+}
+
+/**
+ * @brief Task da varredura: reenvia os quadros pré-codificados até `stop`.
+ *
+ * Cada ponto toma o barramento apenas durante as suas transações (SET e, se
+ * pedido, POS); o outro canal continua sendo atendido entre os pontos.
+ */
+static void raster_task(void *pvParameters) {
+    raster_state_t *s = (raster_state_t *)pvParameters;
+    const raster_config_t *config = &s->config;
+    const uint16_t cols = config->fast.count;
+    bool want_frames = data_plane_wants(DATA_PLANE_TYPE_RASTER_POINT);
+
+    while (!s->stop) {
+        int64_t pass_start = monotonic_us();
+        uint32_t i;
+        for (i = 0; i < s->count && !s->stop; i++) {
+            sercalo_mirror_pos_t readback = {0};
+            esp_err_t ret = ESP_FAIL, pos_ret = ESP_FAIL;
+
+            if (xSemaphoreTake(s_bus_mutex, portMAX_DELAY) == pdTRUE) {
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+                int64_t set_start = monotonic_us();
+#endif
+                ret = sercalo_send_frame(s->dev, s->frames[i], SERCALO_SET_FRAME_LEN, NULL, NULL, 0);
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+                int64_t set_end = monotonic_us();
+#endif
+                if (ret == ESP_OK && config->readback) {
+                    pos_ret = sercalo_get_mirror_position(s->dev, &readback);
+                }
+                xSemaphoreGive(s_bus_mutex);
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+                if (ret == ESP_OK) bus_budget_observe(BUS_BUDGET_OP_SET, (uint32_t)(set_end - set_start));
+                if (pos_ret == ESP_OK) bus_budget_observe(BUS_BUDGET_OP_POS, (uint32_t)(monotonic_us() - set_end));
+#endif
+            }
+            s->points++;
+            if (ret != ESP_OK) s->errors++;
+
+            if (i % cols == 0) {
+                want_frames = data_plane_wants(DATA_PLANE_TYPE_RASTER_POINT); // Uma consulta por linha.
+            }
+            if (want_frames) {
+                sercalo_mirror_pos_t target;
+                uint16_t row = (uint16_t)(i / cols), col = (uint16_t)(i % cols);
+                point_position(config, row, col, &target);
+                dp_raster_point_t record = {
+                    .timestamp_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS),
+                    .pass = s->passes,
+                    .row = row,
+                    .col = col,
+                    .adc = DETECTOR_NO_SAMPLE,
+                    .flags = (ret == ESP_OK) ? 0 : DP_RASTER_FLAG_ERROR,
+                };
+                copy_axes(record.target, &target);
+                if (pos_ret == ESP_OK) {
+                    copy_axes(record.readback, &readback);
+                    record.flags |= DP_RASTER_FLAG_READBACK;
+                }
+                uint16_t adc;
+                if (config->adc && detector_read(&adc) == ESP_OK) {
+                    record.adc = adc;
+                    record.flags |= DP_RASTER_FLAG_ADC;
+                }
+                data_plane_publish(DATA_PLANE_TYPE_RASTER_POINT, s->channel, &record, sizeof(record));
+            }
+            if (config->point_interval_ms > 0) {
+                vTaskDelay((config->point_interval_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+            } else if (ret != ESP_OK) {
+                vTaskDelay(1); // Filtro ausente: não monopoliza o barramento repetindo erros.
+            }
+        }
+        if (i == s->count) {
+            int64_t elapsed = monotonic_us() - pass_start;
+            s->pass_rate = (elapsed > 0) ? (float)(s->count * 1e6 / elapsed) : 0.0f;
+            data_plane_trace(s->channel, "raster: passagem %lu concluída (%lu pontos, %.2f pontos/s)",
+                             (unsigned long)s->passes, (unsigned long)s->count, s->pass_rate);
+            s->passes++;
+        }
+    }
+    s->running = false;
+    vTaskDelete(NULL);
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t raster_init(SemaphoreHandle_t bus_mutex) {
+    if (bus_mutex == NULL) return ESP_ERR_INVALID_ARG;
+    s_bus_mutex = bus_mutex;
+    memset(s_raster, 0, sizeof(s_raster));
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool raster_axis_from_name(const char *name, raster_axis_t *axis) {
+    static const char *const names[RASTER_AXIS_COUNT] = {"xn", "xp", "yn", "yp"};
+    for (int i = 0; i < RASTER_AXIS_COUNT; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *axis = (raster_axis_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t raster_start(sercalo_dev_t *dev, uint8_t channel, const raster_config_t *config) {
+    if (dev == NULL || config == NULL || channel >= RASTER_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    if (!line_in_range(&config->fast) || !line_in_range(&config->slow)) return ESP_ERR_INVALID_ARG;
+    if (config->slow.count > 1 && config->slow.axis == config->fast.axis) return ESP_ERR_INVALID_ARG;
+
+    uint32_t count = (uint32_t)config->fast.count * config->slow.count;
+    if (count > CONFIG_SERCALO_RASTER_MAX_POINTS) return ESP_ERR_INVALID_SIZE;
+
+    raster_stop(channel);
+    raster_state_t *s = &s_raster[channel];
+    s->frames = malloc(count * SERCALO_SET_FRAME_LEN);
+    if (s->frames == NULL) return ESP_ERR_NO_MEM;
+
+    // Todos os quadros (com CRC) ficam prontos antes do primeiro ponto.
+    for (uint32_t i = 0; i < count; i++) {
+        sercalo_mirror_pos_t pos;
+        point_position(config, (uint16_t)(i / config->fast.count), (uint16_t)(i % config->fast.count), &pos);
+        sercalo_encode_mirror_position(dev, &pos, s->frames[i]);
+    }
+
+    s->dev = dev;
+    s->channel = channel;
+    s->config = *config;
+    s->count = count;
+    s->points = 0;
+    s->passes = 0;
+    s->errors = 0;
+    s->pass_rate = 0.0f;
+    s->start_us = monotonic_us();
+    s->stop = false;
+    s->running = true;
+
+    char task_name[16];
+    snprintf(task_name, sizeof(task_name), "raster_%u", channel);
+    if (xTaskCreate(raster_task, task_name, RASTER_TASK_STACK_SIZE, s, RASTER_TASK_PRIORITY, NULL) != pdPASS) {
+        s->running = false;
+        free(s->frames);
+        s->frames = NULL;
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Canal %u: %lu pontos (%u x %u), POS %s, ADC %s", channel, (unsigned long)count,
+             config->fast.count, config->slow.count, config->readback ? "sim" : "não", config->adc ? "sim" : "não");
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void raster_stop(uint8_t channel) {
+    if (channel >= RASTER_MAX_CHANNELS) return;
+    raster_state_t *s = &s_raster[channel];
+    if (s->running) {
+        s->stop = true;
+        while (s->running) {
+            vTaskDelay(pdMS_TO_TICKS(RASTER_STOP_POLL_MS));
+        }
+        ESP_LOGI(TAG, "Canal %u: varredura parada após %lu pontos", channel, (unsigned long)s->points);
+    }
+    free(s->frames);
+    s->frames = NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void raster_get_stats(uint8_t channel, raster_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (channel >= RASTER_MAX_CHANNELS) return;
+    const raster_state_t *s = &s_raster[channel];
+    stats->active = s->running;
+    stats->pass_points = s->count;
+    stats->points = s->points;
+    stats->passes = s->passes;
+    stats->errors = s->errors;
+    stats->points_per_s = s->pass_rate;
+    if (s->passes == 0 && s->points > 0) {
+        int64_t elapsed = monotonic_us() - s->start_us; // Primeira passagem ainda em andamento.
+        stats->points_per_s = (elapsed > 0) ? (float)(s->points * 1e6 / elapsed) : 0.0f;
+    }
+}
+
+#endif // CONFIG_SERCALO_RASTER_ENABLE
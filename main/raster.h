@@ -0,0 +1,133 @@
+/**************************************************************************************************
+* Arquivo:      raster.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.2.0
+*
+* Descrição:    Varredura direta do espelho MEMS (raster), para caracterização e
+* alinhamento. Os valores dos atuadores são comandados com SET, sem
+* conversão de comprimento de onda, em uma grade 1D ou 2D sobre
+* `sercalo_mirror_pos_t`: um eixo rápido (linha) e, opcionalmente, um eixo
+* lento. Os quadros SET de todos os pontos são codificados (com CRC) antes
+* do início, e a task apenas os reenvia, na taxa máxima do dispositivo ou
+* com um intervalo entre os pontos (orçamento do barramento).
+* Opcionalmente, cada ponto lê a posição (POS) e o fotodetector (ADC).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.2.0] - Intervalo entre os pontos.
+*
+**************************************************************************************************/
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sercalo_i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RASTER_MAX_CHANNELS         2
+
+/**
+ * @brief Atuadores do espelho, na ordem de `sercalo_mirror_pos_t`.
+ */
+typedef enum {
+    RASTER_AXIS_X_NEG = 0,      /*!< "xn" */
+    RASTER_AXIS_X_POS,          /*!< "xp" */
+    RASTER_AXIS_Y_NEG,          /*!< "yn" */
+    RASTER_AXIS_Y_POS,          /*!< "yp" */
+    RASTER_AXIS_COUNT,
+} raster_axis_t;
+
+/**
+ * @struct raster_line_t
+ * @brief  Valores de um eixo da grade: `start + i * step`, para i de 0 a `count - 1`.
+ */
+typedef struct {
+    raster_axis_t axis;
+    uint16_t start;
+    int32_t step;               /*!< Pode ser negativo. */
+    uint16_t count;             /*!< 1 no eixo lento de uma varredura 1D. */
+} raster_line_t;
+
+/**
+ * @struct raster_config_t
+ * @brief  Parâmetros de uma varredura do espelho.
+ */
+typedef struct {
+    sercalo_mirror_pos_t base;  /*!< Valores dos atuadores que não são varridos. */
+    raster_line_t fast;         /*!< Eixo rápido (percorrido a cada linha). */
+    raster_line_t slow;         /*!< Eixo lento (uma linha por valor). */
+    bool readback;              /*!< Lê POS após cada ponto (uma transação a mais). */
+    bool adc;                   /*!< Lê o fotodetector após cada ponto. */
+    uint32_t point_interval_ms; /*!< Espera após cada ponto, sem o barramento (0: taxa máxima). */
+} raster_config_t;
+
+/**
+ * @struct raster_stats_t
+ * @brief  Estado e taxa da varredura de um canal.
+ */
+typedef struct {
+    bool active;                /*!< A task de varredura está em execução. */
+    uint32_t pass_points;       /*!< Pontos por passagem completa da grade. */
+    uint32_t points;            /*!< Pontos enviados desde o início. */
+    uint32_t passes;            /*!< Passagens completas. */
+    uint32_t errors;            /*!< Pontos recusados ou sem resposta. */
+    float points_per_s;         /*!< Taxa da última passagem (ou da atual, antes da primeira). */
+} raster_stats_t;
+
+/**
+ * @brief Inicializa o módulo.
+ * @param bus_mutex Mutex que protege o barramento I2C (tomado a cada ponto).
+ */
+esp_err_t raster_init(SemaphoreHandle_t bus_mutex);
+
+/**
+ * @brief Converte o nome de um eixo ("xn", "xp", "yn", "yp").
+ * @return true se o nome é válido.
+ */
+bool raster_axis_from_name(const char *name, raster_axis_t *axis);
+
+/**
+ * @brief Valida a grade, codifica os quadros SET de todos os pontos e inicia a varredura.
+ *
+ * A varredura anterior do canal é parada. Repete a grade continuamente até
+ * `raster_stop`; cada ponto é publicado no plano de dados
+ * (`DATA_PLANE_TYPE_RASTER_POINT`).
+ *
+ * @param channel Índice do canal (0 = C, 1 = L).
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG se algum valor da grade sai de 0..65535.
+ * @return ESP_ERR_INVALID_SIZE se a grade excede CONFIG_SERCALO_RASTER_MAX_POINTS.
+ * @return ESP_ERR_NO_MEM se os quadros não cabem na memória.
+ */
+esp_err_t raster_start(sercalo_dev_t *dev, uint8_t channel, const raster_config_t *config);
+
+/**
+ * @brief Para a varredura do canal, se ativa, ao fim do ponto em andamento.
+ *
+ * A task nunca é interrompida no meio de uma transação: ao retornar, o barramento
+ * está livre e a memória dos quadros foi liberada.
+ */
+void raster_stop(uint8_t channel);
+
+/**
+ * @brief Obtém o estado e a taxa da varredura de um canal.
+ */
+void raster_get_stats(uint8_t channel, raster_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RASTER_H
@@ -0,0 +1,345 @@
+/**************************************************************************************************
+* Arquivo:      response.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Implementação do escritor de respostas de comando (ver response.h).
+* Os valores são convertidos diretamente no buffer de destino, sem
+* snprintf nem strncat (que percorreria a resposta a cada campo).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "response.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define RESPONSE_MAX_DECIMALS       6
+
+static const uint32_t s_pow10[RESPONSE_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+// --- Funções Auxiliares Internas ---
+
+static void put(response_writer_t *w, const char *data, size_t len) {
+    if (w->overflow) return;
+    if (len > w->cap - w->len) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void put_char(response_writer_t *w, char c) {
+    if (w->overflow) return;
+    if (w->len >= w->cap) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static void put_str(response_writer_t *w, const char *s) {
+    put(w, s, strlen(s));
+}
+
+/**
+ * @brief Escreve um inteiro sem sinal em decimal, com no mínimo `min_digits` dígitos.
+ */
+static void put_uint(response_writer_t *w, uint64_t value, int min_digits) {
+    char digits[20];
+    int n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0 && n < (int)sizeof(digits));
+    while (n < min_digits) {
+        digits[n++] = '0';
+    }
+    if (w->overflow || (size_t)n > w->cap - w->len) {
+        w->overflow = true;
+        return;
+    }
+    while (n > 0) {
+        w->buf[w->len++] = digits[--n];
+    }
+}
+
+/**
+ * @brief Separador e chave de um novo campo, conforme o formato.
+ */
+static void begin_field(response_writer_t *w, const char *key) {
+    switch (w->format) {
+    case RESPONSE_FORMAT_TEXT:
+        if (!w->first_field) put(w, ", ", 2);
+        if (key != NULL) {
+            put_str(w, key);
+            put_char(w, '=');
+        }
+        break;
+    case RESPONSE_FORMAT_KV:
+        if (w->len > 0) put_char(w, ' ');
+        if (key != NULL) {
+            if (w->in_group) {
+                put_str(w, w->group_key);
+                put_char(w, '.');
+            }
+            put_str(w, key);
+            put_char(w, '=');
+        }
+        break;
+    case RESPONSE_FORMAT_JSON:
+        if (key == NULL) break; // Valor isolado: a resposta é o próprio valor JSON.
+        if (!w->json_open) {
+            put_char(w, '{');
+            w->json_open = true;
+        } else if (!w->first_field) {
+            put_char(w, ',');
+        }
+        put_char(w, '"');
+        put_str(w, key);
+        put(w, "\":", 2);
+        break;
+    }
+    w->first_field = false;
+}
+
+/**
+ * @brief Texto entre aspas com escapes JSON.
+ */
+static void put_json_string(response_writer_t *w, const char *s) {
+    static const char hex_digits[] = "0123456789abcdef";
+
+    put_char(w, '"');
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            put_char(w, '\\');
+            put_char(w, (char)c);
+        } else if (c < 0x20) {
+            char esc[6] = {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0x0F]};
+            put(w, esc, sizeof(esc));
+        } else {
+            put_char(w, (char)c);
+        }
+    }
+    put_char(w, '"');
+}
+
+/**
+ * @brief Texto nos formatos TEXT (como está) e KV (entre aspas). Caracteres de
+ * controle, que quebrariam a linha de resposta, são trocados por '?'.
+ */
+static void put_plain_string(response_writer_t *w, const char *s, bool quote) {
+    if (quote) put_char(w, '"');
+    for (; *s != '\0'; s++) {
+        char c = *s;
+        if (quote && (c == '"' || c == '\\')) {
+            put_char(w, '\\');
+        }
+        put_char(w, ((unsigned char)c < 0x20) ? '?' : c);
+    }
+    if (quote) put_char(w, '"');
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+void response_init(response_writer_t *w, char *buf, size_t cap, response_format_t format) {
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+    w->format = format;
+    w->first_field = true;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t response_finish(response_writer_t *w) {
+    if (w->json_open) {
+        put_char(w, '}');
+        w->json_open = false;
+    }
+    return w->overflow ? 0 : w->len;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool response_overflowed(const response_writer_t *w) {
+    return w->overflow;
+}
+
+/**
+ * {@inheritdoc}
+ */
+response_format_t response_format(const response_writer_t *w) {
+    return w->format;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_set_format(response_writer_t *w, response_format_t format) {
+    if (w->len == 0) {
+        w->format = format;
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_begin_group(response_writer_t *w, const char *key, const char *label) {
+    switch (w->format) {
+    case RESPONSE_FORMAT_TEXT:
+        if (w->len > 0) put(w, " | ", 3);
+        put_str(w, label);
+        put(w, ": ", 2);
+        break;
+    case RESPONSE_FORMAT_KV:
+        w->group_key = key;
+        break;
+    case RESPONSE_FORMAT_JSON:
+        begin_field(w, key);
+        put_char(w, '{');
+        break;
+    }
+    w->in_group = true;
+    w->first_field = true;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_end_group(response_writer_t *w) {
+    if (w->format == RESPONSE_FORMAT_JSON) {
+        put_char(w, '}');
+    }
+    w->in_group = false;
+    w->group_key = NULL;
+    w->first_field = false;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_add_str(response_writer_t *w, const char *key, const char *value) {
+    begin_field(w, key);
+    if (w->format == RESPONSE_FORMAT_JSON) {
+        put_json_string(w, value);
+    } else {
+        put_plain_string(w, value, w->format == RESPONSE_FORMAT_KV);
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_add_int(response_writer_t *w, const char *key, int64_t value) {
+    begin_field(w, key);
+    if (value < 0) {
+        put_char(w, '-');
+        put_uint(w, (uint64_t)(-(value + 1)) + 1, 1); // Evita o overflow de -INT64_MIN.
+    } else {
+        put_uint(w, (uint64_t)value, 1);
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_add_uint(response_writer_t *w, const char *key, uint64_t value) {
+    begin_field(w, key);
+    put_uint(w, value, 1);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_add_float(response_writer_t *w, const char *key, double value, uint8_t decimals) {
+    begin_field(w, key);
+    if (decimals > RESPONSE_MAX_DECIMALS) decimals = RESPONSE_MAX_DECIMALS;
+
+    if (isnan(value) || isinf(value)) {
+        if (w->format == RESPONSE_FORMAT_JSON) {
+            put(w, "null", 4);
+        } else {
+            put_str(w, isnan(value) ? "nan" : (value > 0 ? "inf" : "-inf"));
+        }
+        return;
+    }
+
+    double scaled = fabs(value) * s_pow10[decimals] + 0.5;
+    if (scaled >= 9.0e18) {
+        // Fora do alcance da conversão inteira (não ocorre com os valores do firmware).
+        char tmp[32];
+        int n = snprintf(tmp, sizeof(tmp), "%.*e", decimals, value);
+        put(w, tmp, (size_t)n);
+        return;
+    }
+
+    uint64_t fixed = (uint64_t)scaled;
+    if (value < 0 && fixed != 0) put_char(w, '-');
+    put_uint(w, fixed / s_pow10[decimals], 1);
+    if (decimals > 0) {
+        put_char(w, '.');
+        put_uint(w, fixed % s_pow10[decimals], decimals);
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_add_bool(response_writer_t *w, const char *key, bool value) {
+    begin_field(w, key);
+    if (w->format == RESPONSE_FORMAT_JSON) {
+        put_str(w, value ? "true" : "false");
+    } else {
+        put_char(w, value ? '1' : '0');
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+void response_add_err(response_writer_t *w, const char *key, esp_err_t err) {
+    response_add_str(w, key, esp_err_to_name(err));
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t response_format_from_name(const char *name, response_format_t *format) {
+    if (strcmp(name, "text") == 0) {
+        *format = RESPONSE_FORMAT_TEXT;
+    } else if (strcmp(name, "kv") == 0) {
+        *format = RESPONSE_FORMAT_KV;
+    } else if (strcmp(name, "json") == 0) {
+        *format = RESPONSE_FORMAT_JSON;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *response_format_name(response_format_t format) {
+    switch (format) {
+    case RESPONSE_FORMAT_KV:   return "kv";
+    case RESPONSE_FORMAT_JSON: return "json";
+    default:                   return "text";
+    }
+}
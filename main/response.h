@@ -0,0 +1,148 @@
+/**************************************************************************************************
+* Arquivo:      response.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Escritor de respostas de comando. Os handlers acrescentam campos tipados
+* (texto, inteiros, reais, erros) diretamente no buffer da linha de resposta,
+* sem buffers intermediários, e o escritor os formata conforme o formato
+* escolhido pela origem do comando: texto legível, `chave=valor` compacto ou
+* JSON (uma linha por resposta). Uma resposta que não cabe no buffer é
+* sinalizada, nunca truncada.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef RESPONSE_H
+#define RESPONSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Formatos de resposta (selecionados por origem com o comando `format`).
+ *
+ * Exemplo com os mesmos campos (`iden?`):
+ * - TEXT: `Canal C: modelo=TF1, sn=1234, fw=1.0 | Canal L: erro=ESP_FAIL`
+ * - KV:   `C.modelo="TF1" C.sn="1234" C.fw="1.0" L.erro="ESP_FAIL"`
+ * - JSON: `{"C":{"modelo":"TF1","sn":"1234","fw":"1.0"},"L":{"erro":"ESP_FAIL"}}`
+ *
+ * No formato KV, textos vão sempre entre aspas (com `\` antes de `"` e `\`) e
+ * números sem aspas, de modo que o tipo de cada valor é o mesmo do JSON. Um
+ * campo sem chave (ex.: `get-wl`) é escrito só como valor.
+ */
+typedef enum {
+    RESPONSE_FORMAT_TEXT = 0,   /*!< Legível: `chave=valor, ...`, grupos separados por ` | `. */
+    RESPONSE_FORMAT_KV,         /*!< Compacto: `chave=valor` separados por espaço, grupos como prefixo `grupo.`. */
+    RESPONSE_FORMAT_JSON,       /*!< Objeto JSON em uma linha, grupos como objetos aninhados. */
+} response_format_t;
+
+/**
+ * @struct response_writer_t
+ * @brief  Estado de uma resposta em construção. Os campos são internos.
+ */
+typedef struct {
+    char *buf;                  /*!< Início da área de dados (dentro da linha de resposta). */
+    size_t cap;                 /*!< Bytes disponíveis em `buf`. */
+    size_t len;                 /*!< Bytes escritos. */
+    response_format_t format;
+    bool overflow;              /*!< Algum campo não coube: a resposta é inválida. */
+    bool in_group;
+    bool first_field;           /*!< Próximo campo é o primeiro do nível atual. */
+    bool json_open;             /*!< `{` do objeto JSON já escrito. */
+    const char *group_key;      /*!< Prefixo dos campos do grupo (formato KV). */
+} response_writer_t;
+
+/**
+ * @brief Prepara um escritor sobre `buf`.
+ */
+void response_init(response_writer_t *w, char *buf, size_t cap, response_format_t format);
+
+/**
+ * @brief Termina a resposta (fecha o objeto JSON, se houver campos).
+ * @return Tamanho dos dados (0 se vazia). Verifique antes response_overflowed().
+ */
+size_t response_finish(response_writer_t *w);
+
+/**
+ * @brief Indica se algum campo não coube no buffer.
+ */
+bool response_overflowed(const response_writer_t *w);
+
+/**
+ * @brief Formato em uso (para handlers que precisam adaptar o conteúdo).
+ */
+response_format_t response_format(const response_writer_t *w);
+
+/**
+ * @brief Troca o formato da resposta. Válido apenas antes do primeiro campo.
+ */
+void response_set_format(response_writer_t *w, response_format_t format);
+
+/**
+ * @brief Inicia um grupo de campos (ex.: um canal).
+ * @param key Nome do grupo nos formatos KV e JSON (ex.: "C").
+ * @param label Rótulo no formato TEXT (ex.: "Canal C").
+ */
+void response_begin_group(response_writer_t *w, const char *key, const char *label);
+
+/**
+ * @brief Termina o grupo atual.
+ */
+void response_end_group(response_writer_t *w);
+
+/**
+ * @brief Acrescenta um texto.
+ *
+ * Em todas as funções `response_add_*`, `key` NULL escreve apenas o valor; nesse
+ * caso, ele deve ser o único campo da resposta.
+ */
+void response_add_str(response_writer_t *w, const char *key, const char *value);
+
+/** @brief Acrescenta um inteiro com sinal. */
+void response_add_int(response_writer_t *w, const char *key, int64_t value);
+
+/** @brief Acrescenta um inteiro sem sinal. */
+void response_add_uint(response_writer_t *w, const char *key, uint64_t value);
+
+/**
+ * @brief Acrescenta um real com `decimals` casas decimais (0 a 6).
+ *
+ * NaN e infinito são escritos como `nan`/`inf` (`null` no JSON).
+ */
+void response_add_float(response_writer_t *w, const char *key, double value, uint8_t decimals);
+
+/** @brief Acrescenta um booleano (`1`/`0`; `true`/`false` no JSON). */
+void response_add_bool(response_writer_t *w, const char *key, bool value);
+
+/** @brief Acrescenta o nome de um código de erro (ex.: `ESP_FAIL`). */
+void response_add_err(response_writer_t *w, const char *key, esp_err_t err);
+
+/**
+ * @brief Converte o nome de um formato ("text", "kv", "json").
+ * @return ESP_ERR_INVALID_ARG se o nome é desconhecido.
+ */
+esp_err_t response_format_from_name(const char *name, response_format_t *format);
+
+/**
+ * @brief Nome de um formato.
+ */
+const char *response_format_name(response_format_t format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESPONSE_H
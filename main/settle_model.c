@@ -0,0 +1,176 @@
+/**************************************************************************************************
+* Arquivo:      settle_model.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Implementação do modelo de tempo de estabilização (ver settle_model.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Estimativa sem contagem (settle_model_estimate_ms) para permanência e admissão.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "settle_model.h"
+
+#if CONFIG_SERCALO_SETTLE_MODEL_ENABLE
+
+#include <string.h>
+#include <math.h>
+#include "freertos/task.h"
+
+#define SETTLE_D0_NM                0.01f       // Salto de referência (ordem da tolerância).
+#define SETTLE_FORGET               0.98f       // Peso das medidas antigas a cada nova medida (~50 medidas).
+#define SETTLE_ERR_ALPHA            0.1f        // Média móvel do erro de previsão.
+#define SETTLE_MIN_PROBES           3           // Medidas antes de prever.
+#define SETTLE_X_MARGIN             0.5f        // Extrapolação aceita além da faixa medida (ln).
+#define SETTLE_MARGIN_SIGMAS        2.0f        // Margem da previsão em erros RMS.
+
+// --- Funções Auxiliares Internas ---
+
+static settle_dir_t direction(float jump_nm) {
+    return (jump_nm < 0.0f) ? SETTLE_DIR_DOWN : SETTLE_DIR_UP;
+}
+
+static float jump_x(float jump_nm) {
+    float d = fabsf(jump_nm);
+    return (d > SETTLE_D0_NM) ? logf(d / SETTLE_D0_NM) : 0.0f;
+}
+
+/**
+ * @brief Resolve a regressão. Com saltos de um só tamanho (ex.: varredura de passo
+ * fixo), a inclinação fica indeterminada e o modelo é a média.
+ */
+static void solve(const settle_fit_t *fit, float *a, float *tau) {
+    float det = fit->n * fit->sxx - fit->sx * fit->sx;
+    if (fit->n <= 0.0f) {
+        *a = 0.0f;
+        *tau = 0.0f;
+    } else if (det > 1e-3f * fit->n * fit->n) {
+        *tau = (fit->n * fit->sxy - fit->sx * fit->sy) / det;
+        *a = (fit->sy - *tau * fit->sx) / fit->n;
+    } else {
+        *tau = 0.0f;
+        *a = fit->sy / fit->n;
+    }
+}
+
+static float predict(const settle_fit_t *fit, float x) {
+    float a, tau;
+    solve(fit, &a, &tau);
+    float t = a + tau * x + SETTLE_MARGIN_SIGMAS * sqrtf(fit->err_sq);
+    return (t > 0.0f) ? t : 0.0f;
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+void settle_model_init(settle_model_t *model) {
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    model->lock = unlocked;
+    memset(model->fit, 0, sizeof(model->fit));
+}
+
+/**
+ * {@inheritdoc}
+ */
+void settle_model_reset(settle_model_t *model) {
+    taskENTER_CRITICAL(&model->lock);
+    memset(model->fit, 0, sizeof(model->fit));
+    taskEXIT_CRITICAL(&model->lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool settle_model_should_probe(settle_model_t *model, float jump_nm, uint32_t step) {
+    float x = jump_x(jump_nm);
+    bool probe;
+
+    taskENTER_CRITICAL(&model->lock);
+    settle_fit_t *fit = &model->fit[direction(jump_nm)];
+    probe = fit->probes < SETTLE_MIN_PROBES
+         || x < fit->x_min - SETTLE_X_MARGIN || x > fit->x_max + SETTLE_X_MARGIN
+         || step % CONFIG_SERCALO_SETTLE_PROBE_INTERVAL == 0;
+    taskEXIT_CRITICAL(&model->lock);
+    return probe;
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t settle_model_estimate_ms(settle_model_t *model, float jump_nm) {
+    float t;
+
+    taskENTER_CRITICAL(&model->lock);
+    t = predict(&model->fit[direction(jump_nm)], jump_x(jump_nm));
+    taskEXIT_CRITICAL(&model->lock);
+    return (uint32_t)(t + 0.5f);
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t settle_model_predict_ms(settle_model_t *model, float jump_nm) {
+    float t;
+
+    taskENTER_CRITICAL(&model->lock);
+    settle_fit_t *fit = &model->fit[direction(jump_nm)];
+    t = predict(fit, jump_x(jump_nm));
+    fit->predictions++;
+    taskEXIT_CRITICAL(&model->lock);
+    return (uint32_t)(t + 0.5f);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void settle_model_observe(settle_model_t *model, float jump_nm, uint32_t settle_ms) {
+    float x = jump_x(jump_nm);
+    float y = (float)settle_ms;
+
+    taskENTER_CRITICAL(&model->lock);
+    settle_fit_t *fit = &model->fit[direction(jump_nm)];
+    if (fit->probes >= SETTLE_MIN_PROBES) {
+        // Erro da previsão (sem margem) que teria sido usada para este passo.
+        float a, tau;
+        solve(fit, &a, &tau);
+        float err = y - (a + tau * x);
+        fit->err_abs += SETTLE_ERR_ALPHA * (fabsf(err) - fit->err_abs);
+        fit->err_sq += SETTLE_ERR_ALPHA * (err * err - fit->err_sq);
+    }
+    if (fit->probes == 0 || x < fit->x_min) fit->x_min = x;
+    if (fit->probes == 0 || x > fit->x_max) fit->x_max = x;
+
+    fit->n = SETTLE_FORGET * fit->n + 1.0f;
+    fit->sx = SETTLE_FORGET * fit->sx + x;
+    fit->sy = SETTLE_FORGET * fit->sy + y;
+    fit->sxx = SETTLE_FORGET * fit->sxx + x * x;
+    fit->sxy = SETTLE_FORGET * fit->sxy + x * y;
+    fit->probes++;
+    taskEXIT_CRITICAL(&model->lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void settle_model_get_stats(settle_model_t *model, settle_dir_t dir, settle_model_stats_t *stats) {
+    taskENTER_CRITICAL(&model->lock);
+    const settle_fit_t *fit = &model->fit[dir];
+    solve(fit, &stats->a_ms, &stats->tau_ms);
+    stats->samples = fit->n;
+    stats->err_mean_ms = fit->err_abs;
+    stats->err_rms_ms = sqrtf(fit->err_sq);
+    stats->probes = fit->probes;
+    stats->predictions = fit->predictions;
+    taskEXIT_CRITICAL(&model->lock);
+}
+
+#endif // CONFIG_SERCALO_SETTLE_MODEL_ENABLE
@@ -0,0 +1,131 @@
+/**************************************************************************************************
+* Arquivo:      settle_model.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Modelo preditivo do tempo de estabilização do espelho, por dispositivo
+* e por sentido do salto. Para um espelho subamortecido, o tempo até a
+* oscilação entrar na tolerância cresce com o logaritmo do salto:
+*
+*     t(d) = a + tau · ln(|d| / d0)      (d0 = 0,01 nm)
+*
+* `a` e `tau` são ajustados por mínimos quadrados (com esquecimento
+* exponencial, para acompanhar deriva) a partir de medidas pela leitura de
+* posição (POS). O agendamento dos passos usa a previsão e mede apenas
+* uma amostra dos passos, que também fornece o erro de previsão.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - settle_model_estimate_ms: previsão sem contagem.
+*
+**************************************************************************************************/
+
+#ifndef SETTLE_MODEL_H
+#define SETTLE_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sentido do salto (os dois lados do espelho podem ter dinâmicas diferentes).
+ */
+typedef enum {
+    SETTLE_DIR_UP = 0,          /*!< Comprimento de onda crescente. */
+    SETTLE_DIR_DOWN,            /*!< Comprimento de onda decrescente. */
+    SETTLE_DIR_COUNT,
+} settle_dir_t;
+
+/**
+ * @struct settle_fit_t
+ * @brief  Somas da regressão de um sentido. Os campos são internos.
+ */
+typedef struct {
+    float n, sx, sy, sxx, sxy;  /*!< Somas ponderadas (com esquecimento). */
+    float x_min, x_max;         /*!< Faixa de saltos já medida (ln(|d|/d0)). */
+    float err_abs;              /*!< Média móvel do erro absoluto de previsão (ms). */
+    float err_sq;               /*!< Média móvel do erro quadrático de previsão (ms²). */
+    uint32_t probes;            /*!< Medidas incorporadas. */
+    uint32_t predictions;       /*!< Passos agendados pela previsão (um por passo). */
+} settle_fit_t;
+
+/**
+ * @struct settle_model_t
+ * @brief  Modelo de um dispositivo.
+ */
+typedef struct {
+    settle_fit_t fit[SETTLE_DIR_COUNT];
+    portMUX_TYPE lock;
+} settle_model_t;
+
+/**
+ * @struct settle_model_stats_t
+ * @brief  Parâmetros ajustados e qualidade da previsão de um sentido.
+ */
+typedef struct {
+    float samples;              /*!< Medidas efetivas (após o esquecimento). */
+    float a_ms;                 /*!< Termo constante. */
+    float tau_ms;               /*!< Constante de tempo (coeficiente de ln(|d|/d0)). */
+    float err_mean_ms;          /*!< Erro absoluto médio de previsão, verificado nas medidas. */
+    float err_rms_ms;           /*!< Erro RMS de previsão. */
+    uint32_t probes;
+    uint32_t predictions;
+} settle_model_stats_t;
+
+/**
+ * @brief Inicializa o modelo (sem medidas).
+ */
+void settle_model_init(settle_model_t *model);
+
+/**
+ * @brief Descarta as medidas (ex.: após trocar o filtro).
+ */
+void settle_model_reset(settle_model_t *model);
+
+/**
+ * @brief Indica se o passo deve ser medido em vez de previsto.
+ *
+ * Mede enquanto o sentido tem poucas medidas, quando o salto está fora da faixa
+ * já medida e a cada CONFIG_SERCALO_SETTLE_PROBE_INTERVAL passos.
+ */
+bool settle_model_should_probe(settle_model_t *model, float jump_nm, uint32_t step);
+
+/**
+ * @brief Tempo previsto até a estabilização, com margem de duas vezes o erro RMS.
+ *
+ * Não altera o modelo: serve para planejar (permanência de um passo, admissão
+ * de uma varredura) sem contar como previsão.
+ *
+ * @return Tempo em ms desde o envio do comando.
+ */
+uint32_t settle_model_estimate_ms(settle_model_t *model, float jump_nm);
+
+/**
+ * @brief Como `settle_model_estimate_ms`, para um passo efetivamente agendado
+ *        pela previsão (sem medida de POS); conta em `predictions`.
+ */
+uint32_t settle_model_predict_ms(settle_model_t *model, float jump_nm);
+
+/**
+ * @brief Incorpora uma medida (e atualiza o erro da previsão feita antes dela).
+ */
+void settle_model_observe(settle_model_t *model, float jump_nm, uint32_t settle_ms);
+
+/**
+ * @brief Obtém os parâmetros de um sentido.
+ */
+void settle_model_get_stats(settle_model_t *model, settle_dir_t dir, settle_model_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SETTLE_MODEL_H
@@ -0,0 +1,509 @@
+/**************************************************************************************************
+* Arquivo:      sweep_log.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.2
+*
+* Descrição:    Implementação do registro de varreduras em flash: buffers duplos de
+* blocos, task de gravação, rotação de arquivos e leitura para replay.
+*
+* Plataforma:   ESP32 (partição LittleFS) / linux (diretório do host)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Listagem por callback (respostas com o escritor de respostas).
+* [2026-10-18] - [Barino] - [0.1.2] - Relógio monotônico comum (monotonic_us).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+
+#if CONFIG_SERCALO_LOG_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "monotonic_clock.h"
+#include "sweep_log.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <sys/statvfs.h>
+#define SWEEP_LOG_BASE_PATH         CONFIG_SERCALO_LOG_HOST_DIR
+#else
+#include "esp_littlefs.h"
+#define SWEEP_LOG_BASE_PATH         "/log"
+#define SWEEP_LOG_PARTITION_LABEL   "log"       // Rótulo da partição em partitions.csv.
+#endif
+
+static const char *TAG = "SWEEP_LOG";
+
+#define SWEEP_LOG_HEADER_LEN        sizeof(sweep_log_block_header_t)
+#define SWEEP_LOG_RECORDS_PER_BLOCK ((CONFIG_SERCALO_LOG_BLOCK_SIZE - SWEEP_LOG_HEADER_LEN) / sizeof(sweep_log_record_t))
+#define SWEEP_LOG_PATH_MAX          64
+#define SWEEP_LOG_REPLAY_CHUNK      1024
+
+// --- Buffers Duplos ---
+//
+// `s_active_buf` recebe os registros. Quando enche (ou no flush), é marcado
+// como pendente e os novos registros passam para o outro buffer, enquanto a
+// task de gravação escreve o pendente. Se os dois estão pendentes, a flash não
+// acompanha a taxa de registros e os novos são descartados (e contados) em vez
+// de bloquear a varredura. Com os dois pendentes, o mais antigo é o
+// `s_active_buf` (foi preenchido antes do outro).
+
+static uint8_t s_buffers[2][CONFIG_SERCALO_LOG_BLOCK_SIZE];
+static uint16_t s_fill[2];                  /*!< Registros em cada buffer. */
+static bool s_pending[2];                   /*!< Buffer aguardando (ou em) gravação. */
+static int s_active_buf = 0;
+static bool s_active = false;
+static uint32_t s_dropped_since_block = 0;
+static portMUX_TYPE s_buffer_spinlock = portMUX_INITIALIZER_UNLOCKED; /*!< Protege os buffers, `s_active` e os contadores. */
+
+// --- Arquivos (acessados com `s_file_mutex`) ---
+
+static SemaphoreHandle_t s_file_mutex = NULL;
+static int s_fd = -1;
+static uint32_t s_file_index = SWEEP_LOG_NO_FILE;  /*!< Arquivo aberto para gravação. */
+static size_t s_file_size = 0;
+static uint32_t s_first_index = 0;          /*!< Arquivo mais antigo mantido. */
+static uint32_t s_next_index = 0;           /*!< Índice do próximo arquivo a criar. */
+static uint32_t s_replay_index = SWEEP_LOG_NO_FILE; /*!< Arquivo em leitura (não é removido). */
+static uint32_t s_blocks_since_sync = 0;
+
+static TaskHandle_t s_writer_task = NULL;
+static SemaphoreHandle_t s_flush_done = NULL;
+static volatile bool s_flush_requested = false;
+static uint32_t s_block_seq = 0;
+static int64_t s_active_since_us = 0;
+
+static sweep_log_stats_t s_stats;
+
+// --- Funções Auxiliares Internas ---
+
+static void make_path(char *path, uint32_t index) {
+    snprintf(path, SWEEP_LOG_PATH_MAX, "%s/sweep_%05lu.bin", SWEEP_LOG_BASE_PATH, (unsigned long)index);
+}
+
+/**
+ * @brief Abre um novo arquivo de registro. Chamar com `s_file_mutex`.
+ */
+static esp_err_t open_next_file(void) {
+    char path[SWEEP_LOG_PATH_MAX];
+
+    make_path(path, s_next_index);
+    s_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (s_fd < 0) {
+        ESP_LOGE(TAG, "Falha ao criar %s: errno %d", path, errno);
+        return ESP_FAIL;
+    }
+    s_file_index = s_next_index++;
+    s_file_size = 0;
+    s_blocks_since_sync = 0;
+
+    // Remove os arquivos mais antigos além do limite (exceto um em leitura).
+    while (s_next_index - s_first_index > CONFIG_SERCALO_LOG_MAX_FILES && s_first_index != s_replay_index) {
+        make_path(path, s_first_index);
+        unlink(path);
+        s_first_index++;
+    }
+    ESP_LOGI(TAG, "Registrando em %s", path);
+    return ESP_OK;
+}
+
+/**
+ * @brief Sincroniza e fecha o arquivo atual. Chamar com `s_file_mutex`.
+ */
+static void close_file(void) {
+    if (s_fd < 0) return;
+    fsync(s_fd);
+    close(s_fd);
+    s_fd = -1;
+    s_file_index = SWEEP_LOG_NO_FILE;
+}
+
+/**
+ * @brief Escolhe o próximo buffer a gravar e o marca como pendente.
+ * @param flush Também entrega o buffer ativo parcialmente preenchido.
+ * @return Índice do buffer, ou -1 se não há o que gravar.
+ */
+static int take_pending_buffer(bool flush) {
+    int buf = -1;
+
+    taskENTER_CRITICAL(&s_buffer_spinlock);
+    int other = s_active_buf ^ 1;
+    if (s_pending[s_active_buf]) {
+        buf = s_active_buf;         // Os dois pendentes: o ativo é o mais antigo.
+    } else if (s_pending[other]) {
+        buf = other;
+    } else if (flush && s_fill[s_active_buf] > 0) {
+        buf = s_active_buf;
+        s_pending[buf] = true;
+        s_active_buf = other;
+    }
+    taskEXIT_CRITICAL(&s_buffer_spinlock);
+    return buf;
+}
+
+/**
+ * @brief Grava um buffer como bloco no arquivo atual, rotacionando se necessário.
+ */
+static void write_block(int buf) {
+    sweep_log_block_header_t *header = (sweep_log_block_header_t *)s_buffers[buf];
+    uint16_t count = s_fill[buf];   // Estável: buffer pendente não recebe registros.
+    size_t len = SWEEP_LOG_HEADER_LEN + count * sizeof(sweep_log_record_t);
+
+    taskENTER_CRITICAL(&s_buffer_spinlock);
+    uint32_t dropped = s_dropped_since_block;
+    s_dropped_since_block = 0;
+    taskEXIT_CRITICAL(&s_buffer_spinlock);
+
+    header->magic = SWEEP_LOG_BLOCK_MAGIC;
+    header->block_seq = s_block_seq++;
+    header->record_count = count;
+    header->record_size = sizeof(sweep_log_record_t);
+    header->dropped = dropped;
+
+    xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    int64_t start = monotonic_us();
+    bool ok = false, synced = false, rotated = false;
+    if (s_fd >= 0 && s_file_size + len > CONFIG_SERCALO_LOG_FILE_MAX_SIZE) {
+        close_file();
+        open_next_file();
+        rotated = true;
+    }
+    if (s_fd >= 0) {
+        ok = write(s_fd, s_buffers[buf], len) == (ssize_t)len;
+        if (ok) {
+            s_file_size += len;
+            if (++s_blocks_since_sync >= CONFIG_SERCALO_LOG_SYNC_BLOCKS) {
+                fsync(s_fd);
+                s_blocks_since_sync = 0;
+                synced = true;
+            }
+        }
+    }
+    uint32_t elapsed_ms = (uint32_t)((monotonic_us() - start) / 1000);
+    xSemaphoreGive(s_file_mutex);
+
+    taskENTER_CRITICAL(&s_buffer_spinlock);
+    if (ok) {
+        s_stats.blocks++;
+        s_stats.record_bytes += count * sizeof(sweep_log_record_t);
+        s_stats.bytes_written += len;
+    } else {
+        s_stats.write_errors++;
+    }
+    if (synced) s_stats.syncs++;
+    if (rotated) s_stats.rotations++;
+    s_stats.write_time_ms += elapsed_ms;
+    if (elapsed_ms > s_stats.max_write_ms) s_stats.max_write_ms = elapsed_ms;
+    s_fill[buf] = 0;
+    s_pending[buf] = false;
+    taskEXIT_CRITICAL(&s_buffer_spinlock);
+}
+
+/**
+ * @brief Task que grava os blocos pendentes.
+ *
+ * Acorda quando um buffer enche, quando um flush é pedido ou periodicamente
+ * (CONFIG_SERCALO_LOG_FLUSH_INTERVAL_MS), para que varreduras lentas também
+ * cheguem à flash em tempo razoável.
+ */
+static void sweep_log_writer_task(void *pvParameters) {
+    while (1) {
+        uint32_t notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_SERCALO_LOG_FLUSH_INTERVAL_MS));
+        bool flush = s_flush_requested || notified == 0;
+
+        int buf;
+        while ((buf = take_pending_buffer(flush)) >= 0) {
+            write_block(buf);
+        }
+
+        if (s_flush_requested) {
+            xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+            bool synced = s_fd >= 0 && s_blocks_since_sync > 0;
+            if (synced) {
+                fsync(s_fd);
+                s_blocks_since_sync = 0;
+            }
+            xSemaphoreGive(s_file_mutex);
+            if (synced) {
+                taskENTER_CRITICAL(&s_buffer_spinlock);
+                s_stats.syncs++;
+                taskEXIT_CRITICAL(&s_buffer_spinlock);
+            }
+            s_flush_requested = false;
+            xSemaphoreGive(s_flush_done);
+        }
+    }
+}
+
+/**
+ * @brief Localiza os arquivos existentes para continuar a numeração.
+ */
+static void scan_files(void) {
+    DIR *dir = opendir(SWEEP_LOG_BASE_PATH);
+    bool found = false;
+    uint32_t min_index = 0, max_index = 0;
+
+    if (dir == NULL) return;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        unsigned long index;
+        if (sscanf(entry->d_name, "sweep_%lu.bin", &index) != 1) continue;
+        if (!found || index < min_index) min_index = index;
+        if (!found || index > max_index) max_index = index;
+        found = true;
+    }
+    closedir(dir);
+
+    if (found) {
+        s_first_index = min_index;
+        s_next_index = max_index + 1;
+    }
+}
+
+static esp_err_t mount_filesystem(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    if (mkdir(SWEEP_LOG_BASE_PATH, 0755) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "Falha ao criar %s: errno %d", SWEEP_LOG_BASE_PATH, errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+#else
+    const esp_vfs_littlefs_conf_t conf = {
+        .base_path = SWEEP_LOG_BASE_PATH,
+        .partition_label = SWEEP_LOG_PARTITION_LABEL,
+        .format_if_mount_failed = true,
+    };
+    return esp_vfs_littlefs_register(&conf);
+#endif
+}
+
+static void get_fs_usage(size_t *total, size_t *used) {
+#if CONFIG_IDF_TARGET_LINUX
+    struct statvfs info;
+    if (statvfs(SWEEP_LOG_BASE_PATH, &info) == 0) {
+        *total = (size_t)info.f_blocks * info.f_frsize;
+        *used = (size_t)(info.f_blocks - info.f_bfree) * info.f_frsize;
+    }
+#else
+    esp_littlefs_info(SWEEP_LOG_PARTITION_LABEL, total, used);
+#endif
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sweep_log_init(void) {
+    s_file_mutex = xSemaphoreCreateMutex();
+    s_flush_done = xSemaphoreCreateBinary();
+    if (s_file_mutex == NULL || s_flush_done == NULL) return ESP_ERR_NO_MEM;
+
+    esp_err_t ret = mount_filesystem();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao montar o sistema de arquivos: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    scan_files();
+
+    // Prioridade abaixo das varreduras e da task de comandos: a flash nunca atrasa um passo.
+    if (xTaskCreate(sweep_log_writer_task, "SweepLogTask", 4096, NULL, 3, &s_writer_task) != pdPASS) {
+        return ESP_FAIL;
+    }
+
+#if CONFIG_SERCALO_LOG_AUTOSTART
+    return sweep_log_set_active(true);
+#else
+    return ESP_OK;
+#endif
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sweep_log_set_active(bool active) {
+    if (s_writer_task == NULL) return ESP_ERR_INVALID_STATE;
+    if (active == s_active) return ESP_OK;
+
+    if (active) {
+        xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+        esp_err_t ret = open_next_file();
+        xSemaphoreGive(s_file_mutex);
+        if (ret != ESP_OK) return ret;
+
+        taskENTER_CRITICAL(&s_buffer_spinlock);
+        s_active = true;
+        taskEXIT_CRITICAL(&s_buffer_spinlock);
+        s_active_since_us = monotonic_us();
+        return ESP_OK;
+    }
+
+    uint32_t active_ms = (uint32_t)((monotonic_us() - s_active_since_us) / 1000);
+    taskENTER_CRITICAL(&s_buffer_spinlock);
+    s_active = false;
+    s_stats.active_ms += active_ms;
+    taskEXIT_CRITICAL(&s_buffer_spinlock);
+
+    esp_err_t ret = sweep_log_flush(5000);
+    xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    close_file();
+    xSemaphoreGive(s_file_mutex);
+    return ret;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool sweep_log_active(void) {
+    return s_active;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sweep_log_append(const sweep_log_record_t *record) {
+    esp_err_t ret = ESP_OK;
+    bool notify = false;
+
+    taskENTER_CRITICAL(&s_buffer_spinlock);
+    int buf = s_active_buf;
+    if (!s_active) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (s_pending[buf]) {
+        s_stats.dropped++;
+        s_dropped_since_block++;
+        ret = ESP_ERR_NO_MEM;
+    } else {
+        memcpy(&s_buffers[buf][SWEEP_LOG_HEADER_LEN + s_fill[buf] * sizeof(sweep_log_record_t)], record, sizeof(*record));
+        s_stats.records++;
+        if (++s_fill[buf] == SWEEP_LOG_RECORDS_PER_BLOCK) {
+            s_pending[buf] = true;
+            s_active_buf = buf ^ 1;
+            notify = true;
+        }
+    }
+    taskEXIT_CRITICAL(&s_buffer_spinlock);
+
+    if (notify) {
+        xTaskNotifyGive(s_writer_task);
+    }
+    return ret;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sweep_log_flush(uint32_t timeout_ms) {
+    if (s_writer_task == NULL) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_flush_done, 0); // Descarta uma conclusão antiga (flush anterior expirado).
+    s_flush_requested = true;
+    xTaskNotifyGive(s_writer_task);
+    return xSemaphoreTake(s_flush_done, pdMS_TO_TICKS(timeout_ms)) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void sweep_log_list(sweep_log_file_fn_t file_fn, void *ctx) {
+    char path[SWEEP_LOG_PATH_MAX];
+
+    xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    for (uint32_t index = s_first_index; index < s_next_index; index++) {
+        struct stat st;
+        make_path(path, index);
+        if (stat(path, &st) != 0) continue;
+        file_fn(ctx, index, (size_t)st.st_size);
+    }
+    xSemaphoreGive(s_file_mutex);
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sweep_log_file_size(uint32_t index, size_t *size) {
+    char path[SWEEP_LOG_PATH_MAX];
+    struct stat st;
+
+    make_path(path, index);
+    if (stat(path, &st) != 0) return ESP_ERR_NOT_FOUND;
+    *size = (size_t)st.st_size;
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t sweep_log_replay(uint32_t index, size_t offset, size_t len, sweep_log_chunk_fn_t chunk_fn, void *ctx) {
+    static uint8_t chunk[SWEEP_LOG_REPLAY_CHUNK]; // Usado apenas pela task de comandos.
+    char path[SWEEP_LOG_PATH_MAX];
+
+    make_path(path, index);
+    xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        s_replay_index = index;
+    }
+    xSemaphoreGive(s_file_mutex);
+    if (fd < 0) return ESP_ERR_NOT_FOUND;
+
+    // A leitura ocorre fora do mutex: a gravação de novos blocos continua.
+    esp_err_t ret = ESP_OK;
+    if (lseek(fd, (off_t)offset, SEEK_SET) < 0) {
+        ret = ESP_ERR_INVALID_ARG;
+    }
+    while (ret == ESP_OK && len > 0) {
+        size_t want = len < sizeof(chunk) ? len : sizeof(chunk);
+        ssize_t got = read(fd, chunk, want);
+        if (got <= 0) {
+            ret = ESP_FAIL;
+            break;
+        }
+        chunk_fn(ctx, chunk, (size_t)got);
+        len -= (size_t)got;
+    }
+
+    xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    close(fd);
+    s_replay_index = SWEEP_LOG_NO_FILE;
+    xSemaphoreGive(s_file_mutex);
+    return ret;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void sweep_log_get_stats(sweep_log_stats_t *stats) {
+    size_t total = 0, used = 0;
+    get_fs_usage(&total, &used);
+
+    xSemaphoreTake(s_file_mutex, portMAX_DELAY);
+    uint32_t file_index = s_file_index;
+    xSemaphoreGive(s_file_mutex);
+
+    taskENTER_CRITICAL(&s_buffer_spinlock);
+    *stats = s_stats;
+    stats->active = s_active;
+    taskEXIT_CRITICAL(&s_buffer_spinlock);
+
+    if (stats->active) {
+        stats->active_ms += (uint32_t)((monotonic_us() - s_active_since_us) / 1000);
+    }
+    stats->file_index = file_index;
+    stats->fs_total = total;
+    stats->fs_used = used;
+}
+
+#endif // CONFIG_SERCALO_LOG_ENABLE
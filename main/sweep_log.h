@@ -0,0 +1,173 @@
+/**************************************************************************************************
+* Arquivo:      sweep_log.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Registro dos passos de varredura em flash (LittleFS), para execuções
+* longas sem host conectado. Os registros são agrupados em blocos do
+* tamanho de uma página por dois buffers alternados: enquanto uma task
+* grava um bloco, a varredura continua preenchendo o outro, sem nunca
+* esperar pela flash. Os arquivos são rotacionados por tamanho.
+*
+* Plataforma:   ESP32 (partição LittleFS) / linux (diretório do host)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Listagem por callback (respostas com o escritor de respostas).
+*
+**************************************************************************************************/
+
+#ifndef SWEEP_LOG_H
+#define SWEEP_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Formato dos arquivos `sweep_NNNNN.bin`: sequência de blocos, cada um com um
+ * cabeçalho seguido de `record_count` registros (little-endian). Um bloco tem
+ * no máximo CONFIG_SERCALO_LOG_BLOCK_SIZE bytes; blocos gravados por flush
+ * (timeout, `log:flush`, `log:off`) podem ser menores.
+ */
+#define SWEEP_LOG_BLOCK_MAGIC       0x31474C53u     // "SLG1"
+#define SWEEP_LOG_NO_FILE           0xFFFFFFFFu
+
+/** @brief Bits de `sweep_log_record_t.flags`. */
+#define SWEEP_LOG_FLAG_READBACK     0x01    /*!< `readback_wl` é válido. */
+#define SWEEP_LOG_FLAG_ADC          0x02    /*!< `adc` é válido. */
+#define SWEEP_LOG_FLAG_ERROR        0x04    /*!< O filtro recusou ou não respondeu ao comando. */
+#define SWEEP_LOG_FLAG_SYNTHETIC    0x80    /*!< Registro gerado pelo `log:bench`. */
+
+/**
+ * @struct sweep_log_block_header_t
+ * @brief  Cabeçalho de um bloco de registros.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         /*!< SWEEP_LOG_BLOCK_MAGIC. */
+    uint32_t block_seq;     /*!< Número do bloco desde o boot. */
+    uint16_t record_count;  /*!< Registros no bloco. */
+    uint16_t record_size;   /*!< sizeof(sweep_log_record_t). */
+    uint32_t dropped;       /*!< Registros descartados (buffers cheios) desde o bloco anterior. */
+} sweep_log_block_header_t;
+
+/**
+ * @struct sweep_log_record_t
+ * @brief  Um passo de varredura registrado.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_ms;  /*!< Instante do passo, em ms desde o boot. */
+    uint32_t cycle;         /*!< Ciclo de varredura. */
+    uint16_t step;          /*!< Passo dentro do ciclo. */
+    uint8_t  channel;       /*!< Índice do canal (0 = C, 1 = L). */
+    uint8_t  flags;         /*!< SWEEP_LOG_FLAG_*. */
+    float    target_wl;     /*!< Comprimento de onda comandado (nm). */
+    float    readback_wl;   /*!< Comprimento de onda informado pelo filtro (nm). */
+    uint16_t adc;           /*!< Leitura do detector (DETECTOR_NO_SAMPLE se ausente). */
+    uint16_t reserved;
+} sweep_log_record_t;
+
+/**
+ * @struct sweep_log_stats_t
+ * @brief  Estado e contadores do registro.
+ */
+typedef struct {
+    bool active;                /*!< Registro habilitado. */
+    uint32_t file_index;        /*!< Arquivo em gravação (SWEEP_LOG_NO_FILE se nenhum). */
+    uint32_t records;           /*!< Registros aceitos desde o boot. */
+    uint32_t dropped;           /*!< Registros descartados com os dois buffers ocupados. */
+    uint32_t blocks;            /*!< Blocos gravados. */
+    uint32_t syncs;             /*!< Chamadas a fsync (cada uma grava metadados do LittleFS). */
+    uint32_t rotations;         /*!< Arquivos fechados por tamanho. */
+    uint32_t write_errors;      /*!< Falhas de escrita (o bloco é perdido). */
+    uint64_t record_bytes;      /*!< Bytes de registros gravados. */
+    uint64_t bytes_written;     /*!< Bytes entregues ao sistema de arquivos (registros + cabeçalhos). */
+    uint32_t write_time_ms;     /*!< Tempo total gasto em write/fsync. */
+    uint32_t max_write_ms;      /*!< Maior tempo de gravação de um bloco. */
+    uint32_t active_ms;         /*!< Tempo com o registro habilitado. */
+    size_t fs_total;            /*!< Capacidade do sistema de arquivos (bytes). */
+    size_t fs_used;             /*!< Espaço ocupado (bytes). */
+} sweep_log_stats_t;
+
+/**
+ * @brief Callback de leitura de um arquivo de registro (ver sweep_log_replay()).
+ */
+typedef void (*sweep_log_chunk_fn_t)(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Callback da listagem de arquivos (ver sweep_log_list()).
+ */
+typedef void (*sweep_log_file_fn_t)(void *ctx, uint32_t index, size_t size);
+
+/**
+ * @brief Monta o sistema de arquivos, localiza os arquivos existentes e inicia a task de gravação.
+ * @return ESP_OK em sucesso, ou um código de erro.
+ */
+esp_err_t sweep_log_init(void);
+
+/**
+ * @brief Habilita (em um novo arquivo) ou desabilita o registro.
+ *
+ * Ao desabilitar, os registros pendentes são gravados e o arquivo é fechado.
+ */
+esp_err_t sweep_log_set_active(bool active);
+
+/**
+ * @brief Indica se o registro está habilitado.
+ */
+bool sweep_log_active(void);
+
+/**
+ * @brief Acrescenta um registro. Nunca bloqueia nem acessa a flash.
+ * @return ESP_OK se aceito.
+ * @return ESP_ERR_INVALID_STATE se o registro está desabilitado.
+ * @return ESP_ERR_NO_MEM se os dois buffers aguardam gravação (registro descartado).
+ */
+esp_err_t sweep_log_append(const sweep_log_record_t *record);
+
+/**
+ * @brief Grava o bloco parcial e sincroniza o arquivo.
+ * @param timeout_ms Tempo máximo de espera pela task de gravação.
+ */
+esp_err_t sweep_log_flush(uint32_t timeout_ms);
+
+/**
+ * @brief Chama `file_fn` para cada arquivo de registro, do mais antigo ao mais recente.
+ */
+void sweep_log_list(sweep_log_file_fn_t file_fn, void *ctx);
+
+/**
+ * @brief Tamanho de um arquivo de registro.
+ * @return ESP_ERR_NOT_FOUND se o arquivo não existe.
+ */
+esp_err_t sweep_log_file_size(uint32_t index, size_t *size);
+
+/**
+ * @brief Lê um trecho de um arquivo, entregando-o em pedaços a `chunk_fn`.
+ *
+ * O arquivo não é removido por rotação enquanto é lido.
+ *
+ * @param index Índice do arquivo.
+ * @param offset Posição inicial.
+ * @param len Bytes a ler (o chamador já limitou ao tamanho do arquivo).
+ * @return ESP_OK se `len` bytes foram entregues.
+ */
+esp_err_t sweep_log_replay(uint32_t index, size_t offset, size_t len, sweep_log_chunk_fn_t chunk_fn, void *ctx);
+
+/**
+ * @brief Copia o estado e os contadores atuais.
+ */
+void sweep_log_get_stats(sweep_log_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SWEEP_LOG_H
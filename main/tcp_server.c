@@ -0,0 +1,412 @@
+/**************************************************************************************************
+* Arquivo:      tcp_server.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.3
+*
+* Descrição:    Servidor TCP de controle com vários clientes. Uma única task atende
+* todas as conexões com `select()`: enquadra os comandos de cada cliente
+* (mesma máquina de estados da UART), entrega-os à fila de comandos e
+* envia cada resposta apenas para o cliente de origem. Clientes podem
+* assinar o plano de dados (`:stream:on`); cada quadro é montado uma vez
+* e repassado a todos os assinantes.
+*
+* Plataforma:   ESP32 (Wi-Fi STA) / linux (loopback do host)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Inicialização do Wi-Fi movida para wifi_sta.c (compartilhada com o streaming UDP).
+* [2026-10-18] - [Barino] - [0.1.2] - Formato de resposta por conexão (comando format).
+* [2026-10-18] - [Barino] - [0.1.3] - Recusas da fila respondidas por command_submit (com a etiqueta do comando).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+
+#if CONFIG_SERCALO_TCP_SERVER_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "command.h"
+#include "data_plane.h"
+#include "tcp_server.h"
+#include "wifi_sta.h"
+
+
+static const char *TAG = "TCP_SERVER";
+
+#define TCP_RX_CHUNK_SIZE       256     // Bytes lidos por chamada a recv().
+#define TCP_SEND_TIMEOUT_MS     200     // Tempo máximo bloqueado enviando para um cliente lento.
+#define TCP_HANDLE_INDEX_BITS   8       // Bits do índice do cliente no handle de resposta.
+
+/**
+ * @struct tcp_client_t
+ * @brief  Estado de uma conexão de cliente.
+ */
+typedef struct {
+    int fd;                             /*!< Socket da conexão. -1 se a posição está livre. */
+    uint32_t generation;                /*!< Incrementado a cada fechamento; invalida respostas atrasadas. */
+    char rx_buf[CMD_BUFFER_SIZE];       /*!< Comando sendo recebido. */
+    int rx_len;                         /*!< Bytes em `rx_buf`. */
+    bool cmd_started;                   /*!< Recebeu ':' e aguarda o terminador. */
+    volatile bool closing;              /*!< Falha de envio detectada; a task do servidor fecha a conexão. */
+    SemaphoreHandle_t tx_mutex;         /*!< Serializa respostas e quadros na mesma conexão. */
+    int sink_id;                        /*!< Destino no plano de dados, ou -1 se não assina. */
+    response_format_t format;           /*!< Formato das respostas desta conexão. */
+} tcp_client_t;
+
+static tcp_client_t s_clients[CONFIG_SERCALO_TCP_MAX_CLIENTS];
+static SemaphoreHandle_t s_clients_mutex = NULL;    /*!< Protege abertura/fechamento e assinaturas. */
+static tcp_server_stats_t s_stats;
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Handles de Resposta ---
+//
+// A resposta de um comando chega depois que ele passou pela fila; o cliente pode
+// ter desconectado (e a posição reutilizada) nesse meio tempo. Por isso a origem
+// carrega o índice e a geração do cliente, e a resposta só é enviada se ambos
+// ainda conferem.
+
+static void *make_handle(int index) {
+    uint32_t generation = s_clients[index].generation;
+    return (void *)(uintptr_t)((generation << TCP_HANDLE_INDEX_BITS) | (uint32_t)index);
+}
+
+static tcp_client_t *client_from_handle(void *handle) {
+    uint32_t value = (uint32_t)(uintptr_t)handle;
+    uint32_t index = value & ((1u << TCP_HANDLE_INDEX_BITS) - 1);
+    uint32_t generation = value >> TCP_HANDLE_INDEX_BITS;
+    if (index >= CONFIG_SERCALO_TCP_MAX_CLIENTS) return NULL;
+
+    tcp_client_t *client = &s_clients[index];
+    uint32_t mask = UINT32_MAX >> TCP_HANDLE_INDEX_BITS;
+    if (client->fd < 0 || (client->generation & mask) != generation) return NULL;
+    return client;
+}
+
+static void count_stat(uint32_t *counter) {
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    (*counter)++;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+}
+
+/**
+ * @brief Envia todos os bytes; em falha, marca o cliente para fechamento. Chamar com `tx_mutex`.
+ */
+static bool send_all(tcp_client_t *client, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(client->fd, data, len, 0);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            // Timeout ou conexão perdida: uma linha parcial corromperia o fluxo, então
+            // a conexão é encerrada.
+            client->closing = true;
+            return false;
+        }
+        data += sent;
+        len -= (size_t)sent;
+    }
+    return true;
+}
+
+// --- Origem de Comandos TCP ---
+
+static void tcp_reply(void *ctx, const char *line, size_t len) {
+    if (xSemaphoreTake(s_clients_mutex, portMAX_DELAY) != pdTRUE) return;
+    tcp_client_t *client = client_from_handle(ctx);
+    if (client != NULL) {
+        xSemaphoreTake(client->tx_mutex, portMAX_DELAY);
+        if (!client->closing) {
+            send_all(client, line, len);
+        }
+        xSemaphoreGive(client->tx_mutex);
+    }
+    xSemaphoreGive(s_clients_mutex);
+}
+
+/**
+ * @brief Destino do plano de dados para um cliente assinante (linhas `:DAT:<hex>`).
+ */
+static bool tcp_sink_write(void *ctx, const uint8_t *frame, size_t len) {
+    static char line[DATA_PLANE_MAX_LINE]; // Chamado apenas pela task de despacho.
+    tcp_client_t *client = (tcp_client_t *)ctx;
+    bool ok = false;
+
+    size_t line_len = data_plane_format_line(frame, len, line, sizeof(line));
+    if (line_len > 0) {
+        xSemaphoreTake(client->tx_mutex, portMAX_DELAY);
+        if (client->fd >= 0 && !client->closing) {
+            ok = send_all(client, line, line_len);
+        }
+        xSemaphoreGive(client->tx_mutex);
+    }
+    count_stat(ok ? &s_stats.frames_sent : &s_stats.frames_dropped);
+    return ok;
+}
+
+static esp_err_t tcp_set_stream(void *ctx, bool enabled) {
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(s_clients_mutex, portMAX_DELAY);
+    tcp_client_t *client = client_from_handle(ctx);
+    if (client == NULL) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (enabled && client->sink_id < 0) {
+        client->sink_id = data_plane_add_sink(tcp_sink_write, client, DATA_PLANE_MASK_ALL);
+        if (client->sink_id < 0) ret = ESP_ERR_NO_MEM;
+    } else if (!enabled && client->sink_id >= 0) {
+        data_plane_remove_sink(client->sink_id);
+        client->sink_id = -1;
+    client->format = RESPONSE_FORMAT_TEXT;
+    }
+    xSemaphoreGive(s_clients_mutex);
+    return ret;
+}
+
+static bool tcp_stream_enabled(void *ctx) {
+    tcp_client_t *client = client_from_handle(ctx);
+    return client != NULL && client->sink_id >= 0;
+}
+
+// O formato é lido e alterado apenas pela task de comandos e volta a TEXT a cada nova conexão.
+static esp_err_t tcp_set_format(void *ctx, response_format_t format) {
+    tcp_client_t *client = client_from_handle(ctx);
+    if (client == NULL) return ESP_ERR_INVALID_STATE;
+    client->format = format;
+    return ESP_OK;
+}
+
+static response_format_t tcp_get_format(void *ctx) {
+    tcp_client_t *client = client_from_handle(ctx);
+    return (client != NULL) ? client->format : RESPONSE_FORMAT_TEXT;
+}
+
+/** @brief Origem dos comandos recebidos por conexões TCP. */
+static const command_source_t s_tcp_source = {
+    .name = "tcp",
+    .reply = tcp_reply,
+    .set_stream = tcp_set_stream,
+    .stream_enabled = tcp_stream_enabled,
+    .set_format = tcp_set_format,
+    .get_format = tcp_get_format,
+};
+
+// --- Gerenciamento das Conexões ---
+
+static void close_client(int index) {
+    tcp_client_t *client = &s_clients[index];
+
+    xSemaphoreTake(s_clients_mutex, portMAX_DELAY);
+    if (client->sink_id >= 0) {
+        data_plane_remove_sink(client->sink_id);
+        client->sink_id = -1;
+    }
+    xSemaphoreTake(client->tx_mutex, portMAX_DELAY);
+    close(client->fd);
+    client->fd = -1;
+    client->generation++;
+    client->closing = false;
+    xSemaphoreGive(client->tx_mutex);
+    xSemaphoreGive(s_clients_mutex);
+
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    s_stats.clients--;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+    ESP_LOGI(TAG, "Cliente %d desconectado.", index);
+}
+
+static void accept_client(int listen_fd) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int fd = accept(listen_fd, (struct sockaddr *)&addr, &addr_len);
+    if (fd < 0) return;
+
+    int index = -1;
+    for (int i = 0; i < CONFIG_SERCALO_TCP_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd < 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        static const char busy[] = ":NACK: Servidor cheio\n";
+        send(fd, busy, sizeof(busy) - 1, 0);
+        close(fd);
+        count_stat(&s_stats.rejected);
+        return;
+    }
+
+    // Respostas curtas devem sair imediatamente (sem Nagle); envios para um
+    // cliente que não lê desistem após TCP_SEND_TIMEOUT_MS.
+    int one = 1;
+    struct timeval send_timeout = { .tv_sec = 0, .tv_usec = TCP_SEND_TIMEOUT_MS * 1000 };
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    tcp_client_t *client = &s_clients[index];
+    xSemaphoreTake(s_clients_mutex, portMAX_DELAY);
+    client->rx_len = 0;
+    client->cmd_started = false;
+    client->closing = false;
+    client->sink_id = -1;
+    client->fd = fd;
+    xSemaphoreGive(s_clients_mutex);
+
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    s_stats.clients++;
+    s_stats.accepted++;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+    ESP_LOGI(TAG, "Cliente %d conectado.", index);
+}
+
+/**
+ * @brief Lê os bytes disponíveis de um cliente e enfileira os comandos completos.
+ * @return false se a conexão foi encerrada pelo cliente.
+ */
+static bool receive_from_client(int index) {
+    tcp_client_t *client = &s_clients[index];
+    char chunk[TCP_RX_CHUNK_SIZE];
+
+    ssize_t received = recv(client->fd, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+        return received < 0 && errno == EINTR;
+    }
+
+    for (ssize_t i = 0; i < received; i++) {
+        char c = chunk[i];
+        if (!client->cmd_started) {
+            if (c == ':') {
+                client->cmd_started = true;
+                client->rx_len = 0;
+            }
+        } else if (c == '\n' || c == '\r') {
+            if (client->rx_len > 0) {
+                client->rx_buf[client->rx_len] = '\0';
+                count_stat(&s_stats.commands);
+                command_submit(client->rx_buf, &s_tcp_source, make_handle(index)); // Uma recusa já é respondida.
+            }
+            client->cmd_started = false;
+        } else if (client->rx_len < CMD_BUFFER_SIZE - 1) {
+            client->rx_buf[client->rx_len++] = c;
+        } else {
+            ESP_LOGW(TAG, "Comando do cliente %d excedeu o tamanho do buffer. Descartado.", index);
+            client->cmd_started = false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Task do servidor: aceita conexões e lê todos os clientes com um único `select()`.
+ */
+static void tcp_server_task(void *pvParameters) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_fd < 0) {
+        ESP_LOGE(TAG, "Falha ao criar socket: errno %d", errno);
+        vTaskDelete(NULL);
+        return;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_SERCALO_TCP_SERVER_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 4) != 0) {
+        ESP_LOGE(TAG, "Falha ao escutar na porta %d: errno %d", CONFIG_SERCALO_TCP_SERVER_PORT, errno);
+        close(listen_fd);
+        vTaskDelete(NULL);
+        return;
+    }
+    ESP_LOGI(TAG, "Servidor TCP na porta %d (até %d clientes).", CONFIG_SERCALO_TCP_SERVER_PORT, CONFIG_SERCALO_TCP_MAX_CLIENTS);
+
+    while (1) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(listen_fd, &read_fds);
+        int max_fd = listen_fd;
+
+        for (int i = 0; i < CONFIG_SERCALO_TCP_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd < 0) continue;
+            if (s_clients[i].closing) {
+                close_client(i);
+                continue;
+            }
+            FD_SET(s_clients[i].fd, &read_fds);
+            if (s_clients[i].fd > max_fd) max_fd = s_clients[i].fd;
+        }
+
+        // Timeout curto para fechar com rapidez as conexões marcadas por falha de envio.
+        struct timeval timeout = { .tv_sec = 0, .tv_usec = 500 * 1000 };
+        int ready = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "select() falhou: errno %d", errno);
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+            continue;
+        }
+        if (ready == 0) continue;
+
+        if (FD_ISSET(listen_fd, &read_fds)) {
+            accept_client(listen_fd);
+        }
+        for (int i = 0; i < CONFIG_SERCALO_TCP_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd >= 0 && FD_ISSET(s_clients[i].fd, &read_fds)) {
+                if (!receive_from_client(i)) {
+                    close_client(i);
+                }
+            }
+        }
+    }
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t tcp_server_start(void) {
+    s_clients_mutex = xSemaphoreCreateMutex();
+    if (s_clients_mutex == NULL) return ESP_ERR_NO_MEM;
+    for (int i = 0; i < CONFIG_SERCALO_TCP_MAX_CLIENTS; i++) {
+        s_clients[i].fd = -1;
+        s_clients[i].sink_id = -1;
+        s_clients[i].tx_mutex = xSemaphoreCreateMutex();
+        if (s_clients[i].tx_mutex == NULL) return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = wifi_sta_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar o Wi-Fi: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (xTaskCreate(tcp_server_task, "TcpServerTask", 4096, NULL, 5, NULL) != pdPASS) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void tcp_server_get_stats(tcp_server_stats_t *stats) {
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+}
+
+#endif // CONFIG_SERCALO_TCP_SERVER_ENABLE
@@ -0,0 +1,57 @@
+/**************************************************************************************************
+* Arquivo:      tcp_server.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Servidor TCP de controle. Expõe o mesmo protocolo de comandos da UART
+* (`:comando...\n` -> `:ACK`/`:NACK`) para vários clientes simultâneos,
+* com as respostas roteadas para a conexão que enviou cada comando.
+*
+* Plataforma:   ESP32 (Wi-Fi STA) / linux (loopback do host)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef TCP_SERVER_H
+#define TCP_SERVER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct tcp_server_stats_t
+ * @brief  Contadores do servidor TCP.
+ */
+typedef struct {
+    uint32_t clients;           /*!< Clientes conectados no momento. */
+    uint32_t accepted;          /*!< Conexões aceitas desde o boot. */
+    uint32_t rejected;          /*!< Conexões recusadas por falta de vagas. */
+    uint32_t commands;          /*!< Comandos recebidos de todos os clientes. */
+    uint32_t frames_sent;       /*!< Quadros do plano de dados enviados aos assinantes. */
+    uint32_t frames_dropped;    /*!< Quadros não entregues (cliente lento ou desconectado). */
+} tcp_server_stats_t;
+
+/**
+ * @brief Conecta o Wi-Fi (no ESP32) e inicia a task do servidor TCP.
+ * @return ESP_OK em sucesso, ou um código de erro.
+ */
+esp_err_t tcp_server_start(void);
+
+/**
+ * @brief Copia os contadores atuais do servidor.
+ */
+void tcp_server_get_stats(tcp_server_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TCP_SERVER_H
@@ -0,0 +1,347 @@
+/**************************************************************************************************
+* Arquivo:      udp_stream.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Implementação do streaming UDP: destino do plano de dados que envia
+* cada quadro em um datagrama numerado, buffer de retransmissão e task
+* que atende os relatórios de lacunas do receptor.
+*
+* Plataforma:   ESP32 (Wi-Fi STA) / linux (sockets do host)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+
+#if CONFIG_SERCALO_UDP_STREAM_ENABLE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "data_plane.h"
+#include "udp_stream.h"
+#include "wifi_sta.h"
+
+static const char *TAG = "UDP_STREAM";
+
+#define UDP_MAX_DATAGRAM        (UDP_STREAM_HEADER_LEN + DATA_PLANE_MAX_FRAME)
+#define UDP_RETX_MAX_FRAMES     256     // Entradas do índice do buffer (potência de 2).
+
+// --- Buffer de Retransmissão ---
+//
+// Os datagramas são gravados em sequência em uma área circular de bytes; um
+// índice circular guarda posição e tamanho de cada um. Como a numeração é
+// contínua, o datagrama `useq` está na entrada `useq % UDP_RETX_MAX_FRAMES`
+// enquanto `s_retx_first <= useq < s_retx_first + s_retx_count`. Ao gravar um
+// novo datagrama, os mais antigos que seriam sobrescritos são descartados.
+
+/**
+ * @struct retx_entry_t
+ * @brief  Posição de um datagrama na área do buffer de retransmissão.
+ */
+typedef struct {
+    uint16_t offset;
+    uint16_t len;
+} retx_entry_t;
+
+static uint8_t s_retx_area[CONFIG_SERCALO_UDP_RETX_BUFFER_SIZE];
+static retx_entry_t s_retx_index[UDP_RETX_MAX_FRAMES];
+static uint32_t s_retx_first = 0;       /*!< `useq` do datagrama mais antigo retido. */
+static uint32_t s_retx_count = 0;       /*!< Datagramas retidos. */
+static size_t s_retx_head = 0;          /*!< Próxima posição de gravação na área. */
+static uint32_t s_next_useq = 0;
+
+static SemaphoreHandle_t s_mutex = NULL;            /*!< Protege o buffer, a numeração e o destino. */
+static int s_sock = -1;
+static struct sockaddr_in s_target;
+static int s_sink_id = -1;
+
+static udp_stream_stats_t s_stats;
+static portMUX_TYPE s_stats_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Guarda um datagrama no buffer de retransmissão. Chamar com `s_mutex`.
+ */
+static void retx_store(uint32_t useq, const uint8_t *datagram, size_t len) {
+    if (s_retx_head + len > sizeof(s_retx_area)) {
+        // Não parte datagramas no fim da área: volta ao início, descartando os
+        // mais antigos, que ficaram depois da posição de gravação.
+        while (s_retx_count > 0 && s_retx_index[s_retx_first % UDP_RETX_MAX_FRAMES].offset >= s_retx_head) {
+            s_retx_first++;
+            s_retx_count--;
+        }
+        s_retx_head = 0;
+    }
+    while (s_retx_count > 0) {
+        const retx_entry_t *oldest = &s_retx_index[s_retx_first % UDP_RETX_MAX_FRAMES];
+        bool overlaps = oldest->offset < s_retx_head + len && oldest->offset + oldest->len > s_retx_head;
+        if (!overlaps && s_retx_count < UDP_RETX_MAX_FRAMES) {
+            break;
+        }
+        s_retx_first++;
+        s_retx_count--;
+    }
+    if (s_retx_count == 0) {
+        s_retx_first = useq;
+    }
+
+    retx_entry_t *entry = &s_retx_index[useq % UDP_RETX_MAX_FRAMES];
+    entry->offset = (uint16_t)s_retx_head;
+    entry->len = (uint16_t)len;
+    memcpy(&s_retx_area[s_retx_head], datagram, len);
+    s_retx_head += len;
+    s_retx_count++;
+}
+
+/**
+ * @brief Copia um datagrama retido. Chamar com `s_mutex`.
+ * @return Tamanho do datagrama, ou 0 se ele não está mais no buffer.
+ */
+static size_t retx_fetch(uint32_t useq, uint8_t *datagram) {
+    if (s_retx_count == 0 || (uint32_t)(useq - s_retx_first) >= s_retx_count) {
+        return 0;
+    }
+    const retx_entry_t *entry = &s_retx_index[useq % UDP_RETX_MAX_FRAMES];
+    memcpy(datagram, &s_retx_area[entry->offset], entry->len);
+    return entry->len;
+}
+
+// --- Destino do Plano de Dados ---
+
+/**
+ * @brief Envia um quadro como datagrama numerado (executa na task de despacho do plano de dados).
+ *
+ * O envio não bloqueia: se o lwIP não tiver buffers livres, o datagrama conta
+ * como enviado-e-perdido e fica no buffer de retransmissão como qualquer outro.
+ */
+static bool udp_sink_write(void *ctx, const uint8_t *frame, size_t len) {
+    static uint8_t datagram[UDP_MAX_DATAGRAM];
+    struct sockaddr_in target;
+    size_t datagram_len = UDP_STREAM_HEADER_LEN + len;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t useq = s_next_useq++;
+    datagram[0] = UDP_STREAM_MAGIC_0;
+    datagram[1] = UDP_STREAM_MAGIC_1;
+    datagram[2] = 0;
+    datagram[3] = 0;
+    datagram[4] = useq & 0xFF;
+    datagram[5] = (useq >> 8) & 0xFF;
+    datagram[6] = (useq >> 16) & 0xFF;
+    datagram[7] = useq >> 24;
+    memcpy(&datagram[UDP_STREAM_HEADER_LEN], frame, len);
+    retx_store(useq, datagram, datagram_len);
+    target = s_target;
+    xSemaphoreGive(s_mutex);
+
+    bool ok = sendto(s_sock, datagram, datagram_len, MSG_DONTWAIT, (struct sockaddr *)&target, sizeof(target)) == (ssize_t)datagram_len;
+
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    s_stats.sent++;
+    if (!ok) s_stats.send_errors++;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+    return ok;
+}
+
+// --- Relatórios de Lacunas ---
+
+/**
+ * @brief Reenvia as faixas pedidas em um relatório de lacunas.
+ */
+static void handle_gap_report(const uint8_t *report, size_t len, const struct sockaddr_in *from) {
+    static uint8_t datagram[UDP_MAX_DATAGRAM];
+    uint32_t retransmitted = 0, expired = 0;
+
+    if (len < UDP_GAP_HEADER_LEN || report[0] != UDP_GAP_MAGIC_0 || report[1] != UDP_GAP_MAGIC_1) {
+        return;
+    }
+    size_t ranges = report[2];
+    if (ranges > UDP_GAP_MAX_RANGES || len < UDP_GAP_HEADER_LEN + ranges * UDP_GAP_RANGE_LEN) {
+        return;
+    }
+
+    for (size_t r = 0; r < ranges; r++) {
+        const uint8_t *range = &report[UDP_GAP_HEADER_LEN + r * UDP_GAP_RANGE_LEN];
+        uint32_t first = range[0] | (range[1] << 8) | (range[2] << 16) | ((uint32_t)range[3] << 24);
+        uint16_t count = range[4] | (range[5] << 8);
+        if (count > UDP_RETX_MAX_FRAMES) count = UDP_RETX_MAX_FRAMES;
+
+        for (uint16_t i = 0; i < count; i++) {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            size_t datagram_len = retx_fetch(first + i, datagram);
+            xSemaphoreGive(s_mutex);
+
+            if (datagram_len == 0) {
+                expired++;
+                continue;
+            }
+            datagram[2] |= UDP_STREAM_FLAG_RETRANSMIT;
+            sendto(s_sock, datagram, datagram_len, MSG_DONTWAIT, (const struct sockaddr *)from, sizeof(*from));
+            retransmitted++;
+        }
+    }
+
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    s_stats.gap_reports++;
+    s_stats.retransmitted += retransmitted;
+    s_stats.expired += expired;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+}
+
+/**
+ * @brief Task que recebe os relatórios de lacunas enviados pelo receptor.
+ *
+ * Só são aceitos relatórios vindos do endereço do destino atual.
+ */
+static void udp_stream_task(void *pvParameters) {
+    uint8_t report[UDP_GAP_HEADER_LEN + UDP_GAP_MAX_RANGES * UDP_GAP_RANGE_LEN];
+
+    while (1) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t len = recvfrom(s_sock, report, sizeof(report), 0, (struct sockaddr *)&from, &from_len);
+        if (len < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "recvfrom falhou: errno %d", errno);
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+            continue;
+        }
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        bool from_target = s_sink_id >= 0 && from.sin_addr.s_addr == s_target.sin_addr.s_addr;
+        xSemaphoreGive(s_mutex);
+
+        if (from_target) {
+            handle_gap_report(report, (size_t)len, &from);
+        }
+    }
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t udp_stream_start(void) {
+    s_mutex = xSemaphoreCreateMutex();
+    if (s_mutex == NULL) return ESP_ERR_NO_MEM;
+
+    esp_err_t ret = wifi_sta_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar o Wi-Fi: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s_sock < 0) {
+        ESP_LOGE(TAG, "Falha ao criar o socket: errno %d", errno);
+        return ESP_FAIL;
+    }
+    // Porta efêmera: o receptor responde para a origem dos datagramas.
+    struct sockaddr_in local = {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(s_sock, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        ESP_LOGE(TAG, "Falha no bind: errno %d", errno);
+        return ESP_FAIL;
+    }
+
+    if (xTaskCreate(udp_stream_task, "UdpStreamTask", 3072, NULL, 4, NULL) != pdPASS) {
+        return ESP_FAIL;
+    }
+
+    if (strlen(CONFIG_SERCALO_UDP_STREAM_HOST) > 0) {
+        return udp_stream_set_target(CONFIG_SERCALO_UDP_STREAM_HOST, CONFIG_SERCALO_UDP_STREAM_PORT);
+    }
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t udp_stream_set_target(const char *host, uint16_t port) {
+    if (s_mutex == NULL) return ESP_ERR_INVALID_STATE;
+
+    if (host == NULL) {
+        if (s_sink_id >= 0) {
+            data_plane_remove_sink(s_sink_id);
+        }
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_sink_id = -1;
+        xSemaphoreGive(s_mutex);
+        ESP_LOGI(TAG, "Streaming UDP desligado.");
+        return ESP_OK;
+    }
+
+    struct sockaddr_in target = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+    };
+    if (port == 0 || inet_pton(AF_INET, host, &target.sin_addr) != 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_target = target;
+    xSemaphoreGive(s_mutex);
+
+    if (s_sink_id < 0) {
+        int sink_id = data_plane_add_sink(udp_sink_write, NULL, DATA_PLANE_MASK_ALL);
+        if (sink_id < 0) return ESP_ERR_NO_MEM;
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_sink_id = sink_id;
+        xSemaphoreGive(s_mutex);
+    }
+    ESP_LOGI(TAG, "Streaming UDP para %s:%u.", host, port);
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void udp_stream_get_target(char *buf, size_t buf_len) {
+    char addr[INET_ADDRSTRLEN];
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool enabled = s_sink_id >= 0;
+    struct sockaddr_in target = s_target;
+    xSemaphoreGive(s_mutex);
+
+    if (!enabled) {
+        snprintf(buf, buf_len, "off");
+        return;
+    }
+    inet_ntop(AF_INET, &target.sin_addr, addr, sizeof(addr));
+    snprintf(buf, buf_len, "%s:%u", addr, ntohs(target.sin_port));
+}
+
+/**
+ * {@inheritdoc}
+ */
+void udp_stream_get_stats(udp_stream_stats_t *stats) {
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t retained = s_retx_count;
+    xSemaphoreGive(s_mutex);
+
+    taskENTER_CRITICAL(&s_stats_spinlock);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_stats_spinlock);
+    stats->retained = retained;
+}
+
+#endif // CONFIG_SERCALO_UDP_STREAM_ENABLE
@@ -0,0 +1,102 @@
+/**************************************************************************************************
+* Arquivo:      udp_stream.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Streaming UDP do plano de dados. Cada quadro vai em um datagrama com
+* numeração própria (contínua, sem as lacunas de quadros descartados na
+* publicação), de forma que toda lacuna vista pelo receptor é perda na
+* rede. O receptor pode pedir o reenvio de faixas de datagramas, que são
+* atendidas a partir de um buffer de retransmissão.
+*
+* Plataforma:   ESP32 (Wi-Fi STA) / linux (sockets do host)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef UDP_STREAM_H
+#define UDP_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Datagrama de dados (firmware -> receptor), little-endian:
+ *
+ *   | 'U' | 'D' | flags | reservado | useq (u32) | quadro do plano de dados |
+ *
+ * `useq` avança de 1 a cada datagrama novo. Reenvios repetem o `useq` original
+ * com UDP_STREAM_FLAG_RETRANSMIT em `flags`.
+ *
+ * Relatório de lacunas (receptor -> porta de origem dos datagramas):
+ *
+ *   | 'N' | 'K' | n (u8) | reservado | n x { primeiro useq (u32), quantidade (u16) } |
+ *
+ * Datagramas que já saíram do buffer de retransmissão não são reenviados; o
+ * receptor os dá como perdidos após algumas tentativas.
+ */
+#define UDP_STREAM_MAGIC_0          'U'
+#define UDP_STREAM_MAGIC_1          'D'
+#define UDP_STREAM_HEADER_LEN       8
+#define UDP_STREAM_FLAG_RETRANSMIT  0x01
+
+#define UDP_GAP_MAGIC_0             'N'
+#define UDP_GAP_MAGIC_1             'K'
+#define UDP_GAP_HEADER_LEN          4
+#define UDP_GAP_RANGE_LEN           6
+#define UDP_GAP_MAX_RANGES          32
+
+/**
+ * @struct udp_stream_stats_t
+ * @brief  Contadores do streaming UDP.
+ */
+typedef struct {
+    uint32_t sent;              /*!< Datagramas novos enviados. */
+    uint32_t send_errors;       /*!< Falhas de `sendto` (sem rota, buffers do lwIP esgotados). */
+    uint32_t gap_reports;       /*!< Relatórios de lacunas recebidos. */
+    uint32_t retransmitted;     /*!< Datagramas reenviados a pedido do receptor. */
+    uint32_t expired;           /*!< Pedidos de reenvio de datagramas fora do buffer. */
+    uint32_t retained;          /*!< Datagramas atualmente no buffer de retransmissão. */
+} udp_stream_stats_t;
+
+/**
+ * @brief Cria o socket, a task de atendimento de lacunas e, se configurado, inicia o envio.
+ * @return ESP_OK em sucesso, ou um código de erro.
+ */
+esp_err_t udp_stream_start(void);
+
+/**
+ * @brief Define o destino dos datagramas.
+ * @param host Endereço IPv4 do receptor, ou NULL para desligar o streaming.
+ * @param port Porta UDP do receptor.
+ * @return ESP_OK em sucesso.
+ * @return ESP_ERR_INVALID_ARG se o endereço for inválido.
+ * @return ESP_ERR_NO_MEM se não houver posição livre para o destino no plano de dados.
+ */
+esp_err_t udp_stream_set_target(const char *host, uint16_t port);
+
+/**
+ * @brief Escreve o destino atual ("ip:porta" ou "off") em `buf`.
+ */
+void udp_stream_get_target(char *buf, size_t buf_len);
+
+/**
+ * @brief Copia os contadores atuais.
+ */
+void udp_stream_get_stats(udp_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UDP_STREAM_H
@@ -0,0 +1,305 @@
+/**************************************************************************************************
+* Arquivo:      verify.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Implementação da verificação dos comprimentos de onda (ver verify.h).
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Barramento do chamador (verify_bus_t); custo medido no barramento.
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "verify.h"
+
+#if CONFIG_SERCALO_VERIFY_ENABLE
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "monotonic_clock.h"
+#include "bus_budget.h"
+
+static const char *TAG = "VERIFY";
+
+#define VERIFY_COST_EWMA_SHIFT      3           // Peso 1/8 para cada nova medida.
+
+typedef struct {
+    verify_mode_t mode;
+    verify_stats_t stats;
+    uint32_t cost_us;           /*!< Ocupação média do barramento por verificação, com as repetições. */
+} verify_channel_t;
+
+/**
+ * @brief Uma verificação em andamento.
+ */
+typedef struct {
+    sercalo_dev_t *dev;
+    const verify_bus_t *bus;    /*!< NULL: o mutex do barramento. */
+    uint32_t bus_us;            /*!< Tempo acumulado nas transações (sem a espera pelo barramento). */
+} verify_ctx_t;
+
+static SemaphoreHandle_t s_bus_mutex = NULL;
+static verify_channel_t s_channels[VERIFY_MAX_CHANNELS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Limites das faixas do histograma, em pm (WVL) ou contagens (POS).
+static const uint32_t s_bin_limits[VERIFY_HIST_BINS] = {1, 2, 5, 10, 20, 50, 100, UINT32_MAX};
+
+// --- Funções Auxiliares Internas ---
+
+/**
+ * @brief Transações de uma leitura sem repetições (WVL: uma; POS: duas).
+ */
+static uint32_t base_transactions(verify_mode_t mode) {
+    return (mode == VERIFY_MODE_POS) ? 2 : 1;
+}
+
+static bool bus_take(const verify_ctx_t *ctx) {
+    if (ctx->bus != NULL) return ctx->bus->take(ctx->bus->ctx);
+    return xSemaphoreTake(s_bus_mutex, portMAX_DELAY) == pdTRUE;
+}
+
+static void bus_give(const verify_ctx_t *ctx) {
+    if (ctx->bus != NULL) {
+        ctx->bus->give(ctx->bus->ctx);
+    } else {
+        xSemaphoreGive(s_bus_mutex);
+    }
+}
+
+/**
+ * @brief Envia (`target_wl` não nulo) ou consulta o comprimento de onda, em uma transação.
+ */
+static esp_err_t transact_wvl(verify_ctx_t *ctx, float *target_wl, float *readback_wl) {
+    if (!bus_take(ctx)) return ESP_ERR_NOT_FINISHED;
+    int64_t start = monotonic_us();
+    esp_err_t ret = sercalo_get_set_wavelength(ctx->dev, target_wl, readback_wl);
+    uint32_t elapsed_us = (uint32_t)(monotonic_us() - start);
+    bus_give(ctx);
+    ctx->bus_us += elapsed_us;
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    if (ret == ESP_OK && target_wl != NULL) bus_budget_observe(BUS_BUDGET_OP_WVL_SET, elapsed_us);
+#endif
+    return ret;
+}
+
+/**
+ * @brief Consulta o comprimento de onda aplicado; erro em pm.
+ */
+static esp_err_t read_wvl(verify_ctx_t *ctx, float target_wl, float *readback_wl, uint32_t *error) {
+    esp_err_t ret = transact_wvl(ctx, NULL, readback_wl);
+    if (ret == ESP_OK) {
+        *error = (uint32_t)lroundf(fabsf(*readback_wl - target_wl) * 1000.0f);
+    }
+    return ret;
+}
+
+static esp_err_t read_pos(verify_ctx_t *ctx, sercalo_mirror_pos_t *pos) {
+    if (!bus_take(ctx)) return ESP_ERR_NOT_FINISHED;
+    int64_t start = monotonic_us();
+    esp_err_t ret = sercalo_get_mirror_position(ctx->dev, pos);
+    uint32_t elapsed_us = (uint32_t)(monotonic_us() - start);
+    bus_give(ctx);
+    ctx->bus_us += elapsed_us;
+#if CONFIG_SERCALO_BUS_BUDGET_ENABLE
+    if (ret == ESP_OK) bus_budget_observe(BUS_BUDGET_OP_POS, elapsed_us);
+#endif
+    return ret;
+}
+
+/**
+ * @brief Maior diferença entre dois eixos correspondentes, em contagens.
+ */
+static uint32_t pos_delta(const sercalo_mirror_pos_t *a, const sercalo_mirror_pos_t *b) {
+    const uint16_t va[4] = {a->x_neg, a->x_pos, a->y_neg, a->y_pos};
+    const uint16_t vb[4] = {b->x_neg, b->x_pos, b->y_neg, b->y_pos};
+    uint32_t delta = 0;
+    for (int i = 0; i < 4; i++) {
+        uint32_t d = (uint32_t)abs((int)va[i] - (int)vb[i]);
+        if (d > delta) delta = d;
+    }
+    return delta;
+}
+
+/**
+ * @brief Contabiliza o resultado de uma verificação.
+ */
+static void record(verify_channel_t *ch, const verify_result_t *result, uint32_t bus_us) {
+    int bin = 0;
+    while (bin < VERIFY_HIST_BINS - 1 && result->error > s_bin_limits[bin]) bin++;
+
+    taskENTER_CRITICAL(&s_lock);
+    verify_stats_t *stats = &ch->stats;
+    stats->checks++;
+    if (result->passed) stats->passed++; else stats->failed++;
+    if (result->attempts > 1) stats->retried++;
+    if (result->error != UINT32_MAX && result->error > stats->max_error) stats->max_error = result->error;
+    stats->hist[bin]++;
+    // As repetições entram na média: é a ocupação que a admissão de uma varredura reserva.
+    int64_t cost = ch->cost_us;
+    cost += ((int64_t)bus_us - cost) / (1 << VERIFY_COST_EWMA_SHIFT);
+    ch->cost_us = (uint32_t)cost;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// --- Funções Públicas ---
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t verify_init(SemaphoreHandle_t bus_mutex) {
+    if (bus_mutex == NULL) return ESP_ERR_INVALID_ARG;
+    s_bus_mutex = bus_mutex;
+    memset(s_channels, 0, sizeof(s_channels));
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+bool verify_mode_from_name(const char *name, verify_mode_t *mode) {
+    static const verify_mode_t modes[] = {VERIFY_MODE_OFF, VERIFY_MODE_WVL, VERIFY_MODE_POS};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcmp(name, verify_mode_name(modes[i])) == 0) {
+            *mode = modes[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *verify_mode_name(verify_mode_t mode) {
+    switch (mode) {
+    case VERIFY_MODE_WVL: return "wvl";
+    case VERIFY_MODE_POS: return "pos";
+    default:              return "off";
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t verify_set_mode(uint8_t channel, verify_mode_t mode) {
+    if (channel >= VERIFY_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    verify_channel_t *ch = &s_channels[channel];
+    taskENTER_CRITICAL(&s_lock);
+    ch->mode = mode;
+    memset(&ch->stats, 0, sizeof(ch->stats));
+    ch->stats.mode = mode;
+    ch->cost_us = base_transactions(mode) * CONFIG_SERCALO_REPLY_WAIT_MS * 1000;
+    taskEXIT_CRITICAL(&s_lock);
+    ESP_LOGI(TAG, "Canal %u: verificação %s", channel, verify_mode_name(mode));
+    return ESP_OK;
+}
+
+/**
+ * {@inheritdoc}
+ */
+verify_mode_t verify_get_mode(uint8_t channel) {
+    return (channel < VERIFY_MAX_CHANNELS) ? s_channels[channel].mode : VERIFY_MODE_OFF;
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t verify_cost_ms(uint8_t channel) {
+    if (channel >= VERIFY_MAX_CHANNELS || s_channels[channel].mode == VERIFY_MODE_OFF) return 0;
+    return (s_channels[channel].cost_us + 999) / 1000;
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t verify_check(sercalo_dev_t *dev, uint8_t channel, float target_wl, const verify_bus_t *bus,
+                       verify_result_t *result) {
+    if (dev == NULL || result == NULL || channel >= VERIFY_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    verify_channel_t *ch = &s_channels[channel];
+    const verify_mode_t mode = ch->mode;
+    if (mode == VERIFY_MODE_OFF) return ESP_ERR_INVALID_STATE;
+
+    memset(result, 0, sizeof(*result));
+    result->error = UINT32_MAX;
+    result->readback_wl = NAN;
+    const uint32_t tolerance = (mode == VERIFY_MODE_WVL) ? CONFIG_SERCALO_VERIFY_WVL_TOLERANCE_PM
+                                                         : CONFIG_SERCALO_VERIFY_POS_TOLERANCE;
+    verify_ctx_t ctx = {.dev = dev, .bus = bus, .bus_us = 0};
+    esp_err_t ret = ESP_OK;
+    sercalo_mirror_pos_t previous, current;
+
+    if (mode == VERIFY_MODE_POS) ret = read_pos(&ctx, &previous);
+    while (ret == ESP_OK && result->attempts <= CONFIG_SERCALO_VERIFY_RETRIES) {
+        if (mode == VERIFY_MODE_WVL) {
+            if (result->attempts > 0) {
+                // Repete o comando: o filtro recusou ou não aplicou o alvo.
+                ret = transact_wvl(&ctx, &target_wl, NULL);
+                if (ret != ESP_OK) break;
+            }
+            ret = read_wvl(&ctx, target_wl, &result->readback_wl, &result->error);
+        } else {
+            // O espelho ainda em movimento: a leitura seguinte é a repetição.
+            ret = read_pos(&ctx, &current);
+            if (ret == ESP_OK) {
+                result->error = pos_delta(&previous, &current);
+                previous = current;
+            }
+        }
+        if (ret != ESP_OK) break;
+        result->attempts++;
+        if (result->error <= tolerance) {
+            result->passed = true;
+            break;
+        }
+    }
+
+    if (ret == ESP_ERR_NOT_FINISHED) return ret; // Interrompida à espera do barramento: não contabilizada.
+    record(ch, result, ctx.bus_us);
+    if (!result->passed) {
+        ESP_LOGW(TAG, "Canal %u: %.3f nm não verificado (%s, erro %lu, %u leituras)", channel, target_wl,
+                 verify_mode_name(mode), (unsigned long)result->error, result->attempts);
+    }
+    return ret;
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint32_t verify_bin_limit(int bin) {
+    return (bin >= 0 && bin < VERIFY_HIST_BINS) ? s_bin_limits[bin] : UINT32_MAX;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void verify_get_stats(uint8_t channel, verify_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (channel >= VERIFY_MAX_CHANNELS) return;
+    taskENTER_CRITICAL(&s_lock);
+    *stats = s_channels[channel].stats;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void verify_reset_stats(uint8_t channel) {
+    if (channel >= VERIFY_MAX_CHANNELS) return;
+    taskENTER_CRITICAL(&s_lock);
+    verify_mode_t mode = s_channels[channel].mode;
+    memset(&s_channels[channel].stats, 0, sizeof(s_channels[channel].stats));
+    s_channels[channel].stats.mode = mode;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+#endif // CONFIG_SERCALO_VERIFY_ENABLE
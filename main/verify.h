@@ -0,0 +1,161 @@
+/**************************************************************************************************
+* Arquivo:      verify.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.1
+*
+* Descrição:    Verificação dos comprimentos de onda comandados (set-wl e passos de
+* varredura). Após o comando, o valor é lido de volta e comparado com o alvo
+* dentro de uma tolerância: pela consulta WVL (o comprimento de onda aplicado
+* pelo filtro) ou pela leitura de POS (o espelho parado na posição, sem
+* movimento residual entre duas leituras). Fora da tolerância, o comando é
+* repetido (WVL) ou a leitura é refeita (POS) até CONFIG_SERCALO_VERIFY_RETRIES
+* vezes; se ainda falhar, a verificação é marcada como falha. O erro final de
+* cada verificação entra em um histograma por canal.
+*
+* Cada transação da verificação toma o barramento pelo acesso do chamador
+* (verify_bus_t): a varredura concorre pelo barramento com as mesmas regras
+* dos seus passos; os comandos avulsos usam o mutex.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+* [2026-10-18] - [Barino] - [0.1.1] - Acesso ao barramento pelo chamador (verify_bus_t).
+*
+**************************************************************************************************/
+
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sercalo_i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VERIFY_MAX_CHANNELS         2
+#define VERIFY_HIST_BINS            8
+
+/**
+ * @brief Forma de leitura de volta.
+ */
+typedef enum {
+    VERIFY_MODE_OFF = 0,        /*!< "off": sem verificação. */
+    VERIFY_MODE_WVL,            /*!< "wvl": consulta WVL; erro em pm. */
+    VERIFY_MODE_POS,            /*!< "pos": duas leituras de POS; erro em contagens (movimento residual). */
+} verify_mode_t;
+
+/**
+ * @struct verify_result_t
+ * @brief  Resultado de uma verificação.
+ */
+typedef struct {
+    bool passed;                /*!< Erro final dentro da tolerância. */
+    uint8_t attempts;           /*!< Leituras comparadas (1 sem repetição). */
+    uint32_t error;             /*!< Erro final (pm ou contagens); UINT32_MAX sem leitura. */
+    float readback_wl;          /*!< Comprimento de onda lido (modo WVL). */
+} verify_result_t;
+
+/**
+ * @struct verify_stats_t
+ * @brief  Contadores e histograma do erro final de um canal.
+ */
+typedef struct {
+    verify_mode_t mode;
+    uint32_t checks;            /*!< Verificações feitas. */
+    uint32_t passed;            /*!< Dentro da tolerância (na primeira leitura ou após repetir). */
+    uint32_t retried;           /*!< Que precisaram repetir. */
+    uint32_t failed;            /*!< Fora da tolerância após as repetições, ou sem leitura. */
+    uint32_t max_error;         /*!< Maior erro final lido. */
+    uint32_t hist[VERIFY_HIST_BINS]; /*!< Erro final por faixa (ver verify_bin_limit). */
+} verify_stats_t;
+
+/**
+ * @struct verify_bus_t
+ * @brief  Acesso ao barramento para as transações de uma verificação.
+ */
+typedef struct {
+    bool (*take)(void *ctx);    /*!< Toma o barramento; false interrompe a verificação. */
+    void (*give)(void *ctx);    /*!< Libera o barramento. */
+    void *ctx;
+} verify_bus_t;
+
+/**
+ * @brief Inicializa o módulo (todos os canais sem verificação).
+ * @param bus_mutex Mutex que protege o barramento I2C (usado sem o acesso do chamador).
+ */
+esp_err_t verify_init(SemaphoreHandle_t bus_mutex);
+
+/**
+ * @brief Converte o nome de um modo ("off", "wvl", "pos").
+ * @return true se o nome é válido.
+ */
+bool verify_mode_from_name(const char *name, verify_mode_t *mode);
+
+/**
+ * @brief Nome de um modo.
+ */
+const char *verify_mode_name(verify_mode_t mode);
+
+/**
+ * @brief Seleciona o modo do canal e zera os contadores.
+ */
+esp_err_t verify_set_mode(uint8_t channel, verify_mode_t mode);
+
+/**
+ * @brief Modo atual do canal.
+ */
+verify_mode_t verify_get_mode(uint8_t channel);
+
+/**
+ * @brief Ocupação média do barramento por uma verificação do canal, com as repetições.
+ *
+ * Entra no custo de um passo na admissão da varredura; no modo POS, a
+ * varredura também começa a leitura essa fração antes do fim do passo.
+ */
+uint32_t verify_cost_ms(uint8_t channel);
+
+/**
+ * @brief Lê de volta e compara com `target_wl`, repetindo fora da tolerância.
+ *
+ * Toma o barramento a cada transação, pelo acesso `bus` ou, se nulo, pelo
+ * mutex. O filtro deve estar em modo normal.
+ *
+ * @param channel Índice do canal (0 = C, 1 = L).
+ * @param bus Acesso ao barramento; NULL para o mutex.
+ * @param[out] result Resultado da verificação (também contabilizado).
+ * @return ESP_OK se a verificação foi feita (aprovada ou não; ver `result->passed`).
+ * @return ESP_ERR_INVALID_STATE se o canal está sem verificação.
+ * @return ESP_ERR_NOT_FINISHED se `bus->take` recusou o barramento (não contabilizada).
+ * @return O erro da comunicação, contabilizado como falha.
+ */
+esp_err_t verify_check(sercalo_dev_t *dev, uint8_t channel, float target_wl, const verify_bus_t *bus,
+                       verify_result_t *result);
+
+/**
+ * @brief Limite superior (inclusivo) da faixa `bin` do histograma; UINT32_MAX na última.
+ */
+uint32_t verify_bin_limit(int bin);
+
+/**
+ * @brief Obtém os contadores do canal.
+ */
+void verify_get_stats(uint8_t channel, verify_stats_t *stats);
+
+/**
+ * @brief Zera os contadores do canal, mantendo o modo.
+ */
+void verify_reset_stats(uint8_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VERIFY_H
@@ -0,0 +1,90 @@
+/**************************************************************************************************
+* Arquivo:      wifi_sta.c
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Implementação da conexão Wi-Fi em modo estação.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial (extraído do servidor TCP).
+*
+**************************************************************************************************/
+
+#include "sdkconfig.h"
+#include "wifi_sta.h"
+
+#if CONFIG_SERCALO_WIFI_STA
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "nvs_flash.h"
+
+static const char *TAG = "WIFI_STA";
+
+static bool s_started = false;
+
+static void wifi_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        ESP_LOGW(TAG, "Wi-Fi desconectado. Reconectando...");
+        esp_wifi_connect();
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+        ESP_LOGI(TAG, "Conectado. IP: " IPSTR, IP2STR(&event->ip_info.ip));
+    }
+}
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t wifi_sta_start(void) {
+    // Chamada apenas durante a inicialização (app_main), sem concorrência.
+    if (s_started) return ESP_OK;
+
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) return ret;
+
+    if ((ret = esp_netif_init()) != ESP_OK) return ret;
+    if ((ret = esp_event_loop_create_default()) != ESP_OK) return ret;
+    esp_netif_create_default_wifi_sta();
+
+    wifi_init_config_t init_config = WIFI_INIT_CONFIG_DEFAULT();
+    if ((ret = esp_wifi_init(&init_config)) != ESP_OK) return ret;
+    esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, wifi_event_handler, NULL);
+
+    wifi_config_t wifi_config = { 0 };
+    strncpy((char *)wifi_config.sta.ssid, CONFIG_SERCALO_WIFI_SSID, sizeof(wifi_config.sta.ssid) - 1);
+    strncpy((char *)wifi_config.sta.password, CONFIG_SERCALO_WIFI_PASSWORD, sizeof(wifi_config.sta.password) - 1);
+
+    if ((ret = esp_wifi_set_mode(WIFI_MODE_STA)) != ESP_OK) return ret;
+    if ((ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config)) != ESP_OK) return ret;
+    if ((ret = esp_wifi_start()) != ESP_OK) return ret;
+
+    s_started = true;
+    return ESP_OK;
+}
+
+#else
+
+/**
+ * {@inheritdoc}
+ */
+esp_err_t wifi_sta_start(void) {
+    return ESP_OK;
+}
+
+#endif // CONFIG_SERCALO_WIFI_STA
@@ -0,0 +1,42 @@
+/**************************************************************************************************
+* Arquivo:      wifi_sta.h
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Conexão Wi-Fi em modo estação, compartilhada pelos serviços de rede
+* (servidor TCP, streaming UDP). No target linux não há o que iniciar:
+* os sockets usam a pilha de rede do host.
+*
+* Plataforma:   ESP32 / linux (target de host do ESP-IDF)
+* Compilador:   xtensa-esp32-elf-gcc (ESP-IDF)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial (extraído do servidor TCP).
+*
+**************************************************************************************************/
+
+#ifndef WIFI_STA_H
+#define WIFI_STA_H
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Inicia o Wi-Fi em modo estação com a rede configurada no menuconfig.
+ *
+ * Pode ser chamada por cada serviço que precisa de rede; apenas a primeira
+ * chamada inicializa o Wi-Fi. A conexão (e as reconexões) seguem em segundo plano.
+ *
+ * @return ESP_OK em sucesso (ou se já iniciado), ou um código de erro.
+ */
+esp_err_t wifi_sta_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_STA_H
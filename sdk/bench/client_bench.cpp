@@ -0,0 +1,214 @@
+/**************************************************************************************************
+* Arquivo:      client_bench.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Medição de comandos/s e latência (p50, p99) do cliente C++ em função do
+* número de comandos pendentes (janela), como o interface/client_bench.py. Roda
+* contra o firmware de host ou o emulador (interface/emulator.py), pela serial ou
+* TCP, com qualquer uma das três formas de resposta do cliente.
+*
+*   sercalo_client_bench --port /tmp/sercalo_emu --command "get-wl?C" --window 1 8 16
+*   sercalo_client_bench --tcp 127.0.0.1 --api future --commands 2000
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sercalo/client.hpp"
+
+using namespace sercalo;
+
+namespace {
+
+struct Args {
+    std::string tcp;
+    std::string port;
+    uint16_t tcp_port = DEFAULT_TCP_PORT;
+    unsigned baudrate = 115200;
+    std::vector<unsigned> windows{1, 2, 4, 8, 16};
+    unsigned commands = 500;
+    std::string command = "stream";
+    std::string api = "poll";
+    unsigned timeout_ms = 2000;
+};
+
+struct Result {
+    std::vector<double> latencies_ms;
+    double elapsed_s = 0.0;
+    unsigned nacks = 0;
+    unsigned failures = 0;      // Prazo vencido ou conexão encerrada.
+};
+
+double ms_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+void count(Result &result, Status status) {
+    if (status == Status::Nack) result.nacks++;
+    if (status == Status::Timeout || status == Status::Disconnected) result.failures++;
+}
+
+/**
+ * Fila de `poll`: a janela é mantida cheia por uma única thread, sem alocação por comando.
+ */
+void run_poll(Client &client, const Args &args, Result &result) {
+    unsigned sent = 0, done = 0;
+    while (done < args.commands) {
+        while (sent < args.commands && client.submit(args.command, sent)) {
+            sent++;
+        }
+        if (!client.wait(std::chrono::seconds(5))) {
+            if (!client.connected()) break;
+            continue;
+        }
+        done += static_cast<unsigned>(client.poll([&](const Completion &c) {
+            result.latencies_ms.push_back(ms_between(c.sent, c.received));
+            count(result, c.status);
+        }));
+    }
+}
+
+/**
+ * Futures: `window` comandos em voo, esperados na ordem de envio.
+ */
+void run_future(Client &client, const Args &args, Result &result) {
+    std::deque<std::pair<Clock::time_point, std::future<Reply>>> pending;
+    for (unsigned sent = 0; sent < args.commands || !pending.empty();) {
+        while (sent < args.commands && pending.size() < client.window()) {
+            pending.emplace_back(Clock::now(), client.request(args.command));
+            sent++;
+        }
+        Reply reply = pending.front().second.get();
+        result.latencies_ms.push_back(ms_between(pending.front().first, Clock::now()));
+        count(result, reply.status);
+        pending.pop_front();
+    }
+}
+
+/**
+ * Callbacks na thread de leitura; `request` espera sozinho quando a janela está cheia.
+ */
+void run_callback(Client &client, const Args &args, Result &result) {
+    std::vector<double> latencies(args.commands);
+    std::vector<Status> statuses(args.commands);
+    std::atomic<unsigned> done{0};
+    std::promise<void> finished;
+    for (unsigned i = 0; i < args.commands; i++) {
+        client.request(args.command, [&, i](const ReplyView &reply) {
+            latencies[i] = ms_between(reply.sent, Clock::now());
+            statuses[i] = reply.status;
+            if (done.fetch_add(1) + 1 == args.commands) finished.set_value();
+        });
+    }
+    finished.get_future().wait();
+    result.latencies_ms = std::move(latencies);
+    for (Status status : statuses) count(result, status);
+}
+
+Result run_window(const Args &args, unsigned window) {
+    ClientOptions options;
+    options.window = window;
+    options.timeout = std::chrono::milliseconds(args.timeout_ms);
+    std::unique_ptr<Client> client = args.tcp.empty()
+        ? Client::open_serial(args.port, options, args.baudrate)
+        : Client::open_tcp(args.tcp, args.tcp_port, options);
+
+    Result result;
+    result.latencies_ms.reserve(args.commands);
+    auto start = Clock::now();
+    if (args.api == "future") {
+        run_future(*client, args, result);
+    } else if (args.api == "callback") {
+        run_callback(*client, args, result);
+    } else {
+        run_poll(*client, args, result);
+    }
+    result.elapsed_s = ms_between(start, Clock::now()) / 1000.0;
+    return result;
+}
+
+[[noreturn]] void usage(const char *prog) {
+    std::fprintf(stderr,
+                 "Uso: %s (--tcp HOST | --port DISPOSITIVO) [--tcp-port N] [--baudrate N]\n"
+                 "          [--window N ...] [--commands N] [--command CMD] [--api poll|future|callback]\n"
+                 "          [--timeout-ms N]\n",
+                 prog);
+    std::exit(2);
+}
+
+Args parse_args(int argc, char **argv) {
+    Args args;
+    for (int i = 1; i < argc; i++) {
+        std::string opt = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) usage(argv[0]);
+            return argv[++i];
+        };
+        if (opt == "--tcp") args.tcp = value();
+        else if (opt == "--port") args.port = value();
+        else if (opt == "--tcp-port") args.tcp_port = static_cast<uint16_t>(std::stoul(value()));
+        else if (opt == "--baudrate") args.baudrate = static_cast<unsigned>(std::stoul(value()));
+        else if (opt == "--commands") args.commands = static_cast<unsigned>(std::stoul(value()));
+        else if (opt == "--command") args.command = value();
+        else if (opt == "--api") args.api = value();
+        else if (opt == "--timeout-ms") args.timeout_ms = static_cast<unsigned>(std::stoul(value()));
+        else if (opt == "--window") {
+            args.windows.clear();
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                args.windows.push_back(static_cast<unsigned>(std::stoul(argv[++i])));
+            }
+            if (args.windows.empty()) usage(argv[0]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (args.tcp.empty() == args.port.empty()) usage(argv[0]);
+    if (args.api != "poll" && args.api != "future" && args.api != "callback") usage(argv[0]);
+    return args;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Args args = parse_args(argc, argv);
+    std::printf("Comando: :%s  (%u por rodada, API %s)\n", args.command.c_str(), args.commands, args.api.c_str());
+    std::printf("%8s %10s %10s %10s %11s %6s %6s\n", "janela", "cmd/s", "p50 (ms)", "p99 (ms)", "máx (ms)",
+                "NACK", "falhas");
+    for (unsigned window : args.windows) {
+        try {
+            Result r = run_window(args, window);
+            const std::vector<double> &ms = r.latencies_ms;
+            std::printf("%8u %10.1f %10.2f %10.2f %10.2f %6u %6u\n", window,
+                        static_cast<double>(ms.size()) / r.elapsed_s, percentile(ms, 50), percentile(ms, 99),
+                        ms.empty() ? 0.0 : *std::max_element(ms.begin(), ms.end()), r.nacks, r.failures);
+        } catch (const std::exception &e) {
+            std::fprintf(stderr, "janela %u: %s\n", window, e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
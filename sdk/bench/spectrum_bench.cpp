@@ -0,0 +1,291 @@
+/**************************************************************************************************
+* Arquivo:      spectrum_bench.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Medição dos kernels de espectro (sercalo/spectrum.hpp) em cada nível
+* (escalar, SSE2, AVX2) contra implementações ingênuas: linha de base com mínimo e
+* máximo recalculados em cada janela, picos e FWHM amostra a amostra e média
+* percorrendo as varreduras ponto a ponto. Os resultados de cada nível são
+* conferidos com os ingênuos. Os espectros são sintéticos: fundo curvo, picos
+* lorentzianos e ruído.
+*
+*   sercalo_spectrum_bench --points 4096 --sweeps 64 --window 101
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sercalo/spectrum.hpp"
+
+using namespace sercalo;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+    size_t points = 4096;
+    size_t sweeps = 64;
+    size_t window = 101;
+    float threshold = 200.0f;
+    size_t min_distance = 5;
+    double seconds = 0.2;       // Tempo mínimo de cada medição.
+};
+
+std::vector<float> make_sweeps(const Args &args) {
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 5.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::vector<float> centers, widths, heights;
+    for (int p = 0; p < 24; p++) {
+        centers.push_back(uniform(rng) * static_cast<float>(args.points));
+        widths.push_back(1.5f + uniform(rng) * 6.0f);
+        heights.push_back(500.0f + uniform(rng) * 3000.0f);
+    }
+    std::vector<float> data(args.points * args.sweeps);
+    for (size_t s = 0; s < args.sweeps; s++) {
+        for (size_t i = 0; i < args.points; i++) {
+            float t = static_cast<float>(i) / static_cast<float>(args.points);
+            float v = 1000.0f + 800.0f * t - 600.0f * t * t;
+            for (size_t p = 0; p < centers.size(); p++) {
+                float d = (static_cast<float>(i) - centers[p]) / widths[p];
+                v += heights[p] / (1.0f + d * d);
+            }
+            data[s * args.points + i] = v + noise(rng);
+        }
+    }
+    return data;
+}
+
+// --- Implementações ingênuas ---
+
+void naive_baseline(const float *x, size_t n, size_t window, float *out, std::vector<float> &eroded) {
+    size_t half = (window | 1) / 2;
+    eroded.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        float v = std::numeric_limits<float>::infinity();
+        for (size_t j = i >= half ? i - half : 0; j <= std::min(n - 1, i + half); j++) v = std::min(v, x[j]);
+        eroded[i] = v;
+    }
+    for (size_t i = 0; i < n; i++) {
+        float v = -std::numeric_limits<float>::infinity();
+        for (size_t j = i >= half ? i - half : 0; j <= std::min(n - 1, i + half); j++) v = std::max(v, eroded[j]);
+        out[i] = x[i] - v;
+    }
+}
+
+size_t naive_peaks(const float *x, size_t n, float threshold, size_t min_distance, Peak *out, size_t cap) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    size_t kept = 0;
+    for (size_t i = 1; i + 1 < n; i++) {
+        if (!(x[i] > x[i - 1] && x[i] >= x[i + 1] && x[i] >= threshold)) continue;
+        uint32_t index = static_cast<uint32_t>(i);
+        if (kept > 0 && index - out[kept - 1].index < min_distance) {
+            if (x[i] > out[kept - 1].height) out[kept - 1] = Peak{index, x[i], nan, nan};
+        } else if (kept < cap) {
+            out[kept++] = Peak{index, x[i], nan, nan};
+        } else {
+            break;
+        }
+    }
+    for (size_t p = 0; p < kept; p++) {
+        Peak &peak = out[p];
+        float half = peak.height * 0.5f;
+        size_t r = peak.index + 1;
+        while (r < n && x[r] >= half) r++;
+        peak.right = r == n ? nan : static_cast<float>(r - 1) + (x[r - 1] - half) / (x[r - 1] - x[r]);
+        size_t l = peak.index;
+        while (l > 0 && x[l - 1] >= half) l--;
+        peak.left = l == 0 ? nan : static_cast<float>(l - 1) + (half - x[l - 1]) / (x[l] - x[l - 1]);
+    }
+    return kept;
+}
+
+void naive_average(const float *spectra, size_t count, size_t n, float *out) {
+    for (size_t i = 0; i < n; i++) {
+        float sum = 0.0f;
+        for (size_t s = 0; s < count; s++) sum += spectra[s * n + i];
+        out[i] = sum / static_cast<float>(count);
+    }
+}
+
+// --- Medição ---
+
+/** Microssegundos por chamada de `fn`: a menor média de 5 rodadas de `seconds` / 5 (o host varia). */
+template <typename F>
+double time_us(double seconds, F &&fn) {
+    double best = 0.0;
+    for (int round = 0; round < 5; round++) {
+        size_t calls = 0;
+        auto start = Clock::now();
+        double elapsed = 0.0;
+        do {
+            fn();
+            calls++;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < seconds / 5);
+        double us = elapsed * 1e6 / static_cast<double>(calls);
+        best = round == 0 ? us : std::min(best, us);
+    }
+    return best;
+}
+
+float max_difference(const std::vector<float> &a, const std::vector<float> &b) {
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) diff = std::max(diff, std::fabs(a[i] - b[i]));
+    return diff;
+}
+
+bool same_peaks(const std::vector<Peak> &a, size_t na, const std::vector<Peak> &b, size_t nb) {
+    if (na != nb) return false;
+    for (size_t i = 0; i < na; i++) {
+        bool left = std::isnan(a[i].left) ? std::isnan(b[i].left) : std::fabs(a[i].left - b[i].left) < 1e-3f;
+        bool right = std::isnan(a[i].right) ? std::isnan(b[i].right) : std::fabs(a[i].right - b[i].right) < 1e-3f;
+        if (a[i].index != b[i].index || !left || !right) return false;
+    }
+    return true;
+}
+
+[[noreturn]] void usage(const char *prog) {
+    std::fprintf(stderr,
+                 "Uso: %s [--points N] [--sweeps N] [--window N] [--threshold V] [--min-distance N]\n"
+                 "          [--seconds S]\n",
+                 prog);
+    std::exit(2);
+}
+
+Args parse_args(int argc, char **argv) {
+    Args args;
+    for (int i = 1; i < argc; i++) {
+        std::string opt = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) usage(argv[0]);
+            return argv[++i];
+        };
+        if (opt == "--points") args.points = std::stoul(value());
+        else if (opt == "--sweeps") args.sweeps = std::stoul(value());
+        else if (opt == "--window") args.window = std::stoul(value());
+        else if (opt == "--threshold") args.threshold = std::stof(value());
+        else if (opt == "--min-distance") args.min_distance = std::stoul(value());
+        else if (opt == "--seconds") args.seconds = std::stod(value());
+        else usage(argv[0]);
+    }
+    if (args.points < 3 || args.sweeps == 0) usage(argv[0]);
+    return args;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Args args = parse_args(argc, argv);
+    const size_t n = args.points;
+    std::vector<float> sweeps = make_sweeps(args);
+    const float *x = sweeps.data();
+    std::vector<uint8_t> raw(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        uint16_t v = static_cast<uint16_t>(std::min(65535.0f, std::max(0.0f, x[i])));
+        raw[2 * i] = static_cast<uint8_t>(v);
+        raw[2 * i + 1] = static_cast<uint8_t>(v >> 8);
+    }
+
+    // Referências ingênuas.
+    std::vector<float> scratch, ref_corrected(n), ref_mean(n), corrected(n), mean(n), converted(n);
+    std::vector<Peak> ref_peaks(1024), peaks(1024);
+    naive_baseline(x, n, args.window, ref_corrected.data(), scratch);
+    size_t ref_count = naive_peaks(ref_corrected.data(), n, args.threshold, args.min_distance, ref_peaks.data(),
+                                   ref_peaks.size());
+    naive_average(x, args.sweeps, n, ref_mean.data());
+
+    struct Row {
+        const char *name;
+        double naive_us;
+        double level_us[3];
+    };
+    Row rows[] = {
+        {"linha de base", 0.0, {}},
+        {"picos + FWHM", 0.0, {}},
+        {"análise completa", 0.0, {}},
+        {"média", 0.0, {}},
+        {"conversão u16", 0.0, {}},
+    };
+    rows[0].naive_us = time_us(args.seconds, [&] {
+        naive_baseline(x, n, args.window, corrected.data(), scratch);
+    });
+    rows[1].naive_us = time_us(args.seconds, [&] {
+        naive_peaks(ref_corrected.data(), n, args.threshold, args.min_distance, peaks.data(), peaks.size());
+    });
+    rows[2].naive_us = rows[0].naive_us + rows[1].naive_us;
+    rows[3].naive_us = time_us(args.seconds, [&] { naive_average(x, args.sweeps, n, mean.data()); });
+    rows[4].naive_us = time_us(args.seconds, [&] {
+        for (size_t i = 0; i < n; i++) {
+            uint16_t v;
+            std::memcpy(&v, raw.data() + 2 * i, 2);
+            converted[i] = static_cast<float>(v);
+        }
+    });
+
+    std::printf("Espectro de %zu pontos, média de %zu varreduras, janela de %zu, %zu picos; CPU: %s\n", n,
+                args.sweeps, args.window, ref_count, to_string(simd_supported()));
+    bool ok = true;
+    SpectrumAnalyzer analyzer;
+    SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2};
+    for (int l = 0; l < 3; l++) {
+        if (set_simd_level(levels[l]) != levels[l]) {
+            for (Row &row : rows) row.level_us[l] = 0.0;
+            continue;
+        }
+        size_t count = analyzer.analyze(x, n, args.window, args.threshold, args.min_distance, corrected.data(),
+                                        peaks.data(), peaks.size());
+        average(x, args.sweeps, n, mean.data());
+        float baseline_diff = max_difference(corrected, ref_corrected);
+        float mean_diff = max_difference(mean, ref_mean);
+        if (baseline_diff != 0.0f || mean_diff > 1e-2f || !same_peaks(peaks, count, ref_peaks, ref_count)) {
+            std::fprintf(stderr, "%s: difere do ingênuo (linha de base %g, média %g, picos %zu/%zu)\n",
+                         to_string(levels[l]), baseline_diff, mean_diff, count, ref_count);
+            ok = false;
+        }
+        rows[0].level_us[l] = time_us(args.seconds, [&] {
+            analyzer.remove_baseline(x, n, args.window, corrected.data());
+        });
+        rows[1].level_us[l] = time_us(args.seconds, [&] {
+            size_t found = find_peaks(ref_corrected.data(), n, args.threshold, args.min_distance, peaks.data(),
+                                      peaks.size());
+            measure_fwhm(ref_corrected.data(), n, peaks.data(), found);
+        });
+        rows[2].level_us[l] = time_us(args.seconds, [&] {
+            analyzer.analyze(x, n, args.window, args.threshold, args.min_distance, corrected.data(), peaks.data(),
+                             peaks.size());
+        });
+        rows[3].level_us[l] = time_us(args.seconds, [&] { average(x, args.sweeps, n, mean.data()); });
+        rows[4].level_us[l] = time_us(args.seconds, [&] { samples_to_float(raw.data(), n, converted.data()); });
+    }
+    set_simd_level(simd_supported());
+
+    std::printf("%-18s %12s %12s %12s %12s %9s\n", "us por espectro", "ingênuo", "escalar", "SSE2", "AVX2", "ganho");
+    for (const Row &row : rows) {
+        double best = row.level_us[0];
+        for (double us : row.level_us) {
+            if (us > 0.0) best = std::min(best, us);
+        }
+        std::printf("%-18s %12.2f %12.2f %12.2f %12.2f %8.1fx\n", row.name, row.naive_us, row.level_us[0],
+                    row.level_us[1], row.level_us[2], row.naive_us / best);
+    }
+    return ok ? 0 : 1;
+}
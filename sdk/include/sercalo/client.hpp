@@ -0,0 +1,298 @@
+/**************************************************************************************************
+* Arquivo:      client.hpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Cliente C++ do controlador, com vários comandos pendentes (pipelining),
+* como o `sercalo_client.py`. Cada comando leva uma etiqueta (`:@17 get-wl?C`),
+* repetida pelo firmware (`:ACK@17: ...`), e um prazo. Uma thread de leitura
+* recebe as linhas em um buffer fixo, analisa-as no próprio buffer
+* (`std::string_view`, sem alocação) e completa o comando pela etiqueta, que
+* indica diretamente a posição do comando na tabela de pendentes.
+*
+* Há três formas de receber a resposta:
+* - `request` -> `std::future<Reply>` (dados copiados em uma `std::string`);
+* - `request` com callback, chamado na thread de leitura com uma `ReplyView`
+*   (sem cópia; válida só durante a chamada);
+* - `submit` + `poll`: as respostas vão para uma fila sem locks (um produtor, um
+*   consumidor) de `Completion`s de tamanho fixo, lida pela thread da aplicação,
+*   sem alocação em nenhuma das pontas.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_CLIENT_HPP
+#define SERCALO_CLIENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "sercalo/data_plane.hpp"
+#include "sercalo/response.hpp"
+#include "sercalo/spsc_queue.hpp"
+#include "sercalo/transport.hpp"
+
+namespace sercalo {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t CMD_QUEUE_LENGTH = 16;         // Fila de comandos do firmware (somando todas as origens).
+constexpr size_t CMD_BUFFER_SIZE = 128;         // Maior linha de comando aceita pelo firmware.
+constexpr size_t COMPLETION_DATA_MAX = 512;     // Maior resposta do firmware (RESPONSE_DATA_BUFFER_SIZE).
+constexpr size_t RX_BUFFER_SIZE = 1 << 20;      // Buffer de recepção: blocos binários (`log:read`) chegam inteiros.
+
+/** @brief Canal (banda) do controlador. */
+enum class Band : char { C = 'C', L = 'L' };
+
+/** @brief Comprimento de onda em nm (tipo distinto de um `double` qualquer). */
+struct Wavelength {
+    double nm;
+};
+
+/** @brief Intervalo sintonizável de um canal. */
+struct Interval {
+    Wavelength min;
+    Wavelength max;
+};
+
+namespace literals {
+constexpr Wavelength operator""_nm(long double nm) { return Wavelength{static_cast<double>(nm)}; }
+constexpr Wavelength operator""_nm(unsigned long long nm) { return Wavelength{static_cast<double>(nm)}; }
+} // namespace literals
+
+enum class Status : uint8_t {
+    Ok,             //!< `:ACK`: `data` são os dados da resposta.
+    Nack,           //!< `:NACK`: `data` é a mensagem de erro.
+    Timeout,        //!< O prazo venceu antes da resposta.
+    Disconnected,   //!< A conexão foi encerrada antes da resposta.
+};
+
+const char *status_name(Status status);
+
+/** @brief Resposta com os dados copiados (API de futures). */
+struct Reply {
+    Status status = Status::Disconnected;
+    std::string data;
+
+    bool ok() const { return status == Status::Ok; }
+};
+
+/** @brief Resposta sem cópia, entregue ao callback. Só é válida durante a chamada. */
+struct ReplyView {
+    Status status;
+    std::string_view data;
+    uint32_t tag;
+    Clock::time_point sent;
+};
+
+/** @brief Resposta entregue por `poll`, com os dados no próprio registro. */
+struct Completion {
+    uint64_t user;                  //!< Valor passado a `submit`.
+    uint32_t tag;
+    Status status;
+    bool truncated;                 //!< Dados maiores que COMPLETION_DATA_MAX (só blocos binários).
+    uint16_t len;
+    Clock::time_point sent;
+    Clock::time_point received;
+    char data[COMPLETION_DATA_MAX];
+
+    std::string_view text() const { return std::string_view(data, len); }
+};
+
+/** @brief Falha de um comando síncrono (`:NACK`, prazo vencido ou conexão encerrada). */
+class CommandError : public std::runtime_error {
+public:
+    CommandError(std::string_view command, Status status, std::string_view message);
+
+    Status status() const { return status_; }
+    const std::string &command() const { return command_; }
+    const std::string &message() const { return message_; }
+
+private:
+    Status status_;
+    std::string command_;
+    std::string message_;
+};
+
+struct ClientOptions {
+    unsigned window = 8;                            //!< Comandos pendentes (até Client::MAX_PENDING).
+    std::chrono::milliseconds timeout{2000};        //!< Prazo padrão, contado a partir do envio.
+    ResponseFormat format = ResponseFormat::Text;   //!< Enviado com `format:` na abertura.
+    std::function<void(const FrameView &)> on_frame;    //!< Quadros de `:DAT:` (thread de leitura).
+    std::function<void(std::string_view)> on_line;      //!< Logs do console e respostas sem dono.
+};
+
+struct ClientStats {
+    uint64_t sent;
+    uint64_t completed;
+    uint64_t nacks;
+    uint64_t timeouts;
+    uint64_t unmatched;     //!< Respostas sem comando pendente (atrasadas ou sem etiqueta).
+    uint64_t frames;
+    uint64_t rx_overflows;  //!< Linhas descartadas por não caberem no buffer de recepção.
+};
+
+/**
+ * @brief Conexão com o controlador (serial ou TCP) com vários comandos pendentes.
+ *
+ * Os métodos podem ser chamados de qualquer thread, exceto `poll` e `wait`, que
+ * pertencem a uma única thread consumidora. Os callbacks (`request` com callback,
+ * `on_frame`, `on_line`) rodam na thread de leitura: devem ser rápidos e não
+ * podem lançar exceções nem esperar respostas do próprio cliente.
+ */
+class Client {
+public:
+    static constexpr size_t MAX_PENDING = 64;       // Posições da tabela de pendentes (potência de 2).
+    using Callback = std::function<void(const ReplyView &)>;
+
+    explicit Client(std::unique_ptr<Transport> transport, ClientOptions options = {});
+    ~Client();
+
+    Client(const Client &) = delete;
+    Client &operator=(const Client &) = delete;
+
+    static std::unique_ptr<Client> open_serial(const std::string &path, ClientOptions options = {},
+                                               unsigned baudrate = 115200);
+    static std::unique_ptr<Client> open_tcp(const std::string &host, uint16_t port = DEFAULT_TCP_PORT,
+                                            ClientOptions options = {});
+
+    /** @brief Encerra a conexão; os comandos pendentes terminam com Status::Disconnected. */
+    void close();
+    bool connected() const { return connected_.load(); }
+
+    // --- Assíncronos ---
+
+    /**
+     * @brief Envia um comando (sem ':' e '\n'); espera se a janela estiver cheia.
+     * @throws std::invalid_argument se o comando não couber em CMD_BUFFER_SIZE.
+     */
+    std::future<Reply> request(std::string_view command);
+    std::future<Reply> request(std::string_view command, Clock::time_point deadline);
+    void request(std::string_view command, Callback callback);
+    void request(std::string_view command, Callback callback, Clock::time_point deadline);
+
+    /**
+     * @brief Envia um comando cuja resposta vai para a fila de `poll`, sem esperar.
+     *
+     * A posição na janela só é devolvida quando a resposta é consumida por
+     * `poll`, de modo que a fila nunca transborda.
+     * @return false se a janela estiver cheia ou a conexão, encerrada.
+     */
+    bool submit(std::string_view command, uint64_t user = 0);
+    bool submit(std::string_view command, uint64_t user, Clock::time_point deadline);
+
+    /** @brief Entrega a `fn(const Completion &)` até `max` respostas da fila. */
+    template <typename F>
+    size_t poll(F &&fn, size_t max = SIZE_MAX) {
+        size_t n = 0;
+        while (n < max) {
+            Completion *completion = completions_.front();
+            if (completion == nullptr) break;
+            fn(static_cast<const Completion &>(*completion));
+            completions_.pop();
+            release_window();
+            n++;
+        }
+        return n;
+    }
+
+    /** @brief Espera até haver resposta na fila de `poll`. */
+    bool wait(Clock::duration timeout);
+
+    // --- Síncronos (lançam CommandError) ---
+
+    std::string command(std::string_view command);
+    std::string iden();
+    Wavelength get_wl(Band band);
+    void set_wl(Band band, Wavelength wavelength);
+    Interval get_interval(Band band);
+
+    /** @brief `get-wl` assíncrono: `done(status, comprimento de onda)` na thread de leitura. */
+    void get_wl(Band band, std::function<void(Status, Wavelength)> done);
+
+    ClientStats stats() const;
+    ResponseFormat format() const { return format_; }
+    unsigned window() const { return window_; }
+
+private:
+    enum SlotState : uint8_t { SLOT_FREE, SLOT_CLAIMED, SLOT_PENDING, SLOT_COMPLETING };
+    enum class Kind : uint8_t { Future, Callback, Queue };
+
+    struct Slot {
+        std::atomic<uint8_t> state{SLOT_FREE};
+        uint32_t generation = 0;
+        std::atomic<uint32_t> tag{0};  // Lida pela thread de leitura ao casar a resposta.
+        Kind kind = Kind::Future;
+        Clock::time_point sent;
+        Clock::time_point deadline;
+        std::promise<Reply> promise;
+        Callback callback;
+        uint64_t user = 0;
+    };
+
+    bool try_reserve();
+    bool acquire_window(bool block);
+    void release_window();
+    Slot *claim_slot();
+    bool send(Slot &slot, std::string_view command);
+    void complete(Slot &slot, Status status, std::string_view data, bool truncated = false);
+    bool try_complete(Slot &slot, Status status, std::string_view data, bool truncated = false);
+
+    void read_loop();
+    size_t process(size_t len);
+    void dispatch(const ResponseLine &line);
+    void expire(Clock::time_point now);
+    void fail_all(Status status);
+
+    std::unique_ptr<Transport> transport_;
+    ClientOptions options_;
+    ResponseFormat format_ = ResponseFormat::Text;
+    unsigned window_;
+
+    Slot slots_[MAX_PENDING];
+    std::atomic<size_t> next_slot_{0};
+    std::atomic<unsigned> in_flight_{0};
+    std::atomic<unsigned> window_waiters_{0};
+    std::mutex window_mutex_;
+    std::condition_variable window_cv_;
+    std::mutex write_mutex_;
+
+    SpscQueue<Completion, MAX_PENDING> completions_;
+    std::atomic<bool> consumer_waiting_{false};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    std::unique_ptr<uint8_t[]> rx_;
+    size_t rx_scanned_ = 0;     // Bytes do início do buffer já examinados à procura de '\n'.
+    FrameDecoder decoder_;
+    uint8_t frame_bytes_[DATA_PLANE_MAX_FRAME * 2];
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> connected_{true};
+    std::thread reader_;
+
+    struct Counters {
+        std::atomic<uint64_t> sent{0}, completed{0}, nacks{0}, timeouts{0}, unmatched{0}, frames{0}, rx_overflows{0};
+    } counters_;
+};
+
+} // namespace sercalo
+
+#endif // SERCALO_CLIENT_HPP
@@ -0,0 +1,132 @@
+/**************************************************************************************************
+* Arquivo:      data_plane.hpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Quadros do plano de dados no host (ver main/data_plane.h): decodificação
+* das linhas `:DAT:<hex>` e do fluxo de bytes da UART de dados, sem alocação, e
+* leitura dos payloads de passo de varredura e de espectro.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_DATA_PLANE_HPP
+#define SERCALO_DATA_PLANE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sercalo {
+
+// Formato do quadro (little-endian), o mesmo do firmware:
+//   | 0xA5 | 0x5A | tipo | canal | seq (u16) | len (u16) | payload (len bytes) | CRC-8 |
+constexpr uint8_t  DATA_PLANE_SYNC_0      = 0xA5;
+constexpr uint8_t  DATA_PLANE_SYNC_1      = 0x5A;
+constexpr size_t   DATA_PLANE_HEADER_LEN  = 8;
+constexpr size_t   DATA_PLANE_MAX_PAYLOAD = 512;
+constexpr size_t   DATA_PLANE_MAX_FRAME   = DATA_PLANE_HEADER_LEN + DATA_PLANE_MAX_PAYLOAD + 1;
+constexpr uint8_t  DATA_PLANE_NO_CHANNEL  = 0xFF;
+
+enum class FrameType : uint8_t {
+    SweepStep   = 0x01,     //!< Um passo de varredura (`SweepStep`).
+    Spectrum    = 0x02,     //!< Trecho do espectro de um ciclo (`SpectrumChunk` + amostras u16).
+    Trace       = 0x03,     //!< Texto de diagnóstico (UTF-8, sem terminador).
+    RasterPoint = 0x04,     //!< Um ponto da varredura do espelho.
+};
+
+/**
+ * @brief Quadro decodificado. `payload` aponta para o buffer do decodificador e
+ *        só é válido durante a chamada que o entregou.
+ */
+struct FrameView {
+    uint8_t type;
+    uint8_t channel;
+    uint16_t seq;
+    const uint8_t *payload;
+    uint16_t len;
+};
+
+/** @brief Payload de FrameType::SweepStep (`dp_sweep_step_t`). */
+struct SweepStep {
+    uint32_t timestamp_ms;
+    uint32_t cycle;
+    uint16_t step;
+    float target_wl;
+};
+
+/** @brief Cabeçalho do payload de FrameType::Spectrum (`dp_spectrum_chunk_t`). */
+struct SpectrumChunk {
+    uint32_t cycle;
+    float start_wl;
+    float step_wl;
+    uint16_t first;             //!< Índice da primeira amostra deste trecho.
+    uint16_t total;             //!< Pontos do espectro completo.
+    const uint8_t *samples;     //!< Amostras u16 little-endian (não alinhadas), dentro do payload.
+    uint16_t count;             //!< Amostras neste trecho.
+};
+
+constexpr size_t SWEEP_STEP_LEN     = 14;
+constexpr size_t SPECTRUM_HEADER_LEN = 16;
+constexpr size_t SPECTRUM_MAX_SAMPLES = (DATA_PLANE_MAX_PAYLOAD - SPECTRUM_HEADER_LEN) / 2;
+
+/** @brief CRC-8 (polinômio 0x07, valor inicial 0), o mesmo do protocolo I2C do TF1. */
+uint8_t crc8(const uint8_t *data, size_t len);
+
+/**
+ * @brief Converte texto hexadecimal em bytes.
+ * @return Bytes escritos em `out`, ou -1 se o texto for inválido ou não couber.
+ */
+long decode_hex(std::string_view hex, uint8_t *out, size_t cap);
+
+bool decode_sweep_step(const FrameView &frame, SweepStep &out);
+bool decode_spectrum_chunk(const FrameView &frame, SpectrumChunk &out);
+
+/**
+ * @brief Extrai quadros de um fluxo de bytes, ressincronizando após lixo ou CRC
+ *        inválido, como o `FrameDecoder` de interface/data_plane.py. O buffer é
+ *        fixo (um quadro máximo); nada é alocado.
+ */
+class FrameDecoder {
+public:
+    /**
+     * @brief Acrescenta bytes recebidos e chama `on_frame(const FrameView &)` para
+     *        cada quadro completo.
+     */
+    template <typename F>
+    void feed(const uint8_t *data, size_t len, F &&on_frame) {
+        while (len > 0) {
+            size_t n = fill(data, len);
+            data += n;
+            len -= n;
+            FrameView frame;
+            while (next(frame)) {
+                on_frame(static_cast<const FrameView &>(frame));
+            }
+        }
+    }
+
+    uint32_t crc_errors() const { return crc_errors_; }
+    uint32_t lost_frames() const { return lost_frames_; }
+
+private:
+    size_t fill(const uint8_t *data, size_t len);
+    bool next(FrameView &frame);
+
+    uint8_t buf_[2 * DATA_PLANE_MAX_FRAME];
+    size_t len_ = 0;
+    size_t consumed_ = 0;       // Bytes do quadro entregue por último, descartados na próxima chamada.
+    int32_t last_seq_ = -1;
+    uint32_t crc_errors_ = 0;
+    uint32_t lost_frames_ = 0;
+};
+
+} // namespace sercalo
+
+#endif // SERCALO_DATA_PLANE_HPP
@@ -0,0 +1,83 @@
+/**************************************************************************************************
+* Arquivo:      response.hpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Análise das linhas recebidas do controlador sem alocação: os resultados
+* são `std::string_view` sobre o buffer de recepção, válidos até a próxima leitura.
+* Reconhece `:ACK[@tag][: dados]`, `:NACK[@tag]: erro` e `:DAT:<hex>`, e localiza
+* campos nos três formatos de resposta do firmware (text, kv e json, ver
+* main/response.h) sem montar uma árvore.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_RESPONSE_HPP
+#define SERCALO_RESPONSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sercalo {
+
+/** @brief Formatos de resposta do firmware (comando `format`). */
+enum class ResponseFormat : uint8_t { Text, Kv, Json };
+
+enum class LineKind : uint8_t {
+    Ack,        //!< `:ACK...`: `payload` são os dados (vazio em `:ACK`).
+    Nack,       //!< `:NACK...`: `payload` é a mensagem de erro.
+    Data,       //!< `:DAT:<hex>`: `payload` é o texto hexadecimal.
+    Other,      //!< Log do console ou lixo: `payload` é a linha inteira.
+};
+
+/**
+ * @brief Uma linha recebida, já classificada. Os campos apontam para a linha.
+ */
+struct ResponseLine {
+    LineKind kind;
+    std::string_view tag;       //!< Etiqueta repetida pelo firmware (vazia se não houver).
+    std::string_view payload;
+};
+
+/**
+ * @brief Classifica uma linha (sem o '\n' final; um '\r' é ignorado).
+ */
+ResponseLine parse_line(std::string_view line);
+
+/**
+ * @brief Converte uma etiqueta numérica. Retorna false se não for um número decimal de até 9 dígitos.
+ */
+bool parse_tag(std::string_view tag, uint32_t &out);
+
+/**
+ * @brief Verifica se os dados de um `:ACK` começam um bloco binário (`#<d><tamanho><dados>`).
+ * @param[out] header Bytes do cabeçalho do bloco (`#`, dígito e tamanho).
+ * @param[out] length Bytes de dados do bloco (que podem conter '\n').
+ */
+bool parse_block_header(std::string_view payload, size_t &header, size_t &length);
+
+/**
+ * @brief Procura um campo nos dados de uma resposta.
+ *
+ * `key` é o nome do campo ou `grupo.campo` (ex.: `C.sn`; grupos só nos formatos
+ * kv e json). Textos entre aspas são devolvidos sem as aspas e sem resolver os
+ * escapes; números, como estão. Uma resposta de valor isolado (ex.: `get-wl`) é
+ * o próprio `payload`.
+ */
+bool find_field(std::string_view payload, std::string_view key, ResponseFormat format, std::string_view &value);
+
+/**
+ * @brief Converte um número (com `std::from_chars`, sem locale e sem alocação).
+ */
+bool parse_number(std::string_view text, double &out);
+
+} // namespace sercalo
+
+#endif // SERCALO_RESPONSE_HPP
@@ -0,0 +1,212 @@
+/**************************************************************************************************
+* Arquivo:      spectrum.hpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Análise de espectros no host: conversão das amostras, média de várias
+* varreduras, remoção da linha de base, detecção de picos e largura a meia altura
+* (FWHM). Os kernels operam sobre vetores contíguos de float e usam AVX2 ou SSE2,
+* escolhidos na primeira chamada conforme o processador, com versão escalar para
+* outras arquiteturas. Nada é alocado nos kernels; `SpectrumAnalyzer` reserva o
+* espaço de trabalho uma vez por tamanho de espectro.
+*
+* Duas origens: o streaming (`SpectrumAssembler` recebe os `SpectrumChunk` do
+* `on_frame` do cliente) e o arquivo de histórico (interface/archive.py), cujas
+* colunas de potência são vetores de float no arquivo mapeado. A API C no fim
+* deste arquivo (biblioteca `sercalo_spectrum`) é usada pelo
+* interface/spectrum_kernels.py.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_SPECTRUM_HPP
+#define SERCALO_SPECTRUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sercalo/data_plane.hpp"
+
+namespace sercalo {
+
+enum class SimdLevel : uint8_t {
+    Scalar = 0,
+    Sse2   = 1,
+    Avx2   = 2,
+};
+
+/** @brief Maior nível suportado pelo processador. */
+SimdLevel simd_supported();
+
+/** @brief Nível em uso pelos kernels (o suportado, salvo `set_simd_level`). */
+SimdLevel simd_level();
+
+/**
+ * @brief Força um nível (ex.: para comparar no benchmark), limitado ao suportado.
+ * @return Nível efetivo.
+ */
+SimdLevel set_simd_level(SimdLevel level);
+
+const char *to_string(SimdLevel level);
+
+/** @brief Pico encontrado por `find_peaks`, em índices de amostra. */
+struct Peak {
+    uint32_t index;     //!< Amostra do máximo.
+    float height;       //!< Valor no máximo (acima da linha de base, se removida).
+    float left;         //!< Posição interpolada da meia altura à esquerda; NaN se não cai antes da borda.
+    float right;        //!< Idem, à direita.
+
+    /** @brief Largura a meia altura em amostras (vezes `step_wl` para nm); NaN se incompleta. */
+    float fwhm() const { return right - left; }
+};
+
+// --- Kernels (vetores contíguos, sem alocação) ---
+
+/** @brief Converte amostras u16 little-endian (não alinhadas, como em `SpectrumChunk::samples`) em float. */
+void samples_to_float(const uint8_t *samples, size_t count, float *out);
+
+/** @brief sum[i] += x[i]. */
+void accumulate(float *sum, const float *x, size_t n);
+
+/** @brief out[i] = x[i] * k (`out` pode ser `x`). */
+void scale(const float *x, size_t n, float k, float *out);
+
+/**
+ * @brief Média de `count` espectros de `n` pontos, guardados em sequência em `spectra`
+ *        (ex.: a coluna de potência do arquivo de histórico).
+ */
+void average(const float *spectra, size_t count, size_t n, float *out);
+
+/**
+ * @brief Máximos locais (maior que o anterior, não menor que o seguinte) com valor
+ *        >= `threshold`. Um máximo a menos de `min_distance` amostras do último
+ *        aceito fica só se for maior (e então o substitui).
+ * @return Picos escritos em `out` (no máximo `cap`), com `left`/`right` NaN.
+ */
+size_t find_peaks(const float *x, size_t n, float threshold, size_t min_distance, Peak *out, size_t cap);
+
+/**
+ * @brief Preenche `left` e `right` de cada pico: as posições, interpoladas
+ *        linearmente, em que o espectro cai abaixo de metade de `height`.
+ *        Espera um espectro sem linha de base (ver `SpectrumAnalyzer`).
+ */
+void measure_fwhm(const float *x, size_t n, Peak *peaks, size_t count);
+
+/**
+ * @brief Análise de um espectro: remoção da linha de base (abertura morfológica:
+ *        mínimo e depois máximo em uma janela de `window` amostras, que segue o
+ *        fundo sob picos mais estreitos que a janela), picos e FWHM.
+ *
+ * O espaço de trabalho é alocado na primeira chamada para cada tamanho; as
+ * seguintes não alocam. Não é thread-safe: uma instância por thread.
+ */
+class SpectrumAnalyzer {
+public:
+    /**
+     * @brief out[i] = x[i] - linha de base, em O(n log window).
+     * @param baseline Recebe a linha de base (opcional).
+     */
+    void remove_baseline(const float *x, size_t n, size_t window, float *out, float *baseline = nullptr);
+
+    /**
+     * @brief Linha de base, picos (`threshold` acima dela) e FWHM. `corrected`
+     *        recebe o espectro sem a linha de base.
+     * @return Picos escritos em `out`.
+     */
+    size_t analyze(const float *x, size_t n, size_t window, float threshold, size_t min_distance,
+                   float *corrected, Peak *out, size_t cap);
+
+private:
+    void morph(const float *in, size_t n, size_t window, bool maximum, float *out);
+
+    std::vector<float> padded_;
+    std::vector<float> work_a_;
+    std::vector<float> work_b_;
+    std::vector<float> eroded_;
+    std::vector<float> baseline_;
+};
+
+/**
+ * @brief Monta os espectros completos a partir dos trechos do streaming
+ *        (`decode_spectrum_chunk` no `on_frame` do cliente).
+ */
+class SpectrumAssembler {
+public:
+    /**
+     * @brief Grava as amostras do trecho. Um ciclo novo descarta o anterior incompleto.
+     * @return true quando o espectro do ciclo do trecho fica completo (`data()`).
+     */
+    bool add(const SpectrumChunk &chunk);
+
+    const float *data() const { return values_.data(); }
+    size_t size() const { return values_.size(); }
+    uint32_t cycle() const { return cycle_; }
+    float start_wl() const { return start_wl_; }
+    float step_wl() const { return step_wl_; }
+    uint32_t incomplete() const { return incomplete_; }     //!< Ciclos descartados incompletos.
+
+private:
+    std::vector<float> values_;
+    uint32_t cycle_ = 0;
+    float start_wl_ = 0.0f;
+    float step_wl_ = 0.0f;
+    size_t received_ = 0;
+    bool started_ = false;
+    uint32_t incomplete_ = 0;
+};
+
+/** @brief Média acumulada de varreduras de mesmo tamanho. */
+class SpectrumAverager {
+public:
+    /** @brief Acrescenta um espectro; um tamanho diferente recomeça a média. */
+    void add(const float *x, size_t n);
+
+    /** @brief Média das varreduras acrescentadas (`size()` pontos). */
+    void mean(float *out) const;
+
+    void reset() { count_ = 0; }
+    size_t size() const { return sum_.size(); }
+    uint32_t count() const { return count_; }
+
+private:
+    std::vector<float> sum_;
+    uint32_t count_ = 0;
+};
+
+} // namespace sercalo
+
+// --- API C (biblioteca compartilhada sercalo_spectrum, para ctypes) ---
+
+extern "C" {
+
+typedef sercalo::Peak sercalo_peak_t;
+
+/** @brief Nível em uso (0 escalar, 1 SSE2, 2 AVX2). */
+int sercalo_simd_level(void);
+
+/** @brief Força um nível; retorna o efetivo. */
+int sercalo_set_simd_level(int level);
+
+void sercalo_average(const float *spectra, size_t count, size_t n, float *out);
+
+/** @brief Ver SpectrumAnalyzer::remove_baseline (`baseline` pode ser NULL). */
+void sercalo_remove_baseline(const float *x, size_t n, size_t window, float *out, float *baseline);
+
+/** @brief Ver SpectrumAnalyzer::analyze. */
+size_t sercalo_analyze(const float *x, size_t n, size_t window, float threshold, size_t min_distance,
+                       float *corrected, sercalo_peak_t *out, size_t cap);
+
+/** @brief Ver find_peaks e measure_fwhm (espectro já sem linha de base). */
+size_t sercalo_find_peaks(const float *x, size_t n, float threshold, size_t min_distance,
+                          sercalo_peak_t *out, size_t cap);
+
+} // extern "C"
+
+#endif // SERCALO_SPECTRUM_HPP
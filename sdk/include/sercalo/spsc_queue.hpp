@@ -0,0 +1,91 @@
+/**************************************************************************************************
+* Arquivo:      spsc_queue.hpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Fila circular sem locks de um produtor e um consumidor, de capacidade
+* fixa (potência de 2). Usada pelo cliente para entregar as respostas da thread
+* de leitura à thread da aplicação sem mutex e sem alocação.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_SPSC_QUEUE_HPP
+#define SERCALO_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace sercalo {
+
+/**
+ * @brief Fila de um produtor e um consumidor. `T` é copiado para dentro da
+ *        fila; `push` falha (sem bloquear) com a fila cheia.
+ *
+ * Os índices só crescem; o produtor publica um item com `tail` (release) e o
+ * consumidor o libera com `head` (release). Cada índice fica em sua própria linha
+ * de cache, para que as duas threads não disputem a mesma linha.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacidade deve ser potência de 2");
+
+public:
+    /** @brief Posição livre para o produtor preencher, ou nullptr com a fila cheia. */
+    T *prepare() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == N) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == N) return nullptr;
+        }
+        return &items_[tail & (N - 1)];
+    }
+
+    /** @brief Publica o item preenchido em `prepare`. */
+    void commit() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool push(const T &item) {
+        T *slot = prepare();
+        if (slot == nullptr) return false;
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    /** @brief Item mais antigo, ou nullptr com a fila vazia. Válido até `pop`. */
+    T *front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return nullptr;
+        }
+        return &items_[head & (N - 1)];
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;     // Cópia de `tail_` do consumidor.
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;     // Cópia de `head_` do produtor.
+    alignas(64) T items_[N];
+};
+
+} // namespace sercalo
+
+#endif // SERCALO_SPSC_QUEUE_HPP
@@ -0,0 +1,78 @@
+/**************************************************************************************************
+* Arquivo:      transport.hpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Transportes do cliente C++: porta serial (ou pseudo-terminal do firmware
+* de host e do emulador) e servidor TCP do firmware. Ambos são descritores POSIX
+* em modo não bloqueante; a leitura espera com `poll` até um tempo limite, para
+* que a thread de leitura também possa expirar os comandos pendentes.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#ifndef SERCALO_TRANSPORT_HPP
+#define SERCALO_TRANSPORT_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace sercalo {
+
+constexpr uint16_t DEFAULT_TCP_PORT = 5025;
+
+/**
+ * @brief Conexão de bytes com o controlador. Uma thread lê e qualquer thread
+ *        escreve (o cliente serializa as escritas).
+ *
+ * Falhas do sistema geram `std::system_error`.
+ */
+class Transport {
+public:
+    virtual ~Transport();
+
+    /**
+     * @brief Lê o que estiver disponível, esperando até `timeout`.
+     * @return Bytes lidos (0 se nada chegou no prazo), ou -1 se a conexão foi encerrada.
+     */
+    long read_some(uint8_t *buf, size_t cap, std::chrono::milliseconds timeout);
+
+    /** @brief Escreve todos os bytes (esperando o dispositivo, se necessário). */
+    void write_all(const void *data, size_t len);
+
+    /** @brief Fecha o descritor. */
+    void close();
+
+    const std::string &name() const { return name_; }
+
+protected:
+    Transport(int fd, std::string name, bool socket);
+
+    int fd_;
+    std::string name_;
+    bool socket_;
+};
+
+/**
+ * @brief Abre a porta serial do console em modo raw (8N1, sem controle de fluxo).
+ *        DTR e RTS não são alterados, para não reiniciar o ESP32.
+ */
+std::unique_ptr<Transport> open_serial(const std::string &path, unsigned baudrate = 115200);
+
+/**
+ * @brief Conecta ao servidor TCP do firmware (Nagle desligado: comandos são pequenos).
+ */
+std::unique_ptr<Transport> open_tcp(const std::string &host, uint16_t port = DEFAULT_TCP_PORT);
+
+} // namespace sercalo
+
+#endif // SERCALO_TRANSPORT_HPP
@@ -0,0 +1,478 @@
+/**************************************************************************************************
+* Arquivo:      client.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Cliente C++ do controlador: tabela de comandos pendentes, thread de
+* leitura e análise das respostas no buffer de recepção.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sercalo/client.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace sercalo {
+
+namespace {
+
+constexpr uint32_t TAG_MODULUS = 100000000;     // Etiquetas de até 8 dígitos (COMMAND_TAG_MAX).
+constexpr auto READ_TICK = std::chrono::milliseconds(5);   // Resolução dos prazos.
+constexpr std::string_view NO_DATA("");        // Respostas sem dados (prazo vencido, conexão encerrada).
+
+static_assert(TAG_MODULUS % Client::MAX_PENDING == 0, "a etiqueta deve indicar a posição na tabela");
+
+const char *format_name(ResponseFormat format) {
+    switch (format) {
+    case ResponseFormat::Kv: return "kv";
+    case ResponseFormat::Json: return "json";
+    default: return "text";
+    }
+}
+
+} // namespace
+
+/** {@inheritdoc} */
+const char *status_name(Status status) {
+    switch (status) {
+    case Status::Ok: return "ok";
+    case Status::Nack: return "nack";
+    case Status::Timeout: return "timeout";
+    case Status::Disconnected: return "disconnected";
+    }
+    return "?";
+}
+
+CommandError::CommandError(std::string_view command, Status status, std::string_view message)
+    : std::runtime_error(std::string(command) + ": " +
+                         (status == Status::Nack ? std::string(message) : std::string(status_name(status)))),
+      status_(status), command_(command), message_(message) {}
+
+Client::Client(std::unique_ptr<Transport> transport, ClientOptions options)
+    : transport_(std::move(transport)), options_(std::move(options)),
+      window_(std::clamp<unsigned>(options_.window, 1, MAX_PENDING)),
+      rx_(new uint8_t[RX_BUFFER_SIZE]) {
+    reader_ = std::thread(&Client::read_loop, this);
+    if (options_.format != ResponseFormat::Text) {
+        char cmd[16];
+        std::snprintf(cmd, sizeof(cmd), "format:%s", format_name(options_.format));
+        try {
+            command(cmd);
+        } catch (...) {
+            close();
+            throw;
+        }
+        format_ = options_.format;
+    }
+}
+
+Client::~Client() {
+    close();
+}
+
+std::unique_ptr<Client> Client::open_serial(const std::string &path, ClientOptions options, unsigned baudrate) {
+    return std::make_unique<Client>(sercalo::open_serial(path, baudrate), std::move(options));
+}
+
+std::unique_ptr<Client> Client::open_tcp(const std::string &host, uint16_t port, ClientOptions options) {
+    return std::make_unique<Client>(sercalo::open_tcp(host, port), std::move(options));
+}
+
+/** {@inheritdoc} */
+void Client::close() {
+    stop_.store(true);
+    if (reader_.joinable()) {
+        reader_.join();     // A thread de leitura termina os pendentes ao sair.
+    }
+    transport_->close();
+}
+
+// --- Janela e tabela de pendentes ---
+
+bool Client::try_reserve() {
+    unsigned n = in_flight_.load();
+    while (n < window_) {
+        if (in_flight_.compare_exchange_weak(n, n + 1)) return true;
+    }
+    return false;
+}
+
+bool Client::acquire_window(bool block) {
+    bool reserved = try_reserve();
+    if (!reserved && block) {
+        std::unique_lock<std::mutex> lock(window_mutex_);
+        window_waiters_++;
+        window_cv_.wait(lock, [&] { return (reserved = try_reserve()) || !connected(); });
+        window_waiters_--;
+    }
+    if (reserved && !connected()) {
+        release_window();
+        return false;
+    }
+    return reserved;
+}
+
+void Client::release_window() {
+    in_flight_.fetch_sub(1);
+    if (window_waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(window_mutex_);
+        window_cv_.notify_one();
+    }
+}
+
+Client::Slot *Client::claim_slot() {
+    // Há sempre uma posição livre: a janela (<= MAX_PENDING) já foi reservada.
+    size_t start = next_slot_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0;; i++) {
+        Slot &slot = slots_[(start + i) % MAX_PENDING];
+        uint8_t expected = SLOT_FREE;
+        if (slot.state.compare_exchange_strong(expected, SLOT_CLAIMED, std::memory_order_acquire)) {
+            size_t index = static_cast<size_t>(&slot - slots_);
+            slot.generation = (slot.generation + 1) % (TAG_MODULUS / MAX_PENDING);
+            slot.tag.store(static_cast<uint32_t>(slot.generation * MAX_PENDING + index), std::memory_order_relaxed);
+            return &slot;
+        }
+    }
+}
+
+bool Client::send(Slot &slot, std::string_view command) {
+    char line[CMD_BUFFER_SIZE + 16];
+    int prefix = std::snprintf(line, sizeof(line), ":@%u ", static_cast<unsigned>(slot.tag.load(std::memory_order_relaxed)));
+    std::memcpy(line + prefix, command.data(), command.size());
+    line[prefix + command.size()] = '\n';
+
+    slot.sent = Clock::now();
+    slot.state.store(SLOT_PENDING);
+    bool written = true;
+    try {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        transport_->write_all(line, static_cast<size_t>(prefix) + command.size() + 1);
+        counters_.sent.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception &) {
+        written = false;
+    }
+    // Sem conexão, a thread de leitura já saiu (e terminou os pendentes que viu): ninguém mais completaria este.
+    if (written && connected()) return true;
+    if (slot.kind != Kind::Queue) {
+        try_complete(slot, Status::Disconnected, NO_DATA);
+        return true;
+    }
+    // A fila de `poll` só tem um produtor (a thread de leitura): o envio é desfeito e `submit` falha.
+    uint8_t expected = SLOT_PENDING;
+    if (!slot.state.compare_exchange_strong(expected, SLOT_COMPLETING)) {
+        return true;    // Já completado pela thread de leitura.
+    }
+    slot.state.store(SLOT_FREE);
+    release_window();
+    return false;
+}
+
+bool Client::try_complete(Slot &slot, Status status, std::string_view data, bool truncated) {
+    uint8_t expected = SLOT_PENDING;
+    if (!slot.state.compare_exchange_strong(expected, SLOT_COMPLETING)) {
+        return false;   // Já completado (resposta, prazo ou falha de escrita).
+    }
+    complete(slot, status, data, truncated);
+    return true;
+}
+
+void Client::complete(Slot &slot, Status status, std::string_view data, bool truncated) {
+    counters_.completed.fetch_add(1, std::memory_order_relaxed);
+    if (status == Status::Nack) counters_.nacks.fetch_add(1, std::memory_order_relaxed);
+    if (status == Status::Timeout) counters_.timeouts.fetch_add(1, std::memory_order_relaxed);
+
+    switch (slot.kind) {
+    case Kind::Future:
+        slot.promise.set_value(Reply{status, std::string(data)});
+        break;
+    case Kind::Callback:
+        slot.callback(ReplyView{status, data, slot.tag.load(std::memory_order_relaxed), slot.sent});
+        slot.callback = nullptr;
+        break;
+    case Kind::Queue: {
+        // Nunca cheia: cada registro na fila ainda ocupa uma posição da janela.
+        Completion *c = completions_.prepare();
+        size_t len = std::min(data.size(), COMPLETION_DATA_MAX);
+        c->user = slot.user;
+        c->tag = slot.tag.load(std::memory_order_relaxed);
+        c->status = status;
+        c->truncated = truncated || len < data.size();
+        c->len = static_cast<uint16_t>(len);
+        c->sent = slot.sent;
+        c->received = Clock::now();
+        std::memcpy(c->data, data.data(), len);
+        completions_.commit();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_.load()) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_cv_.notify_one();
+        }
+        break;
+    }
+    }
+    Kind kind = slot.kind;
+    slot.state.store(SLOT_FREE, std::memory_order_release);
+    if (kind != Kind::Queue) {
+        release_window();
+    }
+}
+
+// --- Envio ---
+
+std::future<Reply> Client::request(std::string_view command) {
+    return request(command, Clock::now() + options_.timeout);
+}
+
+std::future<Reply> Client::request(std::string_view command, Clock::time_point deadline) {
+    if (command.size() + 12 > CMD_BUFFER_SIZE) throw std::invalid_argument("comando longo demais");
+    if (!acquire_window(true)) {
+        std::promise<Reply> failed;
+        failed.set_value(Reply{Status::Disconnected, {}});
+        return failed.get_future();
+    }
+    Slot *slot = claim_slot();
+    slot->kind = Kind::Future;
+    slot->deadline = deadline;
+    slot->promise = std::promise<Reply>();
+    std::future<Reply> future = slot->promise.get_future();
+    send(*slot, command);
+    return future;
+}
+
+void Client::request(std::string_view command, Callback callback) {
+    request(command, std::move(callback), Clock::now() + options_.timeout);
+}
+
+void Client::request(std::string_view command, Callback callback, Clock::time_point deadline) {
+    if (command.size() + 12 > CMD_BUFFER_SIZE) throw std::invalid_argument("comando longo demais");
+    if (!acquire_window(true)) {
+        callback(ReplyView{Status::Disconnected, {}, 0, Clock::now()});
+        return;
+    }
+    Slot *slot = claim_slot();
+    slot->kind = Kind::Callback;
+    slot->deadline = deadline;
+    slot->callback = std::move(callback);
+    send(*slot, command);
+}
+
+bool Client::submit(std::string_view command, uint64_t user) {
+    return submit(command, user, Clock::now() + options_.timeout);
+}
+
+bool Client::submit(std::string_view command, uint64_t user, Clock::time_point deadline) {
+    if (command.size() + 12 > CMD_BUFFER_SIZE) throw std::invalid_argument("comando longo demais");
+    if (!acquire_window(false)) return false;
+    Slot *slot = claim_slot();
+    slot->kind = Kind::Queue;
+    slot->deadline = deadline;
+    slot->user = user;
+    return send(*slot, command);
+}
+
+/** {@inheritdoc} */
+bool Client::wait(Clock::duration timeout) {
+    if (!completions_.empty()) return true;
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    consumer_waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = wait_cv_.wait_for(lock, timeout, [&] { return !completions_.empty() || !connected(); });
+    consumer_waiting_.store(false);
+    return ready && !completions_.empty();
+}
+
+// --- Síncronos ---
+
+std::string Client::command(std::string_view command) {
+    Reply reply = request(command).get();
+    if (!reply.ok()) {
+        throw CommandError(command, reply.status, reply.data);
+    }
+    return std::move(reply.data);
+}
+
+std::string Client::iden() {
+    return command("iden?");
+}
+
+Wavelength Client::get_wl(Band band) {
+    char cmd[16];
+    std::snprintf(cmd, sizeof(cmd), "get-wl?%c", static_cast<char>(band));
+    std::string data = command(cmd);
+    double nm;
+    if (!parse_number(data, nm)) {
+        throw CommandError(cmd, Status::Nack, "resposta inválida: " + data);
+    }
+    return Wavelength{nm};
+}
+
+void Client::get_wl(Band band, std::function<void(Status, Wavelength)> done) {
+    char cmd[16];
+    std::snprintf(cmd, sizeof(cmd), "get-wl?%c", static_cast<char>(band));
+    request(cmd, [done = std::move(done)](const ReplyView &reply) {
+        double nm = 0.0;
+        Status status = reply.status;
+        if (status == Status::Ok && !parse_number(reply.data, nm)) {
+            status = Status::Nack;
+        }
+        done(status, Wavelength{nm});
+    });
+}
+
+void Client::set_wl(Band band, Wavelength wavelength) {
+    char cmd[32];
+    std::snprintf(cmd, sizeof(cmd), "set-wl:%c:%.3f", static_cast<char>(band), wavelength.nm);
+    command(cmd);
+}
+
+Interval Client::get_interval(Band band) {
+    char cmd[24];
+    std::snprintf(cmd, sizeof(cmd), "get-interval?%c", static_cast<char>(band));
+    std::string data = command(cmd);
+    std::string_view min_text, max_text;
+    double min_nm, max_nm;
+    if (!find_field(data, "min", format_, min_text) || !find_field(data, "max", format_, max_text) ||
+        !parse_number(min_text, min_nm) || !parse_number(max_text, max_nm)) {
+        throw CommandError(cmd, Status::Nack, "resposta inválida: " + data);
+    }
+    return Interval{Wavelength{min_nm}, Wavelength{max_nm}};
+}
+
+/** {@inheritdoc} */
+ClientStats Client::stats() const {
+    return ClientStats{counters_.sent.load(), counters_.completed.load(), counters_.nacks.load(),
+                       counters_.timeouts.load(), counters_.unmatched.load(), counters_.frames.load(),
+                       counters_.rx_overflows.load()};
+}
+
+// --- Thread de leitura ---
+
+void Client::read_loop() {
+    size_t len = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+        long n;
+        try {
+            n = transport_->read_some(rx_.get() + len, RX_BUFFER_SIZE - len, READ_TICK);
+        } catch (const std::exception &) {
+            n = -1;
+        }
+        if (n < 0) break;
+        len += static_cast<size_t>(n);
+        if (n > 0) {
+            size_t consumed = process(len);
+            if (consumed == 0 && len == RX_BUFFER_SIZE) {
+                // Linha (ou bloco) maior que o buffer: descartada.
+                counters_.rx_overflows.fetch_add(1, std::memory_order_relaxed);
+                consumed = len;
+            }
+            // Só o trecho incompleto (em geral, parte de uma linha) volta ao início.
+            std::memmove(rx_.get(), rx_.get() + consumed, len - consumed);
+            len -= consumed;
+            rx_scanned_ = rx_scanned_ > consumed ? rx_scanned_ - consumed : 0;
+        }
+        expire(Clock::now());
+    }
+    connected_.store(false);
+    fail_all(Status::Disconnected);
+    {
+        std::lock_guard<std::mutex> lock(window_mutex_);
+        window_cv_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_cv_.notify_all();
+}
+
+/**
+ * @brief Analisa as linhas completas do buffer. Retorna os bytes consumidos.
+ */
+size_t Client::process(size_t len) {
+    const char *buf = reinterpret_cast<const char *>(rx_.get());
+    size_t pos = 0;
+    while (pos < len) {
+        size_t from = std::max(pos, rx_scanned_);
+        const void *nl = std::memchr(buf + from, '\n', len - from);
+        if (nl == nullptr) {
+            rx_scanned_ = len;
+            break;
+        }
+        size_t end = static_cast<size_t>(static_cast<const char *>(nl) - buf);
+        ResponseLine line = parse_line(std::string_view(buf + pos, end - pos));
+
+        size_t header, length;
+        if (line.kind == LineKind::Ack && parse_block_header(line.payload, header, length)) {
+            // Bloco binário: os dados (que podem conter '\n') seguem o cabeçalho, e o '\n' final, os dados.
+            size_t data_start = static_cast<size_t>(line.payload.data() - buf) + header;
+            if (data_start + length + 1 > len) {
+                rx_scanned_ = pos;
+                break;
+            }
+            line.payload = std::string_view(buf + data_start, length);
+            end = data_start + length;
+        }
+        dispatch(line);
+        pos = end + 1;
+        rx_scanned_ = pos;
+    }
+    return pos;
+}
+
+void Client::dispatch(const ResponseLine &line) {
+    switch (line.kind) {
+    case LineKind::Ack:
+    case LineKind::Nack: {
+        uint32_t tag;
+        if (parse_tag(line.tag, tag)) {
+            Slot &slot = slots_[tag % MAX_PENDING];
+            if (slot.tag.load(std::memory_order_relaxed) == tag && try_complete(slot, line.kind == LineKind::Ack ? Status::Ok : Status::Nack,
+                                                line.payload)) {
+                return;
+            }
+        }
+        // Resposta atrasada (prazo vencido), sem etiqueta ou de outro cliente.
+        counters_.unmatched.fetch_add(1, std::memory_order_relaxed);
+        if (options_.on_line) options_.on_line(line.payload);
+        return;
+    }
+    case LineKind::Data: {
+        if (!options_.on_frame) return;
+        long n = decode_hex(line.payload, frame_bytes_, sizeof(frame_bytes_));
+        if (n > 0) {
+            decoder_.feed(frame_bytes_, static_cast<size_t>(n), [&](const FrameView &frame) {
+                counters_.frames.fetch_add(1, std::memory_order_relaxed);
+                options_.on_frame(frame);
+            });
+        }
+        return;
+    }
+    case LineKind::Other:
+        if (options_.on_line && !line.payload.empty()) options_.on_line(line.payload);
+        return;
+    }
+}
+
+void Client::expire(Clock::time_point now) {
+    if (in_flight_.load(std::memory_order_relaxed) == 0) return;
+    for (Slot &slot : slots_) {
+        if (slot.state.load(std::memory_order_acquire) == SLOT_PENDING && slot.deadline <= now) {
+            try_complete(slot, Status::Timeout, NO_DATA);
+        }
+    }
+}
+
+void Client::fail_all(Status status) {
+    for (Slot &slot : slots_) {
+        // Uma posição ainda sendo preenchida é completada pelo envio, que falha em seguida.
+        try_complete(slot, status, NO_DATA);
+    }
+}
+
+} // namespace sercalo
@@ -0,0 +1,175 @@
+/**************************************************************************************************
+* Arquivo:      data_plane.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Decodificação dos quadros do plano de dados no host.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sercalo/data_plane.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace sercalo {
+
+namespace {
+
+constexpr std::array<uint8_t, 256> make_crc8_table() {
+    std::array<uint8_t, 256> table{};
+    for (unsigned byte = 0; byte < 256; byte++) {
+        uint8_t crc = static_cast<uint8_t>(byte);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+        table[byte] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> CRC8_TABLE = make_crc8_table();
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+template <typename T>
+T load_le(const uint8_t *p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));     // Host little-endian (x86, ARM), como o ESP32.
+    return value;
+}
+
+} // namespace
+
+/** {@inheritdoc} */
+uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc = CRC8_TABLE[crc ^ data[i]];
+    }
+    return crc;
+}
+
+/** {@inheritdoc} */
+long decode_hex(std::string_view hex, uint8_t *out, size_t cap) {
+    if (hex.size() % 2 != 0 || hex.size() / 2 > cap) {
+        return -1;
+    }
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = hex_digit(hex[i]);
+        int lo = hex_digit(hex[i + 1]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        out[i / 2] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return static_cast<long>(hex.size() / 2);
+}
+
+/** {@inheritdoc} */
+bool decode_sweep_step(const FrameView &frame, SweepStep &out) {
+    if (frame.type != static_cast<uint8_t>(FrameType::SweepStep) || frame.len < SWEEP_STEP_LEN) {
+        return false;
+    }
+    out.timestamp_ms = load_le<uint32_t>(frame.payload);
+    out.cycle = load_le<uint32_t>(frame.payload + 4);
+    out.step = load_le<uint16_t>(frame.payload + 8);
+    out.target_wl = load_le<float>(frame.payload + 10);
+    return true;
+}
+
+/** {@inheritdoc} */
+bool decode_spectrum_chunk(const FrameView &frame, SpectrumChunk &out) {
+    if (frame.type != static_cast<uint8_t>(FrameType::Spectrum) || frame.len < SPECTRUM_HEADER_LEN) {
+        return false;
+    }
+    out.cycle = load_le<uint32_t>(frame.payload);
+    out.start_wl = load_le<float>(frame.payload + 4);
+    out.step_wl = load_le<float>(frame.payload + 8);
+    out.first = load_le<uint16_t>(frame.payload + 12);
+    out.total = load_le<uint16_t>(frame.payload + 14);
+    out.samples = frame.payload + SPECTRUM_HEADER_LEN;
+    out.count = static_cast<uint16_t>((frame.len - SPECTRUM_HEADER_LEN) / 2);
+    return true;
+}
+
+size_t FrameDecoder::fill(const uint8_t *data, size_t len) {
+    if (consumed_ > 0) {
+        std::memmove(buf_, buf_ + consumed_, len_ - consumed_);
+        len_ -= consumed_;
+        consumed_ = 0;
+    }
+    size_t n = std::min(len, sizeof(buf_) - len_);
+    std::memcpy(buf_ + len_, data, n);
+    len_ += n;
+    return n;
+}
+
+bool FrameDecoder::next(FrameView &frame) {
+    if (consumed_ > 0) {
+        std::memmove(buf_, buf_ + consumed_, len_ - consumed_);
+        len_ -= consumed_;
+        consumed_ = 0;
+    }
+    while (true) {
+        // Procura o sincronismo; um 0xA5 no fim do buffer pode ser o início do próximo.
+        size_t start = 0;
+        while (start + 1 < len_ && !(buf_[start] == DATA_PLANE_SYNC_0 && buf_[start + 1] == DATA_PLANE_SYNC_1)) {
+            start++;
+        }
+        if (start + 1 >= len_) {
+            bool keep = len_ > 0 && buf_[len_ - 1] == DATA_PLANE_SYNC_0;
+            if (keep) {
+                buf_[0] = DATA_PLANE_SYNC_0;
+            }
+            len_ = keep ? 1 : 0;
+            return false;
+        }
+        if (start > 0) {
+            std::memmove(buf_, buf_ + start, len_ - start);
+            len_ -= start;
+        }
+        if (len_ < DATA_PLANE_HEADER_LEN) {
+            return false;
+        }
+        size_t length = load_le<uint16_t>(buf_ + 6);
+        if (length > DATA_PLANE_MAX_PAYLOAD) {
+            std::memmove(buf_, buf_ + 2, len_ - 2);
+            len_ -= 2;
+            continue;
+        }
+        size_t total = DATA_PLANE_HEADER_LEN + length + 1;
+        if (len_ < total) {
+            return false;
+        }
+        if (crc8(buf_ + 2, total - 3) != buf_[total - 1]) {
+            crc_errors_++;
+            std::memmove(buf_, buf_ + 2, len_ - 2);
+            len_ -= 2;
+            continue;
+        }
+        uint16_t seq = load_le<uint16_t>(buf_ + 4);
+        if (last_seq_ >= 0) {
+            lost_frames_ += static_cast<uint16_t>(seq - last_seq_ - 1);
+        }
+        last_seq_ = seq;
+        frame = FrameView{buf_[2], buf_[3], seq, buf_ + DATA_PLANE_HEADER_LEN, static_cast<uint16_t>(length)};
+        consumed_ = total;      // O payload continua válido até a próxima chamada.
+        return true;
+    }
+}
+
+} // namespace sercalo
@@ -0,0 +1,210 @@
+/**************************************************************************************************
+* Arquivo:      response.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Análise das linhas recebidas do controlador, sem alocação.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sercalo/response.hpp"
+
+#include <cctype>
+#include <charconv>
+
+namespace sercalo {
+
+namespace {
+
+bool is_alnum(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+/**
+ * @brief Separa `[@tag][: dados]` após o prefixo `:ACK`/`:NACK`.
+ */
+void split_rest(std::string_view rest, ResponseLine &out) {
+    if (!rest.empty() && rest[0] == '@') {
+        size_t end = 1;
+        while (end < rest.size() && is_alnum(rest[end])) end++;
+        out.tag = rest.substr(1, end - 1);
+        rest.remove_prefix(end);
+    }
+    if (!rest.empty() && rest[0] == ':') {
+        rest.remove_prefix(1);
+        if (!rest.empty() && rest[0] == ' ') rest.remove_prefix(1);
+    }
+    out.payload = rest;
+}
+
+/**
+ * @brief Fim de um texto entre aspas que começa em `start` (após a aspa de abertura).
+ */
+size_t quoted_end(std::string_view s, size_t start) {
+    for (size_t i = start; i < s.size(); i++) {
+        if (s[i] == '\\') {
+            i++;
+        } else if (s[i] == '"') {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @brief Valor que começa em `start`: texto entre aspas ou até um dos delimitadores.
+ */
+bool take_value(std::string_view s, size_t start, std::string_view delimiters, std::string_view &value) {
+    if (start < s.size() && s[start] == '"') {
+        size_t end = quoted_end(s, start + 1);
+        if (end == std::string_view::npos) return false;
+        value = s.substr(start + 1, end - start - 1);
+        return true;
+    }
+    size_t end = s.find_first_of(delimiters, start);
+    value = s.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+    return true;
+}
+
+/**
+ * @brief Procura `key=` no início de um campo (após o início, ' ' ou ',').
+ */
+size_t find_assignment(std::string_view s, std::string_view key) {
+    for (size_t pos = s.find(key); pos != std::string_view::npos; pos = s.find(key, pos + 1)) {
+        size_t after = pos + key.size();
+        bool starts_field = pos == 0 || s[pos - 1] == ' ' || s[pos - 1] == ',';
+        if (starts_field && after < s.size() && s[after] == '=') {
+            return after + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @brief Procura `"key":` no primeiro nível de um objeto JSON e retorna o início do valor.
+ */
+size_t find_json_member(std::string_view s, std::string_view key) {
+    int depth = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+        } else if (c == '"') {
+            size_t end = quoted_end(s, i + 1);
+            if (end == std::string_view::npos) return std::string_view::npos;
+            if (depth == 1 && end + 1 < s.size() && s[end + 1] == ':' && s.substr(i + 1, end - i - 1) == key) {
+                return end + 2;
+            }
+            i = end;
+        }
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @brief Objeto JSON que começa em `start`, até a chave de fechamento correspondente.
+ */
+std::string_view json_object(std::string_view s, size_t start) {
+    int depth = 0;
+    for (size_t i = start; i < s.size(); i++) {
+        char c = s[i];
+        if (c == '"') {
+            i = quoted_end(s, i + 1);
+            if (i == std::string_view::npos) break;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if ((c == '}' || c == ']') && --depth == 0) {
+            return s.substr(start, i - start + 1);
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+/** {@inheritdoc} */
+ResponseLine parse_line(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    ResponseLine out{LineKind::Other, {}, line};
+    if (line.substr(0, 5) == ":DAT:") {
+        out.kind = LineKind::Data;
+        out.payload = line.substr(5);
+    } else if (line.substr(0, 4) == ":ACK") {
+        out.kind = LineKind::Ack;
+        split_rest(line.substr(4), out);
+    } else if (line.substr(0, 5) == ":NACK") {
+        out.kind = LineKind::Nack;
+        split_rest(line.substr(5), out);
+    }
+    return out;
+}
+
+/** {@inheritdoc} */
+bool parse_tag(std::string_view tag, uint32_t &out) {
+    if (tag.empty() || tag.size() > 9) return false;
+    auto result = std::from_chars(tag.data(), tag.data() + tag.size(), out);
+    return result.ec == std::errc() && result.ptr == tag.data() + tag.size();
+}
+
+/** {@inheritdoc} */
+bool parse_block_header(std::string_view payload, size_t &header, size_t &length) {
+    if (payload.size() < 2 || payload[0] != '#' || payload[1] < '1' || payload[1] > '9') return false;
+    size_t digits = static_cast<size_t>(payload[1] - '0');
+    if (payload.size() < 2 + digits) return false;
+    auto result = std::from_chars(payload.data() + 2, payload.data() + 2 + digits, length);
+    if (result.ec != std::errc() || result.ptr != payload.data() + 2 + digits) return false;
+    header = 2 + digits;
+    return true;
+}
+
+/** {@inheritdoc} */
+bool find_field(std::string_view payload, std::string_view key, ResponseFormat format, std::string_view &value) {
+    switch (format) {
+    case ResponseFormat::Text: {
+        size_t start = find_assignment(payload, key);
+        if (start == std::string_view::npos) return false;
+        size_t end = payload.find(", ", start);
+        size_t group_end = payload.find(" | ", start);
+        if (group_end < end) end = group_end;
+        value = payload.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        return true;
+    }
+    case ResponseFormat::Kv: {
+        size_t start = find_assignment(payload, key);
+        return start != std::string_view::npos && take_value(payload, start, " ", value);
+    }
+    case ResponseFormat::Json: {
+        std::string_view object = payload;
+        size_t dot = key.find('.');
+        if (dot != std::string_view::npos) {
+            size_t start = find_json_member(object, key.substr(0, dot));
+            if (start == std::string_view::npos || start >= object.size() || object[start] != '{') return false;
+            object = json_object(object, start);
+            key.remove_prefix(dot + 1);
+        }
+        size_t start = find_json_member(object, key);
+        return start != std::string_view::npos && take_value(object, start, ",}", value);
+    }
+    }
+    return false;
+}
+
+/** {@inheritdoc} */
+bool parse_number(std::string_view text, double &out) {
+    while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+    while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+    if (text.empty()) return false;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+} // namespace sercalo
@@ -0,0 +1,557 @@
+/**************************************************************************************************
+* Arquivo:      spectrum.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Kernels de análise de espectros (escalar, SSE2 e AVX2) e a escolha do
+* conjunto conforme o processador.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sercalo/spectrum.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SERCALO_SPECTRUM_X86 1
+#include <immintrin.h>
+#define SERCALO_TARGET_SSE2 __attribute__((target("sse2")))
+#define SERCALO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SERCALO_SPECTRUM_X86 0
+#endif
+
+namespace sercalo {
+
+namespace {
+
+constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+constexpr size_t AVERAGE_BLOCK = 2048;     // Pontos por bloco da média (8 KiB de soma, no cache L1).
+
+/**
+ * Conjunto de kernels de um nível. Os algoritmos (janelas, picos, FWHM) ficam
+ * fora daqui e chamam só estes laços internos.
+ */
+struct Kernels {
+    SimdLevel level;
+    void (*samples_to_float)(const uint8_t *samples, size_t count, float *out);
+    void (*accumulate)(float *sum, const float *x, size_t n);
+    void (*scale)(const float *x, size_t n, float k, float *out);
+    void (*subtract)(const float *a, const float *b, size_t n, float *out);
+    void (*combine_min)(const float *a, const float *b, size_t n, float *out);
+    void (*combine_max)(const float *a, const float *b, size_t n, float *out);
+    // Índices i em [1, n - 1) com x[i-1] < x[i] >= x[i+1] e x[i] >= threshold (no máximo `cap`).
+    size_t (*local_maxima)(const float *x, size_t n, float threshold, uint32_t *out, size_t cap);
+    // Primeiro j em [from, to) com x[j] < level, ou `to`.
+    size_t (*first_below)(const float *x, size_t from, size_t to, float level);
+    // Último j em [from, to) com x[j] < level, ou NOT_FOUND.
+    size_t (*last_below)(const float *x, size_t from, size_t to, float level);
+};
+
+// --- Escalar ---
+
+void samples_to_float_scalar(const uint8_t *samples, size_t count, float *out) {
+    for (size_t i = 0; i < count; i++) {
+        uint16_t v;
+        std::memcpy(&v, samples + 2 * i, sizeof(v));     // Host little-endian, como em data_plane.cpp.
+        out[i] = static_cast<float>(v);
+    }
+}
+
+void accumulate_scalar(float *sum, const float *x, size_t n) {
+    for (size_t i = 0; i < n; i++) sum[i] += x[i];
+}
+
+void scale_scalar(const float *x, size_t n, float k, float *out) {
+    for (size_t i = 0; i < n; i++) out[i] = x[i] * k;
+}
+
+void subtract_scalar(const float *a, const float *b, size_t n, float *out) {
+    for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i];
+}
+
+void combine_min_scalar(const float *a, const float *b, size_t n, float *out) {
+    for (size_t i = 0; i < n; i++) out[i] = std::min(a[i], b[i]);
+}
+
+void combine_max_scalar(const float *a, const float *b, size_t n, float *out) {
+    for (size_t i = 0; i < n; i++) out[i] = std::max(a[i], b[i]);
+}
+
+size_t local_maxima_scalar_range(const float *x, size_t begin, size_t end, float threshold, uint32_t *out,
+                                 size_t found, size_t cap) {
+    // Sem desvio por amostra: com ruído, a comparação com o vizinho erra a previsão metade das vezes.
+    for (size_t i = begin; i < end && found < cap; i++) {
+        out[found] = static_cast<uint32_t>(i);
+        found += (x[i] > x[i - 1]) & (x[i] >= x[i + 1]) & (x[i] >= threshold);
+    }
+    return found;
+}
+
+size_t local_maxima_scalar(const float *x, size_t n, float threshold, uint32_t *out, size_t cap) {
+    return n < 3 ? 0 : local_maxima_scalar_range(x, 1, n - 1, threshold, out, 0, cap);
+}
+
+size_t first_below_scalar(const float *x, size_t from, size_t to, float level) {
+    for (size_t j = from; j < to; j++) {
+        if (x[j] < level) return j;
+    }
+    return to;
+}
+
+size_t last_below_scalar(const float *x, size_t from, size_t to, float level) {
+    for (size_t j = to; j > from; j--) {
+        if (x[j - 1] < level) return j - 1;
+    }
+    return NOT_FOUND;
+}
+
+constexpr Kernels SCALAR = {
+    SimdLevel::Scalar, samples_to_float_scalar, accumulate_scalar, scale_scalar, subtract_scalar,
+    combine_min_scalar, combine_max_scalar, local_maxima_scalar, first_below_scalar, last_below_scalar,
+};
+
+#if SERCALO_SPECTRUM_X86
+
+// --- SSE2 (4 floats) ---
+
+SERCALO_TARGET_SSE2 void samples_to_float_sse2(const uint8_t *samples, size_t count, float *out) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + 2 * i));
+        _mm_storeu_ps(out + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)));
+        _mm_storeu_ps(out + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)));
+    }
+    samples_to_float_scalar(samples + 2 * i, count - i, out + i);
+}
+
+SERCALO_TARGET_SSE2 void accumulate_sse2(float *sum, const float *x, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), _mm_loadu_ps(x + i)));
+    accumulate_scalar(sum + i, x + i, n - i);
+}
+
+SERCALO_TARGET_SSE2 void scale_sse2(const float *x, size_t n, float k, float *out) {
+    const __m128 vk = _mm_set1_ps(k);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(x + i), vk));
+    scale_scalar(x + i, n - i, k, out + i);
+}
+
+SERCALO_TARGET_SSE2 void subtract_sse2(const float *a, const float *b, size_t n, float *out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    subtract_scalar(a + i, b + i, n - i, out + i);
+}
+
+SERCALO_TARGET_SSE2 void combine_min_sse2(const float *a, const float *b, size_t n, float *out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_min_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    combine_min_scalar(a + i, b + i, n - i, out + i);
+}
+
+SERCALO_TARGET_SSE2 void combine_max_sse2(const float *a, const float *b, size_t n, float *out) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_max_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    combine_max_scalar(a + i, b + i, n - i, out + i);
+}
+
+SERCALO_TARGET_SSE2 size_t local_maxima_sse2(const float *x, size_t n, float threshold, uint32_t *out, size_t cap) {
+    if (n < 3) return 0;
+    const __m128 vt = _mm_set1_ps(threshold);
+    size_t found = 0, i = 1;
+    for (; i + 4 <= n - 1 && found < cap; i += 4) {
+        __m128 c = _mm_loadu_ps(x + i);
+        __m128 m = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(c, _mm_loadu_ps(x + i - 1)),
+                                         _mm_cmpge_ps(c, _mm_loadu_ps(x + i + 1))),
+                              _mm_cmpge_ps(c, vt));
+        for (unsigned mask = static_cast<unsigned>(_mm_movemask_ps(m)); mask && found < cap; mask &= mask - 1) {
+            out[found++] = static_cast<uint32_t>(i + __builtin_ctz(mask));
+        }
+    }
+    return local_maxima_scalar_range(x, i, n - 1, threshold, out, found, cap);
+}
+
+SERCALO_TARGET_SSE2 size_t first_below_sse2(const float *x, size_t from, size_t to, float level) {
+    const __m128 vl = _mm_set1_ps(level);
+    size_t j = from;
+    for (; j + 4 <= to; j += 4) {
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(x + j), vl));
+        if (mask) return j + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    return first_below_scalar(x, j, to, level);
+}
+
+SERCALO_TARGET_SSE2 size_t last_below_sse2(const float *x, size_t from, size_t to, float level) {
+    const __m128 vl = _mm_set1_ps(level);
+    size_t j = to;
+    for (; j >= from + 4; j -= 4) {
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(x + j - 4), vl));
+        if (mask) return j - 4 + (31 - __builtin_clz(static_cast<unsigned>(mask)));
+    }
+    return last_below_scalar(x, from, j, level);
+}
+
+const Kernels SSE2 = {
+    SimdLevel::Sse2, samples_to_float_sse2, accumulate_sse2, scale_sse2, subtract_sse2,
+    combine_min_sse2, combine_max_sse2, local_maxima_sse2, first_below_sse2, last_below_sse2,
+};
+
+// --- AVX2 (8 floats) ---
+
+SERCALO_TARGET_AVX2 void samples_to_float_avx2(const uint8_t *samples, size_t count, float *out) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + 2 * i));
+        _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(v)));
+    }
+    samples_to_float_scalar(samples + 2 * i, count - i, out + i);
+}
+
+SERCALO_TARGET_AVX2 void accumulate_avx2(float *sum, const float *x, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(sum + i, _mm256_add_ps(_mm256_loadu_ps(sum + i), _mm256_loadu_ps(x + i)));
+    }
+    accumulate_scalar(sum + i, x + i, n - i);
+}
+
+SERCALO_TARGET_AVX2 void scale_avx2(const float *x, size_t n, float k, float *out) {
+    const __m256 vk = _mm256_set1_ps(k);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), vk));
+    scale_scalar(x + i, n - i, k, out + i);
+}
+
+SERCALO_TARGET_AVX2 void subtract_avx2(const float *a, const float *b, size_t n, float *out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    subtract_scalar(a + i, b + i, n - i, out + i);
+}
+
+SERCALO_TARGET_AVX2 void combine_min_avx2(const float *a, const float *b, size_t n, float *out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    combine_min_scalar(a + i, b + i, n - i, out + i);
+}
+
+SERCALO_TARGET_AVX2 void combine_max_avx2(const float *a, const float *b, size_t n, float *out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    combine_max_scalar(a + i, b + i, n - i, out + i);
+}
+
+SERCALO_TARGET_AVX2 size_t local_maxima_avx2(const float *x, size_t n, float threshold, uint32_t *out, size_t cap) {
+    if (n < 3) return 0;
+    const __m256 vt = _mm256_set1_ps(threshold);
+    size_t found = 0, i = 1;
+    for (; i + 8 <= n - 1 && found < cap; i += 8) {
+        __m256 c = _mm256_loadu_ps(x + i);
+        __m256 m = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(c, _mm256_loadu_ps(x + i - 1), _CMP_GT_OQ),
+                                               _mm256_cmp_ps(c, _mm256_loadu_ps(x + i + 1), _CMP_GE_OQ)),
+                                 _mm256_cmp_ps(c, vt, _CMP_GE_OQ));
+        for (unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(m)); mask && found < cap; mask &= mask - 1) {
+            out[found++] = static_cast<uint32_t>(i + __builtin_ctz(mask));
+        }
+    }
+    return local_maxima_scalar_range(x, i, n - 1, threshold, out, found, cap);
+}
+
+SERCALO_TARGET_AVX2 size_t first_below_avx2(const float *x, size_t from, size_t to, float level) {
+    const __m256 vl = _mm256_set1_ps(level);
+    size_t j = from;
+    for (; j + 8 <= to; j += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + j), vl, _CMP_LT_OQ));
+        if (mask) return j + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    return first_below_scalar(x, j, to, level);
+}
+
+SERCALO_TARGET_AVX2 size_t last_below_avx2(const float *x, size_t from, size_t to, float level) {
+    const __m256 vl = _mm256_set1_ps(level);
+    size_t j = to;
+    for (; j >= from + 8; j -= 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + j - 8), vl, _CMP_LT_OQ));
+        if (mask) return j - 8 + (31 - __builtin_clz(static_cast<unsigned>(mask)));
+    }
+    return last_below_scalar(x, from, j, level);
+}
+
+const Kernels AVX2 = {
+    SimdLevel::Avx2, samples_to_float_avx2, accumulate_avx2, scale_avx2, subtract_avx2,
+    combine_min_avx2, combine_max_avx2, local_maxima_avx2, first_below_avx2, last_below_avx2,
+};
+
+#endif // SERCALO_SPECTRUM_X86
+
+const Kernels *kernels_for(SimdLevel level) {
+#if SERCALO_SPECTRUM_X86
+    if (level == SimdLevel::Avx2) return &AVX2;
+    if (level == SimdLevel::Sse2) return &SSE2;
+#endif
+    (void)level;
+    return &SCALAR;
+}
+
+std::atomic<const Kernels *> s_kernels{nullptr};
+
+const Kernels &kernels() {
+    const Kernels *k = s_kernels.load(std::memory_order_acquire);
+    if (k == nullptr) {
+        k = kernels_for(simd_supported());
+        s_kernels.store(k, std::memory_order_release);
+    }
+    return *k;
+}
+
+} // namespace
+
+/** {@inheritdoc} */
+SimdLevel simd_supported() {
+#if SERCALO_SPECTRUM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+/** {@inheritdoc} */
+SimdLevel simd_level() {
+    return kernels().level;
+}
+
+/** {@inheritdoc} */
+SimdLevel set_simd_level(SimdLevel level) {
+    const Kernels *k = kernels_for(std::min(level, simd_supported()));
+    s_kernels.store(k, std::memory_order_release);
+    return k->level;
+}
+
+/** {@inheritdoc} */
+const char *to_string(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2: return "AVX2";
+    case SimdLevel::Sse2: return "SSE2";
+    default: return "escalar";
+    }
+}
+
+/** {@inheritdoc} */
+void samples_to_float(const uint8_t *samples, size_t count, float *out) {
+    kernels().samples_to_float(samples, count, out);
+}
+
+/** {@inheritdoc} */
+void accumulate(float *sum, const float *x, size_t n) {
+    kernels().accumulate(sum, x, n);
+}
+
+/** {@inheritdoc} */
+void scale(const float *x, size_t n, float k, float *out) {
+    kernels().scale(x, n, k, out);
+}
+
+/** {@inheritdoc} */
+void average(const float *spectra, size_t count, size_t n, float *out) {
+    if (count == 0) return;
+    const Kernels &k = kernels();
+    // Em blocos de colunas: a soma parcial fica no cache enquanto as varreduras passam.
+    for (size_t begin = 0; begin < n; begin += AVERAGE_BLOCK) {
+        size_t len = std::min(AVERAGE_BLOCK, n - begin);
+        std::memcpy(out + begin, spectra + begin, len * sizeof(float));
+        for (size_t s = 1; s < count; s++) k.accumulate(out + begin, spectra + s * n + begin, len);
+        k.scale(out + begin, len, 1.0f / static_cast<float>(count), out + begin);
+    }
+}
+
+/** {@inheritdoc} */
+size_t find_peaks(const float *x, size_t n, float threshold, size_t min_distance, Peak *out, size_t cap) {
+    const Kernels &k = kernels();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    uint32_t index[256];
+    size_t kept = 0, begin = 1;
+    while (n >= 3 && begin < n - 1 && cap > 0) {
+        // Candidatos em [begin, end), em lotes de até 256; o lote seguinte recomeça após o último.
+        size_t end = std::min(n - 1, begin + 4096);
+        size_t found = k.local_maxima(x + begin - 1, end - begin + 2, threshold, index, 256);
+        for (size_t c = 0; c < found; c++) index[c] += static_cast<uint32_t>(begin - 1);
+        size_t next = found == 256 ? index[255] + 1 : end;
+        for (size_t c = 0; c < found; c++) {
+            uint32_t i = index[c];
+            if (kept > 0 && i - out[kept - 1].index < min_distance) {
+                if (x[i] > out[kept - 1].height) out[kept - 1] = Peak{i, x[i], nan, nan};
+            } else if (kept < cap) {
+                out[kept++] = Peak{i, x[i], nan, nan};
+            } else {
+                return kept;
+            }
+        }
+        begin = next;
+    }
+    return kept;
+}
+
+/** {@inheritdoc} */
+void measure_fwhm(const float *x, size_t n, Peak *peaks, size_t count) {
+    const Kernels &k = kernels();
+    for (size_t p = 0; p < count; p++) {
+        Peak &peak = peaks[p];
+        float half = peak.height * 0.5f;
+        size_t r = k.first_below(x, peak.index + 1, n, half);
+        peak.right = r == n ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(r - 1) + (x[r - 1] - half) / (x[r - 1] - x[r]);
+        size_t l = k.last_below(x, 0, peak.index, half);
+        peak.left = l == NOT_FOUND ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(l) + (half - x[l]) / (x[l + 1] - x[l]);
+    }
+}
+
+// --- SpectrumAnalyzer ---
+
+void SpectrumAnalyzer::morph(const float *in, size_t n, size_t window, bool maximum, float *out) {
+    // Mínimo (ou máximo) em janelas de tamanho dobrado a cada passe, K = 1, 2, 4...: cada
+    // passe combina o vetor com ele mesmo deslocado de K, um kernel vetorial sem dependência
+    // entre amostras. A janela de `window` é a combinação de duas janelas de K sobrepostas.
+    // O(n log window), contra O(n window) recalculando cada janela.
+    const size_t half = window / 2;
+    const size_t m = n + 2 * half;
+    const float pad = maximum ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+    if (padded_.size() < m) {
+        padded_.resize(m);
+        work_a_.resize(m);
+        work_b_.resize(m);
+    }
+    float *p = padded_.data();
+    std::fill(p, p + half, pad);
+    std::memcpy(p + half, in, n * sizeof(float));
+    std::fill(p + half + n, p + m, pad);
+
+    const Kernels &k = kernels();
+    auto combine = maximum ? k.combine_max : k.combine_min;
+    const float *src = p;
+    float *dst = work_a_.data(), *spare = work_b_.data();
+    size_t len = m, span = 1;
+    while (2 * span <= window) {
+        combine(src, src + span, len - span, dst);
+        len -= span;
+        span *= 2;
+        src = dst;
+        std::swap(dst, spare);
+    }
+    combine(src, src + window - span, n, out);
+}
+
+/** {@inheritdoc} */
+void SpectrumAnalyzer::remove_baseline(const float *x, size_t n, size_t window, float *out, float *baseline) {
+    window |= 1;    // Janela centrada: ímpar.
+    if (eroded_.size() < n) eroded_.resize(n);
+    if (baseline == nullptr) {
+        if (baseline_.size() < n) baseline_.resize(n);
+        baseline = baseline_.data();
+    }
+    morph(x, n, window, false, eroded_.data());
+    morph(eroded_.data(), n, window, true, baseline);
+    kernels().subtract(x, baseline, n, out);
+}
+
+/** {@inheritdoc} */
+size_t SpectrumAnalyzer::analyze(const float *x, size_t n, size_t window, float threshold, size_t min_distance,
+                                 float *corrected, Peak *out, size_t cap) {
+    remove_baseline(x, n, window, corrected);
+    size_t count = find_peaks(corrected, n, threshold, min_distance, out, cap);
+    measure_fwhm(corrected, n, out, count);
+    return count;
+}
+
+// --- SpectrumAssembler ---
+
+/** {@inheritdoc} */
+bool SpectrumAssembler::add(const SpectrumChunk &chunk) {
+    if (!started_ || chunk.cycle != cycle_ || chunk.total != values_.size()) {
+        if (started_ && received_ > 0 && received_ < values_.size()) incomplete_++;
+        started_ = true;
+        cycle_ = chunk.cycle;
+        start_wl_ = chunk.start_wl;
+        step_wl_ = chunk.step_wl;
+        received_ = 0;
+        values_.assign(chunk.total, std::numeric_limits<float>::quiet_NaN());
+    }
+    if (chunk.first >= values_.size() || received_ == values_.size()) return false;
+    size_t count = std::min<size_t>(chunk.count, values_.size() - chunk.first);
+    samples_to_float(chunk.samples, count, values_.data() + chunk.first);
+    received_ += count;
+    return received_ == values_.size();
+}
+
+// --- SpectrumAverager ---
+
+/** {@inheritdoc} */
+void SpectrumAverager::add(const float *x, size_t n) {
+    if (n != sum_.size() || count_ == 0) {
+        sum_.assign(x, x + n);
+        count_ = 1;
+        return;
+    }
+    accumulate(sum_.data(), x, n);
+    count_++;
+}
+
+/** {@inheritdoc} */
+void SpectrumAverager::mean(float *out) const {
+    if (count_ > 0) scale(sum_.data(), sum_.size(), 1.0f / static_cast<float>(count_), out);
+}
+
+} // namespace sercalo
+
+// --- API C ---
+
+extern "C" {
+
+int sercalo_simd_level(void) {
+    return static_cast<int>(sercalo::simd_level());
+}
+
+int sercalo_set_simd_level(int level) {
+    return static_cast<int>(sercalo::set_simd_level(static_cast<sercalo::SimdLevel>(std::clamp(level, 0, 2))));
+}
+
+void sercalo_average(const float *spectra, size_t count, size_t n, float *out) {
+    sercalo::average(spectra, count, n, out);
+}
+
+void sercalo_remove_baseline(const float *x, size_t n, size_t window, float *out, float *baseline) {
+    thread_local sercalo::SpectrumAnalyzer analyzer;
+    analyzer.remove_baseline(x, n, window, out, baseline);
+}
+
+size_t sercalo_analyze(const float *x, size_t n, size_t window, float threshold, size_t min_distance,
+                       float *corrected, sercalo_peak_t *out, size_t cap) {
+    thread_local sercalo::SpectrumAnalyzer analyzer;
+    return analyzer.analyze(x, n, window, threshold, min_distance, corrected, out, cap);
+}
+
+size_t sercalo_find_peaks(const float *x, size_t n, float threshold, size_t min_distance,
+                          sercalo_peak_t *out, size_t cap) {
+    size_t count = sercalo::find_peaks(x, n, threshold, min_distance, out, cap);
+    sercalo::measure_fwhm(x, n, out, count);
+    return count;
+}
+
+} // extern "C"
@@ -0,0 +1,169 @@
+/**************************************************************************************************
+* Arquivo:      transport.cpp
+* Autor:        Felipe Oliveira Barino
+* Data:         2026-10-18
+* Versão:       0.1.0
+*
+* Descrição:    Transportes serial e TCP do cliente C++.
+*
+* Plataforma:   Linux / POSIX (host)
+* Compilador:   g++ / clang++ (C++17)
+*
+* Histórico de Modificações:
+* [2026-10-18] - [Barino] - [0.1.0] - Versão inicial.
+*
+**************************************************************************************************/
+
+#include "sercalo/transport.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace sercalo {
+
+namespace {
+
+[[noreturn]] void throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+speed_t baud_constant(unsigned baudrate) {
+    switch (baudrate) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B460800
+    case 460800: return B460800;
+    case 921600: return B921600;
+#endif
+    default: return B0;
+    }
+}
+
+class FdTransport : public Transport {
+public:
+    FdTransport(int fd, std::string name, bool socket) : Transport(fd, std::move(name), socket) {}
+};
+
+} // namespace
+
+Transport::Transport(int fd, std::string name, bool socket) : fd_(fd), name_(std::move(name)), socket_(socket) {}
+
+Transport::~Transport() {
+    close();
+}
+
+/** {@inheritdoc} */
+long Transport::read_some(uint8_t *buf, size_t cap, std::chrono::milliseconds timeout) {
+    if (fd_ < 0) return -1;
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (ready < 0) {
+        if (errno == EINTR) return 0;
+        throw_errno("poll " + name_);
+    }
+    if (ready == 0) return 0;
+    ssize_t n = ::read(fd_, buf, cap);
+    if (n > 0) return n;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+    return -1;  // EOF, ou EIO de um pseudo-terminal cujo outro lado fechou.
+}
+
+/** {@inheritdoc} */
+void Transport::write_all(const void *data, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (len > 0) {
+        // Em sockets, sem SIGPIPE se o outro lado fechou: a falha vira exceção.
+        ssize_t n = socket_ ? ::send(fd_, p, len, MSG_NOSIGNAL) : ::write(fd_, p, len);
+        if (n > 0) {
+            p += n;
+            len -= static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd pfd{fd_, POLLOUT, 0};
+            ::poll(&pfd, 1, 100);
+            continue;
+        }
+        throw_errno("write " + name_);
+    }
+}
+
+/** {@inheritdoc} */
+void Transport::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+/** {@inheritdoc} */
+std::unique_ptr<Transport> open_serial(const std::string &path, unsigned baudrate) {
+    int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) throw_errno("open " + path);
+
+    termios tio;
+    if (::tcgetattr(fd, &tio) == 0) {
+        ::cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        speed_t speed = baud_constant(baudrate);
+        if (speed != B0) {
+            ::cfsetispeed(&tio, speed);
+            ::cfsetospeed(&tio, speed);
+        }
+        ::tcsetattr(fd, TCSANOW, &tio);
+    } // Sem atributos de terminal (ex.: FIFO de teste): usa como está.
+    return std::make_unique<FdTransport>(fd, path, false);
+}
+
+/** {@inheritdoc} */
+std::unique_ptr<Transport> open_tcp(const std::string &host, uint16_t port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *list = nullptr;
+    std::string service = std::to_string(port);
+    int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &list);
+    if (rc != 0) {
+        throw std::system_error(EHOSTUNREACH, std::generic_category(), host + ": " + ::gai_strerror(rc));
+    }
+
+    int fd = -1;
+    int error = ECONNREFUSED;
+    for (addrinfo *ai = list; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            error = errno;
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        error = errno;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(list);
+    if (fd < 0) {
+        throw std::system_error(error, std::generic_category(), "connect " + host + ":" + service);
+    }
+
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return std::make_unique<FdTransport>(fd, host + ":" + service, true);
+}
+
+} // namespace sercalo